@@ -24,6 +24,7 @@
 
 #include "fileList.h"
 #include "lexer/lexer.h"
+#include "util/container/optimization.h"
 #include "util/container/stringBuilder.h"
 #include "util/conversions.h"
 #include "util/format.h"
@@ -301,22 +302,25 @@ Node *varDefnNodeCreate(Node *type, Vector *names, Vector *initializers) {
   n->data.varDefn.type = type;
   n->data.varDefn.names = names;
   n->data.varDefn.initializers = initializers;
+  n->data.varDefn.threadLocal = false;
   return n;
 }
 
 Node *funDeclNodeCreate(Node *returnType, Node *name, Vector *argTypes,
-                        Vector *argNames) {
+                        Vector *argNames, FunctionEffect effect) {
   Node *n = createNode(NT_FUNDECL, returnType->line, returnType->character);
   n->data.funDecl.returnType = returnType;
   n->data.funDecl.name = name;
   n->data.funDecl.argTypes = argTypes;
   n->data.funDecl.argNames = argNames;
+  n->data.funDecl.effect = effect;
   return n;
 }
 Node *varDeclNodeCreate(Node *type, Vector *names) {
   Node *n = createNode(NT_VARDECL, type->line, type->character);
   n->data.varDecl.type = type;
   n->data.varDecl.names = names;
+  n->data.varDecl.threadLocal = false;
   return n;
 }
 Node *opaqueDeclNodeCreate(Token const *keyword, Node *name) {
@@ -359,10 +363,11 @@ Node *compoundStmtNodeCreate(Token const *lbrace, Vector *stmts,
   n->data.compoundStmt.stmts = stmts;
   return n;
 }
-Node *ifStmtNodeCreate(Token const *keyword, Node *predicate, Node *consequent,
-                       HashMap *consequentStab, Node *alternative,
-                       HashMap *alternativeStab) {
+Node *ifStmtNodeCreate(Token const *keyword, BranchHint hint, Node *predicate,
+                       Node *consequent, HashMap *consequentStab,
+                       Node *alternative, HashMap *alternativeStab) {
   Node *n = createNode(NT_IFSTMT, keyword->line, keyword->character);
+  n->data.ifStmt.hint = hint;
   n->data.ifStmt.predicate = predicate;
   n->data.ifStmt.consequent = consequent;
   n->data.ifStmt.consequentStab = consequentStab;
@@ -839,6 +844,468 @@ Node *sizedIntegerLiteralNodeCreate(Token *t, int8_t sign, uint64_t magnitude) {
   }
 }
 
+size_t const PACKED_INIT_MIN_LENGTH = 16;
+
+/**
+ * gets the kind of a literal type - integer types of the same signedness
+ * share a kind
+ *
+ * @param type literal type to classify
+ * @returns narrowest literal type of the kind, or LT_AGGREGATEINIT if literals
+ * of this type can't be packed
+ */
+static LiteralType literalKind(LiteralType type) {
+  switch (type) {
+    case LT_UBYTE:
+    case LT_USHORT:
+    case LT_UINT:
+    case LT_ULONG: {
+      return LT_UBYTE;
+    }
+    case LT_BYTE:
+    case LT_SHORT:
+    case LT_INT:
+    case LT_LONG: {
+      return LT_BYTE;
+    }
+    case LT_FLOAT:
+    case LT_DOUBLE:
+    case LT_CHAR:
+    case LT_WCHAR:
+    case LT_BOOL: {
+      return type;
+    }
+    default: {
+      return LT_AGGREGATEINIT;
+    }
+  }
+}
+/**
+ * gets the packing class of a literal type - elements of an aggregate
+ * initializer can only be packed together if they all share a class
+ *
+ * integers of either signedness share a class, represented by LT_UBYTE
+ *
+ * @param type literal type to classify
+ * @returns class, or LT_AGGREGATEINIT if literals of this type can't be packed
+ */
+static LiteralType packingClass(LiteralType type) {
+  LiteralType kind = literalKind(type);
+  return kind == LT_BYTE ? LT_UBYTE : kind;
+}
+/**
+ * gets the kind of a packed element
+ *
+ * @param elementType type the element is stored as
+ * @param isSigned was the element a signed integer literal
+ * @returns kind of the element's standalone literal type
+ */
+static LiteralType elementKind(LiteralType elementType, bool isSigned) {
+  LiteralType class = packingClass(elementType);
+  return class == LT_UBYTE && isSigned ? LT_BYTE : class;
+}
+/**
+ * gets the width, in bytes, of a packed element
+ *
+ * @param type packable literal type
+ * @returns width of an element of that type
+ */
+static size_t packedElementWidth(LiteralType type) {
+  switch (type) {
+    case LT_UBYTE:
+    case LT_BYTE:
+    case LT_CHAR:
+    case LT_BOOL: {
+      return 1;
+    }
+    case LT_USHORT:
+    case LT_SHORT: {
+      return 2;
+    }
+    case LT_UINT:
+    case LT_INT:
+    case LT_FLOAT:
+    case LT_WCHAR: {
+      return 4;
+    }
+    case LT_ULONG:
+    case LT_LONG:
+    case LT_DOUBLE: {
+      return 8;
+    }
+    default: {
+      error(__FILE__, __LINE__, "unpackable literal type given");
+    }
+  }
+}
+/**
+ * gets the type an integer literal with the given value would have been
+ * given by sizedIntegerLiteralNodeCreate
+ *
+ * @param kind kind of the literal
+ * @param bits raw bits of the literal
+ * @returns narrowest literal type of the kind that holds the value
+ */
+static LiteralType narrowestLiteralType(LiteralType kind, uint64_t bits) {
+  if (kind == LT_UBYTE) {
+    if (bits <= UBYTE_MAX)
+      return LT_UBYTE;
+    else if (bits <= USHORT_MAX)
+      return LT_USHORT;
+    else if (bits <= UINT_MAX)
+      return LT_UINT;
+    else
+      return LT_ULONG;
+  } else if (kind == LT_BYTE) {
+    int64_t value = (int64_t)bits;
+    if (value >= -(int64_t)BYTE_MIN && value <= (int64_t)BYTE_MAX)
+      return LT_BYTE;
+    else if (value >= -(int64_t)SHORT_MIN && value <= (int64_t)SHORT_MAX)
+      return LT_SHORT;
+    else if (value >= -(int64_t)INT_MIN && value <= (int64_t)INT_MAX)
+      return LT_INT;
+    else
+      return LT_LONG;
+  } else {
+    return kind;
+  }
+}
+/**
+ * gets the raw bits of a packable literal
+ *
+ * @param literal literal to read
+ * @returns bits, as described in packedInitGet
+ */
+static uint64_t literalBits(Node const *literal) {
+  switch (literal->data.literal.literalType) {
+    case LT_UBYTE: {
+      return literal->data.literal.data.ubyteVal;
+    }
+    case LT_BYTE: {
+      return (uint64_t)(int64_t)literal->data.literal.data.byteVal;
+    }
+    case LT_USHORT: {
+      return literal->data.literal.data.ushortVal;
+    }
+    case LT_SHORT: {
+      return (uint64_t)(int64_t)literal->data.literal.data.shortVal;
+    }
+    case LT_UINT: {
+      return literal->data.literal.data.uintVal;
+    }
+    case LT_INT: {
+      return (uint64_t)(int64_t)literal->data.literal.data.intVal;
+    }
+    case LT_ULONG: {
+      return literal->data.literal.data.ulongVal;
+    }
+    case LT_LONG: {
+      return (uint64_t)literal->data.literal.data.longVal;
+    }
+    case LT_FLOAT: {
+      return literal->data.literal.data.floatBits;
+    }
+    case LT_DOUBLE: {
+      return literal->data.literal.data.doubleBits;
+    }
+    case LT_CHAR: {
+      return literal->data.literal.data.charVal;
+    }
+    case LT_WCHAR: {
+      return literal->data.literal.data.wcharVal;
+    }
+    case LT_BOOL: {
+      return literal->data.literal.data.boolVal ? 1 : 0;
+    }
+    default: {
+      error(__FILE__, __LINE__, "unpackable literal given to literalBits");
+    }
+  }
+}
+/**
+ * re-creates a standalone literal from its raw bits
+ *
+ * @param type type of the literal
+ * @param bits raw bits of the literal
+ * @param line line of the literal
+ * @param character character of the literal
+ * @returns literal node
+ */
+static Node *bitsLiteralNodeCreate(LiteralType type, uint64_t bits, size_t line,
+                                   size_t character) {
+  Node *n = createNode(NT_LITERAL, line, character);
+  n->data.literal.literalType = type;
+  n->data.literal.type = NULL;
+  switch (type) {
+    case LT_UBYTE: {
+      n->data.literal.data.ubyteVal = (uint8_t)bits;
+      break;
+    }
+    case LT_BYTE: {
+      n->data.literal.data.byteVal = (int8_t)bits;
+      break;
+    }
+    case LT_USHORT: {
+      n->data.literal.data.ushortVal = (uint16_t)bits;
+      break;
+    }
+    case LT_SHORT: {
+      n->data.literal.data.shortVal = (int16_t)bits;
+      break;
+    }
+    case LT_UINT: {
+      n->data.literal.data.uintVal = (uint32_t)bits;
+      break;
+    }
+    case LT_INT: {
+      n->data.literal.data.intVal = (int32_t)bits;
+      break;
+    }
+    case LT_ULONG: {
+      n->data.literal.data.ulongVal = bits;
+      break;
+    }
+    case LT_LONG: {
+      n->data.literal.data.longVal = (int64_t)bits;
+      break;
+    }
+    case LT_FLOAT: {
+      n->data.literal.data.floatBits = (uint32_t)bits;
+      break;
+    }
+    case LT_DOUBLE: {
+      n->data.literal.data.doubleBits = bits;
+      break;
+    }
+    case LT_CHAR: {
+      n->data.literal.data.charVal = (uint8_t)bits;
+      break;
+    }
+    case LT_WCHAR: {
+      n->data.literal.data.wcharVal = (uint32_t)bits;
+      break;
+    }
+    case LT_BOOL: {
+      n->data.literal.data.boolVal = bits != 0;
+      break;
+    }
+    default: {
+      error(__FILE__, __LINE__, "unpackable literal type given");
+    }
+  }
+  return n;
+}
+
+void aggregateInitBuilderInit(AggregateInitBuilder *builder) {
+  builder->literals = NULL;
+  builder->elementType = LT_AGGREGATEINIT;
+  builder->min = 0;
+  builder->max = 0;
+  builder->size = 0;
+  builder->capacity = INT_VECTOR_INIT_CAPACITY;
+  builder->values = malloc(builder->capacity * sizeof(uint64_t));
+  builder->signs = malloc(builder->capacity * sizeof(bool));
+  builder->lines = malloc(builder->capacity * sizeof(size_t));
+  builder->characters = malloc(builder->capacity * sizeof(size_t));
+}
+/**
+ * stops packing - turns all packed elements back into nodes
+ *
+ * @param builder builder to unpack
+ */
+static void aggregateInitBuilderUnpack(AggregateInitBuilder *builder) {
+  builder->literals = vectorCreate();
+  for (size_t idx = 0; idx < builder->size; ++idx) {
+    uint64_t bits = builder->values[idx];
+    LiteralType type = narrowestLiteralType(
+        elementKind(builder->elementType, builder->signs[idx]), bits);
+    vectorInsert(builder->literals,
+                 bitsLiteralNodeCreate(type, bits, builder->lines[idx],
+                                       builder->characters[idx]));
+  }
+  free(builder->values);
+  free(builder->signs);
+  free(builder->lines);
+  free(builder->characters);
+  builder->values = NULL;
+  builder->signs = NULL;
+  builder->lines = NULL;
+  builder->characters = NULL;
+  builder->size = 0;
+}
+/**
+ * gets the narrowest type that holds every integer in a range
+ *
+ * @param min smallest integer
+ * @param max largest non-negative integer
+ * @returns narrowest type, or LT_AGGREGATEINIT if no type holds the range
+ */
+static LiteralType rangeLiteralType(int64_t min, uint64_t max) {
+  if (min >= 0) return narrowestLiteralType(LT_UBYTE, max);
+  if (max > LONG_MAX) return LT_AGGREGATEINIT;
+
+  // within a kind, wider types have larger LiteralType values
+  LiteralType minType = narrowestLiteralType(LT_BYTE, (uint64_t)min);
+  LiteralType maxType = narrowestLiteralType(LT_BYTE, max);
+  return minType > maxType ? minType : maxType;
+}
+void aggregateInitBuilderAdd(AggregateInitBuilder *builder, Node *element) {
+  if (builder->literals == NULL && element->type == NT_LITERAL) {
+    LiteralType type = element->data.literal.literalType;
+    LiteralType kind = literalKind(type);
+    LiteralType class = packingClass(type);
+    if (class != LT_AGGREGATEINIT &&
+        (builder->size == 0 || class == packingClass(builder->elementType))) {
+      uint64_t bits = literalBits(element);
+      int64_t min = builder->min;
+      uint64_t max = builder->max;
+      LiteralType elementType = type;
+      if (class == LT_UBYTE) {
+        // integers are stored in the narrowest type holding all of them
+        if (kind == LT_BYTE && (int64_t)bits < 0)
+          min = (int64_t)bits < min ? (int64_t)bits : min;
+        else
+          max = bits > max ? bits : max;
+        elementType = rangeLiteralType(min, max);
+      }
+      if (narrowestLiteralType(kind, bits) == type &&
+          elementType != LT_AGGREGATEINIT) {
+        // can be packed
+        if (builder->size == builder->capacity) {
+          builder->capacity *= VECTOR_GROWTH_FACTOR;
+          builder->values =
+              realloc(builder->values, builder->capacity * sizeof(uint64_t));
+          builder->signs =
+              realloc(builder->signs, builder->capacity * sizeof(bool));
+          builder->lines =
+              realloc(builder->lines, builder->capacity * sizeof(size_t));
+          builder->characters =
+              realloc(builder->characters, builder->capacity * sizeof(size_t));
+        }
+        builder->elementType = elementType;
+        builder->min = min;
+        builder->max = max;
+        builder->values[builder->size] = bits;
+        builder->signs[builder->size] = kind == LT_BYTE;
+        builder->lines[builder->size] = element->line;
+        builder->characters[builder->size] = element->character;
+        ++builder->size;
+        nodeFree(element);
+        return;
+      }
+    }
+  }
+
+  if (builder->literals == NULL) aggregateInitBuilderUnpack(builder);
+  vectorInsert(builder->literals, element);
+}
+Node *aggregateInitBuilderFinish(AggregateInitBuilder *builder,
+                                 Token const *start) {
+  Node *n = literalNodeCreate(LT_AGGREGATEINIT, start);
+  if (builder->literals == NULL && builder->size >= PACKED_INIT_MIN_LENGTH) {
+    size_t width = packedElementWidth(builder->elementType);
+    bool integral = packingClass(builder->elementType) == LT_UBYTE;
+    size_t signsSize = integral ? (builder->size + 7) / 8 : 0;
+    PackedInit *init =
+        malloc(sizeof(PackedInit) + width * builder->size + signsSize);
+    init->elementType = builder->elementType;
+    init->length = builder->size;
+    uint8_t *signs = &init->data[width * builder->size];
+    memset(signs, 0, signsSize);
+    for (size_t idx = 0; idx < builder->size; ++idx) {
+      if (integral && builder->signs[idx])
+        signs[idx / 8] |= (uint8_t)(1U << (idx % 8));
+
+      uint8_t *element = &init->data[idx * width];
+      switch (width) {
+        case 1: {
+          uint8_t value = (uint8_t)builder->values[idx];
+          memcpy(element, &value, width);
+          break;
+        }
+        case 2: {
+          uint16_t value = (uint16_t)builder->values[idx];
+          memcpy(element, &value, width);
+          break;
+        }
+        case 4: {
+          uint32_t value = (uint32_t)builder->values[idx];
+          memcpy(element, &value, width);
+          break;
+        }
+        default: {
+          memcpy(element, &builder->values[idx], width);
+          break;
+        }
+      }
+    }
+    free(builder->values);
+    free(builder->signs);
+    free(builder->lines);
+    free(builder->characters);
+
+    n->data.literal.literalType = LT_PACKEDINIT;
+    n->data.literal.data.packedInitVal = init;
+  } else {
+    if (builder->literals == NULL) aggregateInitBuilderUnpack(builder);
+    n->data.literal.data.aggregateInitVal = builder->literals;
+  }
+  return n;
+}
+void aggregateInitBuilderUninit(AggregateInitBuilder *builder) {
+  if (builder->literals != NULL) nodeVectorFree(builder->literals);
+  free(builder->values);
+  free(builder->signs);
+  free(builder->lines);
+  free(builder->characters);
+}
+
+uint64_t packedInitGet(PackedInit const *init, size_t idx) {
+  bool isSigned = literalKind(init->elementType) == LT_BYTE;
+  size_t width = packedElementWidth(init->elementType);
+  uint8_t const *element = &init->data[idx * width];
+  switch (width) {
+    case 1: {
+      uint8_t value;
+      memcpy(&value, element, width);
+      return isSigned ? (uint64_t)(int8_t)value : value;
+    }
+    case 2: {
+      uint16_t value;
+      memcpy(&value, element, width);
+      return isSigned ? (uint64_t)(int16_t)value : value;
+    }
+    case 4: {
+      uint32_t value;
+      memcpy(&value, element, width);
+      return isSigned ? (uint64_t)(int32_t)value : value;
+    }
+    default: {
+      uint64_t value;
+      memcpy(&value, element, width);
+      return value;
+    }
+  }
+}
+LiteralType packedInitElementType(PackedInit const *init, size_t idx) {
+  bool isSigned = false;
+  if (packingClass(init->elementType) == LT_UBYTE) {
+    // the signs follow the elements, a bit per element
+    uint8_t const *signs =
+        &init->data[init->length * packedElementWidth(init->elementType)];
+    isSigned = ((signs[idx / 8] >> (idx % 8)) & 1) != 0;
+  }
+  return narrowestLiteralType(elementKind(init->elementType, isSigned),
+                              packedInitGet(init, idx));
+}
+bool packedInitIsZero(PackedInit const *init) {
+  size_t size = init->length * packedElementWidth(init->elementType);
+  for (size_t idx = 0; idx < size; ++idx) {
+    if (init->data[idx] != 0) return false;
+  }
+  return true;
+}
+
 Node *keywordTypeNodeCreate(TypeKeyword keyword, Token const *keywordToken) {
   Node *n =
       createNode(NT_KEYWORDTYPE, keywordToken->line, keywordToken->character);
@@ -1366,6 +1833,10 @@ void nodeFree(Node *n) {
           nodeVectorFree(n->data.literal.data.aggregateInitVal);
           break;
         }
+        case LT_PACKEDINIT: {
+          free(n->data.literal.data.packedInitVal);
+          break;
+        }
         default: {
           break;
         }
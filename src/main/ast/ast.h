@@ -187,8 +187,28 @@ typedef enum {
   LT_BOOL,
   LT_NULL,
   LT_AGGREGATEINIT,
+  LT_PACKEDINIT,
 } LiteralType;
 
+/**
+ * a homogeneous aggregate initializer, stored as a packed array of values
+ *
+ * used in place of an LT_AGGREGATEINIT when every element is a scalar literal
+ * of the same kind (integer, float, double, char, wchar or bool), so large
+ * constant tables don't need a node per element. Integers of either
+ * signedness are packed together, in the narrowest type that holds all of
+ * them, and each keeps the type it would have had as a standalone literal
+ */
+typedef struct {
+  LiteralType elementType; /**< narrowest type holding every element;
+                              determines the width of each element in data */
+  size_t length;           /**< number of elements */
+  uint8_t data[];          /**< elements, each a native-endian value of the
+                              width given by elementType, followed, for
+                              integers, by a bitmap of which elements were
+                              signed literals */
+} PackedInit;
+
 /** type modification kind */
 typedef enum {
   TMK_CONST,
@@ -196,6 +216,20 @@ typedef enum {
   TMK_POINTER,
 } TypeModifierKind;
 
+/** memory effects declared for a function */
+typedef enum {
+  FE_UNKNOWN,  /**< may read and write any memory */
+  FE_READONLY, /**< declared const - only reads memory */
+  FE_PURE,     /**< declared pure - result depends only on the arguments */
+} FunctionEffect;
+
+/** declared probability of a branch being taken */
+typedef enum {
+  BH_NONE,     /**< no hint given */
+  BH_LIKELY,   /**< declared likely - the condition is almost always true */
+  BH_UNLIKELY, /**< declared unlikely - the condition is almost always false */
+} BranchHint;
+
 // type modifier list is shared from symbolTable.h
 // type keyword list is shared from symbolTable.h
 
@@ -233,6 +267,7 @@ typedef struct Node {
       struct Node *type;    /**< type */
       Vector *names;        /**< vector of Nodes, each is an NT_ID */
       Vector *initializers; /**< vector of nullable Nodes, each is a literal */
+      bool threadLocal;     /**< does each thread get its own copy? */
     } varDefn;
 
     struct {
@@ -240,10 +275,12 @@ typedef struct Node {
       struct Node *name;       /**< NT_ID */
       Vector *argTypes;        /**< vector of Nodes, each is a type */
       Vector *argNames; /**< vector of nullable Nodes, each is an NT_ID */
+      FunctionEffect effect; /**< declared memory effects */
     } funDecl;
     struct {
       struct Node *type; /**< type */
       Vector *names;     /**< vector of Nodes, each is an NT_ID */
+      bool threadLocal;  /**< does each thread get its own copy? */
     } varDecl;
     struct {
       struct Node *name; /**< NT_ID */
@@ -277,6 +314,7 @@ typedef struct Node {
       HashMap *consequentStab;  /**< symbol table */
       struct Node *alternative; /**< nullable statement */
       HashMap *alternativeStab; /**< nullable symbol table */
+      BranchHint hint;          /**< declared probability of the predicate */
     } ifStmt;
     struct {
       struct Node *condition; /**< expression */
@@ -378,6 +416,7 @@ typedef struct Node {
         bool boolVal;
         Vector *aggregateInitVal; /**< vector of Nodes, each is an NT_LITERAL or
                                     an NT_SCOPEDID (enumeration constant) */
+        PackedInit *packedInitVal;
       } data;
       Type *type;
     } literal;
@@ -430,7 +469,7 @@ Node *funDefnNodeCreate(Node *returnType, Node *name, Vector *argTypes,
                         Vector *argNames, Node *body);
 Node *varDefnNodeCreate(Node *type, Vector *names, Vector *initializers);
 Node *funDeclNodeCreate(Node *returnType, Node *name, Vector *argTypes,
-                        Vector *argNames);
+                        Vector *argNames, FunctionEffect effect);
 Node *varDeclNodeCreate(Node *type, Vector *names);
 Node *opaqueDeclNodeCreate(Token const *keyword, Node *name);
 Node *structDeclNodeCreate(Token const *keyword, Node *name, Vector *fields);
@@ -440,9 +479,9 @@ Node *enumDeclNodeCreate(Token const *keyword, Node *name,
 Node *typedefDeclNodeCreate(Token const *keyword, Node *originalType,
                             Node *name);
 Node *compoundStmtNodeCreate(Token const *lbrace, Vector *stmts, HashMap *stab);
-Node *ifStmtNodeCreate(Token const *keyword, Node *predicate, Node *consequent,
-                       HashMap *consequentStab, Node *alternative,
-                       HashMap *alternativeStab);
+Node *ifStmtNodeCreate(Token const *keyword, BranchHint hint, Node *predicate,
+                       Node *consequent, HashMap *consequentStab,
+                       Node *alternative, HashMap *alternativeStab);
 Node *whileStmtNodeCreate(Token const *keyword, Node *condition, Node *body,
                           HashMap *bodyStab);
 Node *doWhileStmtNodeCreate(Token const *keyword, Node *body, HashMap *bodyStab,
@@ -486,6 +525,87 @@ Node *scopedIdNodeCreate(Vector *components);
 Node *idNodeCreate(Token *id);
 Node *unparsedNodeCreate(Vector *tokens);
 
+/**
+ * incrementally builds an aggregate initializer, packing elements as they're
+ * added until an element that can't be packed shows up
+ */
+typedef struct {
+  Vector *literals;        /**< unpacked elements - non-null once packing
+                              stops */
+  LiteralType elementType; /**< narrowest type holding every packed element */
+  int64_t min;             /**< smallest packed integer, or zero */
+  uint64_t max;            /**< largest non-negative packed integer, or zero */
+  size_t size;             /**< number of packed elements */
+  size_t capacity;         /**< number of packed elements allocated */
+  uint64_t *values;        /**< raw bits of each packed element */
+  bool *signs;             /**< was each packed element a signed integer */
+  size_t *lines;           /**< line of each packed element */
+  size_t *characters;      /**< character of each packed element */
+} AggregateInitBuilder;
+
+/**
+ * minimum number of elements in an aggregate initializer before it is packed
+ *
+ * smaller initializers keep their element nodes (and thus their element
+ * positions for diagnostics)
+ */
+extern size_t const PACKED_INIT_MIN_LENGTH;
+
+/**
+ * initializes an aggregate initializer builder
+ *
+ * @param builder builder to initialize
+ */
+void aggregateInitBuilderInit(AggregateInitBuilder *builder);
+/**
+ * adds an element to an aggregate initializer builder
+ *
+ * @param builder builder to add to
+ * @param element NT_LITERAL or NT_SCOPEDID to add - builder takes ownership
+ */
+void aggregateInitBuilderAdd(AggregateInitBuilder *builder, Node *element);
+/**
+ * produces the finished initializer, either an LT_PACKEDINIT or an
+ * LT_AGGREGATEINIT, and uninitializes the builder
+ *
+ * @param builder builder to finish
+ * @param start first token in the initializer
+ * @returns initializer node
+ */
+Node *aggregateInitBuilderFinish(AggregateInitBuilder *builder,
+                                 Token const *start);
+/**
+ * frees everything added to a builder without producing an initializer
+ *
+ * @param builder builder to uninitialize
+ */
+void aggregateInitBuilderUninit(AggregateInitBuilder *builder);
+
+/**
+ * gets the raw bits of an element of a packed initializer
+ *
+ * @param init initializer to read from
+ * @param idx index of the element
+ * @returns element bits - zero extended for unsigned, sign extended for
+ * signed, and the IEEE bits of floating point values
+ */
+uint64_t packedInitGet(PackedInit const *init, size_t idx);
+/**
+ * gets the literal type an element would have had as a standalone literal
+ *
+ * @param init initializer to read from
+ * @param idx index of the element
+ * @returns element's literal type
+ */
+LiteralType packedInitElementType(PackedInit const *init, size_t idx);
+/**
+ * is every byte of the packed initializer zero?
+ *
+ * @param init initializer to query
+ * @returns true if the initializer can be placed in zero-filled storage
+ */
+bool packedInitIsZero(PackedInit const *init);
+
 /**
  * creates a stringified version of a scoped id or plain id
  *
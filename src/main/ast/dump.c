@@ -23,6 +23,7 @@
 #include <stdlib.h>
 
 #include "util/conversions.h"
+#include "util/internalError.h"
 #include "util/string.h"
 
 static char const *const BINOP_NAMES[] = {
@@ -58,12 +59,17 @@ static char const *const TYPEMODIFIER_NAMES[] = {
     "POINTER",
 };
 
+static char const *const LITERALTYPE_NAMES[] = {
+    "UBYTE", "BYTE", "USHORT", "SHORT", "UINT", "INT", "ULONG", "LONG",
+};
+
 static void stabEntryDump(FILE *where, SymbolTableEntry *entry) {
   switch (entry->kind) {
     case SK_VARIABLE: {
       char *typeStr = typeToString(entry->data.variable.type);
-      fprintf(where, "VARIABLE(%s, %zu, %zu, %s)", entry->file->inputFilename,
-              entry->line, entry->character, typeStr);
+      fprintf(where, "VARIABLE(%s, %zu, %zu, %s%s)", entry->file->inputFilename,
+              entry->line, entry->character, typeStr,
+              entry->data.variable.threadLocal ? ", THREADLOCAL" : "");
       free(typeStr);
       break;
     }
@@ -176,6 +182,63 @@ static void stabDump(FILE *where, HashMap *stab) {
   fprintf(where, ")");
 }
 
+/**
+ * dumps an element of a packed initializer in the same format as a standalone
+ * literal's value
+ *
+ * @param where file to dump to
+ * @param init initializer to read from
+ * @param idx index of the element to dump
+ */
+static void packedInitElementDump(FILE *where, PackedInit const *init,
+                                  size_t idx) {
+  uint64_t bits = packedInitGet(init, idx);
+  LiteralType type = packedInitElementType(init, idx);
+  switch (type) {
+    case LT_UBYTE:
+    case LT_USHORT:
+    case LT_UINT:
+    case LT_ULONG: {
+      fprintf(where, "%s(%lu)", LITERALTYPE_NAMES[type], bits);
+      break;
+    }
+    case LT_BYTE:
+    case LT_SHORT:
+    case LT_INT:
+    case LT_LONG: {
+      fprintf(where, "%s(%ld)", LITERALTYPE_NAMES[type], (int64_t)bits);
+      break;
+    }
+    case LT_FLOAT: {
+      fprintf(where, "FLOAT(%E)", (double)bitsToFloat((uint32_t)bits));
+      break;
+    }
+    case LT_DOUBLE: {
+      fprintf(where, "DOUBLE(%lE)", bitsToDouble(bits));
+      break;
+    }
+    case LT_CHAR: {
+      char *escaped = escapeTChar((uint8_t)bits);
+      fprintf(where, "CHAR(%s)", escaped);
+      free(escaped);
+      break;
+    }
+    case LT_WCHAR: {
+      char *escaped = escapeTWChar((uint32_t)bits);
+      fprintf(where, "WCHAR(%s)", escaped);
+      free(escaped);
+      break;
+    }
+    case LT_BOOL: {
+      fprintf(where, "BOOL(%s)", bits != 0 ? "true" : "false");
+      break;
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid packed initializer element type");
+    }
+  }
+}
+
 static void nodeDump(FILE *where, Node *n) {
   if (n == NULL) {
     fprintf(where, "(null)");
@@ -242,6 +305,7 @@ static void nodeDump(FILE *where, Node *n) {
         fprintf(where, ", ");
         nodeDump(where, n->data.varDefn.initializers->elements[idx]);
       }
+      if (n->data.varDefn.threadLocal) fprintf(where, ", THREADLOCAL");
       fprintf(where, ")");
       break;
     }
@@ -258,6 +322,20 @@ static void nodeDump(FILE *where, Node *n) {
         fprintf(where, ", ");
         nodeDump(where, n->data.funDecl.argNames->elements[idx]);
       }
+      switch (n->data.funDecl.effect) {
+        case FE_READONLY: {
+          fprintf(where, ", READONLY");
+          break;
+        }
+        case FE_PURE: {
+          fprintf(where, ", PURE");
+          break;
+        }
+        default: {
+          // undeclared effects aren't printed
+          break;
+        }
+      }
       fprintf(where, ")");
       break;
     }
@@ -268,6 +346,7 @@ static void nodeDump(FILE *where, Node *n) {
         fprintf(where, ", ");
         nodeDump(where, n->data.varDecl.names->elements[idx]);
       }
+      if (n->data.varDecl.threadLocal) fprintf(where, ", THREADLOCAL");
       fprintf(where, ")");
       break;
     }
@@ -340,6 +419,20 @@ static void nodeDump(FILE *where, Node *n) {
       nodeDump(where, n->data.ifStmt.alternative);
       fprintf(where, ", ");
       stabDump(where, n->data.ifStmt.alternativeStab);
+      switch (n->data.ifStmt.hint) {
+        case BH_LIKELY: {
+          fprintf(where, ", LIKELY");
+          break;
+        }
+        case BH_UNLIKELY: {
+          fprintf(where, ", UNLIKELY");
+          break;
+        }
+        default: {
+          // unhinted branches aren't printed
+          break;
+        }
+      }
       fprintf(where, ")");
       break;
     }
@@ -580,6 +673,16 @@ static void nodeDump(FILE *where, Node *n) {
           fprintf(where, ")");
           break;
         }
+        case LT_PACKEDINIT: {
+          PackedInit const *init = n->data.literal.data.packedInitVal;
+          fprintf(where, "PACKEDINIT(");
+          for (size_t idx = 0; idx < init->length; ++idx) {
+            if (idx != 0) fprintf(where, ", ");
+            packedInitElementDump(where, init, idx);
+          }
+          fprintf(where, ")");
+          break;
+        }
       }
       fprintf(where, ")");
       break;
@@ -100,6 +100,7 @@ SymbolTableEntry *variableStabEntryCreate(FileListEntry *file, size_t line,
                                           size_t character) {
   SymbolTableEntry *e = stabEntryCreate(file, line, character, SK_VARIABLE);
   e->data.variable.type = NULL;
+  e->data.variable.threadLocal = false;
   return e;
 }
 SymbolTableEntry *functionStabEntryCreate(FileListEntry *file, size_t line,
@@ -110,7 +111,8 @@ SymbolTableEntry *functionStabEntryCreate(FileListEntry *file, size_t line,
   return e;
 }
 
-Type *structLookupField(SymbolTableEntry *structEntry, char const *field) {
+Type *structLookupField(SymbolTableEntry const *structEntry,
+                        char const *field) {
   for (size_t idx = 0; idx < structEntry->data.structType.fieldNames.size;
        ++idx) {
     if (strcmp(structEntry->data.structType.fieldNames.elements[idx], field) ==
@@ -92,6 +92,7 @@ typedef struct SymbolTableEntry {
     // non-types
     struct {
       Type *type;
+      bool threadLocal; /**< does each thread get its own copy? */
     } variable;
     struct {
       Type *returnType;
@@ -127,7 +128,8 @@ SymbolTableEntry *functionStabEntryCreate(FileListEntry *file, size_t line,
 /**
  * find the type associated with a field, or return NULL
  */
-Type *structLookupField(SymbolTableEntry *structEntry, char const *field);
+Type *structLookupField(SymbolTableEntry const *structEntry,
+                        char const *field);
 /**
  * find the type associated with an option, or return NULL
  */
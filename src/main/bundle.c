@@ -0,0 +1,368 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "bundle.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fileList.h"
+#include "lexer/lexer.h"
+#include "parser/common.h"
+#include "util/container/stringBuilder.h"
+
+// A bundle is laid out as a header, the index, the module names and member
+// paths (each null terminated), then the members, each starting on a page
+// boundary. All numbers are in the host's byte order.
+
+/** start of a bundle */
+typedef struct {
+  char magic[4];       /**< BUNDLE_MAGIC */
+  uint32_t version;    /**< BUNDLE_VERSION */
+  uint64_t numMembers; /**< number of entries in the index */
+} BundleHeader;
+
+/** an entry in the index - the index is sorted by module name */
+typedef struct {
+  uint64_t nameOffset; /**< offset of the module name */
+  uint64_t pathOffset; /**< offset of the path the member was bundled from */
+  uint64_t offset;     /**< offset of the member's contents */
+  uint64_t length;     /**< length of the member's contents */
+} BundleIndexEntry;
+
+static char const BUNDLE_MAGIC[4] = {'T', 'D', 'A', 'R'};
+enum {
+  BUNDLE_VERSION = 1,
+  BUNDLE_ALIGNMENT = 4096, /**< alignment of members */
+};
+
+/**
+ * gets the index of a bundle
+ *
+ * @param bundle bundle to get the index of
+ * @returns the index, pointing into the bundle's mapping
+ */
+static BundleIndexEntry const *bundleIndex(Bundle const *bundle) {
+  return (void const *)(bundle->map + sizeof(BundleHeader));
+}
+
+/**
+ * checks that a string in a bundle ends before the bundle does
+ *
+ * @param bundle bundle to check
+ * @param offset offset of the start of the string
+ * @returns whether the string is null terminated within the bundle
+ */
+static bool bundleStringValid(Bundle const *bundle, uint64_t offset) {
+  return offset < bundle->length &&
+         memchr(bundle->map + offset, '\0', bundle->length - offset) != NULL;
+}
+
+int bundleInit(Bundle *bundle, char const *filename) {
+  bundle->filename = filename;
+
+  // try to map the file
+  int fd = open(filename, O_RDONLY);
+  if (fd == -1) {
+    fprintf(stderr, "%s: error: cannot open file\n", filename);
+    return -1;
+  }
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) != 0) {
+    fprintf(stderr, "%s: error: cannot stat file\n", filename);
+    close(fd);
+    return -1;
+  }
+  bundle->length = (size_t)statbuf.st_size;
+  if (bundle->length < sizeof(BundleHeader)) {
+    fprintf(stderr, "%s: error: not a bundle\n", filename);
+    close(fd);
+    return -1;
+  }
+  bundle->map = mmap(NULL, bundle->length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (bundle->map == (void *)-1) {
+    fprintf(stderr, "%s: error: cannot mmap file\n", filename);
+    return -1;
+  }
+
+  // check the header
+  BundleHeader header;
+  memcpy(&header, bundle->map, sizeof(BundleHeader));
+  if (memcmp(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) != 0 ||
+      header.version != BUNDLE_VERSION) {
+    fprintf(stderr,
+            "%s: error: not a bundle, or bundled by a different version of "
+            "tlc\n",
+            filename);
+    munmap(bundle->map, bundle->length);
+    return -1;
+  }
+  if (header.numMembers > (bundle->length - sizeof(BundleHeader)) /
+                              sizeof(BundleIndexEntry)) {
+    fprintf(stderr, "%s: error: bundle is corrupted\n", filename);
+    munmap(bundle->map, bundle->length);
+    return -1;
+  }
+  bundle->numMembers = header.numMembers;
+
+  // check the index - every lookup after this trusts it
+  BundleIndexEntry const *index = bundleIndex(bundle);
+  for (size_t idx = 0; idx < bundle->numMembers; ++idx) {
+    if (!bundleStringValid(bundle, index[idx].nameOffset) ||
+        !bundleStringValid(bundle, index[idx].pathOffset) ||
+        index[idx].offset > bundle->length ||
+        index[idx].length > bundle->length - index[idx].offset ||
+        (idx != 0 && strcmp(bundle->map + index[idx - 1].nameOffset,
+                            bundle->map + index[idx].nameOffset) >= 0)) {
+      fprintf(stderr, "%s: error: bundle is corrupted\n", filename);
+      munmap(bundle->map, bundle->length);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+size_t bundleFind(Bundle const *bundle, char const *moduleName) {
+  BundleIndexEntry const *index = bundleIndex(bundle);
+  size_t low = 0;
+  size_t high = bundle->numMembers;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    int comparison = strcmp(moduleName, bundle->map + index[mid].nameOffset);
+    if (comparison == 0)
+      return mid;
+    else if (comparison < 0)
+      high = mid;
+    else
+      low = mid + 1;
+  }
+  return bundle->numMembers;
+}
+
+char const *bundleMemberPath(Bundle const *bundle, size_t member) {
+  return bundle->map + bundleIndex(bundle)[member].pathOffset;
+}
+
+char *bundleMemberContents(Bundle const *bundle, size_t member,
+                           size_t *length) {
+  BundleIndexEntry const *entry = &bundleIndex(bundle)[member];
+  *length = entry->length;
+  return bundle->map + entry->offset;
+}
+
+void bundleUninit(Bundle *bundle) { munmap(bundle->map, bundle->length); }
+
+/** a decl module being bundled */
+typedef struct {
+  FileListEntry entry; /**< entry for the module, with its file still mapped */
+  char *name;          /**< name of the module */
+} BundleInput;
+
+/**
+ * reads the name from the module declaration at the start of a decl module
+ *
+ * @param entry entry to lex from
+ * @returns name of the module, with components separated by "::", or NULL if
+ * there is no valid module declaration
+ */
+static char *readModuleName(FileListEntry *entry) {
+  Token token;
+  lex(entry, &token);
+  if (token.type != TT_MODULE) {
+    errorExpectedToken(entry, TT_MODULE, &token);
+    tokenUninit(&token);
+    return NULL;
+  }
+
+  StringBuilder name;
+  stringBuilderInit(&name);
+  while (true) {
+    lex(entry, &token);
+    if (token.type != TT_ID) {
+      errorExpectedToken(entry, TT_ID, &token);
+      tokenUninit(&token);
+      stringBuilderUninit(&name);
+      return NULL;
+    }
+    for (char const *c = token.string; *c != '\0'; ++c)
+      stringBuilderPush(&name, *c);
+    tokenUninit(&token);
+
+    lex(entry, &token);
+    if (token.type == TT_SEMI) {
+      break;
+    } else if (token.type != TT_SCOPE) {
+      errorExpectedString(entry, "a semicolon or a scope operator", &token);
+      tokenUninit(&token);
+      stringBuilderUninit(&name);
+      return NULL;
+    }
+    stringBuilderPush(&name, ':');
+    stringBuilderPush(&name, ':');
+  }
+
+  char *retval = stringBuilderData(&name);
+  stringBuilderUninit(&name);
+  return retval;
+}
+
+/**
+ * compares two BundleInputs by module name
+ *
+ * @param lhs first BundleInput
+ * @param rhs second BundleInput
+ * @returns comparison result, as for strcmp
+ */
+static int bundleInputCompare(void const *lhs, void const *rhs) {
+  BundleInput const *a = lhs;
+  BundleInput const *b = rhs;
+  return strcmp(a->name, b->name);
+}
+
+/**
+ * writes a run of bytes to a file
+ *
+ * @param file file to write to
+ * @param data bytes to write
+ * @param length number of bytes
+ * @returns whether the write succeeded
+ */
+static bool writeBytes(FILE *file, void const *data, size_t length) {
+  return length == 0 || fwrite(data, 1, length, file) == length;
+}
+
+int bundleWrite(char const *outputFilename, size_t numInputs,
+                char const *const *inputFilenames) {
+  int retval = 0;
+
+  // map each decl module and read its name
+  BundleInput *inputs = malloc(sizeof(BundleInput) * numInputs);
+  size_t numRead = 0;
+  lexerInitMaps();
+  for (size_t idx = 0; idx < numInputs; ++idx) {
+    BundleInput *input = &inputs[numRead];
+    size_t length = strlen(inputFilenames[idx]);
+    if (length <= 3 ||
+        strcmp(inputFilenames[idx] + (length - 3), ".td") != 0) {
+      fprintf(stderr, "%s: error: not a declaration file\n",
+              inputFilenames[idx]);
+      retval = -1;
+      continue;
+    }
+
+    fileListEntryInit(&input->entry, inputFilenames[idx], false);
+    if (lexerStateInit(&input->entry) != 0) {
+      retval = -1;
+      continue;
+    }
+    input->name = readModuleName(&input->entry);
+    if (input->name == NULL) {
+      lexerStateUninit(&input->entry);
+      retval = -1;
+      continue;
+    }
+    ++numRead;
+  }
+  lexerUninitMaps();
+
+  // sort by name, and check for duplicates
+  qsort(inputs, numRead, sizeof(BundleInput), bundleInputCompare);
+  for (size_t idx = 1; idx < numRead; ++idx) {
+    if (strcmp(inputs[idx - 1].name, inputs[idx].name) == 0) {
+      fprintf(stderr,
+              "%s: error: module '%s' declared in multiple declaration "
+              "modules\n",
+              inputs[idx].entry.inputFilename, inputs[idx].name);
+      fprintf(stderr, "%s: note: declared here\n",
+              inputs[idx - 1].entry.inputFilename);
+      retval = -1;
+    }
+  }
+
+  if (retval == 0) {
+    // lay out the strings, then the members
+    BundleHeader header;
+    memcpy(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+    header.version = BUNDLE_VERSION;
+    header.numMembers = numRead;
+    BundleIndexEntry *index = malloc(sizeof(BundleIndexEntry) * numRead);
+    size_t offset = sizeof(BundleHeader) + sizeof(BundleIndexEntry) * numRead;
+    for (size_t idx = 0; idx < numRead; ++idx) {
+      index[idx].nameOffset = offset;
+      offset += strlen(inputs[idx].name) + 1;
+      index[idx].pathOffset = offset;
+      offset += strlen(inputs[idx].entry.inputFilename) + 1;
+    }
+    size_t stringsEnd = offset;
+    for (size_t idx = 0; idx < numRead; ++idx) {
+      offset = (offset + BUNDLE_ALIGNMENT - 1) / BUNDLE_ALIGNMENT *
+               BUNDLE_ALIGNMENT;
+      index[idx].offset = offset;
+      index[idx].length = inputs[idx].entry.lexerState.length;
+      offset += inputs[idx].entry.lexerState.length;
+    }
+
+    // write it out
+    static char const padding[BUNDLE_ALIGNMENT];
+    FILE *file = fopen(outputFilename, "wb");
+    if (file == NULL) {
+      fprintf(stderr, "%s: error: cannot open file\n", outputFilename);
+      retval = -1;
+    } else {
+      bool written =
+          writeBytes(file, &header, sizeof(BundleHeader)) &&
+          writeBytes(file, index, sizeof(BundleIndexEntry) * numRead);
+      for (size_t idx = 0; written && idx < numRead; ++idx) {
+        written =
+            writeBytes(file, inputs[idx].name, strlen(inputs[idx].name) + 1) &&
+            writeBytes(file, inputs[idx].entry.inputFilename,
+                       strlen(inputs[idx].entry.inputFilename) + 1);
+      }
+      offset = stringsEnd;
+      for (size_t idx = 0; written && idx < numRead; ++idx) {
+        written = writeBytes(file, padding, index[idx].offset - offset) &&
+                  writeBytes(file, inputs[idx].entry.lexerState.map,
+                             index[idx].length);
+        offset = index[idx].offset + index[idx].length;
+      }
+      if (fclose(file) != 0 || !written) {
+        fprintf(stderr, "%s: error: cannot write file\n", outputFilename);
+        remove(outputFilename);
+        retval = -1;
+      }
+    }
+    free(index);
+  }
+
+  for (size_t idx = 0; idx < numRead; ++idx) {
+    lexerStateUninit(&inputs[idx].entry);
+    free(inputs[idx].name);
+  }
+  free(inputs);
+  return retval;
+}
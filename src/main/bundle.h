@@ -0,0 +1,98 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * bundles of decl modules in a single file
+ *
+ * A bundle (.tdar) holds the contents of many decl modules, indexed by module
+ * name, so that a build with thousands of decl modules maps one file instead
+ * of opening, statting and mapping each of them.
+ */
+
+#ifndef TLC_BUNDLE_H_
+#define TLC_BUNDLE_H_
+
+#include <stddef.h>
+
+/** an open bundle */
+typedef struct {
+  char const *filename; /**< path to the bundle */
+  char *map;            /**< mmap of the whole bundle */
+  size_t length;        /**< length of the bundle */
+  size_t numMembers;    /**< number of decl modules in the bundle */
+} Bundle;
+
+/**
+ * opens and maps a bundle, checking that its index is well formed
+ *
+ * @param bundle bundle to initialize
+ * @param filename path to the bundle
+ * @returns status code (0 = OK)
+ */
+int bundleInit(Bundle *bundle, char const *filename);
+
+/**
+ * finds the member declaring the given module
+ *
+ * @param bundle bundle to search
+ * @param moduleName name of the module, with components separated by "::"
+ * @returns index of the member, or bundle->numMembers if there is none
+ */
+size_t bundleFind(Bundle const *bundle, char const *moduleName);
+
+/**
+ * gets the path a member was bundled from
+ *
+ * @param bundle bundle to look in
+ * @param member index of the member
+ * @returns path of the member, pointing into the bundle's mapping
+ */
+char const *bundleMemberPath(Bundle const *bundle, size_t member);
+
+/**
+ * gets the contents of a member
+ *
+ * @param bundle bundle to look in
+ * @param member index of the member
+ * @param length output parameter for the length of the contents
+ * @returns contents of the member, pointing into the bundle's mapping
+ */
+char *bundleMemberContents(Bundle const *bundle, size_t member,
+                           size_t *length);
+
+/**
+ * unmaps a bundle
+ *
+ * @param bundle bundle to uninitialize
+ */
+void bundleUninit(Bundle *bundle);
+
+/**
+ * writes the given decl modules into a new bundle
+ *
+ * @param outputFilename path to write the bundle to
+ * @param numInputs number of decl modules
+ * @param inputFilenames paths to the decl modules
+ * @returns status code (0 = OK)
+ */
+int bundleWrite(char const *outputFilename, size_t numInputs,
+                char const *const *inputFilenames);
+
+#endif  // TLC_BUNDLE_H_
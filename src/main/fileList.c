@@ -41,6 +41,8 @@ int parseFiles(size_t argc, char const *const *argv, size_t numFiles) {
   // setup the fileList
   fileList.size = 0;  // eventually going to be at most numFiles long
   fileList.entries = malloc(sizeof(FileListEntry) * numFiles);
+  fileList.numBundles = 0;
+  fileList.bundles = malloc(sizeof(Bundle) * numFiles);
 
   // read the args
   bool allFiles = false;
@@ -50,6 +52,7 @@ int parseFiles(size_t argc, char const *const *argv, size_t numFiles) {
       size_t length = strlen(argv[idx]);
       bool recognized = false;
       bool isCode;
+      bool isBundle = false;
       if (length > 3 && strcmp(argv[idx] + (length - 3), ".tc") == 0) {
         // is a code file
         recognized = true;
@@ -58,6 +61,12 @@ int parseFiles(size_t argc, char const *const *argv, size_t numFiles) {
         // is a decl file
         recognized = true;
         isCode = false;
+      } else if (length > 5 &&
+                 strcmp(argv[idx] + (length - 5), ".tdar") == 0) {
+        // is a bundle of decl files
+        recognized = true;
+        isCode = false;
+        isBundle = true;
       } else {
         // unrecognized
         switch (options.unrecognizedFile) {
@@ -85,6 +94,13 @@ int parseFiles(size_t argc, char const *const *argv, size_t numFiles) {
             break;
           }
         }
+        for (size_t searchIdx = 0; searchIdx < fileList.numBundles;
+             ++searchIdx) {
+          if (strcmp(argv[idx], fileList.bundles[searchIdx].filename) == 0) {
+            duplicate = true;
+            break;
+          }
+        }
         if (duplicate) {
           switch (options.duplicateFile) {
             case OPTION_W_ERROR: {
@@ -100,6 +116,12 @@ int parseFiles(size_t argc, char const *const *argv, size_t numFiles) {
               break;
             }
           }
+        } else if (isBundle) {
+          if (bundleInit(fileList.bundles + fileList.numBundles, argv[idx]) ==
+              0)
+            ++fileList.numBundles;
+          else
+            err = -1;
         } else {
           fileListEntryInit(fileList.entries + fileList.size, argv[idx],
                             isCode);
@@ -114,6 +136,8 @@ int parseFiles(size_t argc, char const *const *argv, size_t numFiles) {
   // shrink down to size
   fileList.entries =
       realloc(fileList.entries, sizeof(FileListEntry) * fileList.size);
+  fileList.bundles =
+      realloc(fileList.bundles, sizeof(Bundle) * fileList.numBundles);
 
   // need at least one code file
   bool noCodes = true;
@@ -29,6 +29,7 @@
 #include <stddef.h>
 
 #include "ast/ast.h"
+#include "bundle.h"
 #include "lexer/lexer.h"
 #include "util/container/hashMap.h"
 
@@ -51,10 +52,17 @@ typedef struct FileListEntry {
 void fileListEntryInit(FileListEntry *entry, char const *inputName,
                        bool isCode);
 
-/** global file list type */
+/**
+ * global file list type
+ *
+ * decl modules in bundles are only added to the entries once something imports
+ * them
+ */
 typedef struct {
   size_t size;
   FileListEntry *entries;
+  size_t numBundles;
+  Bundle *bundles; /**< bundles given, in the order they were given */
 } FileList;
 
 /**
@@ -0,0 +1,2375 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Implementation of the interpreter
+
+#include "interpreter/interpreter.h"
+
+#include <dlfcn.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ast/symbolTable.h"
+#include "fileList.h"
+#include "optimization/common.h"
+#include "util/format.h"
+#include "util/functional.h"
+#include "util/internalError.h"
+
+enum {
+  MAX_CALL_DEPTH = 10000, /**< deepest nesting of calls before the program is
+                             assumed to recurse forever */
+  MAX_FOREIGN_INTEGRAL_ARGS = 6, /**< integral arguments a C function may
+                                    take - those passed in registers */
+  MAX_FOREIGN_FLOATING_ARGS = 8, /**< floating point arguments a C function
+                                    may take - those passed in registers */
+};
+
+typedef struct Instruction Instruction;
+typedef struct Function Function;
+typedef struct HostFunction HostFunction;
+
+/**
+ * executes an instruction
+ *
+ * @param interpreter interpreter running the instruction
+ * @param registers registers of the current frame
+ * @param instruction instruction to run
+ * @returns next instruction to run, or NULL if the function returned or the
+ * program stopped
+ */
+typedef Instruction const *(*Handler)(Interpreter *interpreter,
+                                      Value *registers,
+                                      Instruction const *instruction);
+
+/** a pre-decoded instruction */
+struct Instruction {
+  Handler handler;
+  size_t dest;               /**< register written */
+  size_t lhs;                /**< first register read */
+  size_t rhs;                /**< second register read */
+  Value immediate;           /**< constant, or index of a global */
+  TypeKeyword type;          /**< type operated on, or converted to */
+  TypeKeyword fromType;      /**< type converted from */
+  BinOpType op;              /**< comparison done */
+  size_t targetIndex;        /**< index of the jump target, while compiling */
+  Instruction const *target; /**< jump target */
+  Function const *callee;    /**< function called */
+  HostFunction const *host;  /**< host function called */
+  void (*foreign)(void);     /**< C function called */
+  uint32_t floatingArgs;     /**< arguments of a C function that are floats
+                                or doubles, as a bit set */
+  uint32_t floatArgs;        /**< arguments of a C function that are floats */
+  size_t numArgs;            /**< number of arguments, starting at lhs */
+  FileListEntry const *file; /**< file containing node */
+  Node const *node;          /**< node compiled, for reporting traps */
+};
+
+/** a function defined in a code file */
+struct Function {
+  SymbolTableEntry const *entry;
+  char const *name;    /**< non-owning */
+  FileListEntry *file; /**< file the function is defined in */
+  Node *definition;    /**< NT_FUNDEFN */
+  size_t numParams;    /**< parameters are passed in the first registers */
+  size_t numRegisters; /**< size of a frame */
+  Instruction *code;   /**< owning, NULL until compiled */
+};
+
+/** a libc function the program may call */
+struct HostFunction {
+  char const *name;
+  /**
+   * calls the function
+   *
+   * @param interpreter interpreter calling the function
+   * @param instruction call instruction
+   * @param args arguments
+   * @param result output pointer to the return value
+   * @returns whether the program should keep running
+   */
+  bool (*call)(Interpreter *interpreter, Instruction const *instruction,
+               Value const *args, Value *result);
+};
+
+// types
+
+/**
+ * gets the keyword of a keyword type
+ *
+ * @param type nullable type to query
+ * @returns keyword, or TK_VOID if the type isn't a keyword type
+ */
+static TypeKeyword keywordOf(Type const *type) {
+  if (type == NULL) return TK_VOID;
+  type = stripType(type);
+  return type->kind == TK_KEYWORD ? type->data.keyword.keyword : TK_VOID;
+}
+
+/**
+ * gets the width of a scalar type
+ *
+ * @param type type to query
+ * @returns width, in bits
+ */
+static size_t widthOf(TypeKeyword type) {
+  switch (type) {
+    case TK_USHORT:
+    case TK_SHORT: {
+      return 16;
+    }
+    case TK_UINT:
+    case TK_INT:
+    case TK_WCHAR:
+    case TK_FLOAT: {
+      return 32;
+    }
+    case TK_ULONG:
+    case TK_LONG:
+    case TK_DOUBLE: {
+      return 64;
+    }
+    default: {
+      return 8;
+    }
+  }
+}
+
+/** is a type an integral type, excluding characters and booleans? */
+static bool isIntegral(TypeKeyword type) {
+  return type >= TK_UBYTE && type <= TK_LONG && type != TK_CHAR &&
+         type != TK_WCHAR;
+}
+
+/** is a type a signed integral type? */
+static bool isSigned(TypeKeyword type) {
+  return type == TK_BYTE || type == TK_SHORT || type == TK_INT ||
+         type == TK_LONG;
+}
+
+/** is a type a floating point type? */
+static bool isFloating(TypeKeyword type) {
+  return type == TK_FLOAT || type == TK_DOUBLE;
+}
+
+/** is a type an integral or floating point type? */
+static bool isNumeric(TypeKeyword type) {
+  return isIntegral(type) || isFloating(type);
+}
+
+/**
+ * can every value of one integral type be represented by another?
+ *
+ * @param to type to convert to
+ * @param from type to convert from
+ */
+static bool typeContains(TypeKeyword to, TypeKeyword from) {
+  return isSigned(to) == isSigned(from)
+             ? widthOf(to) >= widthOf(from)
+             : isSigned(to) && widthOf(to) > widthOf(from);
+}
+
+/**
+ * gets the type two numeric operands are converted to for arithmetic
+ *
+ * @param lhs type of the left operand
+ * @param rhs type of the right operand
+ * @returns common type, or TK_VOID if there is none
+ */
+static TypeKeyword arithmeticType(TypeKeyword lhs, TypeKeyword rhs) {
+  static TypeKeyword const CANDIDATES[] = {
+      TK_UBYTE, TK_BYTE, TK_USHORT, TK_SHORT,
+      TK_UINT,  TK_INT,  TK_ULONG,  TK_LONG,
+  };
+  if (!isNumeric(lhs) || !isNumeric(rhs)) return TK_VOID;
+  if (lhs == TK_DOUBLE || rhs == TK_DOUBLE) return TK_DOUBLE;
+  if (lhs == TK_FLOAT || rhs == TK_FLOAT) return TK_FLOAT;
+  for (size_t idx = 0; idx < sizeof(CANDIDATES) / sizeof(TypeKeyword);
+       ++idx) {
+    if (typeContains(CANDIDATES[idx], lhs) &&
+        typeContains(CANDIDATES[idx], rhs))
+      return CANDIDATES[idx];
+  }
+  return TK_VOID;
+}
+
+/**
+ * gets the type the two arms of a ternary, or the operands of a comparison,
+ * are converted to
+ *
+ * @param lhs type of the first value
+ * @param rhs type of the second value
+ * @returns common type, or TK_VOID if there is none
+ */
+static TypeKeyword mergedType(TypeKeyword lhs, TypeKeyword rhs) {
+  if (lhs == rhs) return lhs;
+  if ((lhs == TK_CHAR || lhs == TK_WCHAR) &&
+      (rhs == TK_CHAR || rhs == TK_WCHAR))
+    return TK_WCHAR;
+  return arithmeticType(lhs, rhs);
+}
+
+// values
+
+/**
+ * truncates a value to the width of its type, then sign or zero extends it
+ *
+ * @param bits value to normalize
+ * @param type integral, character or boolean type of the value
+ * @returns normalized value
+ */
+static uint64_t normalize(uint64_t bits, TypeKeyword type) {
+  switch (type) {
+    case TK_UBYTE:
+    case TK_CHAR: {
+      return bits & UINT8_MAX;
+    }
+    case TK_BYTE: {
+      return (uint64_t)(int64_t)(int8_t)bits;
+    }
+    case TK_USHORT: {
+      return bits & UINT16_MAX;
+    }
+    case TK_SHORT: {
+      return (uint64_t)(int64_t)(int16_t)bits;
+    }
+    case TK_UINT:
+    case TK_WCHAR: {
+      return bits & UINT32_MAX;
+    }
+    case TK_INT: {
+      return (uint64_t)(int64_t)(int32_t)bits;
+    }
+    case TK_BOOL: {
+      return bits != 0;
+    }
+    default: {
+      return bits;
+    }
+  }
+}
+
+/**
+ * converts a value between scalar types
+ *
+ * @param value value to convert
+ * @param from type of the value
+ * @param to type to convert to
+ * @param result output pointer to the converted value
+ * @returns false if a floating point value is out of the range of the integral
+ * type it's converted to
+ */
+static bool convertValue(Value value, TypeKeyword from, TypeKeyword to,
+                         Value *result) {
+  result->bits = 0;
+  if (isFloating(from)) {
+    double d = from == TK_FLOAT ? (double)value.floatVal : value.doubleVal;
+    if (to == TK_FLOAT) {
+      result->floatVal = (float)d;
+    } else if (to == TK_DOUBLE) {
+      result->doubleVal = d;
+    } else if (to == TK_BOOL) {
+      result->bits = fpclassify(d) != FP_ZERO;
+    } else {
+      // the bounds are exact, so NaNs and out of range values fail both
+      // comparisons; the lower bound minus one is only inexact for longs, where
+      // no double lies between it and the lower bound
+      size_t width = widthOf(to);
+      if (isSigned(to)) {
+        double high = (double)(UINT64_C(1) << (width - 1));
+        if (!(d < high && (d >= -high || d > -high - 1))) return false;
+        result->bits = normalize((uint64_t)(int64_t)d, to);
+      } else {
+        double high = 2 * (double)(UINT64_C(1) << (width - 1));
+        if (!(d < high && d > -1)) return false;
+        result->bits = normalize((uint64_t)d, to);
+      }
+    }
+  } else if (to == TK_FLOAT) {
+    result->floatVal = isSigned(from) ? (float)(int64_t)value.bits
+                                      : (float)value.bits;
+  } else if (to == TK_DOUBLE) {
+    result->doubleVal = isSigned(from) ? (double)(int64_t)value.bits
+                                       : (double)value.bits;
+  } else {
+    result->bits = normalize(value.bits, to);
+  }
+  return true;
+}
+
+// handlers
+
+/**
+ * stops the program because it did something undefined
+ *
+ * @param interpreter interpreter to stop
+ * @param instruction instruction that trapped
+ * @param message description of the problem
+ * @returns NULL
+ */
+static Instruction const *trap(Interpreter *interpreter,
+                               Instruction const *instruction,
+                               char const *message) {
+  fprintf(stderr, "%s:%zu:%zu: error: %s\n", instruction->file->inputFilename,
+          instruction->node->line, instruction->node->character, message);
+  interpreter->status = IS_TRAPPED;
+  return NULL;
+}
+
+/**
+ * runs a function
+ *
+ * @param interpreter interpreter to run in
+ * @param function function to run
+ * @param args arguments
+ * @param numArgs number of arguments
+ * @param result output pointer to the return value
+ * @returns whether the program should keep running
+ */
+static bool execute(Interpreter *interpreter, Function const *function,
+                    Value const *args, size_t numArgs, Value *result) {
+  Value *registers = calloc(function->numRegisters, sizeof(Value));
+  memcpy(registers, args,
+         (numArgs < function->numParams ? numArgs : function->numParams) *
+             sizeof(Value));
+
+  ++interpreter->depth;
+  for (Instruction const *instruction = function->code; instruction != NULL;)
+    instruction = instruction->handler(interpreter, registers, instruction);
+  --interpreter->depth;
+
+  free(registers);
+  *result = interpreter->returnValue;
+  return interpreter->status == IS_RUNNING;
+}
+
+static Instruction const *constantHandler(Interpreter *interpreter,
+                                          Value *registers,
+                                          Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest] = instruction->immediate;
+  return instruction + 1;
+}
+
+static Instruction const *moveHandler(Interpreter *interpreter,
+                                      Value *registers,
+                                      Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest] = registers[instruction->lhs];
+  return instruction + 1;
+}
+
+static Instruction const *loadGlobalHandler(Interpreter *interpreter,
+                                            Value *registers,
+                                            Instruction const *instruction) {
+  registers[instruction->dest] =
+      interpreter->globalValues[instruction->immediate.bits];
+  return instruction + 1;
+}
+
+static Instruction const *storeGlobalHandler(Interpreter *interpreter,
+                                             Value *registers,
+                                             Instruction const *instruction) {
+  interpreter->globalValues[instruction->immediate.bits] =
+      registers[instruction->lhs];
+  return instruction + 1;
+}
+
+static Instruction const *convertHandler(Interpreter *interpreter,
+                                         Value *registers,
+                                         Instruction const *instruction) {
+  if (!convertValue(registers[instruction->lhs], instruction->fromType,
+                    instruction->type, &registers[instruction->dest]))
+    return trap(interpreter, instruction,
+                "floating point value is out of range of the integral type "
+                "it is converted to");
+  return instruction + 1;
+}
+
+static Instruction const *addHandler(Interpreter *interpreter,
+                                     Value *registers,
+                                     Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].bits =
+      normalize(registers[instruction->lhs].bits +
+                    registers[instruction->rhs].bits,
+                instruction->type);
+  return instruction + 1;
+}
+
+static Instruction const *subHandler(Interpreter *interpreter,
+                                     Value *registers,
+                                     Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].bits =
+      normalize(registers[instruction->lhs].bits -
+                    registers[instruction->rhs].bits,
+                instruction->type);
+  return instruction + 1;
+}
+
+static Instruction const *mulHandler(Interpreter *interpreter,
+                                     Value *registers,
+                                     Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].bits =
+      normalize(registers[instruction->lhs].bits *
+                    registers[instruction->rhs].bits,
+                instruction->type);
+  return instruction + 1;
+}
+
+static Instruction const *divHandler(Interpreter *interpreter,
+                                     Value *registers,
+                                     Instruction const *instruction) {
+  uint64_t lhs = registers[instruction->lhs].bits;
+  uint64_t rhs = registers[instruction->rhs].bits;
+  if (rhs == 0) return trap(interpreter, instruction, "division by zero");
+  uint64_t result;
+  if (!isSigned(instruction->type))
+    result = lhs / rhs;
+  else if (rhs == UINT64_MAX)
+    result = 0 - lhs;  // avoids overflowing when dividing the minimum by -1
+  else
+    result = (uint64_t)((int64_t)lhs / (int64_t)rhs);
+  registers[instruction->dest].bits = normalize(result, instruction->type);
+  return instruction + 1;
+}
+
+static Instruction const *modHandler(Interpreter *interpreter,
+                                     Value *registers,
+                                     Instruction const *instruction) {
+  uint64_t lhs = registers[instruction->lhs].bits;
+  uint64_t rhs = registers[instruction->rhs].bits;
+  if (rhs == 0) return trap(interpreter, instruction, "division by zero");
+  uint64_t result;
+  if (!isSigned(instruction->type))
+    result = lhs % rhs;
+  else if (rhs == UINT64_MAX)
+    result = 0;
+  else
+    result = (uint64_t)((int64_t)lhs % (int64_t)rhs);
+  registers[instruction->dest].bits = result;
+  return instruction + 1;
+}
+
+static Instruction const *bitAndHandler(Interpreter *interpreter,
+                                        Value *registers,
+                                        Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].bits =
+      registers[instruction->lhs].bits & registers[instruction->rhs].bits;
+  return instruction + 1;
+}
+
+static Instruction const *bitOrHandler(Interpreter *interpreter,
+                                       Value *registers,
+                                       Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].bits =
+      registers[instruction->lhs].bits | registers[instruction->rhs].bits;
+  return instruction + 1;
+}
+
+static Instruction const *bitXorHandler(Interpreter *interpreter,
+                                        Value *registers,
+                                        Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].bits =
+      registers[instruction->lhs].bits ^ registers[instruction->rhs].bits;
+  return instruction + 1;
+}
+
+static Instruction const *lshiftHandler(Interpreter *interpreter,
+                                        Value *registers,
+                                        Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].bits =
+      normalize(registers[instruction->lhs].bits
+                    << (registers[instruction->rhs].bits & 63),
+                instruction->type);
+  return instruction + 1;
+}
+
+static Instruction const *arshiftHandler(Interpreter *interpreter,
+                                         Value *registers,
+                                         Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].bits = normalize(
+      (uint64_t)((int64_t)registers[instruction->lhs].bits >>
+                 (registers[instruction->rhs].bits & 63)),
+      instruction->type);
+  return instruction + 1;
+}
+
+static Instruction const *lrshiftHandler(Interpreter *interpreter,
+                                         Value *registers,
+                                         Instruction const *instruction) {
+  (void)interpreter;
+  size_t width = widthOf(instruction->type);
+  uint64_t mask = width == 64 ? UINT64_MAX : (UINT64_C(1) << width) - 1;
+  registers[instruction->dest].bits =
+      normalize((registers[instruction->lhs].bits & mask) >>
+                    (registers[instruction->rhs].bits & 63),
+                instruction->type);
+  return instruction + 1;
+}
+
+static Instruction const *floatAddHandler(Interpreter *interpreter,
+                                          Value *registers,
+                                          Instruction const *instruction) {
+  (void)interpreter;
+  float result = registers[instruction->lhs].floatVal +
+                 registers[instruction->rhs].floatVal;
+  registers[instruction->dest].bits = 0;
+  registers[instruction->dest].floatVal = result;
+  return instruction + 1;
+}
+
+static Instruction const *floatSubHandler(Interpreter *interpreter,
+                                          Value *registers,
+                                          Instruction const *instruction) {
+  (void)interpreter;
+  float result = registers[instruction->lhs].floatVal -
+                 registers[instruction->rhs].floatVal;
+  registers[instruction->dest].bits = 0;
+  registers[instruction->dest].floatVal = result;
+  return instruction + 1;
+}
+
+static Instruction const *floatMulHandler(Interpreter *interpreter,
+                                          Value *registers,
+                                          Instruction const *instruction) {
+  (void)interpreter;
+  float result = registers[instruction->lhs].floatVal *
+                 registers[instruction->rhs].floatVal;
+  registers[instruction->dest].bits = 0;
+  registers[instruction->dest].floatVal = result;
+  return instruction + 1;
+}
+
+static Instruction const *floatDivHandler(Interpreter *interpreter,
+                                          Value *registers,
+                                          Instruction const *instruction) {
+  (void)interpreter;
+  float result = registers[instruction->lhs].floatVal /
+                 registers[instruction->rhs].floatVal;
+  registers[instruction->dest].bits = 0;
+  registers[instruction->dest].floatVal = result;
+  return instruction + 1;
+}
+
+static Instruction const *doubleAddHandler(Interpreter *interpreter,
+                                           Value *registers,
+                                           Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].doubleVal =
+      registers[instruction->lhs].doubleVal +
+      registers[instruction->rhs].doubleVal;
+  return instruction + 1;
+}
+
+static Instruction const *doubleSubHandler(Interpreter *interpreter,
+                                           Value *registers,
+                                           Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].doubleVal =
+      registers[instruction->lhs].doubleVal -
+      registers[instruction->rhs].doubleVal;
+  return instruction + 1;
+}
+
+static Instruction const *doubleMulHandler(Interpreter *interpreter,
+                                           Value *registers,
+                                           Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].doubleVal =
+      registers[instruction->lhs].doubleVal *
+      registers[instruction->rhs].doubleVal;
+  return instruction + 1;
+}
+
+static Instruction const *doubleDivHandler(Interpreter *interpreter,
+                                           Value *registers,
+                                           Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].doubleVal =
+      registers[instruction->lhs].doubleVal /
+      registers[instruction->rhs].doubleVal;
+  return instruction + 1;
+}
+
+static Instruction const *compareHandler(Interpreter *interpreter,
+                                         Value *registers,
+                                         Instruction const *instruction) {
+  (void)interpreter;
+  Value lhs = registers[instruction->lhs];
+  Value rhs = registers[instruction->rhs];
+
+  // -1, 0 or 1, or 2 if the operands are unordered
+  int order;
+  if (isFloating(instruction->type)) {
+    double l =
+        instruction->type == TK_FLOAT ? (double)lhs.floatVal : lhs.doubleVal;
+    double r =
+        instruction->type == TK_FLOAT ? (double)rhs.floatVal : rhs.doubleVal;
+    if (isless(l, r))
+      order = -1;
+    else if (isgreater(l, r))
+      order = 1;
+    else if (isunordered(l, r))
+      order = 2;
+    else
+      order = 0;
+  } else if (isSigned(instruction->type)) {
+    int64_t l = (int64_t)lhs.bits;
+    int64_t r = (int64_t)rhs.bits;
+    order = l < r ? -1 : l > r ? 1 : 0;
+  } else {
+    order = lhs.bits < rhs.bits ? -1 : lhs.bits > rhs.bits ? 1 : 0;
+  }
+
+  uint64_t result;
+  switch (instruction->op) {
+    case BO_EQ: {
+      result = order == 0;
+      break;
+    }
+    case BO_NEQ: {
+      result = order != 0;
+      break;
+    }
+    case BO_LT: {
+      result = order == -1;
+      break;
+    }
+    case BO_GT: {
+      result = order == 1;
+      break;
+    }
+    case BO_LTEQ: {
+      result = order == -1 || order == 0;
+      break;
+    }
+    case BO_GTEQ: {
+      result = order == 1 || order == 0;
+      break;
+    }
+    default: {
+      // spaceship - unordered operands compare equal
+      result = order == 2 ? 0 : (uint64_t)(int64_t)order;
+      break;
+    }
+  }
+  registers[instruction->dest].bits = result;
+  return instruction + 1;
+}
+
+static Instruction const *negHandler(Interpreter *interpreter,
+                                     Value *registers,
+                                     Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].bits =
+      normalize(0 - registers[instruction->lhs].bits, instruction->type);
+  return instruction + 1;
+}
+
+static Instruction const *floatNegHandler(Interpreter *interpreter,
+                                          Value *registers,
+                                          Instruction const *instruction) {
+  (void)interpreter;
+  float result = -registers[instruction->lhs].floatVal;
+  registers[instruction->dest].bits = 0;
+  registers[instruction->dest].floatVal = result;
+  return instruction + 1;
+}
+
+static Instruction const *doubleNegHandler(Interpreter *interpreter,
+                                           Value *registers,
+                                           Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].doubleVal =
+      -registers[instruction->lhs].doubleVal;
+  return instruction + 1;
+}
+
+static Instruction const *bitNotHandler(Interpreter *interpreter,
+                                        Value *registers,
+                                        Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].bits =
+      normalize(~registers[instruction->lhs].bits, instruction->type);
+  return instruction + 1;
+}
+
+static Instruction const *lnotHandler(Interpreter *interpreter,
+                                      Value *registers,
+                                      Instruction const *instruction) {
+  (void)interpreter;
+  registers[instruction->dest].bits = registers[instruction->lhs].bits == 0;
+  return instruction + 1;
+}
+
+static Instruction const *jumpHandler(Interpreter *interpreter,
+                                      Value *registers,
+                                      Instruction const *instruction) {
+  (void)interpreter;
+  (void)registers;
+  return instruction->target;
+}
+
+static Instruction const *jumpIfFalseHandler(Interpreter *interpreter,
+                                             Value *registers,
+                                             Instruction const *instruction) {
+  (void)interpreter;
+  return registers[instruction->lhs].bits == 0 ? instruction->target
+                                               : instruction + 1;
+}
+
+static Instruction const *jumpIfTrueHandler(Interpreter *interpreter,
+                                            Value *registers,
+                                            Instruction const *instruction) {
+  (void)interpreter;
+  return registers[instruction->lhs].bits != 0 ? instruction->target
+                                               : instruction + 1;
+}
+
+static Instruction const *callHandler(Interpreter *interpreter,
+                                      Value *registers,
+                                      Instruction const *instruction) {
+  if (interpreter->depth == MAX_CALL_DEPTH)
+    return trap(interpreter, instruction, "call stack overflow");
+  Value result;
+  if (!execute(interpreter, instruction->callee, registers + instruction->lhs,
+               instruction->numArgs, &result))
+    return NULL;
+  registers[instruction->dest] = result;
+  return instruction + 1;
+}
+
+static Instruction const *hostCallHandler(Interpreter *interpreter,
+                                          Value *registers,
+                                          Instruction const *instruction) {
+  if (!instruction->host->call(interpreter, instruction,
+                               registers + instruction->lhs,
+                               &registers[instruction->dest]))
+    return NULL;
+  return instruction + 1;
+}
+
+static Instruction const *returnHandler(Interpreter *interpreter,
+                                        Value *registers,
+                                        Instruction const *instruction) {
+  interpreter->returnValue = instruction->type == TK_VOID
+                                 ? instruction->immediate
+                                 : registers[instruction->lhs];
+  return NULL;
+}
+
+static Instruction const *missingReturnHandler(
+    Interpreter *interpreter, Value *registers,
+    Instruction const *instruction) {
+  (void)registers;
+  return trap(interpreter, instruction,
+              "reached the end of a function without returning a value");
+}
+
+// host functions
+
+static bool hostPutchar(Interpreter *interpreter,
+                        Instruction const *instruction, Value const *args,
+                        Value *result) {
+  (void)instruction;
+  int c = fputc((unsigned char)args[0].bits, interpreter->out);
+  result->bits = (uint64_t)(int64_t)c;
+  return true;
+}
+
+static bool hostGetchar(Interpreter *interpreter,
+                        Instruction const *instruction, Value const *args,
+                        Value *result) {
+  (void)instruction;
+  (void)args;
+  result->bits = (uint64_t)(int64_t)fgetc(interpreter->in);
+  return true;
+}
+
+static bool hostExit(Interpreter *interpreter, Instruction const *instruction,
+                     Value const *args, Value *result) {
+  (void)instruction;
+  interpreter->status = IS_EXITED;
+  interpreter->exitStatus = (int)(int64_t)args[0].bits;
+  result->bits = 0;
+  return false;
+}
+
+static bool hostAbort(Interpreter *interpreter, Instruction const *instruction,
+                      Value const *args, Value *result) {
+  (void)args;
+  result->bits = 0;
+  trap(interpreter, instruction, "program aborted");
+  return false;
+}
+
+#if defined(__x86_64__)
+/**
+ * a C function, called as if it took every integral and floating point
+ * argument that can be passed in registers
+ *
+ * the x86_64 System V ABI assigns integral and floating point arguments to
+ * registers separately, each in order, so a function taking at most that many
+ * of each may be called through this type, and ignores the extra arguments.
+ * Floats are passed and returned in the low half of a register
+ */
+typedef uint64_t (*IntegralForeign)(uint64_t, uint64_t, uint64_t, uint64_t,
+                                    uint64_t, uint64_t, double, double, double,
+                                    double, double, double, double, double);
+/** a C function returning a float or double, called like IntegralForeign */
+typedef double (*FloatingForeign)(uint64_t, uint64_t, uint64_t, uint64_t,
+                                  uint64_t, uint64_t, double, double, double,
+                                  double, double, double, double, double);
+
+static Instruction const *foreignCallHandler(Interpreter *interpreter,
+                                             Value *registers,
+                                             Instruction const *instruction) {
+  (void)interpreter;
+  uint64_t integral[MAX_FOREIGN_INTEGRAL_ARGS] = {0};
+  double floating[MAX_FOREIGN_FLOATING_ARGS] = {0};
+  size_t numIntegral = 0;
+  size_t numFloating = 0;
+  Value const *args = registers + instruction->lhs;
+  for (size_t idx = 0; idx < instruction->numArgs; ++idx) {
+    if ((instruction->floatingArgs & (UINT32_C(1) << idx)) != 0) {
+      Value arg = args[idx];
+      if ((instruction->floatArgs & (UINT32_C(1) << idx)) != 0) {
+        arg.bits = 0;
+        arg.floatVal = args[idx].floatVal;
+      }
+      floating[numFloating++] = arg.doubleVal;
+    } else {
+      integral[numIntegral++] = args[idx].bits;
+    }
+  }
+
+  Value *result = &registers[instruction->dest];
+  if (isFloating(instruction->type)) {
+    Value returned;
+    returned.doubleVal = ((FloatingForeign)instruction->foreign)(
+        integral[0], integral[1], integral[2], integral[3], integral[4],
+        integral[5], floating[0], floating[1], floating[2], floating[3],
+        floating[4], floating[5], floating[6], floating[7]);
+    if (instruction->type == TK_FLOAT) {
+      result->bits = 0;
+      result->floatVal = returned.floatVal;
+    } else {
+      *result = returned;
+    }
+  } else {
+    uint64_t returned = ((IntegralForeign)instruction->foreign)(
+        integral[0], integral[1], integral[2], integral[3], integral[4],
+        integral[5], floating[0], floating[1], floating[2], floating[3],
+        floating[4], floating[5], floating[6], floating[7]);
+    // only the low bits of a narrow result are defined
+    result->bits = instruction->type == TK_BOOL
+                       ? (returned & UINT8_MAX) != 0
+                       : normalize(returned, instruction->type);
+  }
+  return instruction + 1;
+}
+#endif
+
+/**
+ * the libc functions the program may call, if it doesn't define them, that
+ * can't be called directly - they use the interpreter's streams, or stop the
+ * program
+ */
+static HostFunction const HOST_FUNCTIONS[] = {
+    {"putchar", hostPutchar},
+    {"getchar", hostGetchar},
+    {"exit", hostExit},
+    {"abort", hostAbort},
+};
+
+/**
+ * finds a host function
+ *
+ * @param name name of the function
+ * @returns the function, or NULL if there is no such function
+ */
+static HostFunction const *findHost(char const *name) {
+  for (size_t idx = 0; idx < sizeof(HOST_FUNCTIONS) / sizeof(HostFunction);
+       ++idx) {
+    if (strcmp(HOST_FUNCTIONS[idx].name, name) == 0)
+      return &HOST_FUNCTIONS[idx];
+  }
+  return NULL;
+}
+
+// compiler
+
+/** state while compiling a function */
+typedef struct {
+  Interpreter *interpreter;
+  Function *function;
+  Vector code;       /**< vector of Instruction, owning */
+  Vector registers;  /**< vector of nullable SymbolTableEntry, the variable
+                        held in each register */
+  Vector *breaks;    /**< nullable vector of Instruction, non-owning - jumps to
+                        the end of the innermost loop or switch */
+  Vector *continues; /**< nullable vector of Instruction, non-owning - jumps to
+                        the next iteration of the innermost loop */
+} Compiler;
+
+/** a scalar variable named by an expression */
+typedef struct {
+  bool global;
+  size_t index; /**< register, or index of the global */
+  TypeKeyword type;
+} Variable;
+
+/**
+ * complains about a construct the interpreter can't run
+ *
+ * @param c compiler
+ * @param node construct to complain about
+ * @param what description of the construct
+ * @returns false
+ */
+static bool unsupported(Compiler *c, Node const *node, char const *what) {
+  fprintf(stderr, "%s:%zu:%zu: error: the interpreter can't run %s\n",
+          c->function->file->inputFilename, node->line, node->character, what);
+  return false;
+}
+
+/**
+ * allocates a register
+ *
+ * @param c compiler
+ * @param variable nullable variable the register holds
+ * @returns the register
+ */
+static size_t newRegister(Compiler *c, SymbolTableEntry *variable) {
+  vectorInsert(&c->registers, variable);
+  return c->registers.size - 1;
+}
+
+/**
+ * adds an instruction to the end of the function
+ *
+ * @param c compiler
+ * @param node node being compiled
+ * @param handler handler for the instruction
+ * @returns the instruction, to fill in
+ */
+static Instruction *emit(Compiler *c, Node const *node, Handler handler) {
+  Instruction *instruction = calloc(1, sizeof(Instruction));
+  instruction->handler = handler;
+  instruction->type = TK_VOID;
+  instruction->fromType = TK_VOID;
+  instruction->file = c->function->file;
+  instruction->node = node;
+  vectorInsert(&c->code, instruction);
+  return instruction;
+}
+
+/**
+ * adds a jump
+ *
+ * @param c compiler
+ * @param node node being compiled
+ * @param handler jump handler
+ * @param condition register tested by a conditional jump
+ * @returns the jump, to set the target of
+ */
+static Instruction *emitJump(Compiler *c, Node const *node, Handler handler,
+                             size_t condition) {
+  Instruction *jump = emit(c, node, handler);
+  jump->lhs = condition;
+  return jump;
+}
+
+/**
+ * sets the target of a list of jumps to the next instruction to be emitted
+ *
+ * @param c compiler
+ * @param jumps vector of Instruction to patch
+ */
+static void patchHere(Compiler *c, Vector const *jumps) {
+  for (size_t idx = 0; idx < jumps->size; ++idx)
+    ((Instruction *)jumps->elements[idx])->targetIndex = c->code.size;
+}
+
+/**
+ * gets the value of a scalar literal
+ *
+ * @param literal NT_LITERAL to evaluate
+ * @param value output pointer to the value
+ * @param type output pointer to the type of the value
+ * @returns whether the literal is a scalar
+ */
+static bool literalValue(Node const *literal, Value *value, TypeKeyword *type) {
+  value->bits = 0;
+  switch (literal->data.literal.literalType) {
+    case LT_UBYTE: {
+      *type = TK_UBYTE;
+      value->bits = literal->data.literal.data.ubyteVal;
+      return true;
+    }
+    case LT_BYTE: {
+      *type = TK_BYTE;
+      value->bits = (uint64_t)(int64_t)literal->data.literal.data.byteVal;
+      return true;
+    }
+    case LT_USHORT: {
+      *type = TK_USHORT;
+      value->bits = literal->data.literal.data.ushortVal;
+      return true;
+    }
+    case LT_SHORT: {
+      *type = TK_SHORT;
+      value->bits = (uint64_t)(int64_t)literal->data.literal.data.shortVal;
+      return true;
+    }
+    case LT_UINT: {
+      *type = TK_UINT;
+      value->bits = literal->data.literal.data.uintVal;
+      return true;
+    }
+    case LT_INT: {
+      *type = TK_INT;
+      value->bits = (uint64_t)(int64_t)literal->data.literal.data.intVal;
+      return true;
+    }
+    case LT_ULONG: {
+      *type = TK_ULONG;
+      value->bits = literal->data.literal.data.ulongVal;
+      return true;
+    }
+    case LT_LONG: {
+      *type = TK_LONG;
+      value->bits = (uint64_t)literal->data.literal.data.longVal;
+      return true;
+    }
+    case LT_FLOAT: {
+      *type = TK_FLOAT;
+      memcpy(&value->floatVal, &literal->data.literal.data.floatBits,
+             sizeof(float));
+      return true;
+    }
+    case LT_DOUBLE: {
+      *type = TK_DOUBLE;
+      memcpy(&value->doubleVal, &literal->data.literal.data.doubleBits,
+             sizeof(double));
+      return true;
+    }
+    case LT_CHAR: {
+      *type = TK_CHAR;
+      value->bits = literal->data.literal.data.charVal;
+      return true;
+    }
+    case LT_WCHAR: {
+      *type = TK_WCHAR;
+      value->bits = literal->data.literal.data.wcharVal;
+      return true;
+    }
+    case LT_BOOL: {
+      *type = TK_BOOL;
+      value->bits = literal->data.literal.data.boolVal;
+      return true;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * converts the value in a register, if needed
+ *
+ * @param c compiler
+ * @param node node being compiled
+ * @param reg register holding the value, replaced with the register holding
+ * the converted value
+ * @param from type of the value
+ * @param to type to convert to
+ * @returns whether the conversion could be compiled
+ */
+static bool convert(Compiler *c, Node const *node, size_t *reg,
+                    TypeKeyword from, TypeKeyword to) {
+  if (from == to) return true;
+  if (from == TK_VOID || to == TK_VOID)
+    return unsupported(c, node, "conversions to or from non-scalar types");
+
+  Instruction *conversion = emit(c, node, convertHandler);
+  conversion->lhs = *reg;
+  conversion->fromType = from;
+  conversion->type = to;
+  conversion->dest = newRegister(c, NULL);
+  *reg = conversion->dest;
+  return true;
+}
+
+/**
+ * finds the scalar variable an expression names
+ *
+ * @param c compiler
+ * @param exp expression to query
+ * @param variable output pointer to the variable
+ * @returns whether the expression names a scalar local or global
+ */
+static bool variableOf(Compiler *c, Node *exp, Variable *variable) {
+  exp = stripParens(exp);
+  SymbolTableEntry *entry;
+  switch (exp->type) {
+    case NT_ID: {
+      entry = exp->data.id.entry;
+      break;
+    }
+    case NT_SCOPEDID: {
+      entry = exp->data.scopedId.entry;
+      break;
+    }
+    default: {
+      return false;
+    }
+  }
+  if (entry == NULL || entry->kind != SK_VARIABLE) return false;
+
+  variable->type = keywordOf(entry->data.variable.type);
+  if (variable->type == TK_VOID) return false;
+  for (size_t idx = 0; idx < c->registers.size; ++idx) {
+    if (c->registers.elements[idx] == entry) {
+      variable->global = false;
+      variable->index = idx;
+      return true;
+    }
+  }
+  for (size_t idx = 0; idx < c->interpreter->globals.size; ++idx) {
+    if (c->interpreter->globals.elements[idx] == entry) {
+      variable->global = true;
+      variable->index = idx;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * reads a variable
+ *
+ * @param c compiler
+ * @param node node being compiled
+ * @param variable variable to read
+ * @returns register holding the value of the variable
+ */
+static size_t readVariable(Compiler *c, Node const *node,
+                           Variable const *variable) {
+  if (!variable->global) return variable->index;
+  Instruction *load = emit(c, node, loadGlobalHandler);
+  load->immediate.bits = variable->index;
+  load->dest = newRegister(c, NULL);
+  return load->dest;
+}
+
+/**
+ * writes a variable
+ *
+ * @param c compiler
+ * @param node node being compiled
+ * @param variable variable to write
+ * @param reg register holding the value, already of the variable's type
+ * @returns register holding the variable's new value
+ */
+static size_t writeVariable(Compiler *c, Node const *node,
+                            Variable const *variable, size_t reg) {
+  if (variable->global) {
+    Instruction *store = emit(c, node, storeGlobalHandler);
+    store->immediate.bits = variable->index;
+    store->lhs = reg;
+    return reg;
+  } else {
+    if (reg != variable->index) {
+      Instruction *move = emit(c, node, moveHandler);
+      move->lhs = reg;
+      move->dest = variable->index;
+    }
+    return variable->index;
+  }
+}
+
+/**
+ * gets the handler for an arithmetic, bitwise or shift operator
+ *
+ * @param op operator
+ * @param type type the operator is done at
+ * @returns handler, or NULL if the operator can't be done at the type
+ */
+static Handler operatorHandler(BinOpType op, TypeKeyword type) {
+  switch (op) {
+    case BO_ADD: {
+      return type == TK_FLOAT    ? floatAddHandler
+             : type == TK_DOUBLE ? doubleAddHandler
+                                 : addHandler;
+    }
+    case BO_SUB: {
+      return type == TK_FLOAT    ? floatSubHandler
+             : type == TK_DOUBLE ? doubleSubHandler
+                                 : subHandler;
+    }
+    case BO_MUL: {
+      return type == TK_FLOAT    ? floatMulHandler
+             : type == TK_DOUBLE ? doubleMulHandler
+                                 : mulHandler;
+    }
+    case BO_DIV: {
+      return type == TK_FLOAT    ? floatDivHandler
+             : type == TK_DOUBLE ? doubleDivHandler
+                                 : divHandler;
+    }
+    case BO_MOD: {
+      return isIntegral(type) ? modHandler : NULL;
+    }
+    case BO_BITAND: {
+      return isIntegral(type) ? bitAndHandler : NULL;
+    }
+    case BO_BITOR: {
+      return isIntegral(type) ? bitOrHandler : NULL;
+    }
+    case BO_BITXOR: {
+      return isIntegral(type) ? bitXorHandler : NULL;
+    }
+    case BO_LSHIFT: {
+      return isIntegral(type) ? lshiftHandler : NULL;
+    }
+    case BO_ARSHIFT: {
+      return isIntegral(type) ? arshiftHandler : NULL;
+    }
+    case BO_LRSHIFT: {
+      return isIntegral(type) ? lrshiftHandler : NULL;
+    }
+    default: {
+      return NULL;
+    }
+  }
+}
+
+/**
+ * gets the operator a compound assignment applies
+ *
+ * @param op compound assignment operator
+ * @returns operator applied
+ */
+static BinOpType compoundOperator(BinOpType op) {
+  switch (op) {
+    case BO_MULASSIGN: {
+      return BO_MUL;
+    }
+    case BO_DIVASSIGN: {
+      return BO_DIV;
+    }
+    case BO_MODASSIGN: {
+      return BO_MOD;
+    }
+    case BO_ADDASSIGN: {
+      return BO_ADD;
+    }
+    case BO_SUBASSIGN: {
+      return BO_SUB;
+    }
+    case BO_LSHIFTASSIGN: {
+      return BO_LSHIFT;
+    }
+    case BO_ARSHIFTASSIGN: {
+      return BO_ARSHIFT;
+    }
+    case BO_LRSHIFTASSIGN: {
+      return BO_LRSHIFT;
+    }
+    case BO_BITANDASSIGN: {
+      return BO_BITAND;
+    }
+    case BO_BITXORASSIGN: {
+      return BO_BITXOR;
+    }
+    case BO_BITORASSIGN: {
+      return BO_BITOR;
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid compound assignment operator");
+    }
+  }
+}
+
+/**
+ * applies an arithmetic, bitwise or shift operator to two values
+ *
+ * @param c compiler
+ * @param node node being compiled
+ * @param op operator to apply
+ * @param lhs register holding the left operand
+ * @param lhsType type of the left operand
+ * @param rhs register holding the right operand
+ * @param rhsType type of the right operand
+ * @param reg output pointer to the register holding the result
+ * @param type output pointer to the type of the result
+ * @returns whether the operator could be compiled
+ */
+static bool operate(Compiler *c, Node const *node, BinOpType op, size_t lhs,
+                    TypeKeyword lhsType, size_t rhs, TypeKeyword rhsType,
+                    size_t *reg, TypeKeyword *type) {
+  bool shift = op == BO_LSHIFT || op == BO_ARSHIFT || op == BO_LRSHIFT;
+  if (shift) {
+    // the shift amount is used as is
+    *type = isIntegral(rhsType) ? lhsType : TK_VOID;
+  } else {
+    *type = arithmeticType(lhsType, rhsType);
+    if (*type != TK_VOID && (!convert(c, node, &lhs, lhsType, *type) ||
+                             !convert(c, node, &rhs, rhsType, *type)))
+      return false;
+  }
+
+  Handler handler = operatorHandler(op, *type);
+  if (handler == NULL)
+    return unsupported(c, node, "this operator on these types of operands");
+  Instruction *operation = emit(c, node, handler);
+  operation->lhs = lhs;
+  operation->rhs = rhs;
+  operation->type = *type;
+  operation->dest = newRegister(c, NULL);
+  *reg = operation->dest;
+  return true;
+}
+
+/**
+ * applies a negation, logical not or bitwise not to a value
+ *
+ * @param c compiler
+ * @param node node being compiled
+ * @param op operator to apply - UO_NEG, UO_LNOT or UO_BITNOT
+ * @param widen should unsigned values be widened to a signed type before
+ * being negated?
+ * @param reg register holding the operand, replaced with the register holding
+ * the result
+ * @param type type of the operand, replaced with the type of the result
+ * @returns whether the operator could be compiled
+ */
+static bool unaryOperate(Compiler *c, Node const *node, UnOpType op,
+                         bool widen, size_t *reg, TypeKeyword *type) {
+  Handler handler;
+  TypeKeyword resultType = *type;
+  switch (op) {
+    case UO_NEG: {
+      if (widen) {
+        switch (*type) {
+          case TK_UBYTE: {
+            resultType = TK_SHORT;
+            break;
+          }
+          case TK_USHORT: {
+            resultType = TK_INT;
+            break;
+          }
+          case TK_UINT: {
+            resultType = TK_LONG;
+            break;
+          }
+          case TK_ULONG: {
+            resultType = TK_VOID;
+            break;
+          }
+          default: {
+            break;
+          }
+        }
+      }
+      handler = resultType == TK_FLOAT    ? floatNegHandler
+                : resultType == TK_DOUBLE ? doubleNegHandler
+                : isIntegral(resultType)  ? negHandler
+                                          : NULL;
+      break;
+    }
+    case UO_LNOT: {
+      resultType = TK_BOOL;
+      handler = lnotHandler;
+      break;
+    }
+    default: {
+      handler = isIntegral(resultType) ? bitNotHandler : NULL;
+      break;
+    }
+  }
+  if (handler == NULL)
+    return unsupported(c, node, "this operator on this type of operand");
+  if (!convert(c, node, reg, *type, resultType)) return false;
+
+  Instruction *operation = emit(c, node, handler);
+  operation->lhs = *reg;
+  operation->type = resultType;
+  operation->dest = newRegister(c, NULL);
+  *reg = operation->dest;
+  *type = resultType;
+  return true;
+}
+
+static bool compileExpression(Compiler *c, Node *exp, size_t *reg,
+                              TypeKeyword *type);
+
+/**
+ * compiles a logical and or or, or their assignment forms
+ *
+ * @param c compiler
+ * @param exp expression to compile
+ * @param isAnd is this an and?
+ * @param reg output pointer to the register holding the result
+ * @returns whether the expression could be compiled
+ */
+static bool compileLogical(Compiler *c, Node *exp, bool isAnd, size_t *reg) {
+  size_t lhs;
+  TypeKeyword lhsType;
+  if (!compileExpression(c, exp->data.binOpExp.lhs, &lhs, &lhsType) ||
+      !convert(c, exp, &lhs, lhsType, TK_BOOL))
+    return false;
+
+  *reg = newRegister(c, NULL);
+  Instruction *move = emit(c, exp, moveHandler);
+  move->lhs = lhs;
+  move->dest = *reg;
+  Instruction *toEnd = emitJump(
+      c, exp, isAnd ? jumpIfFalseHandler : jumpIfTrueHandler, *reg);
+
+  size_t rhs;
+  TypeKeyword rhsType;
+  if (!compileExpression(c, exp->data.binOpExp.rhs, &rhs, &rhsType) ||
+      !convert(c, exp, &rhs, rhsType, TK_BOOL))
+    return false;
+  move = emit(c, exp, moveHandler);
+  move->lhs = rhs;
+  move->dest = *reg;
+  toEnd->targetIndex = c->code.size;
+  return true;
+}
+
+/**
+ * compiles a binary operator expression
+ *
+ * @param c compiler
+ * @param exp expression to compile
+ * @param reg output pointer to the register holding the result
+ * @param type output pointer to the type of the result
+ * @returns whether the expression could be compiled
+ */
+static bool compileBinOp(Compiler *c, Node *exp, size_t *reg,
+                         TypeKeyword *type) {
+  BinOpType op = exp->data.binOpExp.op;
+  Node *lhsExp = exp->data.binOpExp.lhs;
+  Node *rhsExp = exp->data.binOpExp.rhs;
+  size_t lhs;
+  TypeKeyword lhsType;
+  size_t rhs;
+  TypeKeyword rhsType;
+  Variable variable;
+  switch (op) {
+    case BO_SEQ: {
+      return compileExpression(c, lhsExp, &lhs, &lhsType) &&
+             compileExpression(c, rhsExp, reg, type);
+    }
+    case BO_ASSIGN: {
+      if (!variableOf(c, lhsExp, &variable))
+        return unsupported(c, lhsExp,
+                           "assignments to anything but a scalar variable");
+      if (!compileExpression(c, rhsExp, &rhs, &rhsType) ||
+          !convert(c, exp, &rhs, rhsType, variable.type))
+        return false;
+      *reg = writeVariable(c, exp, &variable, rhs);
+      *type = variable.type;
+      return true;
+    }
+    case BO_MULASSIGN:
+    case BO_DIVASSIGN:
+    case BO_MODASSIGN:
+    case BO_ADDASSIGN:
+    case BO_SUBASSIGN:
+    case BO_LSHIFTASSIGN:
+    case BO_ARSHIFTASSIGN:
+    case BO_LRSHIFTASSIGN:
+    case BO_BITANDASSIGN:
+    case BO_BITXORASSIGN:
+    case BO_BITORASSIGN: {
+      if (!variableOf(c, lhsExp, &variable))
+        return unsupported(c, lhsExp,
+                           "assignments to anything but a scalar variable");
+      lhs = readVariable(c, exp, &variable);
+      if (!compileExpression(c, rhsExp, &rhs, &rhsType) ||
+          !operate(c, exp, compoundOperator(op), lhs, variable.type, rhs,
+                   rhsType, reg, type) ||
+          !convert(c, exp, reg, *type, variable.type))
+        return false;
+      *reg = writeVariable(c, exp, &variable, *reg);
+      *type = variable.type;
+      return true;
+    }
+    case BO_LANDASSIGN:
+    case BO_LORASSIGN: {
+      if (!variableOf(c, lhsExp, &variable))
+        return unsupported(c, lhsExp,
+                           "assignments to anything but a scalar variable");
+      if (!compileLogical(c, exp, op == BO_LANDASSIGN, reg) ||
+          !convert(c, exp, reg, TK_BOOL, variable.type))
+        return false;
+      *reg = writeVariable(c, exp, &variable, *reg);
+      *type = variable.type;
+      return true;
+    }
+    case BO_LAND:
+    case BO_LOR: {
+      *type = TK_BOOL;
+      return compileLogical(c, exp, op == BO_LAND, reg);
+    }
+    case BO_EQ:
+    case BO_NEQ:
+    case BO_LT:
+    case BO_GT:
+    case BO_LTEQ:
+    case BO_GTEQ:
+    case BO_SPACESHIP: {
+      if (!compileExpression(c, lhsExp, &lhs, &lhsType) ||
+          !compileExpression(c, rhsExp, &rhs, &rhsType))
+        return false;
+      TypeKeyword merged = mergedType(lhsType, rhsType);
+      if (merged == TK_VOID)
+        return unsupported(c, exp, "comparisons between these types");
+      if (!convert(c, exp, &lhs, lhsType, merged) ||
+          !convert(c, exp, &rhs, rhsType, merged))
+        return false;
+      Instruction *comparison = emit(c, exp, compareHandler);
+      comparison->lhs = lhs;
+      comparison->rhs = rhs;
+      comparison->type = merged;
+      comparison->op = op;
+      comparison->dest = newRegister(c, NULL);
+      *reg = comparison->dest;
+      *type = op == BO_SPACESHIP ? TK_BYTE : TK_BOOL;
+      return true;
+    }
+    case BO_LSHIFT:
+    case BO_ARSHIFT:
+    case BO_LRSHIFT:
+    case BO_ADD:
+    case BO_SUB:
+    case BO_MUL:
+    case BO_DIV:
+    case BO_MOD:
+    case BO_BITAND:
+    case BO_BITOR:
+    case BO_BITXOR: {
+      return compileExpression(c, lhsExp, &lhs, &lhsType) &&
+             compileExpression(c, rhsExp, &rhs, &rhsType) &&
+             operate(c, exp, op, lhs, lhsType, rhs, rhsType, reg, type);
+    }
+    case BO_CAST: {
+      *type = keywordOf(exp->data.binOpExp.type);
+      if (*type == TK_VOID)
+        return unsupported(c, exp, "casts to non-scalar types");
+      if (!compileExpression(c, rhsExp, reg, &rhsType)) return false;
+      return convert(c, exp, reg, rhsType, *type);
+    }
+    default: {
+      return unsupported(c, exp, "structures, unions or arrays");
+    }
+  }
+}
+
+/**
+ * compiles a unary operator expression
+ *
+ * @param c compiler
+ * @param exp expression to compile
+ * @param reg output pointer to the register holding the result
+ * @param type output pointer to the type of the result
+ * @returns whether the expression could be compiled
+ */
+static bool compileUnOp(Compiler *c, Node *exp, size_t *reg,
+                        TypeKeyword *type) {
+  UnOpType op = exp->data.unOpExp.op;
+  Node *target = exp->data.unOpExp.target;
+  Variable variable;
+  switch (op) {
+    case UO_PARENS: {
+      return compileExpression(c, target, reg, type);
+    }
+    case UO_PREINC:
+    case UO_PREDEC:
+    case UO_POSTINC:
+    case UO_POSTDEC: {
+      if (!variableOf(c, target, &variable))
+        return unsupported(c, target,
+                           "assignments to anything but a scalar variable");
+      size_t old = readVariable(c, exp, &variable);
+      if (op == UO_POSTINC || op == UO_POSTDEC) {
+        // keep the old value, since a local's register is about to change
+        Instruction *copy = emit(c, exp, moveHandler);
+        copy->lhs = old;
+        copy->dest = newRegister(c, NULL);
+        old = copy->dest;
+      }
+
+      Instruction *one = emit(c, exp, constantHandler);
+      one->dest = newRegister(c, NULL);
+      if (variable.type == TK_FLOAT)
+        one->immediate.floatVal = 1.0f;
+      else if (variable.type == TK_DOUBLE)
+        one->immediate.doubleVal = 1;
+      else
+        one->immediate.bits = 1;
+
+      size_t updated;
+      if (!operate(c, exp,
+                   op == UO_PREINC || op == UO_POSTINC ? BO_ADD : BO_SUB, old,
+                   variable.type, one->dest, variable.type, &updated, type))
+        return false;
+      size_t written = writeVariable(c, exp, &variable, updated);
+      *reg = op == UO_PREINC || op == UO_PREDEC ? written : old;
+      return true;
+    }
+    case UO_NEG:
+    case UO_LNOT:
+    case UO_BITNOT: {
+      return compileExpression(c, target, reg, type) &&
+             unaryOperate(c, exp, op, true, reg, type);
+    }
+    case UO_NEGASSIGN:
+    case UO_LNOTASSIGN:
+    case UO_BITNOTASSIGN: {
+      if (!variableOf(c, target, &variable))
+        return unsupported(c, target,
+                           "assignments to anything but a scalar variable");
+      *reg = readVariable(c, exp, &variable);
+      *type = variable.type;
+      UnOpType applied = op == UO_NEGASSIGN    ? UO_NEG
+                         : op == UO_LNOTASSIGN ? UO_LNOT
+                                               : UO_BITNOT;
+      if (!unaryOperate(c, exp, applied, false, reg, type) ||
+          !convert(c, exp, reg, *type, variable.type))
+        return false;
+      *reg = writeVariable(c, exp, &variable, *reg);
+      *type = variable.type;
+      return true;
+    }
+    case UO_SIZEOFEXP:
+    case UO_SIZEOFTYPE: {
+      return unsupported(c, exp, "sizeof");
+    }
+    default: {
+      return unsupported(c, exp, "pointers");
+    }
+  }
+}
+
+/**
+ * compiles a ternary expression
+ *
+ * @param c compiler
+ * @param exp expression to compile
+ * @param reg output pointer to the register holding the result
+ * @param type output pointer to the type of the result
+ * @returns whether the expression could be compiled
+ */
+static bool compileTernary(Compiler *c, Node *exp, size_t *reg,
+                           TypeKeyword *type) {
+  size_t predicate;
+  TypeKeyword predicateType;
+  if (!compileExpression(c, exp->data.ternaryExp.predicate, &predicate,
+                         &predicateType) ||
+      !convert(c, exp, &predicate, predicateType, TK_BOOL))
+    return false;
+  Instruction *toAlternative = emitJump(c, exp, jumpIfFalseHandler, predicate);
+
+  // the common type isn't known until both arms are compiled, so each arm
+  // ends in a conversion that's filled in afterwards
+  *reg = newRegister(c, NULL);
+  size_t consequent;
+  TypeKeyword consequentType;
+  if (!compileExpression(c, exp->data.ternaryExp.consequent, &consequent,
+                         &consequentType))
+    return false;
+  Instruction *consequentResult = emit(c, exp, convertHandler);
+  consequentResult->lhs = consequent;
+  consequentResult->fromType = consequentType;
+  consequentResult->dest = *reg;
+  Instruction *toEnd = emitJump(c, exp, jumpHandler, 0);
+
+  toAlternative->targetIndex = c->code.size;
+  size_t alternative;
+  TypeKeyword alternativeType;
+  if (!compileExpression(c, exp->data.ternaryExp.alternative, &alternative,
+                         &alternativeType))
+    return false;
+  Instruction *alternativeResult = emit(c, exp, convertHandler);
+  alternativeResult->lhs = alternative;
+  alternativeResult->fromType = alternativeType;
+  alternativeResult->dest = *reg;
+  toEnd->targetIndex = c->code.size;
+
+  *type = mergedType(consequentType, alternativeType);
+  if (*type == TK_VOID)
+    return unsupported(c, exp, "conditional expressions of these types");
+  consequentResult->type = *type;
+  if (consequentType == *type) consequentResult->handler = moveHandler;
+  alternativeResult->type = *type;
+  if (alternativeType == *type) alternativeResult->handler = moveHandler;
+  return true;
+}
+
+/**
+ * finds a function defined in a code file
+ *
+ * @param interpreter interpreter to search
+ * @param entry nullable symbol the function was called through
+ * @param name name of the function, used if no function was defined through
+ * entry
+ * @returns the function, or NULL if there isn't exactly one such function
+ */
+static Function *findFunction(Interpreter const *interpreter,
+                              SymbolTableEntry const *entry,
+                              char const *name) {
+  if (entry != NULL) {
+    for (size_t idx = 0; idx < interpreter->functions.size; ++idx) {
+      Function *function = interpreter->functions.elements[idx];
+      if (function->entry == entry) return function;
+    }
+  }
+
+  // the call may be through a declaration in another file
+  Function *found = NULL;
+  for (size_t idx = 0; idx < interpreter->functions.size; ++idx) {
+    Function *function = interpreter->functions.elements[idx];
+    if (strcmp(function->name, name) == 0) {
+      if (found != NULL) return NULL;
+      found = function;
+    }
+  }
+  return found;
+}
+
+#if defined(__x86_64__)
+/**
+ * records which arguments of a call to a C function are passed in floating
+ * point registers
+ *
+ * @param c compiler
+ * @param exp call being compiled
+ * @param entry function called
+ * @param call call instruction
+ * @returns whether the function can be called - if it has too many arguments
+ * to pass them all in registers, it can't
+ */
+static bool compileForeignArgs(Compiler *c, Node *exp,
+                               SymbolTableEntry const *entry,
+                               Instruction *call) {
+  Vector const *argumentTypes = &entry->data.function.argumentTypes;
+  size_t numIntegral = 0;
+  size_t numFloating = 0;
+  call->floatingArgs = 0;
+  call->floatArgs = 0;
+  for (size_t idx = 0; idx < argumentTypes->size; ++idx) {
+    TypeKeyword argumentType = keywordOf(argumentTypes->elements[idx]);
+    if (isFloating(argumentType)) {
+      call->floatingArgs |= UINT32_C(1) << idx;
+      if (argumentType == TK_FLOAT) call->floatArgs |= UINT32_C(1) << idx;
+      ++numFloating;
+    } else {
+      ++numIntegral;
+    }
+    if (numIntegral > MAX_FOREIGN_INTEGRAL_ARGS ||
+        numFloating > MAX_FOREIGN_FLOATING_ARGS)
+      return unsupported(c, exp,
+                         "calls to C functions with arguments passed on the "
+                         "stack");
+  }
+  return true;
+}
+#endif
+
+/**
+ * compiles a function call
+ *
+ * @param c compiler
+ * @param exp expression to compile
+ * @param reg output pointer to the register holding the result
+ * @param type output pointer to the type of the result
+ * @returns whether the expression could be compiled
+ */
+static bool compileCall(Compiler *c, Node *exp, size_t *reg,
+                        TypeKeyword *type) {
+  SymbolTableEntry *entry = directCallee(exp);
+  if (entry == NULL)
+    return unsupported(c, exp, "calls through function pointers");
+  Node *function = stripParens(exp->data.funCallExp.function);
+  Node *id = function;
+  if (function->type == NT_SCOPEDID) {
+    Vector *components = function->data.scopedId.components;
+    id = components->elements[components->size - 1];
+  }
+  char const *name = id->data.id.id;
+
+  Type const *returnType = stripType(entry->data.function.returnType);
+  *type = keywordOf(returnType);
+  if (returnType->kind != TK_KEYWORD)
+    return unsupported(c, exp, "calls to functions returning non-scalars");
+
+  // evaluate the arguments, then gather them into consecutive registers
+  Vector *arguments = exp->data.funCallExp.arguments;
+  Vector const *argumentTypes = &entry->data.function.argumentTypes;
+  size_t *values = malloc(arguments->size * sizeof(size_t));
+  for (size_t idx = 0; idx < arguments->size; ++idx) {
+    TypeKeyword argumentType;
+    if (!compileExpression(c, arguments->elements[idx], &values[idx],
+                           &argumentType) ||
+        !convert(c, arguments->elements[idx], &values[idx], argumentType,
+                 keywordOf(argumentTypes->elements[idx]))) {
+      free(values);
+      return false;
+    }
+  }
+  size_t base = c->registers.size;
+  for (size_t idx = 0; idx < arguments->size; ++idx) {
+    Instruction *move = emit(c, exp, moveHandler);
+    move->lhs = values[idx];
+    move->dest = newRegister(c, NULL);
+  }
+  free(values);
+
+  Function const *callee = findFunction(c->interpreter, entry, name);
+  HostFunction const *host = findHost(name);
+  void *address =
+      callee != NULL || host != NULL || c->interpreter->process == NULL
+          ? NULL
+          : dlsym(c->interpreter->process, name);
+  Instruction *call;
+  if (callee != NULL) {
+    call = emit(c, exp, callHandler);
+    call->callee = callee;
+  } else if (host != NULL) {
+    call = emit(c, exp, hostCallHandler);
+    call->host = host;
+  } else if (address != NULL) {
+#if defined(__x86_64__)
+    call = emit(c, exp, foreignCallHandler);
+    if (!compileForeignArgs(c, exp, entry, call)) return false;
+    memcpy(&call->foreign, &address, sizeof(address));
+#else
+    // arguments are passed to C functions as the x86_64 System V ABI does
+    return unsupported(c, exp, "calls to C functions on this processor");
+#endif
+  } else {
+    char *message = format(
+        "calls to '%s', which isn't defined in any code file or the C library",
+        name);
+    unsupported(c, exp, message);
+    free(message);
+    return false;
+  }
+  call->lhs = base;
+  call->numArgs = arguments->size;
+  call->type = *type;
+  call->dest = newRegister(c, NULL);
+  *reg = call->dest;
+  return true;
+}
+
+/**
+ * compiles an expression
+ *
+ * @param c compiler
+ * @param exp expression to compile
+ * @param reg output pointer to the register holding the value
+ * @param type output pointer to the type of the value, TK_VOID if it has none
+ * @returns whether the expression could be compiled
+ */
+static bool compileExpression(Compiler *c, Node *exp, size_t *reg,
+                              TypeKeyword *type) {
+  switch (exp->type) {
+    case NT_BINOPEXP: {
+      return compileBinOp(c, exp, reg, type);
+    }
+    case NT_UNOPEXP: {
+      return compileUnOp(c, exp, reg, type);
+    }
+    case NT_TERNARYEXP: {
+      return compileTernary(c, exp, reg, type);
+    }
+    case NT_FUNCALLEXP: {
+      return compileCall(c, exp, reg, type);
+    }
+    case NT_LITERAL: {
+      Instruction *constant = emit(c, exp, constantHandler);
+      if (!literalValue(exp, &constant->immediate, type))
+        return unsupported(c, exp, "strings, null or aggregate literals");
+      constant->dest = newRegister(c, NULL);
+      *reg = constant->dest;
+      return true;
+    }
+    case NT_ID:
+    case NT_SCOPEDID: {
+      Variable variable;
+      if (!variableOf(c, exp, &variable))
+        return unsupported(
+            c, exp, "names other than scalar variables defined in code files");
+      *reg = readVariable(c, exp, &variable);
+      *type = variable.type;
+      return true;
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid expression type");
+    }
+  }
+}
+
+static bool compileStmt(Compiler *c, Node *stmt);
+
+/**
+ * compiles the body of a loop or switch
+ *
+ * @param c compiler
+ * @param body body to compile
+ * @param breaks vector to add jumps to the end of the loop or switch to
+ * @param continues vector to add jumps to the next iteration to
+ * @returns whether the body could be compiled
+ */
+static bool compileBody(Compiler *c, Node *body, Vector *breaks,
+                        Vector *continues) {
+  Vector *outerBreaks = c->breaks;
+  Vector *outerContinues = c->continues;
+  c->breaks = breaks;
+  c->continues = continues;
+  bool compiled = compileStmt(c, body);
+  c->breaks = outerBreaks;
+  c->continues = outerContinues;
+  return compiled;
+}
+
+/**
+ * compiles a condition, and a jump taken if it's false
+ *
+ * @param c compiler
+ * @param condition condition to compile
+ * @param jump output pointer to the jump, to set the target of
+ * @returns whether the condition could be compiled
+ */
+static bool compileCondition(Compiler *c, Node *condition, Instruction **jump) {
+  size_t reg;
+  TypeKeyword type;
+  if (!compileExpression(c, condition, &reg, &type) ||
+      !convert(c, condition, &reg, type, TK_BOOL))
+    return false;
+  *jump = emitJump(c, condition, jumpIfFalseHandler, reg);
+  return true;
+}
+
+/**
+ * compiles a switch statement
+ *
+ * @param c compiler
+ * @param stmt statement to compile
+ * @returns whether the statement could be compiled
+ */
+static bool compileSwitch(Compiler *c, Node *stmt) {
+  size_t condition;
+  TypeKeyword conditionType;
+  if (!compileExpression(c, stmt->data.switchStmt.condition, &condition,
+                         &conditionType))
+    return false;
+
+  // compare against each case value in turn, then jump to the default
+  Vector *cases = stmt->data.switchStmt.cases;
+  Vector *caseJumps = malloc(cases->size * sizeof(Vector));
+  for (size_t idx = 0; idx < cases->size; ++idx) vectorInit(&caseJumps[idx]);
+  Vector breaks;
+  vectorInit(&breaks);
+  Instruction *toDefault = NULL;
+  bool hasDefault = false;
+  bool compiled = true;
+  for (size_t caseIdx = 0; compiled && caseIdx < cases->size; ++caseIdx) {
+    Node *switchCase = cases->elements[caseIdx];
+    if (switchCase->type != NT_SWITCHCASE) continue;
+    Vector *values = switchCase->data.switchCase.values;
+    for (size_t idx = 0; compiled && idx < values->size; ++idx) {
+      Node *value = values->elements[idx];
+      size_t lhs = condition;
+      size_t rhs;
+      TypeKeyword valueType;
+      compiled = compileExpression(c, value, &rhs, &valueType);
+      if (!compiled) break;
+      TypeKeyword merged = mergedType(conditionType, valueType);
+      compiled = merged != TK_VOID
+                     ? convert(c, value, &lhs, conditionType, merged) &&
+                           convert(c, value, &rhs, valueType, merged)
+                     : unsupported(c, value, "a case of this type");
+      if (!compiled) break;
+      Instruction *comparison = emit(c, value, compareHandler);
+      comparison->lhs = lhs;
+      comparison->rhs = rhs;
+      comparison->type = merged;
+      comparison->op = BO_EQ;
+      comparison->dest = newRegister(c, NULL);
+      vectorInsert(&caseJumps[caseIdx], emitJump(c, value, jumpIfTrueHandler,
+                                                 comparison->dest));
+    }
+  }
+  if (compiled) toDefault = emitJump(c, stmt, jumpHandler, 0);
+
+  // then lay out the bodies, which fall through into each other
+  for (size_t idx = 0; compiled && idx < cases->size; ++idx) {
+    Node *switchCase = cases->elements[idx];
+    Node *body;
+    if (switchCase->type == NT_SWITCHCASE) {
+      patchHere(c, &caseJumps[idx]);
+      body = switchCase->data.switchCase.body;
+    } else {
+      hasDefault = true;
+      toDefault->targetIndex = c->code.size;
+      body = switchCase->data.switchDefault.body;
+    }
+    compiled = compileBody(c, body, &breaks, c->continues);
+  }
+  if (compiled && !hasDefault) toDefault->targetIndex = c->code.size;
+  patchHere(c, &breaks);
+
+  for (size_t idx = 0; idx < cases->size; ++idx)
+    vectorUninit(&caseJumps[idx], nullDtor);
+  free(caseJumps);
+  vectorUninit(&breaks, nullDtor);
+  return compiled;
+}
+
+/**
+ * compiles a statement
+ *
+ * @param c compiler
+ * @param stmt statement to compile
+ * @returns whether the statement could be compiled
+ */
+static bool compileStmt(Compiler *c, Node *stmt) {
+  switch (stmt->type) {
+    case NT_COMPOUNDSTMT: {
+      Vector *stmts = stmt->data.compoundStmt.stmts;
+      for (size_t idx = 0; idx < stmts->size; ++idx) {
+        if (!compileStmt(c, stmts->elements[idx])) return false;
+      }
+      return true;
+    }
+    case NT_IFSTMT: {
+      Instruction *toAlternative;
+      if (!compileCondition(c, stmt->data.ifStmt.predicate, &toAlternative) ||
+          !compileStmt(c, stmt->data.ifStmt.consequent))
+        return false;
+      if (stmt->data.ifStmt.alternative == NULL) {
+        toAlternative->targetIndex = c->code.size;
+        return true;
+      }
+      Instruction *toEnd = emitJump(c, stmt, jumpHandler, 0);
+      toAlternative->targetIndex = c->code.size;
+      if (!compileStmt(c, stmt->data.ifStmt.alternative)) return false;
+      toEnd->targetIndex = c->code.size;
+      return true;
+    }
+    case NT_WHILESTMT:
+    case NT_FORSTMT: {
+      bool isFor = stmt->type == NT_FORSTMT;
+      if (isFor && !compileStmt(c, stmt->data.forStmt.initializer))
+        return false;
+
+      size_t top = c->code.size;
+      Instruction *toEnd;
+      if (!compileCondition(c,
+                            isFor ? stmt->data.forStmt.condition
+                                  : stmt->data.whileStmt.condition,
+                            &toEnd))
+        return false;
+      Vector breaks;
+      vectorInit(&breaks);
+      Vector continues;
+      vectorInit(&continues);
+      bool compiled = compileBody(
+          c, isFor ? stmt->data.forStmt.body : stmt->data.whileStmt.body,
+          &breaks, &continues);
+      patchHere(c, &continues);
+      if (compiled && isFor && stmt->data.forStmt.increment != NULL) {
+        size_t reg;
+        TypeKeyword type;
+        compiled =
+            compileExpression(c, stmt->data.forStmt.increment, &reg, &type);
+      }
+      emitJump(c, stmt, jumpHandler, 0)->targetIndex = top;
+      toEnd->targetIndex = c->code.size;
+      patchHere(c, &breaks);
+      vectorUninit(&breaks, nullDtor);
+      vectorUninit(&continues, nullDtor);
+      return compiled;
+    }
+    case NT_DOWHILESTMT: {
+      size_t top = c->code.size;
+      Vector breaks;
+      vectorInit(&breaks);
+      Vector continues;
+      vectorInit(&continues);
+      bool compiled =
+          compileBody(c, stmt->data.doWhileStmt.body, &breaks, &continues);
+      patchHere(c, &continues);
+      size_t reg;
+      TypeKeyword type;
+      if (compiled) {
+        compiled = compileExpression(c, stmt->data.doWhileStmt.condition, &reg,
+                                     &type) &&
+                   convert(c, stmt, &reg, type, TK_BOOL);
+      }
+      if (compiled)
+        emitJump(c, stmt, jumpIfTrueHandler, reg)->targetIndex = top;
+      patchHere(c, &breaks);
+      vectorUninit(&breaks, nullDtor);
+      vectorUninit(&continues, nullDtor);
+      return compiled;
+    }
+    case NT_SWITCHSTMT: {
+      return compileSwitch(c, stmt);
+    }
+    case NT_BREAKSTMT: {
+      vectorInsert(c->breaks, emitJump(c, stmt, jumpHandler, 0));
+      return true;
+    }
+    case NT_CONTINUESTMT: {
+      vectorInsert(c->continues, emitJump(c, stmt, jumpHandler, 0));
+      return true;
+    }
+    case NT_RETURNSTMT: {
+      Type const *returnType =
+          stripType(c->function->entry->data.function.returnType);
+      Instruction *ret;
+      if (stmt->data.returnStmt.value == NULL) {
+        ret = emit(c, stmt, returnHandler);
+      } else {
+        if (returnType->kind != TK_KEYWORD)
+          return unsupported(c, stmt, "returning non-scalar values");
+        size_t reg;
+        TypeKeyword type;
+        if (!compileExpression(c, stmt->data.returnStmt.value, &reg, &type) ||
+            !convert(c, stmt, &reg, type, returnType->data.keyword.keyword))
+          return false;
+        ret = emit(c, stmt, returnHandler);
+        ret->lhs = reg;
+        ret->type = returnType->data.keyword.keyword;
+      }
+      return true;
+    }
+    case NT_ASMSTMT: {
+      return unsupported(c, stmt, "inline assembly");
+    }
+    case NT_VARDEFNSTMT: {
+      Vector *names = stmt->data.varDefnStmt.names;
+      Vector *initializers = stmt->data.varDefnStmt.initializers;
+      for (size_t idx = 0; idx < names->size; ++idx) {
+        Node *name = names->elements[idx];
+        SymbolTableEntry *entry = name->data.id.entry;
+        TypeKeyword variableType = keywordOf(entry->data.variable.type);
+        if (variableType == TK_VOID)
+          return unsupported(c, name, "variables of non-scalar types");
+
+        size_t variable = newRegister(c, entry);
+        Node *initializer = initializers->elements[idx];
+        if (initializer == NULL) {
+          // uninitialized variables are zeroed, so runs are reproducible
+          emit(c, name, constantHandler)->dest = variable;
+          continue;
+        }
+        size_t reg;
+        TypeKeyword type;
+        if (!compileExpression(c, initializer, &reg, &type) ||
+            !convert(c, initializer, &reg, type, variableType))
+          return false;
+        Instruction *move = emit(c, name, moveHandler);
+        move->lhs = reg;
+        move->dest = variable;
+      }
+      return true;
+    }
+    case NT_EXPRESSIONSTMT: {
+      size_t reg;
+      TypeKeyword type;
+      return compileExpression(c, stmt->data.expressionStmt.expression, &reg,
+                               &type);
+    }
+    case NT_NULLSTMT: {
+      return true;
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid statement type");
+    }
+  }
+}
+
+/**
+ * compiles a function body
+ *
+ * @param interpreter interpreter the function belongs to
+ * @param function function to compile
+ * @returns whether the function could be compiled
+ */
+static bool compileFunction(Interpreter *interpreter, Function *function) {
+  Compiler c;
+  c.interpreter = interpreter;
+  c.function = function;
+  vectorInit(&c.code);
+  vectorInit(&c.registers);
+  c.breaks = NULL;
+  c.continues = NULL;
+
+  Node *definition = function->definition;
+  Vector *argNames = definition->data.funDefn.argNames;
+  for (size_t idx = 0; idx < argNames->size; ++idx) {
+    Node *name = argNames->elements[idx];
+    newRegister(&c, name == NULL ? NULL
+                                 : hashMapGet(definition->data.funDefn.argStab,
+                                              name->data.id.id));
+  }
+  function->numParams = argNames->size;
+
+  bool compiled = compileStmt(&c, definition->data.funDefn.body);
+  if (compiled) {
+    // falling off the end returns from void functions, and traps otherwise
+    emit(&c, definition,
+         keywordOf(function->entry->data.function.returnType) == TK_VOID
+             ? returnHandler
+             : missingReturnHandler);
+
+    function->numRegisters = c.registers.size;
+    function->code = malloc(c.code.size * sizeof(Instruction));
+    for (size_t idx = 0; idx < c.code.size; ++idx) {
+      function->code[idx] = *(Instruction *)c.code.elements[idx];
+      function->code[idx].target =
+          function->code + function->code[idx].targetIndex;
+    }
+  }
+
+  vectorUninit(&c.code, free);
+  vectorUninit(&c.registers, nullDtor);
+  return compiled;
+}
+
+// interface
+
+int interpreterInit(Interpreter *interpreter, FILE *in, FILE *out) {
+  vectorInit(&interpreter->functions);
+  vectorInit(&interpreter->globals);
+  interpreter->globalValues = NULL;
+  interpreter->in = in;
+  interpreter->out = out;
+  interpreter->status = IS_RUNNING;
+  interpreter->exitStatus = 0;
+  interpreter->depth = 0;
+  interpreter->returnValue.bits = 0;
+  interpreter->process = dlopen(NULL, RTLD_LAZY);
+
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    FileListEntry *file = &fileList.entries[fileIdx];
+    if (!file->isCode) continue;
+
+    Vector *bodies = file->ast->data.file.bodies;
+    for (size_t bodyIdx = 0; bodyIdx < bodies->size; ++bodyIdx) {
+      Node *body = bodies->elements[bodyIdx];
+      if (body->type == NT_FUNDEFN) {
+        Function *function = malloc(sizeof(Function));
+        function->entry = body->data.funDefn.name->data.id.entry;
+        function->name = body->data.funDefn.name->data.id.id;
+        function->file = file;
+        function->definition = body;
+        function->numParams = 0;
+        function->numRegisters = 0;
+        function->code = NULL;
+        vectorInsert(&interpreter->functions, function);
+      } else if (body->type == NT_VARDEFN) {
+        // globals that aren't scalars with scalar initializers are left out,
+        // and rejected if a function uses them
+        Vector *names = body->data.varDefn.names;
+        Vector *initializers = body->data.varDefn.initializers;
+        for (size_t idx = 0; idx < names->size; ++idx) {
+          Node *name = names->elements[idx];
+          Node *initializer = initializers->elements[idx];
+          TypeKeyword globalType =
+              keywordOf(name->data.id.entry->data.variable.type);
+          Value initial;
+          TypeKeyword initialType = globalType;
+          initial.bits = 0;
+          if (globalType == TK_VOID ||
+              (initializer != NULL &&
+               !literalValue(initializer, &initial, &initialType)) ||
+              !convertValue(initial, initialType, globalType, &initial))
+            continue;
+
+          vectorInsert(&interpreter->globals, name->data.id.entry);
+          interpreter->globalValues =
+              realloc(interpreter->globalValues,
+                      interpreter->globals.size * sizeof(Value));
+          interpreter->globalValues[interpreter->globals.size - 1] = initial;
+        }
+      }
+    }
+  }
+
+  int retval = 0;
+  for (size_t idx = 0; idx < interpreter->functions.size; ++idx) {
+    if (!compileFunction(interpreter, interpreter->functions.elements[idx]))
+      retval = -1;
+  }
+  return retval;
+}
+
+int interpreterCall(Interpreter *interpreter, char const *name,
+                    Value const *args, size_t numArgs, Value *result) {
+  Function const *function = findFunction(interpreter, NULL, name);
+  if (function == NULL) {
+    fprintf(stderr, "tlc: error: no unique function named '%s' to run\n",
+            name);
+    return -1;
+  }
+
+  interpreter->status = IS_RUNNING;
+  interpreter->depth = 0;
+  if (execute(interpreter, function, args, numArgs, result)) return 0;
+  if (interpreter->status != IS_EXITED) return -1;
+  result->bits = (uint64_t)(int64_t)interpreter->exitStatus;
+  return 0;
+}
+
+/**
+ * deinitializes and frees a function
+ *
+ * @param function function to free
+ */
+static void functionFree(void *function) {
+  free(((Function *)function)->code);
+  free(function);
+}
+
+void interpreterUninit(Interpreter *interpreter) {
+  vectorUninit(&interpreter->functions, functionFree);
+  vectorUninit(&interpreter->globals, nullDtor);
+  free(interpreter->globalValues);
+  if (interpreter->process != NULL) dlclose(interpreter->process);
+}
@@ -0,0 +1,122 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * interpreter
+ *
+ * runs T programs without assembling and linking them, for quick edit-run
+ * cycles and as an oracle when testing optimizations
+ *
+ * each function body is compiled once to an array of pre-decoded instructions
+ * over a frame of registers; each instruction holds a pointer to the handler
+ * that executes it, and each handler returns the next instruction to run, so
+ * dispatch never decodes anything. Only scalar values are supported - any
+ * pointer, array or aggregate is reported when the function using it is
+ * compiled
+ *
+ * functions declared but not defined in any code file are looked up in the
+ * interpreter's own process, and called with their scalar arguments passed in
+ * registers, as the x86_64 System V ABI passes them
+ */
+
+#ifndef TLC_INTERPRETER_INTERPRETER_H_
+#define TLC_INTERPRETER_INTERPRETER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "util/container/vector.h"
+
+/**
+ * a value held in a register
+ *
+ * integral and boolean values are kept sign or zero extended from the width of
+ * their type
+ */
+typedef union {
+  uint64_t bits;
+  float floatVal;
+  double doubleVal;
+} Value;
+
+/** why an interpreter stopped running */
+typedef enum {
+  IS_RUNNING, /**< hasn't stopped */
+  IS_EXITED,  /**< the program called exit */
+  IS_TRAPPED, /**< the program did something undefined, or aborted */
+} InterpreterStatus;
+
+/** the compiled program and its state */
+typedef struct {
+  Vector functions;    /**< vector of compiled functions, owning */
+  Vector globals;      /**< vector of SymbolTableEntry, non-owning */
+  Value *globalValues; /**< values of globals, parallel to globals */
+  FILE *in;            /**< stream getchar reads from */
+  FILE *out;           /**< stream putchar writes to */
+  void *process; /**< the interpreter's own process, whose C library functions
+                    the program may call, or NULL if it couldn't be opened */
+  InterpreterStatus status;
+  int exitStatus;    /**< argument to exit, if status is IS_EXITED */
+  size_t depth;      /**< number of active calls */
+  Value returnValue; /**< value being returned by the innermost call */
+} Interpreter;
+
+/**
+ * compiles every function and global defined in the code files of the global
+ * file list
+ *
+ * complains about any construct the interpreter can't run
+ *
+ * @param interpreter interpreter to initialize, must be uninitialized even if
+ * this fails
+ * @param in stream the program reads from
+ * @param out stream the program writes to
+ * @returns status code (0 = OK)
+ */
+int interpreterInit(Interpreter *interpreter, FILE *in, FILE *out);
+
+/**
+ * calls a function
+ *
+ * missing arguments are zero and extra arguments are ignored. Globals keep
+ * their values between calls
+ *
+ * @param interpreter interpreter to run in
+ * @param name name of the function
+ * @param args arguments, each already of the type of its parameter
+ * @param numArgs number of arguments
+ * @param result output pointer to the return value, or to the status passed to
+ * exit if the program exited
+ * @returns status code (0 = OK) - non-zero if there is no such function, or
+ * the program trapped
+ */
+int interpreterCall(Interpreter *interpreter, char const *name,
+                    Value const *args, size_t numArgs, Value *result);
+
+/**
+ * uninitializes an interpreter
+ *
+ * @param interpreter interpreter to uninitialize
+ */
+void interpreterUninit(Interpreter *interpreter);
+
+#endif  // TLC_INTERPRETER_INTERPRETER_H_
@@ -65,6 +65,10 @@ static char const *const TOKEN_NAMES[] = {
     "BOOL",
     "CONST",
     "VOLATILE",
+    "PURE",
+    "LIKELY",
+    "UNLIKELY",
+    "THREADLOCAL",
     "SEMI",
     "COMMA",
     "LPAREN",
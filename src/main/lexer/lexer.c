@@ -66,21 +66,25 @@ void tokenUninit(Token *token) { free(token->string); }
 /** keyword map */
 HashMap keywordMap;
 char const *const KEYWORD_STRINGS[] = {
-    "module",  "import", "opaque",   "struct", "union",    "enum",   "typedef",
-    "if",      "else",   "while",    "do",     "for",      "switch", "case",
-    "default", "break",  "continue", "return", "asm",      "cast",   "sizeof",
-    "true",    "false",  "null",     "void",   "ubyte",    "byte",   "char",
-    "ushort",  "short",  "uint",     "int",    "wchar",    "ulong",  "long",
-    "float",   "double", "bool",     "const",  "volatile",
+    "module",   "import",      "opaque",  "struct",   "union",    "enum",
+    "typedef",  "if",          "else",    "while",    "do",       "for",
+    "switch",   "case",        "default", "break",    "continue", "return",
+    "asm",      "cast",        "sizeof",  "true",     "false",    "null",
+    "void",     "ubyte",       "byte",    "char",     "ushort",   "short",
+    "uint",     "int",         "wchar",   "ulong",    "long",     "float",
+    "double",   "bool",        "const",   "volatile", "pure",     "likely",
+    "unlikely", "threadlocal",
 };
 TokenType const KEYWORD_TOKENS[] = {
-    TT_MODULE,  TT_IMPORT, TT_OPAQUE,  TT_STRUCT,   TT_UNION,    TT_ENUM,
-    TT_TYPEDEF, TT_IF,     TT_ELSE,    TT_WHILE,    TT_DO,       TT_FOR,
-    TT_SWITCH,  TT_CASE,   TT_DEFAULT, TT_BREAK,    TT_CONTINUE, TT_RETURN,
-    TT_ASM,     TT_CAST,   TT_SIZEOF,  TT_TRUE,     TT_FALSE,    TT_NULL,
-    TT_VOID,    TT_UBYTE,  TT_BYTE,    TT_CHAR,     TT_USHORT,   TT_SHORT,
-    TT_UINT,    TT_INT,    TT_WCHAR,   TT_ULONG,    TT_LONG,     TT_FLOAT,
-    TT_DOUBLE,  TT_BOOL,   TT_CONST,   TT_VOLATILE,
+    TT_MODULE, TT_IMPORT,   TT_OPAQUE,   TT_STRUCT,      TT_UNION,
+    TT_ENUM,   TT_TYPEDEF,  TT_IF,       TT_ELSE,        TT_WHILE,
+    TT_DO,     TT_FOR,      TT_SWITCH,   TT_CASE,        TT_DEFAULT,
+    TT_BREAK,  TT_CONTINUE, TT_RETURN,   TT_ASM,         TT_CAST,
+    TT_SIZEOF, TT_TRUE,     TT_FALSE,    TT_NULL,        TT_VOID,
+    TT_UBYTE,  TT_BYTE,     TT_CHAR,     TT_USHORT,      TT_SHORT,
+    TT_UINT,   TT_INT,      TT_WCHAR,    TT_ULONG,       TT_LONG,
+    TT_FLOAT,  TT_DOUBLE,   TT_BOOL,     TT_CONST,       TT_VOLATILE,
+    TT_PURE,   TT_LIKELY,   TT_UNLIKELY, TT_THREADLOCAL,
 };
 
 /** magic token map */
@@ -101,7 +105,107 @@ MagicTokenType const MAGIC_TOKENS[] = {
     MTT_VERSION,
 };
 
+/** punctuation tokens, matched by maximal munch */
+char const *const PUNCTUATION_STRINGS[] = {
+    ";",  ",",   "(",   ")",    "[",   "]",  "{",  "}",   ".",   "->", "++",
+    "--", "*",   "&",   "+",    "-",   "!",  "~",  "=-",  "=!",  "=~", "/",
+    "%",  "<<",  ">>",  ">>>",  "<=>", "<",  ">",  "<=",  ">=",  "==", "!=",
+    "|",  "^",   "&&",  "||",   "?",   ":",  "=",  "*=",  "/=",  "%=", "+=",
+    "-=", "<<=", ">>=", ">>>=", "&=",  "^=", "|=", "&&=", "||=", "::",
+};
+TokenType const PUNCTUATION_TOKENS[] = {
+    TT_SEMI,         TT_COMMA,        TT_LPAREN,        TT_RPAREN,
+    TT_LSQUARE,      TT_RSQUARE,      TT_LBRACE,        TT_RBRACE,
+    TT_DOT,          TT_ARROW,        TT_INC,           TT_DEC,
+    TT_STAR,         TT_AMP,          TT_PLUS,          TT_MINUS,
+    TT_BANG,         TT_TILDE,        TT_NEGASSIGN,     TT_LNOTASSIGN,
+    TT_BITNOTASSIGN, TT_SLASH,        TT_PERCENT,       TT_LSHIFT,
+    TT_ARSHIFT,      TT_LRSHIFT,      TT_SPACESHIP,     TT_LANGLE,
+    TT_RANGLE,       TT_LTEQ,         TT_GTEQ,          TT_EQ,
+    TT_NEQ,          TT_BAR,          TT_CARET,         TT_LAND,
+    TT_LOR,          TT_QUESTION,     TT_COLON,         TT_ASSIGN,
+    TT_MULASSIGN,    TT_DIVASSIGN,    TT_MODASSIGN,     TT_ADDASSIGN,
+    TT_SUBASSIGN,    TT_LSHIFTASSIGN, TT_ARSHIFTASSIGN, TT_LRSHIFTASSIGN,
+    TT_BITANDASSIGN, TT_BITXORASSIGN, TT_BITORASSIGN,   TT_LANDASSIGN,
+    TT_LORASSIGN,    TT_SCOPE,
+};
+
+/** what a character may start */
+typedef enum {
+  CC_OTHER,       /**< nothing - an unexpected character */
+  CC_EOF,         /**< end of file */
+  CC_ID,          /**< identifier, keyword, or magic token */
+  CC_DIGIT,       /**< number */
+  CC_STRING,      /**< string or wstring literal */
+  CC_CHAR,        /**< char or wchar literal */
+  CC_PUNCTUATION, /**< punctuation token */
+} CharClass;
+/** class of each character */
+static CharClass charClasses[256];
+
+enum {
+  PUNCTUATION_COLUMNS = 32, /**< maximum distinct punctuation characters + 1 */
+  PUNCTUATION_STATES = 64,  /**< maximum punctuation prefixes + 1 */
+};
+/**
+ * column in punctuationTransitions for each character - zero if the character
+ * isn't in any punctuation token
+ */
+static uint8_t punctuationColumns[256];
+/**
+ * punctuation DFA - state zero is the start state, and a transition to zero
+ * means no token continues with that character
+ */
+static uint8_t punctuationTransitions[PUNCTUATION_STATES][PUNCTUATION_COLUMNS];
+/** token ending at each DFA state, or TT_EOF if no token ends there */
+static TokenType punctuationAccepts[PUNCTUATION_STATES];
+
+/** builds the character class table and the punctuation DFA */
+static void lexerInitTables(void) {
+  memset(charClasses, 0, sizeof(charClasses));
+  memset(punctuationColumns, 0, sizeof(punctuationColumns));
+  memset(punctuationTransitions, 0, sizeof(punctuationTransitions));
+  memset(punctuationAccepts, 0, sizeof(punctuationAccepts));
+
+  charClasses['\x04'] = CC_EOF;
+  charClasses['_'] = CC_ID;
+  for (char c = 'a'; c <= 'z'; ++c) charClasses[(unsigned char)c] = CC_ID;
+  for (char c = 'A'; c <= 'Z'; ++c) charClasses[(unsigned char)c] = CC_ID;
+  for (char c = '0'; c <= '9'; ++c) charClasses[(unsigned char)c] = CC_DIGIT;
+  charClasses['"'] = CC_STRING;
+  charClasses['\''] = CC_CHAR;
+
+  uint8_t numColumns = 1;
+  uint8_t numStates = 1;
+  for (size_t idx = 0;
+       idx < sizeof(PUNCTUATION_STRINGS) / sizeof(char const *); ++idx) {
+    unsigned char const *string =
+        (unsigned char const *)PUNCTUATION_STRINGS[idx];
+    charClasses[string[0]] = CC_PUNCTUATION;
+
+    uint8_t current = 0;
+    for (; *string != '\0'; ++string) {
+      if (punctuationColumns[*string] == 0) {
+        if (numColumns == PUNCTUATION_COLUMNS)
+          error(__FILE__, __LINE__, "too many punctuation characters");
+        punctuationColumns[*string] = numColumns++;
+      }
+      uint8_t *next =
+          &punctuationTransitions[current][punctuationColumns[*string]];
+      if (*next == 0) {
+        if (numStates == PUNCTUATION_STATES)
+          error(__FILE__, __LINE__, "too many punctuation prefixes");
+        *next = numStates++;
+      }
+      current = *next;
+    }
+    punctuationAccepts[current] = PUNCTUATION_TOKENS[idx];
+  }
+}
+
 void lexerInitMaps(void) {
+  lexerInitTables();
+
   hashMapInit(&keywordMap);
   for (size_t idx = 0; idx < sizeof(KEYWORD_STRINGS) / sizeof(char const *);
        ++idx) {
@@ -130,6 +234,7 @@ int lexerStateInit(FileListEntry *entry) {
   state->character = 1;
   state->line = 1;
   state->pushedBack = false;
+  state->shared = false;
 
   // try to map the file
   int fd = open(entry->inputFilename, O_RDONLY);
@@ -159,6 +264,17 @@ int lexerStateInit(FileListEntry *entry) {
   return 0;
 }
 
+void lexerStateInitBundled(FileListEntry *entry, char *contents,
+                           size_t length) {
+  LexerState *state = &entry->lexerState;
+  state->character = 1;
+  state->line = 1;
+  state->pushedBack = false;
+  state->shared = true;
+  state->length = length;
+  state->current = state->map = contents;
+}
+
 /**
  * gets a character from the lexer, returns '\x04' if end of file
  */
@@ -503,58 +619,55 @@ static void lexId(FileListEntry *entry, Token *token) {
   LexerState *state = &entry->lexerState;
   char const *start = state->current;
 
-  while (true) {
-    char c = get(state);
-    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
-          (c >= 'A' && c <= 'Z') || c == '_')) {
-      // end of identifier
-      put(state, 1);
-      size_t length = (size_t)(state->current - start);
-      char *clip = strncpy(malloc(length + 1), start, length);
-      clip[length] = '\0';
-
-      // classify the clip
-      TokenType const *keywordToken = hashMapGet(&keywordMap, clip);
-      if (keywordToken != NULL) {
-        // this is a keyword
-        tokenInit(state, token, *keywordToken, NULL);
+  // an identifier continues until the first character that can't be in one
+  char const *end = state->map + state->length;
+  while (state->current < end &&
+         (charClasses[(unsigned char)*state->current] == CC_ID ||
+          charClasses[(unsigned char)*state->current] == CC_DIGIT))
+    ++state->current;
+
+  size_t length = (size_t)(state->current - start);
+  char *clip = strncpy(malloc(length + 1), start, length);
+  clip[length] = '\0';
+
+  // classify the clip
+  TokenType const *keywordToken = hashMapGet(&keywordMap, clip);
+  if (keywordToken != NULL) {
+    // this is a keyword
+    tokenInit(state, token, *keywordToken, NULL);
+    state->character += length;
+    free(clip);
+    return;
+  }
+  MagicTokenType const *magicToken = hashMapGet(&magicMap, clip);
+  if (magicToken != NULL) {
+    // this is a magic token
+    switch (*magicToken) {
+      case MTT_FILE: {
+        tokenInit(state, token, TT_LIT_STRING,
+                  escapeString(entry->inputFilename));
         state->character += length;
         free(clip);
         return;
       }
-      MagicTokenType const *magicToken = hashMapGet(&magicMap, clip);
-      if (magicToken != NULL) {
-        // this is a magic token
-        switch (*magicToken) {
-          case MTT_FILE: {
-            tokenInit(state, token, TT_LIT_STRING,
-                      escapeString(entry->inputFilename));
-            state->character += length;
-            free(clip);
-            return;
-          }
-          case MTT_LINE: {
-            tokenInit(state, token, TT_LIT_INT_D, format("%zu", state->line));
-            state->character += length;
-            free(clip);
-            return;
-          }
-          case MTT_VERSION: {
-            tokenInit(state, token, TT_LIT_STRING,
-                      escapeString(VERSION_STRING));
-            state->character += length;
-            free(clip);
-            return;
-          }
-        }
+      case MTT_LINE: {
+        tokenInit(state, token, TT_LIT_INT_D, format("%zu", state->line));
+        state->character += length;
+        free(clip);
+        return;
+      }
+      case MTT_VERSION: {
+        tokenInit(state, token, TT_LIT_STRING, escapeString(VERSION_STRING));
+        state->character += length;
+        free(clip);
+        return;
       }
-
-      // this is a regular id
-      tokenInit(state, token, TT_ID, clip);
-      state->character += length;
-      return;
     }
   }
+
+  // this is a regular id
+  tokenInit(state, token, TT_ID, clip);
+  state->character += length;
 }
 
 /**
@@ -999,6 +1112,43 @@ static void lexChar(FileListEntry *entry, Token *token) {
   state->character += length + (type == TT_LIT_CHAR ? 2 : 3);
 }
 
+/**
+ * lexes a punctuation token, or a signed number, by maximal munch
+ */
+static void lexPunctuation(FileListEntry *entry, Token *token) {
+  LexerState *state = &entry->lexerState;
+  char const *end = state->map + state->length;
+
+  // run the DFA as far as it goes, remembering the longest token seen
+  TokenType type = TT_EOF;
+  size_t length = 0;
+  uint8_t current = 0;
+  for (char const *next = state->current; next < end; ++next) {
+    current = punctuationTransitions[current]
+                                    [punctuationColumns[(unsigned char)*next]];
+    if (current == 0) break;
+    if (punctuationAccepts[current] != TT_EOF) {
+      type = punctuationAccepts[current];
+      length = (size_t)(next - state->current) + 1;
+    }
+  }
+
+  if (type == TT_EOF)
+    error(__FILE__, __LINE__,
+          "lexPunctuation called when not at the start of punctuation");
+
+  if ((type == TT_PLUS || type == TT_MINUS) && state->current + 1 < end &&
+      charClasses[(unsigned char)state->current[1]] == CC_DIGIT) {
+    // [+-][0-9] is a number
+    lexNumber(entry, token);
+    return;
+  }
+
+  tokenInit(state, token, type, NULL);
+  state->current += length;
+  state->character += length;
+}
+
 void lex(FileListEntry *entry, Token *token) {
   LexerState *state = &entry->lexerState;
 
@@ -1013,497 +1163,53 @@ void lex(FileListEntry *entry, Token *token) {
   lexWhitespace(entry);
 
   // return a token
-  char c = get(state);
-  switch (c) {
-    // EOF
-    case '\x04': {
+  char const *end = state->map + state->length;
+  unsigned char c =
+      state->current < end ? (unsigned char)*state->current : '\x04';
+  switch (charClasses[c]) {
+    case CC_EOF: {
       tokenInit(state, token, TT_EOF, NULL);
       return;
     }
-
-    // punctuation
-    case ';': {
-      tokenInit(state, token, TT_SEMI, NULL);
-      state->character += 1;
-      return;
-    }
-    case ',': {
-      tokenInit(state, token, TT_COMMA, NULL);
-      state->character += 1;
-      return;
-    }
-    case '(': {
-      tokenInit(state, token, TT_LPAREN, NULL);
-      state->character += 1;
+    case CC_PUNCTUATION: {
+      lexPunctuation(entry, token);
       return;
     }
-    case ')': {
-      tokenInit(state, token, TT_RPAREN, NULL);
-      state->character += 1;
+    case CC_DIGIT: {
+      lexNumber(entry, token);
       return;
     }
-    case '[': {
-      tokenInit(state, token, TT_LSQUARE, NULL);
-      state->character += 1;
+    case CC_ID: {
+      // id, keyword, magic token
+      lexId(entry, token);
       return;
     }
-    case ']': {
-      tokenInit(state, token, TT_RSQUARE, NULL);
-      state->character += 1;
+    case CC_STRING: {
+      // string or wstring
+      ++state->current;
+      lexString(entry, token);
       return;
     }
-    case '{': {
-      tokenInit(state, token, TT_LBRACE, NULL);
-      state->character += 1;
-      return;
-    }
-    case '}': {
-      tokenInit(state, token, TT_RBRACE, NULL);
-      state->character += 1;
-      return;
-    }
-    case '.': {
-      tokenInit(state, token, TT_DOT, NULL);
-      state->character += 1;
-      return;
-    }
-    case '-': {
-      char next = get(state);
-      switch (next) {
-        case '>': {
-          // ->
-          tokenInit(state, token, TT_ARROW, NULL);
-          state->character += 2;
-          return;
-        }
-        case '-': {
-          // --
-          tokenInit(state, token, TT_DEC, NULL);
-          state->character += 2;
-          return;
-        }
-        case '=': {
-          // -=
-          tokenInit(state, token, TT_SUBASSIGN, NULL);
-          state->character += 2;
-          return;
-        }
-        default: {
-          if (next >= '0' && next <= '9') {
-            // number, return - and zero
-            put(state, 2);
-            lexNumber(entry, token);
-            return;
-          } else {
-            // just -
-            put(state, 1);
-            tokenInit(state, token, TT_MINUS, NULL);
-            state->character += 1;
-            return;
-          }
-        }
-      }
-    }
-    case '+': {
-      char next = get(state);
-      switch (next) {
-        case '+': {
-          // ++
-          tokenInit(state, token, TT_INC, NULL);
-          state->character += 2;
-          return;
-        }
-        case '=': {
-          // +=
-          tokenInit(state, token, TT_ADDASSIGN, NULL);
-          state->character += 2;
-          return;
-        }
-        default: {
-          if (next >= '0' && next <= '9') {
-            // number, return + and zero
-            put(state, 2);
-            lexNumber(entry, token);
-            return;
-          } else {
-            // just +
-            put(state, 1);
-            tokenInit(state, token, TT_PLUS, NULL);
-            state->character += 1;
-            return;
-          }
-        }
-      }
-    }
-    case '*': {
-      char next = get(state);
-      switch (next) {
-        case '=': {
-          // *=
-          tokenInit(state, token, TT_MULASSIGN, NULL);
-          state->character += 2;
-          return;
-        }
-        default: {
-          // just *
-          put(state, 1);
-          tokenInit(state, token, TT_STAR, NULL);
-          state->character += 1;
-          return;
-        }
-      }
-    }
-    case '&': {
-      char next1 = get(state);
-      switch (next1) {
-        case '&': {
-          // &&
-          char next2 = get(state);
-          switch (next2) {
-            case '=': {
-              // &&=
-              tokenInit(state, token, TT_LANDASSIGN, NULL);
-              state->character += 3;
-              return;
-            }
-            default: {
-              // just &&
-              put(state, 1);
-              tokenInit(state, token, TT_LAND, NULL);
-              state->character += 2;
-              return;
-            }
-          }
-        }
-        case '=': {
-          // &=
-          tokenInit(state, token, TT_BITANDASSIGN, NULL);
-          state->character += 2;
-          return;
-        }
-        default: {
-          // just &
-          put(state, 1);
-          tokenInit(state, token, TT_AMP, NULL);
-          state->character += 1;
-          return;
-        }
-      }
-    }
-    case '!': {
-      char next = get(state);
-      switch (next) {
-        case '=': {
-          // !=
-          tokenInit(state, token, TT_NEQ, NULL);
-          state->character += 2;
-          return;
-        }
-        default: {
-          // just !
-          put(state, 1);
-          tokenInit(state, token, TT_BANG, NULL);
-          state->character += 1;
-          return;
-        }
-      }
-    }
-    case '~': {
-      tokenInit(state, token, TT_TILDE, NULL);
-      state->character += 1;
+    case CC_CHAR: {
+      // char or wchar
+      ++state->current;
+      lexChar(entry, token);
       return;
     }
-    case '=': {
-      char next = get(state);
-      switch (next) {
-        case '=': {
-          // ==
-          tokenInit(state, token, TT_EQ, NULL);
-          state->character += 2;
-          return;
-        }
-        case '-': {
-          // =-
-          tokenInit(state, token, TT_NEGASSIGN, NULL);
-          state->character += 2;
-          return;
-        }
-        case '!': {
-          // =!
-          tokenInit(state, token, TT_LNOTASSIGN, NULL);
-          state->character += 2;
-          return;
-        }
-        case '~': {
-          // =~
-          tokenInit(state, token, TT_BITNOTASSIGN, NULL);
-          state->character += 2;
-          return;
-        }
-        default: {
-          // just =
-          put(state, 1);
-          tokenInit(state, token, TT_ASSIGN, NULL);
-          state->character += 1;
-          return;
-        }
-      }
-    }
-    case '/': {
-      // note - comments dealt with in whitespace
-      char next = get(state);
-      switch (next) {
-        case '=': {
-          // /=
-          tokenInit(state, token, TT_DIVASSIGN, NULL);
-          state->character += 2;
-          return;
-        }
-        default: {
-          // just /
-          put(state, 1);
-          tokenInit(state, token, TT_SLASH, NULL);
-          state->character += 1;
-          return;
-        }
-      }
-    }
-    case '%': {
-      char next = get(state);
-      switch (next) {
-        case '=': {
-          // %=
-          tokenInit(state, token, TT_MODASSIGN, NULL);
-          state->character += 2;
-          return;
-        }
-        default: {
-          // just %
-          put(state, 1);
-          tokenInit(state, token, TT_PERCENT, NULL);
-          state->character += 1;
-          return;
-        }
-      }
-    }
-    case '<': {
-      char next1 = get(state);
-      switch (next1) {
-        case '<': {
-          // <<
-          char next2 = get(state);
-          switch (next2) {
-            case '=': {
-              tokenInit(state, token, TT_LSHIFTASSIGN, NULL);
-              state->character += 3;
-              return;
-            }
-            default: {
-              // just <<
-              put(state, 1);
-              tokenInit(state, token, TT_LSHIFT, NULL);
-              state->character += 2;
-              return;
-            }
-          }
-        }
-        case '=': {
-          // <=
-          char next2 = get(state);
-          switch (next2) {
-            case '>': {
-              // <=>
-              tokenInit(state, token, TT_SPACESHIP, NULL);
-              state->character += 3;
-              return;
-            }
-            default: {
-              // just <=
-              put(state, 1);
-              tokenInit(state, token, TT_LTEQ, NULL);
-              state->character += 2;
-              return;
-            }
-          }
-        }
-        default: {
-          // just <
-          put(state, 1);
-          tokenInit(state, token, TT_LANGLE, NULL);
-          state->character += 1;
-          return;
-        }
-      }
-    }
-    case '>': {
-      char next1 = get(state);
-      switch (next1) {
-        case '>': {
-          // >>
-          char next2 = get(state);
-          switch (next2) {
-            case '>': {
-              // >>>
-              char next3 = get(state);
-              switch (next3) {
-                case '=': {
-                  // >>>=
-                  tokenInit(state, token, TT_LRSHIFTASSIGN, NULL);
-                  state->character += 4;
-                  return;
-                }
-                default: {
-                  // just >>>
-                  put(state, 1);
-                  tokenInit(state, token, TT_LRSHIFT, NULL);
-                  state->character += 3;
-                  return;
-                }
-              }
-            }
-            case '=': {
-              // >>=
-              tokenInit(state, token, TT_ARSHIFTASSIGN, NULL);
-              state->character += 3;
-              return;
-            }
-            default: {
-              // just >>
-              put(state, 1);
-              tokenInit(state, token, TT_ARSHIFT, NULL);
-              state->character += 2;
-              return;
-            }
-          }
-        }
-        case '=': {
-          // >=
-          tokenInit(state, token, TT_GTEQ, NULL);
-          state->character += 2;
-          return;
-        }
-        default: {
-          // just >
-          put(state, 1);
-          tokenInit(state, token, TT_RANGLE, NULL);
-          state->character += 1;
-          return;
-        }
-      }
-    }
-    case '|': {
-      char next1 = get(state);
-      switch (next1) {
-        case '|': {
-          // ||
-          char next2 = get(state);
-          switch (next2) {
-            case '=': {
-              // ||=
-              tokenInit(state, token, TT_LORASSIGN, NULL);
-              state->character += 3;
-              return;
-            }
-            default: {
-              // just ||
-              put(state, 1);
-              tokenInit(state, token, TT_LOR, NULL);
-              state->character += 2;
-              return;
-            }
-          }
-        }
-        case '=': {
-          // |=
-          tokenInit(state, token, TT_BITORASSIGN, NULL);
-          state->character += 2;
-          return;
-        }
-        default: {
-          // just |
-          put(state, 1);
-          tokenInit(state, token, TT_BAR, NULL);
-          state->character += 1;
-          return;
-        }
-      }
-    }
-    case '^': {
-      char next = get(state);
-      switch (next) {
-        case '=': {
-          // ^=
-          tokenInit(state, token, TT_BITXORASSIGN, NULL);
-          state->character += 2;
-          return;
-        }
-        default: {
-          // just ^
-          put(state, 1);
-          tokenInit(state, token, TT_CARET, NULL);
-          state->character += 1;
-          return;
-        }
-      }
-    }
-    case '?': {
-      tokenInit(state, token, TT_QUESTION, NULL);
+    case CC_OTHER: {
+      // error
+      char *prettyString = escapeChar((char)c);
+      fprintf(stderr, "%s:%zu:%zu: error: unexpected character: %s\n",
+              entry->inputFilename, state->line, state->character,
+              prettyString);
+      free(prettyString);
+      ++state->current;
       state->character += 1;
+      entry->errored = true;
+      // skip character and try again
+      lex(entry, token);
       return;
     }
-    case ':': {
-      char next = get(state);
-      switch (next) {
-        case ':': {
-          // ::
-          tokenInit(state, token, TT_SCOPE, NULL);
-          state->character += 2;
-          return;
-        }
-        default: {
-          // just :
-          put(state, 1);
-          tokenInit(state, token, TT_COLON, NULL);
-          state->character += 1;
-          return;
-        }
-      }
-    }
-
-    // everything else
-    default: {
-      if (c >= '0' && c <= '9') {
-        // number
-        put(state, 1);
-        lexNumber(entry, token);
-        return;
-      } else if (c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
-        // id, keyword, magic token
-        put(state, 1);
-        lexId(entry, token);
-        return;
-      } else if (c == '"') {
-        // string or wstring
-        lexString(entry, token);
-        return;
-      } else if (c == '\'') {
-        // char or wchar
-        lexChar(entry, token);
-        return;
-      } else {
-        // error
-        char *prettyString = escapeChar(c);
-        fprintf(stderr, "%s:%zu:%zu: error: unexpected character: %s\n",
-                entry->inputFilename, state->line, state->character,
-                prettyString);
-        free(prettyString);
-        state->character += 1;
-        entry->errored = true;
-        // skip character and try again
-        lex(entry, token);
-        return;
-      }
-    }
   }
 }
 
@@ -1518,6 +1224,7 @@ void unLex(FileListEntry *entry, Token const *token) {
 
 void lexerStateUninit(FileListEntry *entry) {
   LexerState *state = &entry->lexerState;
-  if (state->map != NULL) munmap((void *)state->map, state->length);
+  if (state->map != NULL && !state->shared)
+    munmap((void *)state->map, state->length);
   if (state->pushedBack) tokenUninit(&state->previous);
 }
\ No newline at end of file
@@ -78,6 +78,10 @@ typedef enum {
   TT_BOOL,
   TT_CONST,
   TT_VOLATILE,
+  TT_PURE,
+  TT_LIKELY,
+  TT_UNLIKELY,
+  TT_THREADLOCAL,
 
   // punctuation
   TT_SEMI,
@@ -180,8 +184,8 @@ typedef struct {
 void tokenUninit(Token *token);
 
 /**
- * Initializes keyword and magic token maps - must be called before any lexing
- * is done
+ * Initializes keyword and magic token maps, and the character class and
+ * punctuation tables - must be called before any lexing is done
  */
 void lexerInitMaps(void);
 
@@ -196,6 +200,7 @@ typedef struct {
   char *map;           /**< mmap of file */
   size_t length;       /**< length of file */
   char const *current; /**< character about to be read */
+  bool shared;         /**< is map part of a bundle's mapping? */
 
   size_t line;
   size_t character;
@@ -212,6 +217,17 @@ typedef struct {
  */
 int lexerStateInit(FileListEntry *entry);
 
+/**
+ * Initializes the internal lexer state for a file entry whose contents are
+ * already mapped, as part of a bundle
+ *
+ * @param entry entry to initialize
+ * @param contents contents of the file, not owned by the lexer state
+ * @param length length of the contents
+ */
+void lexerStateInitBundled(FileListEntry *entry, char *contents,
+                           size_t length);
+
 /**
  * lexes one token
  *
@@ -23,15 +23,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "ast/dump.h"
+#include "bundle.h"
 #include "fileList.h"
+#include "interpreter/interpreter.h"
 #include "lexer/dump.h"
 #include "lexer/lexer.h"
+#include "optimization/passManager.h"
+#include "optimization/remarks.h"
 #include "options.h"
 #include "parser/parser.h"
 #include "typechecker/typechecker.h"
 #include "util/internalError.h"
+#include "util/timeReport.h"
 #include "version.h"
 
 /**
@@ -65,6 +71,19 @@ static bool helpRequested(size_t argc, char **argv) {
   }
   return false;
 }
+/**
+ * finds the "--bundle" argument in argv
+ *
+ * @param argc number of arguments (including name of program)
+ * @param argv list of arguments (including name of program)
+ * @returns index of the "--bundle" argument, or zero if there isn't one
+ */
+static size_t bundleRequested(size_t argc, char **argv) {
+  for (size_t idx = 1; idx < argc; ++idx) {
+    if (strcmp(argv[idx], "--bundle") == 0) return idx;
+  }
+  return 0;
+}
 
 /** possible return values for main */
 enum {
@@ -73,6 +92,7 @@ enum {
   CODE_FILE_ERROR,
   CODE_PARSE_ERROR,
   CODE_TYPECHECK_ERROR,
+  CODE_RUN_ERROR,
 };
 
 // compile the given declaration and code files into one assembly file per code
@@ -87,9 +107,20 @@ int main(int argc, char **argv) {
         "Options:\n"
         "  --help, -h, -?    Display this information, and stop\n"
         "  --version         Display version information, and stop\n"
+        "  --bundle out.tdar file...\n"
+        "                    Bundle decl modules into one file, and stop\n"
         "  --arch=...        Set the target architecture\n"
+        "  -O...             Set the optimization level\n"
+        "  -f...             Configure code generation\n"
+        "  -mtune=...        Set the processor to schedule for\n"
         "  -W...=...         Configure warning options\n"
         "  --debug-dump=...  Configure debug information\n"
+        "  -print-before=..., -print-after=...\n"
+        "                    Dump the program around optimization passes\n"
+        "  --time-report     Report the time taken by each phase and pass\n"
+        "  --run             Run main in the interpreter instead of compiling\n"
+        "  -Rpass=..., -Rpass-missed=...\n"
+        "                    Report optimizations done or missed by passes\n"
         "\n"
         "Please report bugs at "
         "<https://github.com/JustinHuPrime/TCompiler/issues>\n");
@@ -106,11 +137,37 @@ int main(int argc, char **argv) {
     return CODE_SUCCESS;
   }
 
+  // bundle decl modules instead of compiling
+  size_t bundleIdx = bundleRequested((size_t)argc, argv);
+  if (bundleIdx != 0) {
+    if (bundleIdx + 1 == (size_t)argc) {
+      fprintf(stderr, "tlc: error: no bundle file given after '--bundle'\n");
+      return CODE_OPTION_ERROR;
+    }
+    return bundleWrite(argv[bundleIdx + 1], (size_t)argc - bundleIdx - 2,
+                       (char const *const *)argv + bundleIdx + 2) == 0
+               ? CODE_SUCCESS
+               : CODE_FILE_ERROR;
+  }
+
   // parse options, get number of files
   size_t numFiles;
   if (parseArgs((size_t)argc, (char const *const *)argv, &numFiles) != 0)
     return CODE_OPTION_ERROR;
 
+  // select optimization passes
+  PassPipeline pipeline;
+  if (passPipelineInit(&pipeline) != 0) {
+    passPipelineUninit(&pipeline);
+    return CODE_OPTION_ERROR;
+  }
+  if (remarksInit() != 0) {
+    passPipelineUninit(&pipeline);
+    return CODE_OPTION_ERROR;
+  }
+  TimeReport report;
+  timeReportInit(&report);
+
   // fill in global file list
   if (parseFiles((size_t)argc, (char const *const *)argv, numFiles) != 0)
     return CODE_FILE_ERROR;
@@ -126,7 +183,9 @@ int main(int argc, char **argv) {
   // front-end
 
   // parse
+  clock_t start = clock();
   if (parse() != 0) return CODE_PARSE_ERROR;
+  timeReportAddPhase(&report, "parse", start, clock());
 
   // debug-dump stop for parsing
   if (options.dump == OPTION_DD_PARSE) {
@@ -135,10 +194,16 @@ int main(int argc, char **argv) {
   }
 
   // typecheck
+  start = clock();
   if (typecheck() != 0) return CODE_TYPECHECK_ERROR;
+  timeReportAddPhase(&report, "typecheck", start, clock());
 
   // source code optimization
-  // TODO: write this
+  passPipelineRun(&pipeline,
+                  options.timeReport == OPTION_TR_REPORT ? &report : NULL);
+  passPipelineUninit(&pipeline);
+  if (remarksSave() != 0) return CODE_FILE_ERROR;
+  remarksUninit();
 
   // translate to IR
   // TODO: write this
@@ -166,5 +231,26 @@ int main(int argc, char **argv) {
   //   }
   // }
 
+  if (options.timeReport == OPTION_TR_REPORT) timeReportPrint(stderr, &report);
+  timeReportUninit(&report);
+
+  // interpret instead of compiling
+  if (options.run == OPTION_RUN_INTERPRET) {
+    Interpreter interpreter;
+    if (interpreterInit(&interpreter, stdin, stdout) != 0) {
+      interpreterUninit(&interpreter);
+      return CODE_RUN_ERROR;
+    }
+    // main gets argc and argv, but can't use argv, since the interpreter
+    // doesn't support pointers
+    Value args[2];
+    args[0].bits = 1;
+    args[1].bits = 0;
+    Value result;
+    int retval = interpreterCall(&interpreter, "main", args, 2, &result);
+    interpreterUninit(&interpreter);
+    return retval == 0 ? (int)(int64_t)result.bits : CODE_RUN_ERROR;
+  }
+
   return CODE_SUCCESS;
 }
\ No newline at end of file
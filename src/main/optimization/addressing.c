@@ -0,0 +1,185 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// symbol addressing implementation
+
+#include "optimization/addressing.h"
+
+#include "optimization/common.h"
+#include "util/format.h"
+#include "util/internalError.h"
+
+bool symbolIsModuleLocal(FileListEntry *file, SymbolTableEntry const *symbol) {
+  return symbol->file == file ||
+         symbol->file ==
+             fileListFindDeclName(file->ast->data.file.module->data.module.id);
+}
+
+/**
+ * is a symbol defined in the current module visible outside of it?
+ *
+ * @param file code file being compiled
+ * @param symbol symbol defined in the current module
+ */
+static bool symbolIsModuleExported(FileListEntry *file,
+                                   SymbolTableEntry const *symbol) {
+  if (!symbol->file->isCode) return true;
+
+  HashMap *stab = symbol->file->ast->data.file.stab;
+  for (size_t idx = 0; idx < stab->capacity; ++idx) {
+    if (stab->keys[idx] != NULL && stab->values[idx] == symbol)
+      return symbolIsExported(file, stab->keys[idx]);
+  }
+  return false;
+}
+
+DataAddressing dataAddressingOf(PositionDependenceOption positionDependence,
+                                FileListEntry *file,
+                                SymbolTableEntry const *symbol) {
+  switch (positionDependence) {
+    case OPTION_PD_PDC: {
+      return DA_ABSOLUTE;
+    }
+    case OPTION_PD_PIE: {
+      // nothing in an executable can be preempted
+      return DA_RIPRELATIVE;
+    }
+    case OPTION_PD_PIC: {
+      // exported data may be copied into the executable by a copy relocation,
+      // so even the module's own references have to go through the GOT
+      return symbolIsModuleLocal(file, symbol) &&
+                     !symbolIsModuleExported(file, symbol)
+                 ? DA_RIPRELATIVE
+                 : DA_GOT;
+    }
+    default: {
+      error(__FILE__, __LINE__,
+            "invalid PositionDependenceOption enum encountered");
+    }
+  }
+}
+
+TlsModel tlsModelOf(PositionDependenceOption positionDependence,
+                    TlsModelOption tlsModel, FileListEntry *file,
+                    SymbolTableEntry const *symbol) {
+  TlsModel model;
+  switch (positionDependence) {
+    case OPTION_PD_PDC:
+    case OPTION_PD_PIE: {
+      // the executable's own thread-locals are in its block, but another
+      // module's may be in a shared library, which local-exec can't reach
+      model = symbolIsModuleLocal(file, symbol) ? TLS_LOCAL_EXEC
+                                                : TLS_INITIAL_EXEC;
+      break;
+    }
+    case OPTION_PD_PIC: {
+      model = symbolIsModuleLocal(file, symbol) ? TLS_LOCAL_DYNAMIC
+                                                : TLS_GENERAL_DYNAMIC;
+      break;
+    }
+    default: {
+      error(__FILE__, __LINE__,
+            "invalid PositionDependenceOption enum encountered");
+    }
+  }
+
+  switch (tlsModel) {
+    case OPTION_TM_GLOBAL_DYNAMIC: {
+      return model;
+    }
+    case OPTION_TM_INITIAL_EXEC: {
+      return model > TLS_INITIAL_EXEC ? TLS_INITIAL_EXEC : model;
+    }
+    case OPTION_TM_LOCAL_EXEC: {
+      return TLS_LOCAL_EXEC;
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid TlsModelOption enum encountered");
+    }
+  }
+}
+
+CallTarget callTargetOf(PositionDependenceOption positionDependence,
+                        FileListEntry *file, SymbolTableEntry const *symbol) {
+  return positionDependence == OPTION_PD_PIC &&
+                 !symbolIsModuleLocal(file, symbol)
+             ? CT_PLT
+             : CT_DIRECT;
+}
+
+SymbolBinding symbolBindingOf(PositionDependenceOption positionDependence,
+                              FileListEntry *file, char const *name) {
+  if (!symbolIsExported(file, name))
+    return SB_LOCAL;
+  else if (positionDependence == OPTION_PD_PIC)
+    return SB_PROTECTED;
+  else
+    return SB_GLOBAL;
+}
+
+char *dataAddressOperand(DataAddressing addressing, char const *label) {
+  switch (addressing) {
+    case DA_ABSOLUTE: {
+      return format("%s", label);
+    }
+    case DA_RIPRELATIVE: {
+      return format("%s(%%rip)", label);
+    }
+    case DA_GOT: {
+      return format("%s@GOTPCREL(%%rip)", label);
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid DataAddressing enum encountered");
+    }
+  }
+}
+
+char *tlsAddressOperand(TlsModel model, char const *label) {
+  switch (model) {
+    case TLS_LOCAL_EXEC: {
+      return format("%%fs:%s@tpoff", label);
+    }
+    case TLS_INITIAL_EXEC: {
+      return format("%s@gottpoff(%%rip)", label);
+    }
+    case TLS_LOCAL_DYNAMIC: {
+      return format("%s@dtpoff", label);
+    }
+    case TLS_GENERAL_DYNAMIC: {
+      return format("%s@tlsgd(%%rip)", label);
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid TlsModel enum encountered");
+    }
+  }
+}
+
+char *callTargetOperand(CallTarget target, char const *label) {
+  switch (target) {
+    case CT_DIRECT: {
+      return format("%s", label);
+    }
+    case CT_PLT: {
+      return format("%s@PLT", label);
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid CallTarget enum encountered");
+    }
+  }
+}
@@ -0,0 +1,161 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * symbol addressing - decides how symbols are referenced under each position
+ * dependence option
+ *
+ * in position independent code, only functions from other modules go through
+ * the PLT, and only variables that are exported or from other modules go
+ * through the GOT - an executable linked against the module may have moved an
+ * exported variable into itself with a copy relocation
+ *
+ * thread-local variables likewise use the cheapest access model the kind of
+ * output allows - a call to __tls_get_addr is only made in position independent
+ * code, and only once per function for thread-locals from the current module
+ */
+
+#ifndef TLC_OPTIMIZATION_ADDRESSING_H_
+#define TLC_OPTIMIZATION_ADDRESSING_H_
+
+#include <stdbool.h>
+
+#include "ast/symbolTable.h"
+#include "fileList.h"
+#include "options.h"
+
+/** how the address of a data symbol is formed */
+typedef enum {
+  DA_ABSOLUTE,    /**< absolute address - sym */
+  DA_RIPRELATIVE, /**< relative to the instruction pointer - sym(%rip) */
+  DA_GOT, /**< loaded from the global offset table - sym@GOTPCREL(%rip) */
+} DataAddressing;
+
+/** how the address of a thread-local variable is formed, cheapest first */
+typedef enum {
+  TLS_LOCAL_EXEC,      /**< constant offset from the thread pointer */
+  TLS_INITIAL_EXEC,    /**< offset from the thread pointer, loaded from the
+                          GOT */
+  TLS_LOCAL_DYNAMIC,   /**< offset from the current module's block, which is
+                          found with one call to __tls_get_addr per function */
+  TLS_GENERAL_DYNAMIC, /**< found with a call to __tls_get_addr per access */
+} TlsModel;
+
+/** how a function is called */
+typedef enum {
+  CT_DIRECT, /**< call sym */
+  CT_PLT,    /**< call through the procedure linkage table - call sym@PLT */
+} CallTarget;
+
+/** how a symbol defined in the current module is bound */
+typedef enum {
+  SB_LOCAL,     /**< module-private - not visible to the linker */
+  SB_GLOBAL,    /**< exported - .globl */
+  SB_PROTECTED, /**< exported, but can't be preempted - .globl and .protected */
+} SymbolBinding;
+
+/**
+ * is a symbol defined in the same module as a file?
+ *
+ * @param file code file being compiled
+ * @param symbol symbol referenced from the file
+ */
+bool symbolIsModuleLocal(FileListEntry *file, SymbolTableEntry const *symbol);
+
+/**
+ * decides how to address a data symbol
+ *
+ * @param positionDependence position dependence of the generated code
+ * @param file code file being compiled
+ * @param symbol variable referenced from the file
+ */
+DataAddressing dataAddressingOf(PositionDependenceOption positionDependence,
+                                FileListEntry *file,
+                                SymbolTableEntry const *symbol);
+
+/**
+ * decides how to access a thread-local variable
+ *
+ * @param positionDependence position dependence of the generated code
+ * @param tlsModel most general model the generated code may use
+ * @param file code file being compiled
+ * @param symbol thread-local variable referenced from the file
+ */
+TlsModel tlsModelOf(PositionDependenceOption positionDependence,
+                    TlsModelOption tlsModel, FileListEntry *file,
+                    SymbolTableEntry const *symbol);
+
+/**
+ * decides how to call a function
+ *
+ * @param positionDependence position dependence of the generated code
+ * @param file code file being compiled
+ * @param symbol function called from the file
+ */
+CallTarget callTargetOf(PositionDependenceOption positionDependence,
+                        FileListEntry *file, SymbolTableEntry const *symbol);
+
+/**
+ * decides how to bind a symbol defined in a file
+ *
+ * exported symbols are protected in position independent code, so calls from
+ * within the module never need to go through the PLT
+ *
+ * @param positionDependence position dependence of the generated code
+ * @param file code file being compiled
+ * @param name name of a symbol defined in the file
+ */
+SymbolBinding symbolBindingOf(PositionDependenceOption positionDependence,
+                              FileListEntry *file, char const *name);
+
+/**
+ * formats the memory operand for a data symbol
+ *
+ * @param addressing how the symbol is addressed
+ * @param label assembly label of the symbol
+ * @returns operand (caller owns the memory) - for DA_GOT, the operand is the
+ * GOT entry, and the address of the symbol must first be loaded from it
+ */
+char *dataAddressOperand(DataAddressing addressing, char const *label);
+
+/**
+ * formats the operand for a thread-local variable
+ *
+ * @param model how the variable is accessed
+ * @param label assembly label of the variable
+ * @returns operand (caller owns the memory) - only for TLS_LOCAL_EXEC is the
+ * operand the variable itself. For TLS_INITIAL_EXEC, the operand is the GOT
+ * entry holding the variable's offset from %fs. For TLS_LOCAL_DYNAMIC, it is
+ * the offset to add to the module's block, from `leaq label@tlsld(%rip), %rdi`
+ * and `call __tls_get_addr@PLT`. For TLS_GENERAL_DYNAMIC, it is the argument to
+ * pass to __tls_get_addr in %rdi, which returns the variable's address
+ */
+char *tlsAddressOperand(TlsModel model, char const *label);
+
+/**
+ * formats the operand for a call
+ *
+ * @param target how the function is called
+ * @param label assembly label of the function
+ * @returns operand (caller owns the memory)
+ */
+char *callTargetOperand(CallTarget target, char const *label);
+
+#endif  // TLC_OPTIMIZATION_ADDRESSING_H_
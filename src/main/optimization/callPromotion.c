@@ -0,0 +1,410 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// indirect call promotion implementation
+
+#include "optimization/callPromotion.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "fileList.h"
+#include "optimization/common.h"
+#include "util/functional.h"
+
+uint64_t const PROFILED_TARGET_MIN_REMAINING_PERCENT = 50;
+uint64_t const PROFILED_TARGET_MIN_TOTAL_PERCENT = 5;
+
+/** the functions a function pointer variable may hold */
+typedef struct {
+  SymbolTableEntry *variable; /**< SK_VARIABLE stab entry */
+  bool unknown;     /**< has something other than a function been stored? */
+  Vector functions; /**< vector of SymbolTableEntry, functions stored */
+} VariableTargets;
+
+/**
+ * creates a VariableTargets with nothing stored
+ *
+ * @param variable variable to track
+ */
+static VariableTargets *variableTargetsCreate(SymbolTableEntry *variable) {
+  VariableTargets *targets = malloc(sizeof(VariableTargets));
+  targets->variable = variable;
+  targets->unknown = false;
+  vectorInit(&targets->functions);
+  return targets;
+}
+
+/**
+ * deinitializes and frees a VariableTargets
+ *
+ * @param targets VariableTargets to free
+ */
+static void variableTargetsFree(VariableTargets *targets) {
+  vectorUninit(&targets->functions, nullDtor);
+  free(targets);
+}
+
+/**
+ * gets the entry an id or scoped id references
+ *
+ * @param exp expression, may be parenthesized
+ * @returns nullable stab entry
+ */
+static SymbolTableEntry *entryOf(Node *exp) {
+  exp = stripParens(exp);
+  switch (exp->type) {
+    case NT_ID: {
+      return exp->data.id.entry;
+    }
+    case NT_SCOPEDID: {
+      return exp->data.scopedId.entry;
+    }
+    default: {
+      return NULL;
+    }
+  }
+}
+
+/**
+ * finds the tracked stores to a variable
+ *
+ * @param targets CallTargets to search
+ * @param variable nullable stab entry
+ * @returns tracking record, or NULL if the variable isn't tracked
+ */
+static VariableTargets *variableTargetsOf(CallTargets const *targets,
+                                          SymbolTableEntry const *variable) {
+  return variable == NULL ? NULL
+                          : pointerMapGet(&targets->variables, variable);
+}
+/**
+ * starts tracking the stores to a variable
+ *
+ * @param targets CallTargets to update
+ * @param variable SK_VARIABLE stab entry
+ */
+static void trackVariable(CallTargets *targets, SymbolTableEntry *variable) {
+  VariableTargets *variableTargets = variableTargetsCreate(variable);
+  if (pointerMapPut(&targets->variables, variable, variableTargets) != 0)
+    variableTargetsFree(variableTargets);
+}
+
+/**
+ * records a store to a variable
+ *
+ * @param targets CallTargets to update
+ * @param variable nullable stab entry of the variable stored to
+ * @param value value stored, or NULL if unknown
+ */
+static void recordStore(CallTargets *targets, SymbolTableEntry const *variable,
+                        Node *value) {
+  VariableTargets *variableTargets = variableTargetsOf(targets, variable);
+  if (variableTargets == NULL) return;
+
+  if (value != NULL) {
+    value = stripParens(value);
+    if (value->type == NT_LITERAL && value->data.literal.literalType == LT_NULL)
+      return;  // calling null is undefined
+
+    SymbolTableEntry *function = entryOf(value);
+    if (function != NULL && function->kind == SK_FUNCTION) {
+      // past MAX_PROMOTED_TARGETS, the variable can't be promoted anyway, so
+      // the vector stays short
+      Vector *functions = &variableTargets->functions;
+      if (functions->size <= MAX_PROMOTED_TARGETS &&
+          !vectorContains(functions, function))
+        vectorInsert(functions, function);
+      return;
+    }
+  }
+  variableTargets->unknown = true;
+}
+
+/**
+ * finds functions whose address is taken, and stores to tracked variables
+ *
+ * @param node node being visited
+ * @param data CallTargets
+ */
+static bool findTargets(Node *node, void *data) {
+  CallTargets *targets = data;
+  switch (node->type) {
+    case NT_FUNCALLEXP: {
+      if (directCallee(node) == NULL) return true;
+
+      // direct call - only the arguments can take an address
+      Vector *arguments = node->data.funCallExp.arguments;
+      for (size_t idx = 0; idx < arguments->size; ++idx)
+        nodeVisit(arguments->elements[idx], findTargets, data);
+      return false;
+    }
+    case NT_ID:
+    case NT_SCOPEDID: {
+      SymbolTableEntry *entry = entryOf(node);
+      if (entry != NULL && entry->kind == SK_FUNCTION &&
+          pointerSetPut(&targets->addressTakenSet, entry) == 0)
+        vectorInsert(&targets->addressTaken, entry);
+      return false;
+    }
+    case NT_VARDEFNSTMT: {
+      Vector *names = node->data.varDefnStmt.names;
+      Vector *initializers = node->data.varDefnStmt.initializers;
+      for (size_t idx = 0; idx < names->size; ++idx) {
+        SymbolTableEntry *variable = entryOf(names->elements[idx]);
+        if (stripType(variable->data.variable.type)->kind != TK_FUNPTR)
+          continue;
+        trackVariable(targets, variable);
+        if (initializers->elements[idx] != NULL)
+          recordStore(targets, variable, initializers->elements[idx]);
+      }
+      return true;
+    }
+    case NT_BINOPEXP: {
+      if (node->data.binOpExp.op == BO_ASSIGN)
+        recordStore(targets, entryOf(node->data.binOpExp.lhs),
+                    node->data.binOpExp.rhs);
+      return true;
+    }
+    case NT_UNOPEXP: {
+      // a variable whose address is taken can be written through a pointer
+      if (node->data.unOpExp.op == UO_ADDROF)
+        recordStore(targets, entryOf(node->data.unOpExp.target), NULL);
+      return true;
+    }
+    default: {
+      return true;
+    }
+  }
+}
+
+void callTargetsInit(CallTargets *targets) {
+  vectorInit(&targets->addressTaken);
+  pointerSetInit(&targets->addressTakenSet);
+  pointerMapInit(&targets->variables);
+
+  // globals other modules can't store to
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    FileListEntry *file = &fileList.entries[fileIdx];
+    if (!file->isCode) continue;
+
+    Vector *bodies = file->ast->data.file.bodies;
+    for (size_t idx = 0; idx < bodies->size; ++idx) {
+      Node *body = bodies->elements[idx];
+      if (body->type != NT_VARDEFN) continue;
+
+      Vector *names = body->data.varDefn.names;
+      for (size_t nameIdx = 0; nameIdx < names->size; ++nameIdx) {
+        Node *name = names->elements[nameIdx];
+        SymbolTableEntry *variable = name->data.id.entry;
+        if (stripType(variable->data.variable.type)->kind == TK_FUNPTR &&
+            !symbolIsExported(file, name->data.id.id))
+          trackVariable(targets, variable);
+      }
+    }
+  }
+
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    FileListEntry *file = &fileList.entries[fileIdx];
+    if (!file->isCode) continue;
+
+    Vector *bodies = file->ast->data.file.bodies;
+    for (size_t idx = 0; idx < bodies->size; ++idx) {
+      Node *body = bodies->elements[idx];
+      if (body->type == NT_FUNDEFN)
+        nodeVisit(body->data.funDefn.body, findTargets, targets);
+    }
+  }
+}
+
+/**
+ * gets the static type of the function pointer a call calls through
+ *
+ * @param exp callee expression
+ * @returns type, or NULL if unknown
+ */
+static Type const *calleeType(Node *exp) {
+  exp = stripParens(exp);
+  switch (exp->type) {
+    case NT_ID:
+    case NT_SCOPEDID: {
+      SymbolTableEntry *entry = entryOf(exp);
+      return entry != NULL && entry->kind == SK_VARIABLE
+                 ? entry->data.variable.type
+                 : NULL;
+    }
+    case NT_BINOPEXP: {
+      switch (exp->data.binOpExp.op) {
+        case BO_ARRAY: {
+          // element of a dispatch table
+          Type const *table = calleeType(exp->data.binOpExp.lhs);
+          if (table == NULL) return NULL;
+          table = stripType(table);
+          switch (table->kind) {
+            case TK_ARRAY: {
+              return table->data.array.type;
+            }
+            case TK_POINTER: {
+              return table->data.pointer.base;
+            }
+            default: {
+              return NULL;
+            }
+          }
+        }
+        case BO_FIELD:
+        case BO_PTRFIELD: {
+          Type const *aggregate = calleeType(exp->data.binOpExp.lhs);
+          if (aggregate == NULL) return NULL;
+          aggregate = stripType(aggregate);
+          if (exp->data.binOpExp.op == BO_PTRFIELD) {
+            if (aggregate->kind != TK_POINTER) return NULL;
+            aggregate = stripType(aggregate->data.pointer.base);
+          }
+          if (aggregate->kind != TK_REFERENCE ||
+              aggregate->data.reference.entry->kind != SK_STRUCT)
+            return NULL;
+          return structLookupField(aggregate->data.reference.entry,
+                                   exp->data.binOpExp.rhs->data.id.id);
+        }
+        default: {
+          return NULL;
+        }
+      }
+    }
+    case NT_UNOPEXP: {
+      if (exp->data.unOpExp.op != UO_DEREF) return NULL;
+      Type const *pointer = calleeType(exp->data.unOpExp.target);
+      if (pointer == NULL) return NULL;
+      pointer = stripType(pointer);
+      return pointer->kind == TK_POINTER ? pointer->data.pointer.base : NULL;
+    }
+    default: {
+      return NULL;
+    }
+  }
+}
+
+/**
+ * can a function be called through a function pointer type?
+ *
+ * @param function SK_FUNCTION stab entry
+ * @param funPtr TK_FUNPTR type
+ */
+static bool functionMatches(SymbolTableEntry const *function,
+                            Type const *funPtr) {
+  Vector const *argumentTypes = &function->data.function.argumentTypes;
+  Vector const *pointerArgumentTypes = &funPtr->data.funPtr.argTypes;
+  if (function->data.function.returnType == NULL ||
+      !typeEqual(function->data.function.returnType,
+                 funPtr->data.funPtr.returnType) ||
+      argumentTypes->size != pointerArgumentTypes->size)
+    return false;
+
+  for (size_t idx = 0; idx < argumentTypes->size; ++idx) {
+    if (!typeEqual(argumentTypes->elements[idx],
+                   pointerArgumentTypes->elements[idx]))
+      return false;
+  }
+  return true;
+}
+
+void callPromotionPlan(CallTargets const *targets, Node *call,
+                       CallPromotion *promotion) {
+  promotion->kind = CPK_NONE;
+  promotion->numTargets = 0;
+
+  if (directCallee(call) != NULL) return;
+  Node *function = call->data.funCallExp.function;
+
+  // a variable with only visible stores can only hold what was stored
+  VariableTargets const *variableTargets =
+      variableTargetsOf(targets, entryOf(function));
+  if (variableTargets != NULL && !variableTargets->unknown) {
+    Vector const *functions = &variableTargets->functions;
+    if (functions->size == 0 || functions->size > MAX_PROMOTED_TARGETS) return;
+
+    promotion->kind = CPK_EXHAUSTIVE;
+    promotion->numTargets = functions->size;
+    for (size_t idx = 0; idx < functions->size; ++idx)
+      promotion->targets[idx] = functions->elements[idx];
+    return;
+  }
+
+  // otherwise, any function of the right type with its address taken
+  Type const *type = calleeType(function);
+  if (type == NULL) return;
+  type = stripType(type);
+  if (type->kind != TK_FUNPTR) return;
+
+  size_t numTargets = 0;
+  for (size_t idx = 0; idx < targets->addressTaken.size; ++idx) {
+    SymbolTableEntry *candidate = targets->addressTaken.elements[idx];
+    if (!functionMatches(candidate, type)) continue;
+    if (numTargets == MAX_PROMOTED_TARGETS) return;
+    promotion->targets[numTargets++] = candidate;
+  }
+  if (numTargets == 0) return;
+
+  // code outside the file list could pass in another function
+  promotion->kind = CPK_GUARDED;
+  promotion->numTargets = numTargets;
+}
+
+void callPromotionFromProfile(SymbolTableEntry *const *targets,
+                              uint64_t const *counts, size_t numTargets,
+                              CallPromotion *promotion) {
+  promotion->kind = CPK_NONE;
+  promotion->numTargets = 0;
+
+  uint64_t total = 0;
+  for (size_t idx = 0; idx < numTargets; ++idx) total += counts[idx];
+  uint64_t remaining = total;
+
+  bool *promoted = calloc(numTargets, sizeof(bool));
+  while (promotion->numTargets < MAX_PROMOTED_TARGETS && remaining != 0) {
+    size_t best = numTargets;
+    for (size_t idx = 0; idx < numTargets; ++idx) {
+      if (!promoted[idx] && (best == numTargets || counts[idx] > counts[best]))
+        best = idx;
+    }
+    if (best == numTargets) break;
+    uint64_t percent = counts[best] * 100;
+    if (percent < remaining * PROFILED_TARGET_MIN_REMAINING_PERCENT ||
+        percent < total * PROFILED_TARGET_MIN_TOTAL_PERCENT)
+      break;
+
+    promoted[best] = true;
+    promotion->targets[promotion->numTargets++] = targets[best];
+    remaining -= counts[best];
+  }
+  free(promoted);
+
+  if (promotion->numTargets != 0) promotion->kind = CPK_GUARDED;
+}
+
+void callTargetsUninit(CallTargets *targets) {
+  vectorUninit(&targets->addressTaken, nullDtor);
+  pointerSetUninit(&targets->addressTakenSet);
+  for (size_t idx = 0; idx < targets->variables.capacity; ++idx) {
+    if (targets->variables.keys[idx] != NULL)
+      variableTargetsFree(targets->variables.values[idx]);
+  }
+  pointerMapUninit(&targets->variables);
+}
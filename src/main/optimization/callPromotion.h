@@ -0,0 +1,135 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * indirect call promotion
+ *
+ * a call through a function pointer that can only reach a few functions is
+ * turned into comparisons of the pointer against each function, guarding
+ * direct calls. Direct calls are predicted perfectly and can be inlined
+ */
+
+#ifndef TLC_OPTIMIZATION_CALLPROMOTION_H_
+#define TLC_OPTIMIZATION_CALLPROMOTION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ast/ast.h"
+#include "ast/symbolTable.h"
+#include "util/container/pointerMap.h"
+#include "util/container/pointerSet.h"
+#include "util/container/vector.h"
+
+/** how an indirect call should be lowered */
+typedef enum {
+  CPK_NONE,       /**< keep the call as it is */
+  CPK_GUARDED,    /**< compare against each target, falling back to the
+                     indirect call */
+  CPK_EXHAUSTIVE, /**< the targets are the only possible callees - compare
+                     against all but the last target, which needs no guard,
+                     and drop the indirect call */
+} CallPromotionKind;
+
+enum {
+  MAX_PROMOTED_TARGETS = 3, /**< maximum number of direct calls a promoted
+                               call becomes - each costs a compare and a
+                               branch */
+};
+
+/** a call and how it should be lowered */
+typedef struct {
+  CallPromotionKind kind;
+  size_t numTargets;
+  SymbolTableEntry *targets[MAX_PROMOTED_TARGETS]; /**< functions to call
+                                                      directly, most likely
+                                                      first. Non-owning */
+} CallPromotion;
+
+/**
+ * minimum share, in percent, of the calls not handled by already promoted
+ * targets a profiled target must account for to be promoted
+ */
+extern uint64_t const PROFILED_TARGET_MIN_REMAINING_PERCENT;
+/**
+ * minimum share, in percent, of all calls a profiled target must account for
+ * to be promoted
+ */
+extern uint64_t const PROFILED_TARGET_MIN_TOTAL_PERCENT;
+
+/** the functions function pointers in the file list may point to */
+typedef struct {
+  Vector addressTaken;        /**< vector of SymbolTableEntry, functions used
+                                 other than by calling them, in the order
+                                 found */
+  PointerSet addressTakenSet; /**< set of the same functions */
+  PointerMap variables;       /**< map from the SymbolTableEntry of a
+                                 function pointer variable whose stores are
+                                 all visible to its VariableTargets
+                                 (private) */
+} CallTargets;
+
+/**
+ * finds the possible targets of function pointers in the global file list
+ *
+ * @param targets CallTargets to initialize
+ */
+void callTargetsInit(CallTargets *targets);
+
+/**
+ * decides how a call should be lowered
+ *
+ * a call through a variable that is only ever assigned a few functions is
+ * promoted exhaustively. The variable must be a local, or a global that isn't
+ * exported and never has its address taken. Otherwise, if the type of the
+ * function pointer is known, the call is guarded against every function of
+ * that type whose address is taken, if there are few enough of them
+ *
+ * @param targets possible targets in the file list
+ * @param call NT_FUNCALLEXP node
+ * @param promotion output pointer to the decision
+ */
+void callPromotionPlan(CallTargets const *targets, Node *call,
+                       CallPromotion *promotion);
+
+/**
+ * decides how a call should be lowered given the targets it was observed
+ * calling
+ *
+ * targets are promoted in order of decreasing count, as long as each accounts
+ * for enough of the remaining calls and of all calls
+ *
+ * @param targets functions observed as targets
+ * @param counts number of calls to each target
+ * @param numTargets length of targets and counts
+ * @param promotion output pointer to the decision
+ */
+void callPromotionFromProfile(SymbolTableEntry *const *targets,
+                              uint64_t const *counts, size_t numTargets,
+                              CallPromotion *promotion);
+
+/**
+ * deinitializes a CallTargets
+ *
+ * @param targets CallTargets to deinitialize
+ */
+void callTargetsUninit(CallTargets *targets);
+
+#endif  // TLC_OPTIMIZATION_CALLPROMOTION_H_
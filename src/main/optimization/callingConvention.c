@@ -0,0 +1,225 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// calling convention implementation
+
+#include "optimization/callingConvention.h"
+
+#include "ast/symbolTable.h"
+#include "optimization/common.h"
+#include "optimization/memoryOps.h"
+#include "util/internalError.h"
+
+/** System V integer argument registers */
+static Register const SYSV_INTEGER_ARGS[] = {
+    REG_RDI, REG_RSI, REG_RDX, REG_RCX, REG_R8, REG_R9,
+};
+/** internal integer argument registers - the scratch registers are added */
+static Register const INTERNAL_INTEGER_ARGS[] = {
+    REG_RDI, REG_RSI, REG_RDX, REG_RCX, REG_R8, REG_R9, REG_R10, REG_R11,
+};
+enum {
+  NUM_SYSV_SSE_ARGS = 8,      /**< xmm0 to xmm7 */
+  NUM_INTERNAL_SSE_ARGS = 16, /**< every xmm register */
+};
+
+/** registers preserved across a System V call */
+static RegisterSet const SYSV_CALLEE_SAVED =
+    1U << REG_RBX | 1U << REG_RBP | 1U << REG_RSP | 1U << REG_R12 |
+    1U << REG_R13 | 1U << REG_R14 | 1U << REG_R15;
+
+/** how an argument is passed */
+typedef enum {
+  AC_INTEGER,
+  AC_SSE,
+  AC_MEMORY,
+} ArgumentClass;
+
+/**
+ * classifies a type for argument passing
+ *
+ * @param type type to classify
+ */
+static ArgumentClass classify(Type const *type) {
+  switch (type->kind) {
+    case TK_KEYWORD: {
+      switch (type->data.keyword.keyword) {
+        case TK_FLOAT:
+        case TK_DOUBLE: {
+          return AC_SSE;
+        }
+        default: {
+          return AC_INTEGER;
+        }
+      }
+    }
+    case TK_QUALIFIED: {
+      return classify(type->data.qualified.base);
+    }
+    case TK_POINTER:
+    case TK_FUNPTR: {
+      return AC_INTEGER;
+    }
+    case TK_REFERENCE: {
+      SymbolTableEntry const *entry = type->data.reference.entry;
+      switch (entry->kind) {
+        case SK_ENUM: {
+          return AC_INTEGER;
+        }
+        case SK_TYPEDEF: {
+          return classify(entry->data.typedefType.actual);
+        }
+        default: {
+          // structs and unions are passed on the stack
+          return AC_MEMORY;
+        }
+      }
+    }
+    default: {
+      return AC_MEMORY;
+    }
+  }
+}
+
+/** data for the address taken search */
+typedef struct {
+  SymbolTableEntry *function; /**< function to look for */
+  bool found;                 /**< was the address of the function taken */
+} AddressTakenSearch;
+/**
+ * looks for uses of a function other than calling it
+ */
+static bool findAddressTaken(Node *node, void *data) {
+  AddressTakenSearch *search = data;
+  if (search->found) return false;
+
+  if (node->type == NT_FUNCALLEXP && directCallee(node) != NULL) {
+    // direct call - only the arguments can take an address
+    Vector *arguments = node->data.funCallExp.arguments;
+    for (size_t idx = 0; idx < arguments->size; ++idx)
+      nodeVisit(arguments->elements[idx], findAddressTaken, data);
+    return false;
+  } else if ((node->type == NT_ID &&
+              node->data.id.entry == search->function) ||
+             (node->type == NT_SCOPEDID &&
+              node->data.scopedId.entry == search->function)) {
+    search->found = true;
+    return false;
+  } else {
+    return true;
+  }
+}
+
+CallingConvention callingConventionOf(FileListEntry *file, Node *function) {
+  if (!file->isCode || function->type != NT_FUNDEFN) return CC_SYSV;
+
+  Node *name = function->data.funDefn.name;
+  if (symbolIsExported(file, name->data.id.id)) return CC_SYSV;
+
+  AddressTakenSearch search = {name->data.id.entry, false};
+  Vector *bodies = file->ast->data.file.bodies;
+  for (size_t idx = 0; idx < bodies->size && !search.found; ++idx) {
+    Node *body = bodies->elements[idx];
+    if (body->type == NT_FUNDEFN)
+      nodeVisit(body->data.funDefn.body, findAddressTaken, &search);
+  }
+  return search.found ? CC_SYSV : CC_INTERNAL;
+}
+
+size_t callingConventionAssignArguments(CallingConvention convention,
+                                        Vector const *argumentTypes,
+                                        ArgumentLocation *locations) {
+  Register const *integerArgs;
+  size_t numIntegerArgs;
+  size_t numSseArgs;
+  switch (convention) {
+    case CC_SYSV: {
+      integerArgs = SYSV_INTEGER_ARGS;
+      numIntegerArgs = sizeof(SYSV_INTEGER_ARGS) / sizeof(Register);
+      numSseArgs = NUM_SYSV_SSE_ARGS;
+      break;
+    }
+    case CC_INTERNAL: {
+      integerArgs = INTERNAL_INTEGER_ARGS;
+      numIntegerArgs = sizeof(INTERNAL_INTEGER_ARGS) / sizeof(Register);
+      numSseArgs = NUM_INTERNAL_SSE_ARGS;
+      break;
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid CallingConvention enum encountered");
+    }
+  }
+
+  size_t integerIdx = 0;
+  size_t sseIdx = 0;
+  size_t stackIdx = 0;
+  for (size_t idx = 0; idx < argumentTypes->size; ++idx) {
+    ArgumentLocation *location = &locations[idx];
+    location->reg = REG_NONE;
+    location->stackIndex = 0;
+    switch (classify(argumentTypes->elements[idx])) {
+      case AC_INTEGER: {
+        if (integerIdx < numIntegerArgs)
+          location->reg = integerArgs[integerIdx++];
+        break;
+      }
+      case AC_SSE: {
+        if (sseIdx < numSseArgs) location->reg = REG_XMM0 + sseIdx++;
+        break;
+      }
+      case AC_MEMORY: {
+        break;
+      }
+      default: {
+        error(__FILE__, __LINE__, "invalid ArgumentClass enum encountered");
+      }
+    }
+    if (location->reg == REG_NONE) location->stackIndex = stackIdx++;
+  }
+  return stackIdx;
+}
+
+RegisterSet callingConventionPreserved(CallingConvention convention,
+                                       RegisterSet calleeClobbers) {
+  switch (convention) {
+    case CC_SYSV: {
+      return SYSV_CALLEE_SAVED;
+    }
+    case CC_INTERNAL: {
+      // anything the callee doesn't touch survives, and the stack pointer is
+      // always restored
+      return ~calleeClobbers | 1U << REG_RSP;
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid CallingConvention enum encountered");
+    }
+  }
+}
+
+bool callingConventionNeedsAlignment(CallingConvention convention,
+                                     bool calleeIsLeaf) {
+  // a leaf internal function never calls anything that expects alignment, and
+  // is generated using unaligned SSE moves
+  return convention == CC_SYSV || !calleeIsLeaf;
+}
+
+bool functionIsLeaf(Node *function) {
+  Node *body = function->data.funDefn.body;
+  return !nodeContainsCall(body) && !nodeContainsMemoryCall(body);
+}
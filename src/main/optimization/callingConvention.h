@@ -0,0 +1,137 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * calling conventions
+ *
+ * functions defined in a code module but not declared in its declaration
+ * module can only be called from within the module, so they use a faster
+ * internal calling convention instead of System V, unless their address is
+ * taken
+ */
+
+#ifndef TLC_OPTIMIZATION_CALLINGCONVENTION_H_
+#define TLC_OPTIMIZATION_CALLINGCONVENTION_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ast/ast.h"
+#include "fileList.h"
+
+/** a calling convention */
+typedef enum {
+  CC_SYSV,     /**< System V AMD64 ABI - used for anything visible outside the
+                  module */
+  CC_INTERNAL, /**< module-private - more argument registers, and
+                  caller-saved registers tuned by callee register usage */
+} CallingConvention;
+
+/** an x86_64 register */
+typedef enum {
+  REG_RAX,
+  REG_RBX,
+  REG_RCX,
+  REG_RDX,
+  REG_RSI,
+  REG_RDI,
+  REG_RBP,
+  REG_RSP,
+  REG_R8,
+  REG_R9,
+  REG_R10,
+  REG_R11,
+  REG_R12,
+  REG_R13,
+  REG_R14,
+  REG_R15,
+  REG_XMM0,
+  REG_XMM15 = REG_XMM0 + 15,
+  REG_NONE, /**< passed on the stack */
+} Register;
+
+/** a set of registers, one bit per register */
+typedef uint32_t RegisterSet;
+
+/** where an argument or return value is passed */
+typedef struct {
+  Register reg;      /**< register, or REG_NONE if passed on the stack */
+  size_t stackIndex; /**< index among the stack arguments, if on the stack */
+} ArgumentLocation;
+
+/**
+ * decides which calling convention a function uses
+ *
+ * @param file code or declaration file the function is defined or declared in
+ * @param function NT_FUNDEFN or NT_FUNDECL node
+ * @returns CC_INTERNAL if the function is defined in a code module, isn't
+ * declared in the matching declaration module, and never has its address
+ * taken, or CC_SYSV otherwise
+ */
+CallingConvention callingConventionOf(FileListEntry *file, Node *function);
+
+/**
+ * assigns arguments to registers and stack slots
+ *
+ * integral and pointer arguments go in general purpose registers, floating
+ * point arguments in SSE registers, and anything else on the stack
+ *
+ * @param convention calling convention to use
+ * @param argumentTypes vector of Types of the arguments
+ * @param locations output array of locations, as long as argumentTypes
+ * @returns number of stack slots used
+ */
+size_t callingConventionAssignArguments(CallingConvention convention,
+                                        Vector const *argumentTypes,
+                                        ArgumentLocation *locations);
+
+/**
+ * gets the registers whose value survives a call
+ *
+ * @param convention calling convention of the callee
+ * @param calleeClobbers registers the callee, or anything it calls, might
+ * write to - ignored for CC_SYSV, since an exported function may be replaced
+ * at link time
+ * @returns registers that don't need to be saved by the caller
+ */
+RegisterSet callingConventionPreserved(CallingConvention convention,
+                                       RegisterSet calleeClobbers);
+
+/**
+ * does the stack need to be 16-byte aligned before a call?
+ *
+ * @param convention calling convention of the callee
+ * @param calleeIsLeaf does the callee make no calls of its own
+ */
+bool callingConventionNeedsAlignment(CallingConvention convention,
+                                     bool calleeIsLeaf);
+
+/**
+ * does a function make no calls?
+ *
+ * aggregate copies and initializations lowered to calls to memcpy or memset
+ * count as calls
+ *
+ * @param function NT_FUNDEFN node
+ */
+bool functionIsLeaf(Node *function);
+
+#endif  // TLC_OPTIMIZATION_CALLINGCONVENTION_H_
@@ -0,0 +1,654 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// identical code folding implementation
+
+#include "optimization/codeFolding.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fileList.h"
+#include "optimization/common.h"
+#include "util/container/pointerSet.h"
+#include "util/functional.h"
+
+/** a function definition that may be folded */
+typedef struct {
+  Node *definition;              /**< NT_FUNDEFN */
+  FileListEntry *file;           /**< file the function is defined in */
+  SymbolTableEntry *entry;       /**< definition's stab entry */
+  SymbolTableEntry *declaration; /**< nullable declaration's stab entry */
+  bool foldable;  /**< may the function's code be replaced by an alias? */
+  size_t index;   /**< position in the order definitions were found */
+  uint64_t shape; /**< hash of the function's structure - identical
+                     functions have the same shape */
+} Candidate;
+
+/** state for the address-taken scan */
+typedef struct {
+  PointerSet callees; /**< set of Node, function expressions of calls */
+  PointerSet taken;   /**< set of SymbolTableEntry, address-taken functions */
+} AddressTaken;
+
+/**
+ * records functions referenced other than by being called
+ *
+ * @param node node to check
+ * @param data AddressTaken
+ */
+static bool addressTakenVisitor(Node *node, void *data) {
+  AddressTaken *state = data;
+  SymbolTableEntry *entry;
+  switch (node->type) {
+    case NT_FUNCALLEXP: {
+      pointerSetPut(&state->callees,
+                    stripParens(node->data.funCallExp.function));
+      return true;
+    }
+    case NT_ID: {
+      entry = node->data.id.entry;
+      break;
+    }
+    case NT_SCOPEDID: {
+      entry = node->data.scopedId.entry;
+      break;
+    }
+    default: {
+      return true;
+    }
+  }
+  if (entry != NULL && entry->kind == SK_FUNCTION &&
+      !pointerSetContains(&state->callees, node))
+    pointerSetPut(&state->taken, entry);
+  return true;
+}
+
+/**
+ * mixes a value into a hash
+ *
+ * @param hash hash so far
+ * @param value value to mix in
+ */
+static uint64_t hashMix(uint64_t hash, uint64_t value) {
+  // FNV-1a step, on a whole value at a time
+  return (hash ^ value) * 0x100000001b3;
+}
+
+static uint64_t expShape(uint64_t hash, Node *exp);
+/**
+ * hashes the structure of a vector of nullable expressions
+ *
+ * @param hash hash so far
+ * @param exps vector of expressions
+ */
+static uint64_t expVectorShape(uint64_t hash, Vector const *exps) {
+  hash = hashMix(hash, exps->size);
+  for (size_t idx = 0; idx < exps->size; ++idx)
+    hash = expShape(hash, exps->elements[idx]);
+  return hash;
+}
+/**
+ * hashes the structure of a nullable expression - everything expsCorrespond
+ * compares except which symbols are referenced and the values of literals
+ *
+ * @param hash hash so far
+ * @param exp expression to hash
+ */
+static uint64_t expShape(uint64_t hash, Node *exp) {
+  if (exp == NULL) return hashMix(hash, 0);
+  exp = stripParens(exp);
+  hash = hashMix(hash, exp->type + 1);
+
+  switch (exp->type) {
+    case NT_LITERAL: {
+      return hashMix(hash, exp->data.literal.literalType);
+    }
+    case NT_BINOPEXP: {
+      hash = hashMix(hash, exp->data.binOpExp.op);
+      if (exp->data.binOpExp.op != BO_CAST)
+        hash = expShape(hash, exp->data.binOpExp.lhs);
+      return expShape(hash, exp->data.binOpExp.rhs);
+    }
+    case NT_TERNARYEXP: {
+      hash = expShape(hash, exp->data.ternaryExp.predicate);
+      hash = expShape(hash, exp->data.ternaryExp.consequent);
+      return expShape(hash, exp->data.ternaryExp.alternative);
+    }
+    case NT_UNOPEXP: {
+      hash = hashMix(hash, exp->data.unOpExp.op);
+      return exp->data.unOpExp.op == UO_SIZEOFTYPE
+                 ? hash
+                 : expShape(hash, exp->data.unOpExp.target);
+    }
+    case NT_FUNCALLEXP: {
+      hash = expShape(hash, exp->data.funCallExp.function);
+      return expVectorShape(hash, exp->data.funCallExp.arguments);
+    }
+    default: {
+      // symbols are matched up by the full comparison
+      return hash;
+    }
+  }
+}
+/**
+ * hashes the structure of a nullable statement
+ *
+ * @param hash hash so far
+ * @param stmt statement to hash
+ */
+static uint64_t stmtShape(uint64_t hash, Node *stmt) {
+  if (stmt == NULL) return hashMix(hash, 0);
+  hash = hashMix(hash, stmt->type + 1);
+
+  switch (stmt->type) {
+    case NT_COMPOUNDSTMT: {
+      Vector const *stmts = stmt->data.compoundStmt.stmts;
+      hash = hashMix(hash, stmts->size);
+      for (size_t idx = 0; idx < stmts->size; ++idx)
+        hash = stmtShape(hash, stmts->elements[idx]);
+      return hash;
+    }
+    case NT_IFSTMT: {
+      hash = hashMix(hash, stmt->data.ifStmt.hint);
+      hash = expShape(hash, stmt->data.ifStmt.predicate);
+      hash = stmtShape(hash, stmt->data.ifStmt.consequent);
+      return stmtShape(hash, stmt->data.ifStmt.alternative);
+    }
+    case NT_WHILESTMT: {
+      hash = expShape(hash, stmt->data.whileStmt.condition);
+      return stmtShape(hash, stmt->data.whileStmt.body);
+    }
+    case NT_DOWHILESTMT: {
+      hash = stmtShape(hash, stmt->data.doWhileStmt.body);
+      return expShape(hash, stmt->data.doWhileStmt.condition);
+    }
+    case NT_FORSTMT: {
+      hash = stmtShape(hash, stmt->data.forStmt.initializer);
+      hash = expShape(hash, stmt->data.forStmt.condition);
+      hash = expShape(hash, stmt->data.forStmt.increment);
+      return stmtShape(hash, stmt->data.forStmt.body);
+    }
+    case NT_SWITCHSTMT: {
+      Vector const *cases = stmt->data.switchStmt.cases;
+      hash = expShape(hash, stmt->data.switchStmt.condition);
+      hash = hashMix(hash, cases->size);
+      for (size_t idx = 0; idx < cases->size; ++idx)
+        hash = stmtShape(hash, cases->elements[idx]);
+      return hash;
+    }
+    case NT_SWITCHCASE: {
+      hash = expVectorShape(hash, stmt->data.switchCase.values);
+      return stmtShape(hash, stmt->data.switchCase.body);
+    }
+    case NT_SWITCHDEFAULT: {
+      return stmtShape(hash, stmt->data.switchDefault.body);
+    }
+    case NT_RETURNSTMT: {
+      return expShape(hash, stmt->data.returnStmt.value);
+    }
+    case NT_VARDEFNSTMT: {
+      return expVectorShape(hash, stmt->data.varDefnStmt.initializers);
+    }
+    case NT_EXPRESSIONSTMT: {
+      return expShape(hash, stmt->data.expressionStmt.expression);
+    }
+    default: {
+      return hash;
+    }
+  }
+}
+
+/**
+ * orders candidates by shape, then by the order they were found
+ *
+ * @param a pointer to the first Candidate *
+ * @param b pointer to the second Candidate *
+ */
+static int candidateCompare(void const *a, void const *b) {
+  Candidate const *first = *(Candidate *const *)a;
+  Candidate const *second = *(Candidate *const *)b;
+  if (first->shape != second->shape)
+    return first->shape < second->shape ? -1 : 1;
+  else if (first->index != second->index)
+    return first->index < second->index ? -1 : 1;
+  else
+    return 0;
+}
+
+/** corresponding symbols of two functions being compared */
+typedef struct {
+  Candidate const *a;
+  Candidate const *b;
+  PointerMap const *definitions; /**< map from the SymbolTableEntry of a
+                                    candidate's declaration to its
+                                    definition's */
+  PointerMap aToB; /**< map from locals of a to the corresponding locals of
+                      b */
+  PointerMap bToA; /**< the same pairs, from b to a */
+} Correspondence;
+
+/**
+ * gets the definition of a function
+ *
+ * @param definitions map from the declarations of candidates to their
+ * definitions
+ * @param entry function's stab entry
+ * @returns definition's stab entry, or entry if it isn't a declaration of a
+ * candidate
+ */
+static SymbolTableEntry const *functionDefinition(
+    PointerMap const *definitions, SymbolTableEntry const *entry) {
+  SymbolTableEntry const *definition = pointerMapGet(definitions, entry);
+  return definition != NULL ? definition : entry;
+}
+
+/**
+ * do two references to symbols correspond?
+ *
+ * @param c correspondence
+ * @param a first entry, non-null
+ * @param b second entry, non-null
+ */
+static bool entriesCorrespond(Correspondence const *c,
+                              SymbolTableEntry const *a,
+                              SymbolTableEntry const *b) {
+  SymbolTableEntry const *aPartner = pointerMapGet(&c->aToB, a);
+  SymbolTableEntry const *bPartner = pointerMapGet(&c->bToA, b);
+  if (aPartner != NULL || bPartner != NULL)
+    return aPartner == b && bPartner == a;
+
+  if (a->kind == SK_FUNCTION && b->kind == SK_FUNCTION) {
+    a = functionDefinition(c->definitions, a);
+    b = functionDefinition(c->definitions, b);
+    // recursive calls correspond
+    if (a == c->a->entry && b == c->b->entry) return true;
+  }
+  return a == b;
+}
+
+/**
+ * records that two locals correspond
+ *
+ * @param c correspondence to add to
+ * @param a first entry
+ * @param b second entry
+ * @returns whether the locals have the same type
+ */
+static bool addPair(Correspondence *c, SymbolTableEntry *a,
+                    SymbolTableEntry *b) {
+  if (a == NULL || b == NULL || a->kind != SK_VARIABLE ||
+      b->kind != SK_VARIABLE ||
+      !typeEqual(a->data.variable.type, b->data.variable.type))
+    return false;
+  // a local that is already paired keeps its first partner
+  pointerMapPut(&c->aToB, a, b);
+  pointerMapPut(&c->bToA, b, a);
+  return true;
+}
+
+static bool expsCorrespond(Correspondence *c, Node *a, Node *b);
+
+/**
+ * do two vectors of nullable expressions correspond?
+ *
+ * @param c correspondence
+ * @param a first vector
+ * @param b second vector
+ */
+static bool expVectorsCorrespond(Correspondence *c, Vector const *a,
+                                 Vector const *b) {
+  if (a->size != b->size) return false;
+  for (size_t idx = 0; idx < a->size; ++idx) {
+    if (!expsCorrespond(c, a->elements[idx], b->elements[idx])) return false;
+  }
+  return true;
+}
+
+/**
+ * do two nullable expressions compute the same thing?
+ *
+ * @param c correspondence
+ * @param a first expression
+ * @param b second expression
+ */
+static bool expsCorrespond(Correspondence *c, Node *a, Node *b) {
+  if (a == NULL || b == NULL) return a == b;
+  a = stripParens(a);
+  b = stripParens(b);
+  if (a->type != b->type) return false;
+
+  switch (a->type) {
+    case NT_ID: {
+      if (a->data.id.entry != NULL && b->data.id.entry != NULL)
+        return entriesCorrespond(c, a->data.id.entry, b->data.id.entry);
+      else
+        return a->data.id.entry == b->data.id.entry &&
+               strcmp(a->data.id.id, b->data.id.id) == 0;
+    }
+    case NT_SCOPEDID: {
+      return a->data.scopedId.entry != NULL &&
+             b->data.scopedId.entry != NULL &&
+             entriesCorrespond(c, a->data.scopedId.entry,
+                               b->data.scopedId.entry);
+    }
+    case NT_LITERAL: {
+      return literalEqual(a, b);
+    }
+    case NT_BINOPEXP: {
+      if (a->data.binOpExp.op != b->data.binOpExp.op) return false;
+      if (a->data.binOpExp.op == BO_CAST)
+        return a->data.binOpExp.type != NULL &&
+               b->data.binOpExp.type != NULL &&
+               typeEqual(a->data.binOpExp.type, b->data.binOpExp.type) &&
+               expsCorrespond(c, a->data.binOpExp.rhs, b->data.binOpExp.rhs);
+      else
+        return expsCorrespond(c, a->data.binOpExp.lhs, b->data.binOpExp.lhs) &&
+               expsCorrespond(c, a->data.binOpExp.rhs, b->data.binOpExp.rhs);
+    }
+    case NT_TERNARYEXP: {
+      return expsCorrespond(c, a->data.ternaryExp.predicate,
+                            b->data.ternaryExp.predicate) &&
+             expsCorrespond(c, a->data.ternaryExp.consequent,
+                            b->data.ternaryExp.consequent) &&
+             expsCorrespond(c, a->data.ternaryExp.alternative,
+                            b->data.ternaryExp.alternative);
+    }
+    case NT_UNOPEXP: {
+      // the operand of sizeof a type is a type, which isn't compared
+      return a->data.unOpExp.op == b->data.unOpExp.op &&
+             a->data.unOpExp.op != UO_SIZEOFTYPE &&
+             expsCorrespond(c, a->data.unOpExp.target, b->data.unOpExp.target);
+    }
+    case NT_FUNCALLEXP: {
+      return expsCorrespond(c, a->data.funCallExp.function,
+                            b->data.funCallExp.function) &&
+             expVectorsCorrespond(c, a->data.funCallExp.arguments,
+                                  b->data.funCallExp.arguments);
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * do two nullable statements do the same thing?
+ *
+ * @param c correspondence - locals defined by the statements are added
+ * @param a first statement
+ * @param b second statement
+ */
+static bool stmtsCorrespond(Correspondence *c, Node *a, Node *b) {
+  if (a == NULL || b == NULL) return a == b;
+  if (a->type != b->type) return false;
+
+  switch (a->type) {
+    case NT_COMPOUNDSTMT: {
+      Vector const *aStmts = a->data.compoundStmt.stmts;
+      Vector const *bStmts = b->data.compoundStmt.stmts;
+      if (aStmts->size != bStmts->size) return false;
+      for (size_t idx = 0; idx < aStmts->size; ++idx) {
+        if (!stmtsCorrespond(c, aStmts->elements[idx], bStmts->elements[idx]))
+          return false;
+      }
+      return true;
+    }
+    case NT_IFSTMT: {
+      return a->data.ifStmt.hint == b->data.ifStmt.hint &&
+             expsCorrespond(c, a->data.ifStmt.predicate,
+                            b->data.ifStmt.predicate) &&
+             stmtsCorrespond(c, a->data.ifStmt.consequent,
+                             b->data.ifStmt.consequent) &&
+             stmtsCorrespond(c, a->data.ifStmt.alternative,
+                             b->data.ifStmt.alternative);
+    }
+    case NT_WHILESTMT: {
+      return expsCorrespond(c, a->data.whileStmt.condition,
+                            b->data.whileStmt.condition) &&
+             stmtsCorrespond(c, a->data.whileStmt.body, b->data.whileStmt.body);
+    }
+    case NT_DOWHILESTMT: {
+      return stmtsCorrespond(c, a->data.doWhileStmt.body,
+                             b->data.doWhileStmt.body) &&
+             expsCorrespond(c, a->data.doWhileStmt.condition,
+                            b->data.doWhileStmt.condition);
+    }
+    case NT_FORSTMT: {
+      return stmtsCorrespond(c, a->data.forStmt.initializer,
+                             b->data.forStmt.initializer) &&
+             expsCorrespond(c, a->data.forStmt.condition,
+                            b->data.forStmt.condition) &&
+             expsCorrespond(c, a->data.forStmt.increment,
+                            b->data.forStmt.increment) &&
+             stmtsCorrespond(c, a->data.forStmt.body, b->data.forStmt.body);
+    }
+    case NT_SWITCHSTMT: {
+      if (!expsCorrespond(c, a->data.switchStmt.condition,
+                          b->data.switchStmt.condition))
+        return false;
+      Vector const *aCases = a->data.switchStmt.cases;
+      Vector const *bCases = b->data.switchStmt.cases;
+      if (aCases->size != bCases->size) return false;
+      for (size_t idx = 0; idx < aCases->size; ++idx) {
+        if (!stmtsCorrespond(c, aCases->elements[idx], bCases->elements[idx]))
+          return false;
+      }
+      return true;
+    }
+    case NT_SWITCHCASE: {
+      return expVectorsCorrespond(c, a->data.switchCase.values,
+                                  b->data.switchCase.values) &&
+             stmtsCorrespond(c, a->data.switchCase.body,
+                             b->data.switchCase.body);
+    }
+    case NT_SWITCHDEFAULT: {
+      return stmtsCorrespond(c, a->data.switchDefault.body,
+                             b->data.switchDefault.body);
+    }
+    case NT_BREAKSTMT:
+    case NT_CONTINUESTMT:
+    case NT_NULLSTMT: {
+      return true;
+    }
+    case NT_RETURNSTMT: {
+      return expsCorrespond(c, a->data.returnStmt.value,
+                            b->data.returnStmt.value);
+    }
+    case NT_ASMSTMT: {
+      return literalEqual(a->data.asmStmt.assembly, b->data.asmStmt.assembly);
+    }
+    case NT_VARDEFNSTMT: {
+      Vector const *aNames = a->data.varDefnStmt.names;
+      Vector const *bNames = b->data.varDefnStmt.names;
+      if (aNames->size != bNames->size) return false;
+      for (size_t idx = 0; idx < aNames->size; ++idx) {
+        Node const *aName = aNames->elements[idx];
+        Node const *bName = bNames->elements[idx];
+        if (!addPair(c, aName->data.id.entry, bName->data.id.entry))
+          return false;
+      }
+      return expVectorsCorrespond(c, a->data.varDefnStmt.initializers,
+                                  b->data.varDefnStmt.initializers);
+    }
+    case NT_EXPRESSIONSTMT: {
+      return expsCorrespond(c, a->data.expressionStmt.expression,
+                            b->data.expressionStmt.expression);
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * are two functions identical?
+ *
+ * @param definitions map from the declarations of candidates to their
+ * definitions
+ * @param a first function
+ * @param b second function
+ */
+static bool functionsIdentical(PointerMap const *definitions,
+                               Candidate const *a, Candidate const *b) {
+  Node *aDefn = a->definition;
+  Node *bDefn = b->definition;
+  if (!typeEqual(a->entry->data.function.returnType,
+                 b->entry->data.function.returnType) ||
+      aDefn->data.funDefn.argNames->size != bDefn->data.funDefn.argNames->size)
+    return false;
+
+  Correspondence c;
+  c.a = a;
+  c.b = b;
+  c.definitions = definitions;
+  pointerMapInit(&c.aToB);
+  pointerMapInit(&c.bToA);
+
+  bool identical = true;
+  Vector const *aNames = aDefn->data.funDefn.argNames;
+  Vector const *bNames = bDefn->data.funDefn.argNames;
+  Vector const *aTypes = &a->entry->data.function.argumentTypes;
+  Vector const *bTypes = &b->entry->data.function.argumentTypes;
+  for (size_t idx = 0; idx < aNames->size && identical; ++idx) {
+    Node const *aName = aNames->elements[idx];
+    Node const *bName = bNames->elements[idx];
+    if (aName == NULL || bName == NULL) {
+      // unnamed arguments are never used, but their types still matter
+      identical = aName == bName &&
+                  typeEqual(aTypes->elements[idx], bTypes->elements[idx]);
+    } else {
+      identical = addPair(
+          &c, hashMapGet(aDefn->data.funDefn.argStab, aName->data.id.id),
+          hashMapGet(bDefn->data.funDefn.argStab, bName->data.id.id));
+    }
+  }
+  identical = identical && stmtsCorrespond(&c, aDefn->data.funDefn.body,
+                                           bDefn->data.funDefn.body);
+
+  pointerMapUninit(&c.aToB);
+  pointerMapUninit(&c.bToA);
+  return identical;
+}
+
+void codeFoldingInit(CodeFolding *folding, bool wholeProgram) {
+  vectorInit(&folding->folded);
+  pointerMapInit(&folding->targets);
+
+  Vector candidates;
+  vectorInit(&candidates);
+  PointerMap definitions;
+  pointerMapInit(&definitions);
+  AddressTaken addressTaken;
+  pointerSetInit(&addressTaken.callees);
+  pointerSetInit(&addressTaken.taken);
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    FileListEntry *file = &fileList.entries[fileIdx];
+    if (!file->isCode) continue;
+
+    FileListEntry *declFile =
+        fileListFindDeclName(file->ast->data.file.module->data.module.id);
+    HashMap const *declStab =
+        declFile == NULL ? NULL : declFile->ast->data.file.stab;
+    Vector *bodies = file->ast->data.file.bodies;
+    for (size_t idx = 0; idx < bodies->size; ++idx) {
+      Node *body = bodies->elements[idx];
+      if (body->type != NT_FUNDEFN) continue;
+
+      nodeVisit(body->data.funDefn.body, addressTakenVisitor, &addressTaken);
+      if (body->data.funDefn.body->type != NT_COMPOUNDSTMT) continue;
+
+      Node *name = body->data.funDefn.name;
+      Candidate *candidate = malloc(sizeof(Candidate));
+      candidate->definition = body;
+      candidate->file = file;
+      candidate->entry = name->data.id.entry;
+      candidate->declaration =
+          declStab == NULL ? NULL : hashMapGet(declStab, name->data.id.id);
+      candidate->index = candidates.size;
+      candidate->shape =
+          stmtShape(hashMix(0xcbf29ce484222325,
+                            body->data.funDefn.argNames->size),
+                    body->data.funDefn.body);
+      vectorInsert(&candidates, candidate);
+      if (candidate->declaration != NULL)
+        pointerMapPut(&definitions, candidate->declaration, candidate->entry);
+    }
+  }
+
+  for (size_t idx = 0; idx < candidates.size; ++idx) {
+    Candidate *candidate = candidates.elements[idx];
+    candidate->foldable =
+        !pointerSetContains(&addressTaken.taken, candidate->entry) &&
+        !(candidate->declaration != NULL &&
+          (!wholeProgram ||
+           pointerSetContains(&addressTaken.taken, candidate->declaration)));
+  }
+
+  // only functions with the same shape can be identical, so each is only
+  // compared to the earlier functions with its shape
+  Candidate **byShape = malloc(candidates.size * sizeof(Candidate *));
+  for (size_t idx = 0; idx < candidates.size; ++idx)
+    byShape[idx] = candidates.elements[idx];
+  qsort(byShape, candidates.size, sizeof(Candidate *), candidateCompare);
+
+  for (size_t start = 0, end; start < candidates.size; start = end) {
+    for (end = start + 1;
+         end < candidates.size && byShape[end]->shape == byShape[start]->shape;
+         ++end)
+      ;
+
+    for (size_t idx = start + 1; idx < end; ++idx) {
+      Candidate *candidate = byShape[idx];
+      if (!candidate->foldable) continue;
+
+      // fold into the first identical function that keeps its code
+      for (size_t targetIdx = start; targetIdx < idx; ++targetIdx) {
+        Candidate *target = byShape[targetIdx];
+        if ((!wholeProgram && target->file != candidate->file) ||
+            codeFoldingTargetOf(folding, target->entry) != NULL ||
+            !functionsIdentical(&definitions, target, candidate))
+          continue;
+
+        FoldedFunction *folded = malloc(sizeof(FoldedFunction));
+        folded->function = candidate->entry;
+        folded->target = target->entry;
+        vectorInsert(&folding->folded, folded);
+        pointerMapPut(&folding->targets, folded->function, folded->target);
+        break;
+      }
+    }
+  }
+
+  free(byShape);
+  pointerSetUninit(&addressTaken.callees);
+  pointerSetUninit(&addressTaken.taken);
+  pointerMapUninit(&definitions);
+  vectorUninit(&candidates, free);
+}
+
+SymbolTableEntry *codeFoldingTargetOf(CodeFolding const *folding,
+                                      SymbolTableEntry const *function) {
+  return pointerMapGet(&folding->targets, function);
+}
+
+void codeFoldingUninit(CodeFolding *folding) {
+  vectorUninit(&folding->folded, free);
+  pointerMapUninit(&folding->targets);
+}
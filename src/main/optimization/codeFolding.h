@@ -0,0 +1,80 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * identical code folding - finds functions that compile to the same code, so
+ * only one copy is emitted and the others become aliases of it
+ */
+
+#ifndef TLC_OPTIMIZATION_CODEFOLDING_H_
+#define TLC_OPTIMIZATION_CODEFOLDING_H_
+
+#include <stdbool.h>
+
+#include "ast/symbolTable.h"
+#include "util/container/pointerMap.h"
+#include "util/container/vector.h"
+
+/** a function emitted as an alias of an identical function */
+typedef struct {
+  SymbolTableEntry *function; /**< function whose code is dropped */
+  SymbolTableEntry *target;   /**< function whose code it shares */
+} FoldedFunction;
+
+/** the functions in the program that share code */
+typedef struct {
+  Vector folded;      /**< vector of FoldedFunction */
+  PointerMap targets; /**< map from the stab entry of each folded function to
+                         its target's */
+} CodeFolding;
+
+/**
+ * finds identical function definitions in the parsed files
+ *
+ * functions are identical if they have the same type and their bodies are the
+ * same up to renaming of arguments and locals, and calls to themselves. A
+ * function only becomes an alias if its address is never taken, since
+ * aliases share an address; outside of whole-program mode, exported functions
+ * may have their address taken by another module, so are never aliases
+ *
+ * @param folding CodeFolding to initialize
+ * @param wholeProgram are all the modules in the program being compiled
+ * together? If not, functions are only folded within a module
+ */
+void codeFoldingInit(CodeFolding *folding, bool wholeProgram);
+
+/**
+ * gets the function whose code a function shares
+ *
+ * @param folding CodeFolding to query
+ * @param function function definition's stab entry
+ * @returns function to alias, or NULL if the function's code is emitted
+ */
+SymbolTableEntry *codeFoldingTargetOf(CodeFolding const *folding,
+                                      SymbolTableEntry const *function);
+
+/**
+ * deinitializes a CodeFolding
+ *
+ * @param folding CodeFolding to deinitialize
+ */
+void codeFoldingUninit(CodeFolding *folding);
+
+#endif  // TLC_OPTIMIZATION_CODEFOLDING_H_
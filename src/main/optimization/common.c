@@ -0,0 +1,505 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// common functions for source-level optimizations
+
+#include "optimization/common.h"
+
+#include <string.h>
+
+Node *stripParens(Node *exp) {
+  while (exp->type == NT_UNOPEXP && exp->data.unOpExp.op == UO_PARENS)
+    exp = exp->data.unOpExp.target;
+  return exp;
+}
+
+bool integerLiteralValue(Node *exp, int64_t *value) {
+  exp = stripParens(exp);
+  if (exp->type != NT_LITERAL) return false;
+
+  switch (exp->data.literal.literalType) {
+    case LT_UBYTE: {
+      *value = exp->data.literal.data.ubyteVal;
+      return true;
+    }
+    case LT_BYTE: {
+      *value = exp->data.literal.data.byteVal;
+      return true;
+    }
+    case LT_USHORT: {
+      *value = exp->data.literal.data.ushortVal;
+      return true;
+    }
+    case LT_SHORT: {
+      *value = exp->data.literal.data.shortVal;
+      return true;
+    }
+    case LT_UINT: {
+      *value = exp->data.literal.data.uintVal;
+      return true;
+    }
+    case LT_INT: {
+      *value = exp->data.literal.data.intVal;
+      return true;
+    }
+    case LT_ULONG: {
+      if (exp->data.literal.data.ulongVal > INT64_MAX) return false;
+      *value = (int64_t)exp->data.literal.data.ulongVal;
+      return true;
+    }
+    case LT_LONG: {
+      *value = exp->data.literal.data.longVal;
+      return true;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+bool expressionIsPure(Node *exp) {
+  switch (exp->type) {
+    case NT_LITERAL:
+    case NT_SCOPEDID:
+    case NT_ID: {
+      return true;
+    }
+    case NT_BINOPEXP: {
+      switch (exp->data.binOpExp.op) {
+        case BO_ASSIGN:
+        case BO_MULASSIGN:
+        case BO_DIVASSIGN:
+        case BO_MODASSIGN:
+        case BO_ADDASSIGN:
+        case BO_SUBASSIGN:
+        case BO_LSHIFTASSIGN:
+        case BO_ARSHIFTASSIGN:
+        case BO_LRSHIFTASSIGN:
+        case BO_BITANDASSIGN:
+        case BO_BITXORASSIGN:
+        case BO_BITORASSIGN:
+        case BO_LANDASSIGN:
+        case BO_LORASSIGN: {
+          return false;
+        }
+        case BO_CAST: {
+          return expressionIsPure(exp->data.binOpExp.rhs);
+        }
+        default: {
+          return expressionIsPure(exp->data.binOpExp.lhs) &&
+                 expressionIsPure(exp->data.binOpExp.rhs);
+        }
+      }
+    }
+    case NT_TERNARYEXP: {
+      return expressionIsPure(exp->data.ternaryExp.predicate) &&
+             expressionIsPure(exp->data.ternaryExp.consequent) &&
+             expressionIsPure(exp->data.ternaryExp.alternative);
+    }
+    case NT_UNOPEXP: {
+      switch (exp->data.unOpExp.op) {
+        case UO_PREINC:
+        case UO_PREDEC:
+        case UO_POSTINC:
+        case UO_POSTDEC:
+        case UO_NEGASSIGN:
+        case UO_LNOTASSIGN:
+        case UO_BITNOTASSIGN: {
+          return false;
+        }
+        case UO_SIZEOFTYPE: {
+          return true;
+        }
+        default: {
+          return expressionIsPure(exp->data.unOpExp.target);
+        }
+      }
+    }
+    default: {
+      return false;  // function calls and anything unexpected
+    }
+  }
+}
+
+bool expressionIsSpeculatable(Node *exp) {
+  if (!expressionIsPure(exp)) return false;
+
+  switch (exp->type) {
+    case NT_BINOPEXP: {
+      switch (exp->data.binOpExp.op) {
+        case BO_DIV:
+        case BO_MOD:
+        case BO_PTRFIELD:
+        case BO_ARRAY: {
+          return false;  // division by zero or bad memory access
+        }
+        case BO_CAST: {
+          return expressionIsSpeculatable(exp->data.binOpExp.rhs);
+        }
+        default: {
+          return expressionIsSpeculatable(exp->data.binOpExp.lhs) &&
+                 expressionIsSpeculatable(exp->data.binOpExp.rhs);
+        }
+      }
+    }
+    case NT_TERNARYEXP: {
+      return expressionIsSpeculatable(exp->data.ternaryExp.predicate) &&
+             expressionIsSpeculatable(exp->data.ternaryExp.consequent) &&
+             expressionIsSpeculatable(exp->data.ternaryExp.alternative);
+    }
+    case NT_UNOPEXP: {
+      switch (exp->data.unOpExp.op) {
+        case UO_DEREF: {
+          return false;  // bad memory access
+        }
+        case UO_SIZEOFEXP:
+        case UO_SIZEOFTYPE: {
+          return true;  // operand isn't evaluated
+        }
+        default: {
+          return expressionIsSpeculatable(exp->data.unOpExp.target);
+        }
+      }
+    }
+    default: {
+      return true;  // pure leaf
+    }
+  }
+}
+
+bool literalEqual(Node const *a, Node const *b) {
+  if (a->data.literal.literalType != b->data.literal.literalType) return false;
+
+  switch (a->data.literal.literalType) {
+    case LT_UBYTE: {
+      return a->data.literal.data.ubyteVal == b->data.literal.data.ubyteVal;
+    }
+    case LT_BYTE: {
+      return a->data.literal.data.byteVal == b->data.literal.data.byteVal;
+    }
+    case LT_USHORT: {
+      return a->data.literal.data.ushortVal == b->data.literal.data.ushortVal;
+    }
+    case LT_SHORT: {
+      return a->data.literal.data.shortVal == b->data.literal.data.shortVal;
+    }
+    case LT_UINT: {
+      return a->data.literal.data.uintVal == b->data.literal.data.uintVal;
+    }
+    case LT_INT: {
+      return a->data.literal.data.intVal == b->data.literal.data.intVal;
+    }
+    case LT_ULONG: {
+      return a->data.literal.data.ulongVal == b->data.literal.data.ulongVal;
+    }
+    case LT_LONG: {
+      return a->data.literal.data.longVal == b->data.literal.data.longVal;
+    }
+    case LT_FLOAT: {
+      return a->data.literal.data.floatBits == b->data.literal.data.floatBits;
+    }
+    case LT_DOUBLE: {
+      return a->data.literal.data.doubleBits == b->data.literal.data.doubleBits;
+    }
+    case LT_STRING: {
+      return strcmp((char const *)a->data.literal.data.stringVal,
+                    (char const *)b->data.literal.data.stringVal) == 0;
+    }
+    case LT_CHAR: {
+      return a->data.literal.data.charVal == b->data.literal.data.charVal;
+    }
+    case LT_WSTRING: {
+      uint32_t const *aString = a->data.literal.data.wstringVal;
+      uint32_t const *bString = b->data.literal.data.wstringVal;
+      size_t idx = 0;
+      for (; aString[idx] != 0 && aString[idx] == bString[idx]; ++idx)
+        ;
+      return aString[idx] == bString[idx];
+    }
+    case LT_WCHAR: {
+      return a->data.literal.data.wcharVal == b->data.literal.data.wcharVal;
+    }
+    case LT_BOOL: {
+      return a->data.literal.data.boolVal == b->data.literal.data.boolVal;
+    }
+    case LT_NULL: {
+      return true;
+    }
+    default: {
+      return false;  // aggregate initializers are never compared
+    }
+  }
+}
+
+bool literalIsZero(Node *literal) {
+  if (literal->type != NT_LITERAL) return false;
+
+  int64_t value;
+  if (integerLiteralValue(literal, &value)) return value == 0;
+
+  switch (literal->data.literal.literalType) {
+    case LT_FLOAT: {
+      return literal->data.literal.data.floatBits == 0;
+    }
+    case LT_DOUBLE: {
+      return literal->data.literal.data.doubleBits == 0;
+    }
+    case LT_CHAR: {
+      return literal->data.literal.data.charVal == 0;
+    }
+    case LT_WCHAR: {
+      return literal->data.literal.data.wcharVal == 0;
+    }
+    case LT_BOOL: {
+      return !literal->data.literal.data.boolVal;
+    }
+    case LT_NULL: {
+      return true;
+    }
+    case LT_AGGREGATEINIT: {
+      Vector const *elements = literal->data.literal.data.aggregateInitVal;
+      for (size_t idx = 0; idx < elements->size; ++idx) {
+        if (!literalIsZero(elements->elements[idx])) return false;
+      }
+      return true;
+    }
+    case LT_PACKEDINIT: {
+      return packedInitIsZero(literal->data.literal.data.packedInitVal);
+    }
+    default: {
+      return false;  // strings are never all zero
+    }
+  }
+}
+
+/**
+ * structural equality of expressions, ignoring parentheses
+ *
+ * @param a first expression
+ * @param b second expression
+ * @returns whether the expressions have the same structure
+ */
+static bool structurallyEqual(Node *a, Node *b) {
+  a = stripParens(a);
+  b = stripParens(b);
+  if (a->type != b->type) return false;
+
+  switch (a->type) {
+    case NT_ID: {
+      if (a->data.id.entry != NULL && b->data.id.entry != NULL)
+        return a->data.id.entry == b->data.id.entry;
+      else
+        return strcmp(a->data.id.id, b->data.id.id) == 0;
+    }
+    case NT_SCOPEDID: {
+      if (a->data.scopedId.entry != NULL && b->data.scopedId.entry != NULL)
+        return a->data.scopedId.entry == b->data.scopedId.entry;
+      else
+        return nameNodeEqual(a, b);
+    }
+    case NT_LITERAL: {
+      return literalEqual(a, b);
+    }
+    case NT_BINOPEXP: {
+      if (a->data.binOpExp.op != b->data.binOpExp.op) return false;
+      if (a->data.binOpExp.op == BO_CAST)
+        return a->data.binOpExp.type != NULL &&
+               b->data.binOpExp.type != NULL &&
+               typeEqual(a->data.binOpExp.type, b->data.binOpExp.type) &&
+               structurallyEqual(a->data.binOpExp.rhs, b->data.binOpExp.rhs);
+      else
+        return structurallyEqual(a->data.binOpExp.lhs, b->data.binOpExp.lhs) &&
+               structurallyEqual(a->data.binOpExp.rhs, b->data.binOpExp.rhs);
+    }
+    case NT_TERNARYEXP: {
+      return structurallyEqual(a->data.ternaryExp.predicate,
+                               b->data.ternaryExp.predicate) &&
+             structurallyEqual(a->data.ternaryExp.consequent,
+                               b->data.ternaryExp.consequent) &&
+             structurallyEqual(a->data.ternaryExp.alternative,
+                               b->data.ternaryExp.alternative);
+    }
+    case NT_UNOPEXP: {
+      return a->data.unOpExp.op == b->data.unOpExp.op &&
+             a->data.unOpExp.op != UO_SIZEOFTYPE &&
+             structurallyEqual(a->data.unOpExp.target,
+                               b->data.unOpExp.target);
+    }
+    default: {
+      return false;
+    }
+  }
+}
+bool expressionEqual(Node *a, Node *b) {
+  return expressionIsPure(a) && expressionIsPure(b) && structurallyEqual(a, b);
+}
+
+bool symbolIsExported(FileListEntry *file, char const *name) {
+  // main is called by the C runtime, and needn't be declared
+  if (strcmp(name, "main") == 0) {
+    SymbolTableEntry const *entry = hashMapGet(file->ast->data.file.stab, name);
+    if (entry != NULL && entry->kind == SK_FUNCTION) return true;
+  }
+
+  FileListEntry *declEntry =
+      fileListFindDeclName(file->ast->data.file.module->data.module.id);
+  return declEntry != NULL &&
+         hashMapGet(declEntry->ast->data.file.stab, name) != NULL;
+}
+
+Type const *stripType(Type const *type) {
+  while (true) {
+    if (type->kind == TK_QUALIFIED) {
+      type = type->data.qualified.base;
+    } else if (type->kind == TK_REFERENCE &&
+               type->data.reference.entry->kind == SK_TYPEDEF) {
+      type = type->data.reference.entry->data.typedefType.actual;
+    } else {
+      return type;
+    }
+  }
+}
+
+/**
+ * visits each node in a vector of nodes
+ *
+ * @param nodes vector of nullable nodes
+ */
+static void nodeVectorVisit(Vector *nodes, bool (*visitor)(Node *, void *),
+                            void *data) {
+  for (size_t idx = 0; idx < nodes->size; ++idx)
+    nodeVisit(nodes->elements[idx], visitor, data);
+}
+void nodeVisit(Node *node, bool (*visitor)(Node *, void *), void *data) {
+  if (node == NULL || !visitor(node, data)) return;
+
+  switch (node->type) {
+    case NT_COMPOUNDSTMT: {
+      nodeVectorVisit(node->data.compoundStmt.stmts, visitor, data);
+      break;
+    }
+    case NT_IFSTMT: {
+      nodeVisit(node->data.ifStmt.predicate, visitor, data);
+      nodeVisit(node->data.ifStmt.consequent, visitor, data);
+      nodeVisit(node->data.ifStmt.alternative, visitor, data);
+      break;
+    }
+    case NT_WHILESTMT: {
+      nodeVisit(node->data.whileStmt.condition, visitor, data);
+      nodeVisit(node->data.whileStmt.body, visitor, data);
+      break;
+    }
+    case NT_DOWHILESTMT: {
+      nodeVisit(node->data.doWhileStmt.body, visitor, data);
+      nodeVisit(node->data.doWhileStmt.condition, visitor, data);
+      break;
+    }
+    case NT_FORSTMT: {
+      nodeVisit(node->data.forStmt.initializer, visitor, data);
+      nodeVisit(node->data.forStmt.condition, visitor, data);
+      nodeVisit(node->data.forStmt.increment, visitor, data);
+      nodeVisit(node->data.forStmt.body, visitor, data);
+      break;
+    }
+    case NT_SWITCHSTMT: {
+      nodeVisit(node->data.switchStmt.condition, visitor, data);
+      nodeVectorVisit(node->data.switchStmt.cases, visitor, data);
+      break;
+    }
+    case NT_RETURNSTMT: {
+      nodeVisit(node->data.returnStmt.value, visitor, data);
+      break;
+    }
+    case NT_VARDEFNSTMT: {
+      nodeVectorVisit(node->data.varDefnStmt.initializers, visitor, data);
+      break;
+    }
+    case NT_EXPRESSIONSTMT: {
+      nodeVisit(node->data.expressionStmt.expression, visitor, data);
+      break;
+    }
+    case NT_SWITCHCASE: {
+      nodeVisit(node->data.switchCase.body, visitor, data);
+      break;
+    }
+    case NT_SWITCHDEFAULT: {
+      nodeVisit(node->data.switchDefault.body, visitor, data);
+      break;
+    }
+    case NT_BINOPEXP: {
+      if (node->data.binOpExp.op != BO_CAST)
+        nodeVisit(node->data.binOpExp.lhs, visitor, data);
+      nodeVisit(node->data.binOpExp.rhs, visitor, data);
+      break;
+    }
+    case NT_TERNARYEXP: {
+      nodeVisit(node->data.ternaryExp.predicate, visitor, data);
+      nodeVisit(node->data.ternaryExp.consequent, visitor, data);
+      nodeVisit(node->data.ternaryExp.alternative, visitor, data);
+      break;
+    }
+    case NT_UNOPEXP: {
+      if (node->data.unOpExp.op != UO_SIZEOFTYPE)
+        nodeVisit(node->data.unOpExp.target, visitor, data);
+      break;
+    }
+    case NT_FUNCALLEXP: {
+      nodeVisit(node->data.funCallExp.function, visitor, data);
+      nodeVectorVisit(node->data.funCallExp.arguments, visitor, data);
+      break;
+    }
+    default: {
+      // leaves - literals, ids, and statements without children
+      break;
+    }
+  }
+}
+
+/**
+ * looks for a function call
+ */
+static bool findCall(Node *node, void *data) {
+  bool *found = data;
+  if (node->type == NT_FUNCALLEXP) *found = true;
+  return !*found;
+}
+bool nodeContainsCall(Node *node) {
+  bool found = false;
+  nodeVisit(node, findCall, &found);
+  return found;
+}
+
+SymbolTableEntry *directCallee(Node *call) {
+  Node *function = stripParens(call->data.funCallExp.function);
+  SymbolTableEntry *entry;
+  switch (function->type) {
+    case NT_ID: {
+      entry = function->data.id.entry;
+      break;
+    }
+    case NT_SCOPEDID: {
+      entry = function->data.scopedId.entry;
+      break;
+    }
+    default: {
+      return NULL;
+    }
+  }
+  return entry != NULL && entry->kind == SK_FUNCTION ? entry : NULL;
+}
@@ -0,0 +1,146 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * common functions for source-level optimizations
+ */
+
+#ifndef TLC_OPTIMIZATION_COMMON_H_
+#define TLC_OPTIMIZATION_COMMON_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ast/ast.h"
+#include "fileList.h"
+
+/**
+ * skips any parentheses around an expression
+ *
+ * @param exp expression to look through
+ * @returns first non-parenthesis node
+ */
+Node *stripParens(Node *exp);
+
+/**
+ * gets the value of an integer literal, if the expression is one
+ *
+ * @param exp expression to query, may be parenthesized
+ * @param value output pointer to the value, sign extended if signed
+ * @returns whether the expression is an integer literal
+ */
+bool integerLiteralValue(Node *exp, int64_t *value);
+
+/**
+ * is an expression free of side effects?
+ *
+ * reads through pointers are assumed to be side effect free, so this doesn't
+ * detect volatile accesses
+ *
+ * @param exp expression to query
+ * @returns whether the expression is free of side effects
+ */
+bool expressionIsPure(Node *exp);
+
+/**
+ * can an expression be evaluated even if the program wouldn't have evaluated
+ * it? (is it free of side effects, and can't trap?)
+ *
+ * @param exp expression to query
+ * @returns whether the expression can be speculatively evaluated
+ */
+bool expressionIsSpeculatable(Node *exp);
+
+/**
+ * are two side effect free expressions guaranteed to evaluate to the same
+ * value?
+ *
+ * expressions are compared structurally, ignoring parentheses
+ *
+ * @param a first expression
+ * @param b second expression
+ * @returns whether the expressions are equal
+ */
+bool expressionEqual(Node *a, Node *b);
+
+/**
+ * are two literals equal?
+ *
+ * @param a first literal
+ * @param b second literal
+ * @returns whether the literals are known to have the same value
+ */
+bool literalEqual(Node const *a, Node const *b);
+
+/**
+ * is a literal all zero bits?
+ *
+ * @param literal literal to query, may be an enumeration constant in an
+ * aggregate initializer
+ * @returns whether the literal is known to be all zero bits
+ */
+bool literalIsZero(Node *literal);
+
+/**
+ * is a symbol visible outside its module?
+ *
+ * @param file code file the symbol is defined in
+ * @param name name of the symbol
+ * @returns whether the declaration module matching the code file declares the
+ * symbol, or the symbol is a main function
+ */
+bool symbolIsExported(FileListEntry *file, char const *name);
+
+/**
+ * removes typedefs and qualifiers from a type
+ *
+ * @param type type to strip
+ * @returns first type that isn't qualified or a typedef
+ */
+Type const *stripType(Type const *type);
+
+/**
+ * visits the statements and expressions in a function body, in pre-order
+ *
+ * types are not visited, and neither are the names in a variable definition
+ *
+ * @param node statement or expression to start at
+ * @param visitor function called with each node and data - returns whether
+ * the children of the node should be visited
+ * @param data passed to the visitor
+ */
+void nodeVisit(Node *node, bool (*visitor)(Node *, void *), void *data);
+
+/**
+ * does a statement or expression contain a function call?
+ *
+ * @param node nullable statement or expression to search
+ */
+bool nodeContainsCall(Node *node);
+
+/**
+ * gets the function directly called by a call
+ *
+ * @param call NT_FUNCALLEXP node
+ * @returns SK_FUNCTION stab entry, or NULL if the call is indirect
+ */
+SymbolTableEntry *directCallee(Node *call);
+
+#endif  // TLC_OPTIMIZATION_COMMON_H_
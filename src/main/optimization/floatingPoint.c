@@ -0,0 +1,500 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// floating point rewrite implementation
+
+#include "optimization/floatingPoint.h"
+
+#include <string.h>
+
+#include "optimization/common.h"
+#include "options.h"
+
+/**
+ * gets the keyword type of a variable
+ *
+ * @param exp expression, may be parenthesized
+ * @returns keyword, or TK_VOID if the expression isn't a variable of keyword
+ * type
+ */
+static TypeKeyword variableKeyword(Node *exp) {
+  exp = stripParens(exp);
+  SymbolTableEntry *entry;
+  switch (exp->type) {
+    case NT_ID: {
+      entry = exp->data.id.entry;
+      break;
+    }
+    case NT_SCOPEDID: {
+      entry = exp->data.scopedId.entry;
+      break;
+    }
+    default: {
+      return TK_VOID;
+    }
+  }
+  if (entry == NULL || entry->kind != SK_VARIABLE) return TK_VOID;
+  Type const *type = stripType(entry->data.variable.type);
+  return type->kind == TK_KEYWORD ? type->data.keyword.keyword : TK_VOID;
+}
+
+/**
+ * gets the floating point type of an expression
+ *
+ * @param exp expression to query
+ * @returns TK_FLOAT or TK_DOUBLE, or TK_VOID if the expression isn't known to
+ * be floating point
+ */
+static TypeKeyword floatTypeOf(Node *exp) {
+  exp = stripParens(exp);
+  switch (exp->type) {
+    case NT_LITERAL: {
+      switch (exp->data.literal.literalType) {
+        case LT_FLOAT: {
+          return TK_FLOAT;
+        }
+        case LT_DOUBLE: {
+          return TK_DOUBLE;
+        }
+        default: {
+          return TK_VOID;
+        }
+      }
+    }
+    case NT_ID:
+    case NT_SCOPEDID: {
+      TypeKeyword keyword = variableKeyword(exp);
+      return keyword == TK_FLOAT || keyword == TK_DOUBLE ? keyword : TK_VOID;
+    }
+    case NT_UNOPEXP: {
+      return exp->data.unOpExp.op == UO_NEG
+                 ? floatTypeOf(exp->data.unOpExp.target)
+                 : TK_VOID;
+    }
+    case NT_BINOPEXP: {
+      switch (exp->data.binOpExp.op) {
+        case BO_ADD:
+        case BO_SUB:
+        case BO_MUL:
+        case BO_DIV: {
+          // if one type is a double, the common type is a double, then if one
+          // is a float, the common type is a float - but an operand of unknown
+          // type could be a double
+          TypeKeyword lhs = floatTypeOf(exp->data.binOpExp.lhs);
+          TypeKeyword rhs = floatTypeOf(exp->data.binOpExp.rhs);
+          if (lhs == TK_VOID || rhs == TK_VOID)
+            return TK_VOID;
+          else if (lhs == TK_DOUBLE || rhs == TK_DOUBLE)
+            return TK_DOUBLE;
+          else
+            return TK_FLOAT;
+        }
+        case BO_CAST: {
+          Type const *type = stripType(exp->data.binOpExp.type);
+          return type->kind == TK_KEYWORD &&
+                         (type->data.keyword.keyword == TK_FLOAT ||
+                          type->data.keyword.keyword == TK_DOUBLE)
+                     ? type->data.keyword.keyword
+                     : TK_VOID;
+        }
+        default: {
+          return TK_VOID;
+        }
+      }
+    }
+    default: {
+      return TK_VOID;
+    }
+  }
+}
+
+/**
+ * gets the value of a floating point literal, possibly negated, as the bits of
+ * a double
+ *
+ * @param exp expression to query, may be parenthesized
+ * @param bits output pointer to the bits of the value, converted to a double
+ * @returns whether the expression is a floating point literal
+ */
+static bool floatLiteralBits(Node *exp, uint64_t *bits) {
+  exp = stripParens(exp);
+  if (exp->type == NT_UNOPEXP && exp->data.unOpExp.op == UO_NEG) {
+    if (!floatLiteralBits(exp->data.unOpExp.target, bits)) return false;
+    *bits ^= UINT64_C(0x8000000000000000);
+    return true;
+  }
+  if (exp->type != NT_LITERAL) return false;
+  switch (exp->data.literal.literalType) {
+    case LT_FLOAT: {
+      float value;
+      memcpy(&value, &exp->data.literal.data.floatBits, sizeof(float));
+      double widened = (double)value;
+      memcpy(bits, &widened, sizeof(double));
+      return true;
+    }
+    case LT_DOUBLE: {
+      *bits = exp->data.literal.data.doubleBits;
+      return true;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * is an expression a floating point literal with the given value?
+ *
+ * @param exp expression to query, may be parenthesized
+ * @param bits bits of the value, as a double
+ */
+static bool floatLiteralIs(Node *exp, uint64_t bits) {
+  uint64_t actual;
+  return floatLiteralBits(exp, &actual) && actual == bits;
+}
+
+/** bits of 0.0 */
+static uint64_t const POSITIVE_ZERO = UINT64_C(0x0000000000000000);
+/** bits of -0.0 */
+static uint64_t const NEGATIVE_ZERO = UINT64_C(0x8000000000000000);
+/** bits of 1.0 */
+static uint64_t const ONE = UINT64_C(0x3ff0000000000000);
+
+/** state for usesVariable */
+typedef struct {
+  SymbolTableEntry const *entry;
+  bool found;
+} UsesVariableState;
+
+/**
+ * visitor for usesVariable
+ *
+ * @param node node to check
+ * @param data UsesVariableState
+ */
+static bool usesVariableVisitor(Node *node, void *data) {
+  UsesVariableState *state = data;
+  if ((node->type == NT_ID && node->data.id.entry == state->entry) ||
+      (node->type == NT_SCOPEDID && node->data.scopedId.entry == state->entry))
+    state->found = true;
+  return !state->found;
+}
+
+/**
+ * does an expression use a variable?
+ *
+ * @param exp expression to search
+ * @param entry SK_VARIABLE stab entry to look for
+ */
+static bool usesVariable(Node *exp, SymbolTableEntry const *entry) {
+  UsesVariableState state = {entry, false};
+  nodeVisit(exp, usesVariableVisitor, &state);
+  return state.found;
+}
+
+/**
+ * gets the variable an id or scoped id refers to
+ *
+ * @param exp expression, may be parenthesized
+ * @returns SK_VARIABLE stab entry, or NULL if the expression isn't a variable
+ */
+static SymbolTableEntry *variableOf(Node *exp) {
+  exp = stripParens(exp);
+  SymbolTableEntry *entry;
+  switch (exp->type) {
+    case NT_ID: {
+      entry = exp->data.id.entry;
+      break;
+    }
+    case NT_SCOPEDID: {
+      entry = exp->data.scopedId.entry;
+      break;
+    }
+    default: {
+      return NULL;
+    }
+  }
+  return entry != NULL && entry->kind == SK_VARIABLE ? entry : NULL;
+}
+
+bool reductionUpdateRecognize(Node *exp, ReductionUpdate *update) {
+  exp = stripParens(exp);
+  if (exp->type != NT_BINOPEXP) return false;
+
+  Node *accumulator = exp->data.binOpExp.lhs;
+  SymbolTableEntry *variable = variableOf(accumulator);
+  if (variable == NULL) return false;
+
+  Node *operand;
+  BinOpType op;
+  switch (exp->data.binOpExp.op) {
+    case BO_ADDASSIGN: {
+      op = BO_ADD;
+      operand = exp->data.binOpExp.rhs;
+      break;
+    }
+    case BO_MULASSIGN: {
+      op = BO_MUL;
+      operand = exp->data.binOpExp.rhs;
+      break;
+    }
+    case BO_ASSIGN: {
+      Node *value = stripParens(exp->data.binOpExp.rhs);
+      if (value->type != NT_BINOPEXP ||
+          (value->data.binOpExp.op != BO_ADD &&
+           value->data.binOpExp.op != BO_MUL))
+        return false;
+      op = value->data.binOpExp.op;
+      if (variableOf(value->data.binOpExp.lhs) == variable)
+        operand = value->data.binOpExp.rhs;
+      else if (variableOf(value->data.binOpExp.rhs) == variable)
+        operand = value->data.binOpExp.lhs;
+      else
+        return false;
+      break;
+    }
+    default: {
+      return false;
+    }
+  }
+  if (usesVariable(operand, variable)) return false;
+
+  switch (variableKeyword(accumulator)) {
+    case TK_UBYTE:
+    case TK_BYTE:
+    case TK_USHORT:
+    case TK_SHORT:
+    case TK_UINT:
+    case TK_INT:
+    case TK_ULONG:
+    case TK_LONG: {
+      // wrapping integer arithmetic is associative
+      break;
+    }
+    case TK_FLOAT:
+    case TK_DOUBLE: {
+      if (options.associativeMath != OPTION_AM_REASSOCIATE) return false;
+      break;
+    }
+    default: {
+      return false;
+    }
+  }
+
+  update->accumulator = accumulator;
+  update->operand = operand;
+  update->op = op;
+  return true;
+}
+
+/**
+ * gets the reciprocal of a floating point constant
+ *
+ * @param bits bits of the value
+ * @param exponentBits width of the exponent field
+ * @param mantissaBits width of the mantissa field
+ * @param reciprocal output pointer to the bits of the reciprocal
+ * @returns whether the value is a normal power of two with a normal reciprocal
+ */
+static bool exactReciprocal(uint64_t bits, size_t exponentBits,
+                            size_t mantissaBits, uint64_t *reciprocal) {
+  uint64_t exponentMask = (UINT64_C(1) << exponentBits) - 1;
+  uint64_t mantissa = bits & ((UINT64_C(1) << mantissaBits) - 1);
+  uint64_t exponent = (bits >> mantissaBits) & exponentMask;
+  uint64_t sign = bits & (UINT64_C(1) << (exponentBits + mantissaBits));
+  // 2^(e - bias) has reciprocal 2^(bias - e), so the biased exponent becomes
+  // 2 * bias - e, where 2 * bias is exponentMask - 1
+  if (mantissa != 0 || exponent == 0 || exponent >= exponentMask - 1)
+    return false;
+  *reciprocal = sign | ((exponentMask - 1 - exponent) << mantissaBits);
+  return true;
+}
+
+/**
+ * is a floating point value finite and non-zero?
+ *
+ * @param bits bits of the value
+ * @param exponentBits width of the exponent field
+ * @param mantissaBits width of the mantissa field
+ */
+static bool finiteNonzero(uint64_t bits, size_t exponentBits,
+                          size_t mantissaBits) {
+  uint64_t exponentMask = (UINT64_C(1) << exponentBits) - 1;
+  uint64_t magnitude =
+      bits & ((UINT64_C(1) << (exponentBits + mantissaBits)) - 1);
+  return magnitude != 0 &&
+         ((bits >> mantissaBits) & exponentMask) != exponentMask;
+}
+
+bool floatReciprocalDivision(Node *exp, uint64_t *reciprocal) {
+  exp = stripParens(exp);
+  if (exp->type != NT_BINOPEXP || exp->data.binOpExp.op != BO_DIV)
+    return false;
+
+  TypeKeyword type = floatTypeOf(exp);
+  uint64_t divisorBits;
+  if (type == TK_VOID ||
+      !floatLiteralBits(exp->data.binOpExp.rhs, &divisorBits))
+    return false;
+
+  // zeros, infinities and NaNs are never replaced
+  if (type == TK_FLOAT) {
+    // the divisor is a float literal, so narrows exactly
+    double divisor;
+    memcpy(&divisor, &divisorBits, sizeof(double));
+    float narrowed = (float)divisor;
+    uint32_t narrowedBits;
+    memcpy(&narrowedBits, &narrowed, sizeof(float));
+    if (exactReciprocal(narrowedBits, 8, 23, reciprocal)) return true;
+    if (options.reciprocalMath != OPTION_RM_APPROXIMATE ||
+        !finiteNonzero(narrowedBits, 8, 23))
+      return false;
+    narrowed = 1.0f / narrowed;
+    memcpy(&narrowedBits, &narrowed, sizeof(float));
+    *reciprocal = narrowedBits;
+    return true;
+  } else {
+    if (exactReciprocal(divisorBits, 11, 52, reciprocal)) return true;
+    if (options.reciprocalMath != OPTION_RM_APPROXIMATE ||
+        !finiteNonzero(divisorBits, 11, 52))
+      return false;
+    double divisor;
+    memcpy(&divisor, &divisorBits, sizeof(double));
+    divisor = 1 / divisor;
+    memcpy(reciprocal, &divisor, sizeof(double));
+    return true;
+  }
+}
+
+/**
+ * is an expression a floating point multiplication?
+ *
+ * @param exp expression to query
+ */
+static bool isFloatMultiplication(Node *exp) {
+  exp = stripParens(exp);
+  return exp->type == NT_BINOPEXP && exp->data.binOpExp.op == BO_MUL &&
+         floatTypeOf(exp) != TK_VOID;
+}
+
+bool floatContraction(Node *exp, FusedMultiplyAdd *fma) {
+  exp = stripParens(exp);
+  if (options.fpContract != OPTION_FPC_FAST || exp->type != NT_BINOPEXP ||
+      (exp->data.binOpExp.op != BO_ADD && exp->data.binOpExp.op != BO_SUB) ||
+      floatTypeOf(exp) == TK_VOID)
+    return false;
+
+  // the product must be computed in the type of the sum, or else the
+  // unfused product would have been widened before the addition
+  Node *product;
+  bool subtract = exp->data.binOpExp.op == BO_SUB;
+  if (isFloatMultiplication(exp->data.binOpExp.lhs) &&
+      floatTypeOf(exp->data.binOpExp.lhs) == floatTypeOf(exp)) {
+    product = stripParens(exp->data.binOpExp.lhs);
+    fma->addend = exp->data.binOpExp.rhs;
+    fma->negateProduct = false;
+    fma->negateAddend = subtract;
+  } else if (isFloatMultiplication(exp->data.binOpExp.rhs) &&
+             floatTypeOf(exp->data.binOpExp.rhs) == floatTypeOf(exp)) {
+    product = stripParens(exp->data.binOpExp.rhs);
+    fma->addend = exp->data.binOpExp.lhs;
+    fma->negateProduct = subtract;
+    fma->negateAddend = false;
+  } else {
+    return false;
+  }
+  fma->multiplicand = product->data.binOpExp.lhs;
+  fma->multiplier = product->data.binOpExp.rhs;
+  return true;
+}
+
+/**
+ * folds a floating point operation with an identity operand
+ *
+ * @param exp expression to consider
+ * @param result output pointer to the non-identity operand
+ * @param ignoreZeroSign may -0.0 become 0.0
+ */
+static bool identityFold(Node *exp, Node **result, bool ignoreZeroSign) {
+  exp = stripParens(exp);
+  if (exp->type != NT_BINOPEXP || floatTypeOf(exp) == TK_VOID) return false;
+
+  Node *lhs = exp->data.binOpExp.lhs;
+  Node *rhs = exp->data.binOpExp.rhs;
+  // the folded operand must already have the type of the result
+  TypeKeyword type = floatTypeOf(exp);
+  switch (exp->data.binOpExp.op) {
+    case BO_ADD: {
+      if (floatTypeOf(lhs) == type &&
+          (floatLiteralIs(rhs, NEGATIVE_ZERO) ||
+           (ignoreZeroSign && floatLiteralIs(rhs, POSITIVE_ZERO)))) {
+        *result = lhs;
+        return true;
+      } else if (floatTypeOf(rhs) == type &&
+                 (floatLiteralIs(lhs, NEGATIVE_ZERO) ||
+                  (ignoreZeroSign && floatLiteralIs(lhs, POSITIVE_ZERO)))) {
+        *result = rhs;
+        return true;
+      } else {
+        return false;
+      }
+    }
+    case BO_SUB: {
+      if (floatTypeOf(lhs) == type &&
+          (floatLiteralIs(rhs, POSITIVE_ZERO) ||
+           (ignoreZeroSign && floatLiteralIs(rhs, NEGATIVE_ZERO)))) {
+        *result = lhs;
+        return true;
+      } else {
+        return false;
+      }
+    }
+    case BO_MUL: {
+      if (floatTypeOf(lhs) == type && floatLiteralIs(rhs, ONE)) {
+        *result = lhs;
+        return true;
+      } else if (floatTypeOf(rhs) == type && floatLiteralIs(lhs, ONE)) {
+        *result = rhs;
+        return true;
+      } else {
+        return false;
+      }
+    }
+    case BO_DIV: {
+      if (floatTypeOf(lhs) == type && floatLiteralIs(rhs, ONE)) {
+        *result = lhs;
+        return true;
+      } else {
+        return false;
+      }
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+bool floatIdentityFold(Node *exp, Node **result) {
+  return identityFold(exp, result, options.signedZeros == OPTION_SZ_IGNORE);
+}
+
+bool floatIdentityNeedsNoSignedZeros(Node *exp) {
+  Node *result;
+  return !identityFold(exp, &result, false) && identityFold(exp, &result, true);
+}
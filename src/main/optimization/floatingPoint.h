@@ -0,0 +1,111 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * floating point rewrites - reassociation, reciprocals, contraction and
+ * identities, each allowed only as far as the floating point options permit
+ */
+
+#ifndef TLC_OPTIMIZATION_FLOATINGPOINT_H_
+#define TLC_OPTIMIZATION_FLOATINGPOINT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ast/ast.h"
+
+/** an update of a reduction accumulator */
+typedef struct {
+  Node *accumulator; /**< variable being reduced into. Non-owning */
+  Node *operand;     /**< value combined into the accumulator. Non-owning */
+  BinOpType op;      /**< BO_ADD or BO_MUL */
+} ReductionUpdate;
+
+/** a multiplication and addition fused into one rounding */
+typedef struct {
+  Node *multiplicand; /**< non-owning */
+  Node *multiplier;   /**< non-owning */
+  Node *addend;       /**< non-owning */
+  bool negateProduct; /**< is the product subtracted? - vfnmadd */
+  bool negateAddend;  /**< is the addend subtracted? - vfmsub */
+} FusedMultiplyAdd;
+
+/**
+ * recognizes an update of a reduction that may be split into independent
+ * partial results, as a vectorized loop would
+ *
+ * handles acc += x, acc *= x, acc = acc + x and acc = x + acc (and likewise
+ * for multiplication), where x doesn't use acc. Integral reductions may always
+ * be split; floating point reductions need -fassociative-math
+ *
+ * @param exp expression to consider
+ * @param update output pointer to the update
+ * @returns whether the expression is a splittable reduction update
+ */
+bool reductionUpdateRecognize(Node *exp, ReductionUpdate *update);
+
+/**
+ * decides whether a floating point division by a constant should be a
+ * multiplication by the constant's reciprocal
+ *
+ * powers of two have exact reciprocals, so are always replaced; other
+ * constants need -freciprocal-math
+ *
+ * @param exp expression to consider
+ * @param reciprocal output pointer to the bits of the reciprocal, in the type
+ * of the division - a float's bits are in the low 32 bits
+ * @returns whether the division should be replaced
+ */
+bool floatReciprocalDivision(Node *exp, uint64_t *reciprocal);
+
+/**
+ * recognizes a floating point multiplication and addition that may be fused
+ *
+ * needs -ffp-contract=fast; instruction selection must still check that the
+ * target has FMA instructions
+ *
+ * @param exp addition or subtraction to consider
+ * @param fma output pointer to the operands
+ * @returns whether the expression may be fused
+ */
+bool floatContraction(Node *exp, FusedMultiplyAdd *fma);
+
+/**
+ * folds a floating point operation with an identity operand
+ *
+ * x + -0.0, x - 0.0, x * 1.0 and x / 1.0 are always x; x + 0.0 and x - -0.0
+ * are x only with -fno-signed-zeros, since they turn -0.0 into 0.0
+ *
+ * @param exp expression to consider
+ * @param result output pointer to the non-identity operand. Non-owning
+ * @returns whether the expression was folded
+ */
+bool floatIdentityFold(Node *exp, Node **result);
+
+/**
+ * would a floating point operation fold with -fno-signed-zeros, but not
+ * without it?
+ *
+ * @param exp expression to consider
+ * @returns whether the only identity operand is a zero of the wrong sign
+ */
+bool floatIdentityNeedsNoSignedZeros(Node *exp);
+
+#endif  // TLC_OPTIMIZATION_FLOATINGPOINT_H_
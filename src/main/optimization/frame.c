@@ -0,0 +1,89 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// stack frame layout implementation
+
+#include "optimization/frame.h"
+
+#include "optimization/common.h"
+#include "optimization/memoryOps.h"
+
+enum {
+  STACK_ALIGNMENT = 16, /**< alignment of the stack pointer at a call */
+  SLOT_SIZE = 8,        /**< size of a pushed register or return address */
+};
+
+void framePlanCreate(FramePointerOption framePointer, bool isLeaf,
+                     size_t localsSize, size_t numSaves, FramePlan *plan) {
+  plan->usesFramePointer = framePointer == OPTION_FP_KEEP;
+  plan->numSaves = numSaves;
+
+  size_t pushed = plan->usesFramePointer ? SLOT_SIZE : 0;
+  size_t saves = numSaves * SLOT_SIZE;
+
+  if (isLeaf && saves + localsSize <= RED_ZONE_SIZE) {
+    plan->usesRedZone = true;
+    plan->stackAdjustment = 0;
+    plan->frameSize = pushed + saves + localsSize;
+    return;
+  }
+
+  plan->usesRedZone = false;
+  pushed += saves;
+  size_t adjustment = localsSize;
+  if (!isLeaf) {
+    // the return address and pushes, plus the adjustment, must be aligned
+    size_t misalignment = (SLOT_SIZE + pushed + adjustment) % STACK_ALIGNMENT;
+    if (misalignment != 0) adjustment += STACK_ALIGNMENT - misalignment;
+  }
+  plan->stackAdjustment = adjustment;
+  plan->frameSize = pushed + adjustment;
+}
+
+bool framePlanIsEmpty(FramePlan const *plan) {
+  return !plan->usesFramePointer && plan->stackAdjustment == 0 &&
+         plan->numSaves == 0;
+}
+
+/**
+ * is a statement a guard clause? (if (cond) return value;)
+ */
+static bool isGuardClause(Node *stmt) {
+  if (stmt->type != NT_IFSTMT || stmt->data.ifStmt.alternative != NULL ||
+      nodeContainsCall(stmt->data.ifStmt.predicate) ||
+      nodeContainsMemoryCall(stmt->data.ifStmt.predicate))
+    return false;
+
+  Node *consequent = stmt->data.ifStmt.consequent;
+  while (consequent->type == NT_COMPOUNDSTMT &&
+         consequent->data.compoundStmt.stmts->size == 1)
+    consequent = consequent->data.compoundStmt.stmts->elements[0];
+  return consequent->type == NT_RETURNSTMT &&
+         !nodeContainsCall(consequent->data.returnStmt.value) &&
+         !nodeContainsMemoryCall(consequent->data.returnStmt.value);
+}
+size_t shrinkWrapPoint(Node *function) {
+  Vector *stmts = function->data.funDefn.body->data.compoundStmt.stmts;
+  size_t idx = 0;
+  for (; idx < stmts->size; ++idx) {
+    Node *stmt = stmts->elements[idx];
+    if (stmt->type != NT_NULLSTMT && !isGuardClause(stmt)) break;
+  }
+  return idx;
+}
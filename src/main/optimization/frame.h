@@ -0,0 +1,84 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * stack frame layout - red zone use, frame pointer omission, and
+ * shrink-wrapping of the prologue
+ */
+
+#ifndef TLC_OPTIMIZATION_FRAME_H_
+#define TLC_OPTIMIZATION_FRAME_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ast/ast.h"
+#include "options.h"
+
+enum {
+  RED_ZONE_SIZE = 128, /**< bytes below the stack pointer a leaf may use */
+};
+
+/** the stack frame of a function */
+typedef struct {
+  bool usesFramePointer; /**< is rbp pushed and set up */
+  bool usesRedZone;      /**< are the saves and locals below the stack pointer,
+                            with saves done by mov instead of push */
+  size_t numSaves;       /**< number of callee-saved registers, besides rbp */
+  size_t stackAdjustment; /**< bytes subtracted from rsp in the prologue */
+  size_t frameSize; /**< bytes used by saves, the frame pointer, and locals */
+} FramePlan;
+
+/**
+ * lays out a stack frame
+ *
+ * leaf functions whose saves and locals fit in the red zone never adjust the
+ * stack pointer, and functions that make calls keep the stack 16-byte aligned
+ *
+ * @param framePointer frame pointer option
+ * @param isLeaf does the function make no calls, as decided by functionIsLeaf
+ * @param localsSize bytes of locals and spill slots
+ * @param numSaves number of callee-saved registers used, besides rbp
+ * @param plan output pointer to the plan
+ */
+void framePlanCreate(FramePointerOption framePointer, bool isLeaf,
+                     size_t localsSize, size_t numSaves, FramePlan *plan);
+
+/**
+ * does a planned frame need any prologue or epilogue code?
+ *
+ * @param plan plan to query
+ */
+bool framePlanIsEmpty(FramePlan const *plan);
+
+/**
+ * finds how far the prologue can be delayed (shrink-wrapped)
+ *
+ * the leading guard clauses of a function - if statements without an else
+ * that only return, and contain no calls - run before the prologue, so an
+ * early exit doesn't pay for the frame
+ *
+ * @param function NT_FUNDEFN node
+ * @returns number of leading statements of the body that run before the
+ * prologue
+ */
+size_t shrinkWrapPoint(Node *function);
+
+#endif  // TLC_OPTIMIZATION_FRAME_H_
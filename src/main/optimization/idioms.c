@@ -0,0 +1,416 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// bit-manipulation idiom recognition implementation
+
+#include "optimization/idioms.h"
+
+#include "optimization/common.h"
+
+enum {
+  MAX_LOAD_BYTES = 8, /**< maximum number of bytes assembled into one load */
+};
+
+/**
+ * is the value a possible width of a rotate?
+ */
+static bool isRotateWidth(int64_t width) {
+  return width == 8 || width == 16 || width == 32 || width == 64;
+}
+/**
+ * is the expression a binary operation of the given type?
+ *
+ * @param exp expression to check - must have parentheses stripped
+ * @param op operation to check for
+ */
+static bool isBinOp(Node const *exp, BinOpType op) {
+  return exp->type == NT_BINOPEXP && exp->data.binOpExp.op == op;
+}
+/**
+ * is the expression a unary operation of the given type?
+ *
+ * @param exp expression to check - must have parentheses stripped
+ * @param op operation to check for
+ */
+static bool isUnOp(Node const *exp, UnOpType op) {
+  return exp->type == NT_UNOPEXP && exp->data.unOpExp.op == op;
+}
+/**
+ * is the expression the given integer literal?
+ */
+static bool isIntegerLiteral(Node *exp, int64_t expected) {
+  int64_t value;
+  return integerLiteralValue(exp, &value) && value == expected;
+}
+/**
+ * is the expression x - 1?
+ *
+ * @param exp expression to check
+ * @param x expected value of x
+ */
+static bool isMinusOne(Node *exp, Node *x) {
+  exp = stripParens(exp);
+  return isBinOp(exp, BO_SUB) && expressionEqual(exp->data.binOpExp.lhs, x) &&
+         isIntegerLiteral(exp->data.binOpExp.rhs, 1);
+}
+/**
+ * skips any casts and parentheses around an expression
+ */
+static Node *stripCasts(Node *exp) {
+  exp = stripParens(exp);
+  while (isBinOp(exp, BO_CAST)) exp = stripParens(exp->data.binOpExp.rhs);
+  return exp;
+}
+
+/**
+ * matches a rotate, given the operands of the or
+ *
+ * @param left left-shifted operand
+ * @param right logical right-shifted operand
+ * @param idiom output idiom
+ */
+static bool matchRotate(Node *left, Node *right, Idiom *idiom) {
+  left = stripParens(left);
+  right = stripParens(right);
+  if (!isBinOp(left, BO_LSHIFT) || !isBinOp(right, BO_LRSHIFT) ||
+      !expressionEqual(left->data.binOpExp.lhs, right->data.binOpExp.lhs))
+    return false;
+
+  Node *leftAmount = stripParens(left->data.binOpExp.rhs);
+  Node *rightAmount = stripParens(right->data.binOpExp.rhs);
+  int64_t leftValue;
+  int64_t rightValue;
+  if (integerLiteralValue(leftAmount, &leftValue) &&
+      integerLiteralValue(rightAmount, &rightValue)) {
+    // constant rotate - (x << n) | (x >>> (width - n)), with width - n folded
+    if (leftValue <= 0 || rightValue <= 0 ||
+        !isRotateWidth(leftValue + rightValue))
+      return false;
+    idiom->kind = IK_ROTL;
+    idiom->operands[1] = leftAmount;
+    idiom->width = (size_t)(leftValue + rightValue);
+  } else if (isBinOp(rightAmount, BO_SUB) &&
+             integerLiteralValue(rightAmount->data.binOpExp.lhs, &rightValue) &&
+             isRotateWidth(rightValue) &&
+             expressionEqual(rightAmount->data.binOpExp.rhs, leftAmount)) {
+    // (x << n) | (x >>> (width - n))
+    idiom->kind = IK_ROTL;
+    idiom->operands[1] = leftAmount;
+    idiom->width = (size_t)rightValue;
+  } else if (isBinOp(leftAmount, BO_SUB) &&
+             integerLiteralValue(leftAmount->data.binOpExp.lhs, &leftValue) &&
+             isRotateWidth(leftValue) &&
+             expressionEqual(leftAmount->data.binOpExp.rhs, rightAmount)) {
+    // (x >>> n) | (x << (width - n))
+    idiom->kind = IK_ROTR;
+    idiom->operands[1] = rightAmount;
+    idiom->width = (size_t)leftValue;
+  } else {
+    return false;
+  }
+
+  idiom->operands[0] = left->data.binOpExp.lhs;
+  idiom->offset = 0;
+  return true;
+}
+
+/**
+ * flattens a tree of ors and adds into its terms
+ *
+ * @param exp expression to flatten
+ * @param terms array of at most MAX_LOAD_BYTES terms to fill
+ * @param numTerms number of terms filled so far
+ * @returns false if there are too many terms
+ */
+static bool collectTerms(Node *exp, Node **terms, size_t *numTerms) {
+  exp = stripParens(exp);
+  if (isBinOp(exp, BO_BITOR) || isBinOp(exp, BO_ADD)) {
+    return collectTerms(exp->data.binOpExp.lhs, terms, numTerms) &&
+           collectTerms(exp->data.binOpExp.rhs, terms, numTerms);
+  } else if (*numTerms == MAX_LOAD_BYTES) {
+    return false;
+  } else {
+    terms[(*numTerms)++] = exp;
+    return true;
+  }
+}
+/**
+ * matches an assembly of bytes from consecutive elements of an array
+ *
+ * @param exp expression to match
+ * @param idiom output idiom
+ */
+static bool matchLoad(Node *exp, Idiom *idiom) {
+  Node *terms[MAX_LOAD_BYTES];
+  size_t numTerms = 0;
+  if (!collectTerms(exp, terms, &numTerms) ||
+      (numTerms != 2 && numTerms != 4 && numTerms != 8))
+    return false;
+
+  Node *base = NULL;
+  int64_t indices[MAX_LOAD_BYTES];
+  int64_t shifts[MAX_LOAD_BYTES];
+  int64_t first = INT64_MAX;
+  for (size_t idx = 0; idx < numTerms; ++idx) {
+    // term = [cast<...>]array[index] [<< shift]
+    Node *term = terms[idx];
+    shifts[idx] = 0;
+    if (isBinOp(term, BO_LSHIFT)) {
+      if (!integerLiteralValue(term->data.binOpExp.rhs, &shifts[idx]))
+        return false;
+      term = term->data.binOpExp.lhs;
+    }
+    term = stripCasts(term);
+    if (!isBinOp(term, BO_ARRAY) ||
+        !integerLiteralValue(term->data.binOpExp.rhs, &indices[idx]))
+      return false;
+    if (base == NULL)
+      base = term->data.binOpExp.lhs;
+    else if (!expressionEqual(base, term->data.binOpExp.lhs))
+      return false;
+    if (indices[idx] < first) first = indices[idx];
+  }
+
+  bool littleEndian = true;
+  bool bigEndian = true;
+  bool seen[MAX_LOAD_BYTES] = {false};
+  for (size_t idx = 0; idx < numTerms; ++idx) {
+    int64_t position = indices[idx] - first;
+    if (position >= (int64_t)numTerms || seen[position]) return false;
+    seen[position] = true;
+    littleEndian = littleEndian && shifts[idx] == 8 * position;
+    bigEndian =
+        bigEndian && shifts[idx] == 8 * ((int64_t)numTerms - 1 - position);
+  }
+  if (!littleEndian && !bigEndian) return false;
+
+  idiom->kind = littleEndian ? IK_LOADLE : IK_LOADBE;
+  idiom->operands[0] = base;
+  idiom->operands[1] = NULL;
+  idiom->width = 8 * numTerms;
+  idiom->offset = first;
+  return true;
+}
+
+/**
+ * matches one side of a three way comparison
+ *
+ * @param exp expression to match
+ * @param greater true if matching a > b, false if matching a < b
+ * @param a output pointer to a
+ * @param b output pointer to b
+ */
+static bool matchComparison(Node *exp, bool greater, Node **a, Node **b) {
+  exp = stripCasts(exp);
+  if (isBinOp(exp, greater ? BO_GT : BO_LT)) {
+    *a = exp->data.binOpExp.lhs;
+    *b = exp->data.binOpExp.rhs;
+    return true;
+  } else if (isBinOp(exp, greater ? BO_LT : BO_GT)) {
+    *a = exp->data.binOpExp.rhs;
+    *b = exp->data.binOpExp.lhs;
+    return true;
+  } else {
+    return false;
+  }
+}
+
+/**
+ * sets up a one or two operand idiom
+ */
+static bool recognized(Idiom *idiom, IdiomKind kind, Node *first,
+                       Node *second) {
+  idiom->kind = kind;
+  idiom->operands[0] = first;
+  idiom->operands[1] = second;
+  idiom->width = 0;
+  idiom->offset = 0;
+  return true;
+}
+
+bool idiomRecognizeExpression(Node *exp, Idiom *idiom) {
+  exp = stripParens(exp);
+  if (exp->type != NT_BINOPEXP) return false;
+
+  Node *lhs = stripParens(exp->data.binOpExp.lhs);
+  Node *rhs = stripParens(exp->data.binOpExp.rhs);
+  switch (exp->data.binOpExp.op) {
+    case BO_BITOR:
+    case BO_ADD:
+    case BO_BITXOR: {
+      if (matchRotate(lhs, rhs, idiom) || matchRotate(rhs, lhs, idiom))
+        return true;
+      if (exp->data.binOpExp.op != BO_BITXOR) return matchLoad(exp, idiom);
+      if (isMinusOne(rhs, lhs))
+        return recognized(idiom, IK_BLSMSK, lhs, NULL);
+      else if (isMinusOne(lhs, rhs))
+        return recognized(idiom, IK_BLSMSK, rhs, NULL);
+      return false;
+    }
+    case BO_BITAND: {
+      if (isMinusOne(rhs, lhs))
+        return recognized(idiom, IK_BLSR, lhs, NULL);
+      else if (isMinusOne(lhs, rhs))
+        return recognized(idiom, IK_BLSR, rhs, NULL);
+      else if (isUnOp(rhs, UO_NEG) &&
+               expressionEqual(rhs->data.unOpExp.target, lhs))
+        return recognized(idiom, IK_BLSI, lhs, NULL);
+      else if (isUnOp(lhs, UO_NEG) &&
+               expressionEqual(lhs->data.unOpExp.target, rhs))
+        return recognized(idiom, IK_BLSI, rhs, NULL);
+      else if (isUnOp(lhs, UO_BITNOT))
+        return recognized(idiom, IK_ANDN, lhs->data.unOpExp.target, rhs);
+      else if (isUnOp(rhs, UO_BITNOT))
+        return recognized(idiom, IK_ANDN, rhs->data.unOpExp.target, lhs);
+      return false;
+    }
+    case BO_SUB: {
+      Node *greaterA;
+      Node *greaterB;
+      Node *lessA;
+      Node *lessB;
+      if (matchComparison(lhs, true, &greaterA, &greaterB) &&
+          matchComparison(rhs, false, &lessA, &lessB) &&
+          expressionEqual(greaterA, lessA) && expressionEqual(greaterB, lessB))
+        return recognized(idiom, IK_THREEWAY, greaterA, greaterB);
+      return false;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * is the expression a test of x against zero? (x != 0, 0 != x, or just x)
+ *
+ * @param exp expression to match
+ * @param x output pointer to x
+ */
+static bool matchNonZeroTest(Node *exp, Node **x) {
+  exp = stripParens(exp);
+  if (isBinOp(exp, BO_NEQ)) {
+    if (isIntegerLiteral(exp->data.binOpExp.rhs, 0)) {
+      *x = stripParens(exp->data.binOpExp.lhs);
+      return true;
+    } else if (isIntegerLiteral(exp->data.binOpExp.lhs, 0)) {
+      *x = stripParens(exp->data.binOpExp.rhs);
+      return true;
+    } else {
+      return false;
+    }
+  } else {
+    *x = exp;
+    return true;
+  }
+}
+/**
+ * is the expression x &= x - 1 or x = x & (x - 1)?
+ */
+static bool isClearLowestBit(Node *exp, Node *x) {
+  exp = stripParens(exp);
+  Idiom blsr;
+  return (isBinOp(exp, BO_BITANDASSIGN) &&
+          expressionEqual(exp->data.binOpExp.lhs, x) &&
+          isMinusOne(exp->data.binOpExp.rhs, x)) ||
+         (isBinOp(exp, BO_ASSIGN) &&
+          expressionEqual(exp->data.binOpExp.lhs, x) &&
+          idiomRecognizeExpression(exp->data.binOpExp.rhs, &blsr) &&
+          blsr.kind == IK_BLSR && expressionEqual(blsr.operands[0], x));
+}
+/**
+ * is the expression ++counter, counter++, or counter += 1?
+ *
+ * @param exp expression to match
+ * @param counter output pointer to the counter
+ */
+static bool matchIncrement(Node *exp, Node **counter) {
+  exp = stripParens(exp);
+  if (isUnOp(exp, UO_PREINC) || isUnOp(exp, UO_POSTINC)) {
+    *counter = stripParens(exp->data.unOpExp.target);
+    return true;
+  } else if (isBinOp(exp, BO_ADDASSIGN) &&
+             isIntegerLiteral(exp->data.binOpExp.rhs, 1)) {
+    *counter = stripParens(exp->data.binOpExp.lhs);
+    return true;
+  } else {
+    return false;
+  }
+}
+/**
+ * gets the expression of an expression statement, possibly wrapped in a
+ * compound statement
+ *
+ * @param stmt statement to look in
+ * @returns expression, or NULL if stmt isn't a single expression statement
+ */
+static Node *singleExpression(Node *stmt) {
+  while (stmt->type == NT_COMPOUNDSTMT &&
+         stmt->data.compoundStmt.stmts->size == 1)
+    stmt = stmt->data.compoundStmt.stmts->elements[0];
+  return stmt->type == NT_EXPRESSIONSTMT ? stmt->data.expressionStmt.expression
+                                         : NULL;
+}
+/**
+ * checks that a popcount loop's variables are distinct plain variables
+ */
+static bool popcountRecognized(Idiom *idiom, Node *x, Node *counter) {
+  if (x->type != NT_ID || counter->type != NT_ID ||
+      expressionEqual(x, counter))
+    return false;
+  return recognized(idiom, IK_POPCOUNT, x, counter);
+}
+
+bool idiomRecognizeStatement(Node *stmt, Idiom *idiom) {
+  Node *x;
+  Node *counter;
+  switch (stmt->type) {
+    case NT_WHILESTMT: {
+      // while (x != 0) { x &= x - 1; ++counter; }, in either order
+      if (!matchNonZeroTest(stmt->data.whileStmt.condition, &x)) return false;
+      Node *body = stmt->data.whileStmt.body;
+      if (body->type != NT_COMPOUNDSTMT ||
+          body->data.compoundStmt.stmts->size != 2)
+        return false;
+      Node *first =
+          singleExpression(body->data.compoundStmt.stmts->elements[0]);
+      Node *second =
+          singleExpression(body->data.compoundStmt.stmts->elements[1]);
+      if (first == NULL || second == NULL) return false;
+      if ((isClearLowestBit(first, x) && matchIncrement(second, &counter)) ||
+          (isClearLowestBit(second, x) && matchIncrement(first, &counter)))
+        return popcountRecognized(idiom, x, counter);
+      return false;
+    }
+    case NT_FORSTMT: {
+      // for (; x != 0; x &= x - 1) ++counter;
+      if (stmt->data.forStmt.initializer->type != NT_NULLSTMT ||
+          stmt->data.forStmt.increment == NULL ||
+          !matchNonZeroTest(stmt->data.forStmt.condition, &x) ||
+          !isClearLowestBit(stmt->data.forStmt.increment, x))
+        return false;
+      Node *body = singleExpression(stmt->data.forStmt.body);
+      if (body == NULL || !matchIncrement(body, &counter)) return false;
+      return popcountRecognized(idiom, x, counter);
+    }
+    default: {
+      return false;
+    }
+  }
+}
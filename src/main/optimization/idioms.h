@@ -0,0 +1,84 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * bit-manipulation idiom recognition
+ *
+ * recognizes hand-written bit twiddling that can be done with a single
+ * instruction, so translation can emit that instruction instead
+ */
+
+#ifndef TLC_OPTIMIZATION_IDIOMS_H_
+#define TLC_OPTIMIZATION_IDIOMS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ast/ast.h"
+
+/** the kind of a recognized idiom */
+typedef enum {
+  IK_ROTL,     /**< (x << n) | (x >>> (width - n)) */
+  IK_ROTR,     /**< (x >>> n) | (x << (width - n)) */
+  IK_LOADLE,   /**< little-endian assembly of bytes, a plain load */
+  IK_LOADBE,   /**< big-endian assembly of bytes, a load and byte swap */
+  IK_BLSR,     /**< x & (x - 1), reset lowest set bit */
+  IK_BLSI,     /**< x & -x, isolate lowest set bit */
+  IK_BLSMSK,   /**< x ^ (x - 1), mask up to lowest set bit */
+  IK_ANDN,     /**< ~x & y */
+  IK_THREEWAY, /**< (a > b) - (a < b), three way comparison */
+  IK_POPCOUNT, /**< loop clearing the lowest set bit of x while counting -
+                  equivalent to counter += popcount(x), x = 0 */
+} IdiomKind;
+
+/** a recognized idiom */
+typedef struct {
+  IdiomKind kind;
+  Node *operands[2]; /**< non-owning references to the operands - x and n for
+                        rotates, the byte array for loads, x for bit
+                        manipulation, x and y for andn, a and b for three way
+                        comparisons, and x and the counter for popcount */
+  size_t width;      /**< width in bits for rotates and loads */
+  int64_t offset;    /**< index of the first byte for loads */
+} Idiom;
+
+/**
+ * recognizes an expression idiom
+ *
+ * idioms are recognized syntactically, so the translation of an idiom must
+ * check that the operand types agree with the idiom - for example, that a
+ * rotated value is as wide as the rotation
+ *
+ * @param exp expression to recognize
+ * @param idiom output pointer to the recognized idiom
+ * @returns whether an idiom was recognized
+ */
+bool idiomRecognizeExpression(Node *exp, Idiom *idiom);
+/**
+ * recognizes a statement idiom (a popcount loop)
+ *
+ * @param stmt statement to recognize
+ * @param idiom output pointer to the recognized idiom
+ * @returns whether an idiom was recognized
+ */
+bool idiomRecognizeStatement(Node *stmt, Idiom *idiom);
+
+#endif  // TLC_OPTIMIZATION_IDIOMS_H_
@@ -0,0 +1,239 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// if-conversion implementation
+
+#include "optimization/ifConversion.h"
+
+#include "optimization/common.h"
+
+size_t const IF_CONVERSION_MAX_COST = 4;
+
+/**
+ * estimates the number of instructions needed to evaluate an expression
+ *
+ * @param exp expression to estimate - must be side effect free
+ */
+static size_t expressionCost(Node *exp) {
+  exp = stripParens(exp);
+  switch (exp->type) {
+    case NT_BINOPEXP: {
+      if (exp->data.binOpExp.op == BO_CAST)
+        return expressionCost(exp->data.binOpExp.rhs);
+      else if (exp->data.binOpExp.op == BO_FIELD)
+        return expressionCost(exp->data.binOpExp.lhs);
+      else
+        return 1 + expressionCost(exp->data.binOpExp.lhs) +
+               expressionCost(exp->data.binOpExp.rhs);
+    }
+    case NT_UNOPEXP: {
+      if (exp->data.unOpExp.op == UO_SIZEOFEXP ||
+          exp->data.unOpExp.op == UO_SIZEOFTYPE)
+        return 0;
+      else
+        return 1 + expressionCost(exp->data.unOpExp.target);
+    }
+    case NT_TERNARYEXP: {
+      return 1 + expressionCost(exp->data.ternaryExp.predicate) +
+             expressionCost(exp->data.ternaryExp.consequent) +
+             expressionCost(exp->data.ternaryExp.alternative);
+    }
+    default: {
+      // literals and ids are immediates or already in registers
+      return 0;
+    }
+  }
+}
+/**
+ * gets the value of an integer constant, possibly negated
+ */
+static bool constantValue(Node *exp, int64_t *value) {
+  exp = stripParens(exp);
+  if (exp->type == NT_UNOPEXP && exp->data.unOpExp.op == UO_NEG) {
+    if (!constantValue(exp->data.unOpExp.target, value)) return false;
+    *value = (int64_t)-(uint64_t)*value;
+    return true;
+  }
+  return integerLiteralValue(exp, value);
+}
+/**
+ * is the expression the given integer constant?
+ */
+static bool isConstant(Node *exp, int64_t expected) {
+  int64_t value;
+  return constantValue(exp, &value) && value == expected;
+}
+/**
+ * is the expression a comparison of the given type?
+ */
+static bool isComparison(Node *exp, BinOpType op) {
+  exp = stripParens(exp);
+  return exp->type == NT_BINOPEXP && exp->data.binOpExp.op == op;
+}
+/**
+ * is the expression a three way comparison written with nested ternaries?
+ *
+ * recognizes a < b ? -1 : a > b ? 1 : 0 and a > b ? 1 : a < b ? -1 : 0
+ */
+static bool isNestedThreeWay(Node *exp, IfConversion *conversion) {
+  Node *outerPredicate = stripParens(exp->data.ternaryExp.predicate);
+  Node *inner = stripParens(exp->data.ternaryExp.alternative);
+  if (inner->type != NT_TERNARYEXP ||
+      !isConstant(inner->data.ternaryExp.alternative, 0))
+    return false;
+  Node *innerPredicate = stripParens(inner->data.ternaryExp.predicate);
+
+  BinOpType innerOp;
+  int64_t outerValue;
+  if (isComparison(outerPredicate, BO_LT)) {
+    innerOp = BO_GT;
+    outerValue = -1;
+  } else if (isComparison(outerPredicate, BO_GT)) {
+    innerOp = BO_LT;
+    outerValue = 1;
+  } else {
+    return false;
+  }
+  Node *lhs = outerPredicate->data.binOpExp.lhs;
+  Node *rhs = outerPredicate->data.binOpExp.rhs;
+  if (!isConstant(exp->data.ternaryExp.consequent, outerValue) ||
+      !isComparison(innerPredicate, innerOp) ||
+      !isConstant(inner->data.ternaryExp.consequent, -outerValue) ||
+      !expressionEqual(innerPredicate->data.binOpExp.lhs, lhs) ||
+      !expressionEqual(innerPredicate->data.binOpExp.rhs, rhs))
+    return false;
+
+  conversion->kind = ICK_THREEWAY;
+  conversion->predicate = lhs;
+  conversion->consequent = rhs;
+  conversion->alternative = NULL;
+  return true;
+}
+/**
+ * picks a branchless lowering for a conditional with the given values
+ *
+ * @param conversion conversion with predicate, consequent, and alternative set
+ */
+static bool classifyValues(IfConversion *conversion) {
+  int64_t consequent;
+  int64_t alternative;
+  if (constantValue(conversion->consequent, &consequent) &&
+      constantValue(conversion->alternative, &alternative)) {
+    if ((consequent == 0 && alternative == -1) ||
+        (consequent == -1 && alternative == 0))
+      conversion->kind = ICK_MASK;
+    else
+      conversion->kind = ICK_SETCC;
+    return true;
+  }
+
+  if (expressionIsSpeculatable(conversion->consequent) &&
+      expressionIsSpeculatable(conversion->alternative) &&
+      expressionCost(conversion->consequent) +
+              expressionCost(conversion->alternative) <=
+          IF_CONVERSION_MAX_COST) {
+    conversion->kind = ICK_SELECT;
+    return true;
+  }
+
+  conversion->kind = ICK_BRANCH;
+  return false;
+}
+
+bool ifConvertExpression(Node *exp, IfConversion *conversion) {
+  exp = stripParens(exp);
+  conversion->kind = ICK_BRANCH;
+  conversion->predicate = NULL;
+  conversion->consequent = NULL;
+  conversion->alternative = NULL;
+  conversion->destination = NULL;
+
+  if (exp->type == NT_BINOPEXP && exp->data.binOpExp.op == BO_SPACESHIP) {
+    conversion->kind = ICK_THREEWAY;
+    conversion->predicate = exp->data.binOpExp.lhs;
+    conversion->consequent = exp->data.binOpExp.rhs;
+    return true;
+  } else if (exp->type != NT_TERNARYEXP) {
+    return false;
+  }
+
+  if (isNestedThreeWay(exp, conversion)) return true;
+
+  conversion->predicate = exp->data.ternaryExp.predicate;
+  conversion->consequent = exp->data.ternaryExp.consequent;
+  conversion->alternative = exp->data.ternaryExp.alternative;
+  return classifyValues(conversion);
+}
+
+/**
+ * gets the assignment a branch of an if statement consists of
+ *
+ * @param stmt branch - a statement, or a compound statement containing only
+ * one statement
+ * @returns the assignment, or NULL if the branch isn't a simple assignment
+ */
+static Node *branchAssignment(Node *stmt) {
+  while (stmt->type == NT_COMPOUNDSTMT) {
+    if (stmt->data.compoundStmt.stmts->size != 1) return NULL;
+    stmt = stmt->data.compoundStmt.stmts->elements[0];
+  }
+  if (stmt->type != NT_EXPRESSIONSTMT) return NULL;
+  Node *exp = stripParens(stmt->data.expressionStmt.expression);
+  if (exp->type != NT_BINOPEXP || exp->data.binOpExp.op != BO_ASSIGN)
+    return NULL;
+  return exp;
+}
+
+bool ifConvertStatement(Node *stmt, IfConversion *conversion) {
+  conversion->kind = ICK_BRANCH;
+  conversion->predicate = NULL;
+  conversion->consequent = NULL;
+  conversion->alternative = NULL;
+  conversion->destination = NULL;
+
+  if (stmt->type != NT_IFSTMT) return false;
+
+  Node *consequent = branchAssignment(stmt->data.ifStmt.consequent);
+  if (consequent == NULL) return false;
+  Node *destination = consequent->data.binOpExp.lhs;
+
+  conversion->predicate = stmt->data.ifStmt.predicate;
+  conversion->consequent = consequent->data.binOpExp.rhs;
+  conversion->destination = destination;
+  if (stmt->data.ifStmt.alternative != NULL) {
+    Node *alternative = branchAssignment(stmt->data.ifStmt.alternative);
+    if (alternative == NULL || !expressionIsPure(destination) ||
+        !expressionEqual(destination, alternative->data.binOpExp.lhs))
+      return false;
+    conversion->alternative = alternative->data.binOpExp.rhs;
+  } else {
+    // the destination is unconditionally stored to, so it must not trap
+    if (!expressionIsSpeculatable(destination)) return false;
+    conversion->alternative = destination;
+  }
+
+  // a hinted branch is declared predictable, so a select, which evaluates
+  // both values, only costs more
+  if (!classifyValues(conversion)) return false;
+  if (conversion->kind == ICK_SELECT && stmt->data.ifStmt.hint != BH_NONE) {
+    conversion->kind = ICK_BRANCH;
+    return false;
+  }
+  return true;
+}
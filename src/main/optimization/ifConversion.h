@@ -0,0 +1,86 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * if-conversion - decides which conditionals should become branchless
+ */
+
+#ifndef TLC_OPTIMIZATION_IFCONVERSION_H_
+#define TLC_OPTIMIZATION_IFCONVERSION_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ast/ast.h"
+
+/** how a conditional should be lowered */
+typedef enum {
+  ICK_BRANCH,   /**< keep the branch */
+  ICK_SETCC,    /**< select between two constants - setcc, then arithmetic */
+  ICK_MASK,     /**< select between 0 and -1 - neg or sbb of the condition */
+  ICK_SELECT,   /**< evaluate both values, then cmov */
+  ICK_THREEWAY, /**< three way comparison - setg, setl, and sub */
+} IfConversionKind;
+
+/** a conditional and how it should be lowered */
+typedef struct {
+  IfConversionKind kind;
+  Node *predicate;   /**< condition - for three way comparisons, the first
+                        operand. Non-owning */
+  Node *consequent;  /**< value if true - for three way comparisons, the second
+                        operand. Non-owning */
+  Node *alternative; /**< value if false - unused for three way comparisons.
+                        Non-owning */
+  Node *destination; /**< for if statements, where the value is stored, null
+                        for expressions. Non-owning */
+} IfConversion;
+
+/**
+ * maximum total cost of the two values of a conditional converted to a
+ * select - both values are always evaluated, so a mispredicted branch must be
+ * more expensive than the cheaper value
+ */
+extern size_t const IF_CONVERSION_MAX_COST;
+
+/**
+ * decides how an expression should be lowered
+ *
+ * handles ternaries, spaceship comparisons, and nested ternaries that are three
+ * way comparisons (a < b ? -1 : a > b ? 1 : 0)
+ *
+ * @param exp expression to consider
+ * @param conversion output pointer to the decision
+ * @returns true if the expression should be lowered without branches
+ */
+bool ifConvertExpression(Node *exp, IfConversion *conversion);
+/**
+ * decides how an if statement should be lowered
+ *
+ * handles if statements whose branches each only assign to the same variable
+ * (or, without an else, whose branch only assigns to a variable). Branches
+ * hinted likely or unlikely are kept, unless both values are constants
+ *
+ * @param stmt statement to consider
+ * @param conversion output pointer to the decision
+ * @returns true if the statement should be lowered without branches
+ */
+bool ifConvertStatement(Node *stmt, IfConversion *conversion);
+
+#endif  // TLC_OPTIMIZATION_IFCONVERSION_H_
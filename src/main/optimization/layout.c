@@ -0,0 +1,303 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// storage layout implementation
+
+#include "optimization/layout.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "options.h"
+#include "util/internalError.h"
+#include "util/numericSizing.h"
+
+enum {
+  WIDEST = 3, /**< index of the 64 bit types */
+};
+
+/** integer types by width, narrowest first */
+static TypeKeyword const UNSIGNED_TYPES[] = {
+    TK_UBYTE,
+    TK_USHORT,
+    TK_UINT,
+    TK_ULONG,
+};
+static TypeKeyword const SIGNED_TYPES[] = {
+    TK_BYTE,
+    TK_SHORT,
+    TK_INT,
+    TK_LONG,
+};
+/** largest value of each unsigned type */
+static uint64_t const *const UNSIGNED_MAXES[] = {
+    &UBYTE_MAX,
+    &USHORT_MAX,
+    &UINT_MAX,
+    &ULONG_MAX,
+};
+/** largest value and absolute value of the smallest value of each signed type
+ */
+static uint64_t const *const SIGNED_MAXES[] = {
+    &BYTE_MAX,
+    &SHORT_MAX,
+    &INT_MAX,
+    &LONG_MAX,
+};
+static uint64_t const *const SIGNED_MINS[] = {
+    &BYTE_MIN,
+    &SHORT_MIN,
+    &INT_MIN,
+    &LONG_MIN,
+};
+
+/**
+ * gets the narrowest width index allowed by -fenum-width
+ */
+static size_t minimumEnumWidth(void) {
+  switch (options.enumWidth) {
+    case OPTION_EW_NARROWEST:
+    case OPTION_EW_8: {
+      return 0;
+    }
+    case OPTION_EW_16: {
+      return 1;
+    }
+    case OPTION_EW_32: {
+      return 2;
+    }
+    case OPTION_EW_64: {
+      return WIDEST;
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid EnumWidthOption enum encountered");
+    }
+  }
+}
+
+TypeKeyword enumStorageType(SymbolTableEntry const *enumEntry) {
+  Vector const *constants = &enumEntry->data.enumType.constantValues;
+
+  uint64_t maxValue = 0;  // largest non-negative constant
+  uint64_t minValue = 0;  // absolute value of the smallest negative constant
+  bool hasNegative = false;
+  for (size_t idx = 0; idx < constants->size; ++idx) {
+    SymbolTableEntry const *constant = constants->elements[idx];
+    if (constant->data.enumConst.signedness &&
+        constant->data.enumConst.data.signedValue < 0) {
+      // negate in unsigned arithmetic to handle LONG_MIN
+      uint64_t magnitude =
+          0 - (uint64_t)constant->data.enumConst.data.signedValue;
+      if (magnitude > minValue) minValue = magnitude;
+      hasNegative = true;
+    } else {
+      // signed enums store their non-negative constants as signed values, but
+      // those have the same representation as the unsigned value
+      uint64_t value = constant->data.enumConst.data.unsignedValue;
+      if (value > maxValue) maxValue = value;
+    }
+  }
+
+  size_t width = minimumEnumWidth();
+  if (hasNegative) {
+    while (width < WIDEST &&
+           (maxValue > *SIGNED_MAXES[width] || minValue > *SIGNED_MINS[width]))
+      ++width;
+    return SIGNED_TYPES[width];
+  } else {
+    while (width < WIDEST && maxValue > *UNSIGNED_MAXES[width]) ++width;
+    return UNSIGNED_TYPES[width];
+  }
+}
+
+/**
+ * lays out a keyword type
+ */
+static void keywordLayout(TypeKeyword keyword, size_t *size) {
+  switch (keyword) {
+    case TK_UBYTE:
+    case TK_BYTE:
+    case TK_BOOL: {
+      *size = BYTE_WIDTH;
+      break;
+    }
+    case TK_CHAR: {
+      *size = CHAR_WIDTH;
+      break;
+    }
+    case TK_USHORT:
+    case TK_SHORT: {
+      *size = SHORT_WIDTH;
+      break;
+    }
+    case TK_UINT:
+    case TK_INT: {
+      *size = INT_WIDTH;
+      break;
+    }
+    case TK_WCHAR: {
+      *size = WCHAR_WIDTH;
+      break;
+    }
+    case TK_ULONG:
+    case TK_LONG: {
+      *size = LONG_WIDTH;
+      break;
+    }
+    case TK_FLOAT: {
+      *size = FLOAT_WIDTH;
+      break;
+    }
+    case TK_DOUBLE: {
+      *size = DOUBLE_WIDTH;
+      break;
+    }
+    case TK_VOID: {
+      error(__FILE__, __LINE__, "attempted to lay out void");
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid TypeKeyword enum encountered");
+    }
+  }
+}
+
+/**
+ * rounds a size up to a multiple of an alignment
+ */
+static size_t alignUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * lays out the fields of a struct
+ *
+ * @param structEntry SK_STRUCT entry
+ * @param stop number of fields to place
+ * @param size output pointer to the offset after the last placed field, or,
+ * if every field was placed, the padded size of the struct
+ * @param alignment output pointer to the alignment of the struct
+ * @returns offset of the field at stop, or the padded size if every field was
+ * placed
+ */
+static size_t structLayout(SymbolTableEntry const *structEntry, size_t stop,
+                           size_t *size, size_t *alignment) {
+  Vector const *fields = &structEntry->data.structType.fieldTypes;
+  size_t offset = 0;
+  size_t structAlignment = 1;
+  for (size_t idx = 0; idx < fields->size; ++idx) {
+    size_t fieldSize;
+    size_t fieldAlignment;
+    typeLayout(fields->elements[idx], &fieldSize, &fieldAlignment);
+    offset = alignUp(offset, fieldAlignment);
+    if (idx == stop) return offset;
+    offset += fieldSize;
+    if (fieldAlignment > structAlignment) structAlignment = fieldAlignment;
+  }
+  *size = alignUp(offset, structAlignment);
+  *alignment = structAlignment;
+  return *size;
+}
+
+/**
+ * lays out a named type
+ */
+static void referenceLayout(SymbolTableEntry const *entry, size_t *size,
+                            size_t *alignment) {
+  switch (entry->kind) {
+    case SK_ENUM: {
+      keywordLayout(enumStorageType(entry), size);
+      *alignment = *size;
+      break;
+    }
+    case SK_STRUCT: {
+      structLayout(entry, SIZE_MAX, size, alignment);
+      break;
+    }
+    case SK_UNION: {
+      Vector const *optionTypes = &entry->data.unionType.optionTypes;
+      size_t unionSize = 0;
+      size_t unionAlignment = 1;
+      for (size_t idx = 0; idx < optionTypes->size; ++idx) {
+        size_t optionSize;
+        size_t optionAlignment;
+        typeLayout(optionTypes->elements[idx], &optionSize, &optionAlignment);
+        if (optionSize > unionSize) unionSize = optionSize;
+        if (optionAlignment > unionAlignment) unionAlignment = optionAlignment;
+      }
+      *size = alignUp(unionSize, unionAlignment);
+      *alignment = unionAlignment;
+      break;
+    }
+    case SK_TYPEDEF: {
+      typeLayout(entry->data.typedefType.actual, size, alignment);
+      break;
+    }
+    case SK_OPAQUE: {
+      if (entry->data.opaqueType.definition == NULL)
+        error(__FILE__, __LINE__, "attempted to lay out an incomplete type");
+      referenceLayout(entry->data.opaqueType.definition, size, alignment);
+      break;
+    }
+    default: {
+      error(__FILE__, __LINE__, "attempted to lay out a non-type symbol");
+    }
+  }
+}
+
+void typeLayout(Type const *type, size_t *size, size_t *alignment) {
+  switch (type->kind) {
+    case TK_KEYWORD: {
+      keywordLayout(type->data.keyword.keyword, size);
+      *alignment = *size;
+      break;
+    }
+    case TK_QUALIFIED: {
+      typeLayout(type->data.qualified.base, size, alignment);
+      break;
+    }
+    case TK_POINTER:
+    case TK_FUNPTR: {
+      *size = POINTER_WIDTH;
+      *alignment = POINTER_WIDTH;
+      break;
+    }
+    case TK_ARRAY: {
+      size_t elementSize;
+      typeLayout(type->data.array.type, &elementSize, alignment);
+      *size = type->data.array.length * elementSize;
+      break;
+    }
+    case TK_REFERENCE: {
+      referenceLayout(type->data.reference.entry, size, alignment);
+      break;
+    }
+    case TK_AGGREGATE: {
+      error(__FILE__, __LINE__, "attempted to lay out an aggregate init type");
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid TypeKind enum encountered");
+    }
+  }
+}
+
+size_t structFieldOffset(SymbolTableEntry const *structEntry, size_t field) {
+  size_t size;
+  size_t alignment;
+  return structLayout(structEntry, field, &size, &alignment);
+}
@@ -0,0 +1,70 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * storage layout of types - sizes, alignments, and field offsets
+ *
+ * enums are stored in the narrowest integer type that holds every one of their
+ * constants, unless -fenum-width pins a wider minimum
+ */
+
+#ifndef TLC_OPTIMIZATION_LAYOUT_H_
+#define TLC_OPTIMIZATION_LAYOUT_H_
+
+#include <stddef.h>
+
+#include "ast/symbolTable.h"
+#include "ast/type.h"
+
+/**
+ * picks the integer type an enum is stored as
+ *
+ * enums without negative constants are stored unsigned; with -fenum-width, the
+ * type is at least as wide as requested, but is still widened if a constant
+ * doesn't fit
+ *
+ * @param enumEntry SK_ENUM entry whose constants have been evaluated
+ * @returns one of the byte, short, int, or long keywords
+ */
+TypeKeyword enumStorageType(SymbolTableEntry const *enumEntry);
+
+/**
+ * lays out a type in memory
+ *
+ * struct fields are placed in order at their natural alignment, and structs
+ * and unions are padded to a multiple of their alignment, so arrays of them
+ * stay aligned
+ *
+ * @param type complete, non-void type to lay out
+ * @param size output pointer to the size in bytes
+ * @param alignment output pointer to the alignment in bytes
+ */
+void typeLayout(Type const *type, size_t *size, size_t *alignment);
+
+/**
+ * finds where a field of a struct is placed
+ *
+ * @param structEntry SK_STRUCT entry
+ * @param field index of the field
+ * @returns offset of the field from the start of the struct, in bytes
+ */
+size_t structFieldOffset(SymbolTableEntry const *structEntry, size_t field);
+
+#endif  // TLC_OPTIMIZATION_LAYOUT_H_
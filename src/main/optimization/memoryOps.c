@@ -0,0 +1,420 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// bulk memory operation lowering implementation
+
+#include "optimization/memoryOps.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "optimization/common.h"
+#include "optimization/layout.h"
+#include "options.h"
+#include "util/functional.h"
+
+/**
+ * adds a move to a plan
+ */
+static void addMove(Vector *moves, size_t offset, size_t width) {
+  MemoryMove *move = malloc(sizeof(MemoryMove));
+  move->offset = offset;
+  move->width = width;
+  vectorInsert(moves, move);
+}
+
+void memoryPlanCreate(size_t size, MemoryPlan *plan) {
+  plan->size = size;
+  vectorInit(&plan->moves);
+
+  if (size > MEMORY_INLINE_LIMIT) {
+    // only processors with enhanced rep movsb are worth the startup cost of
+    // string instructions - the runtime library picks the best loop otherwise
+    plan->strategy =
+        size >= MEMORY_REP_THRESHOLD && options.tune == OPTION_MT_SKYLAKE
+            ? MS_REP
+            : MS_CALL;
+    return;
+  }
+
+  plan->strategy = MS_INLINE;
+  if (size == 0) {
+    return;
+  } else if (size < MEMORY_MOVE_MAX) {
+    // two moves of the widest width that fits, overlapping in the middle
+    size_t width = MEMORY_MOVE_MAX;
+    while (width > size) width /= 2;
+    addMove(&plan->moves, 0, width);
+    if (width != size) addMove(&plan->moves, size - width, width);
+  } else {
+    // full width moves, with the last one overlapping the one before
+    size_t offset = 0;
+    for (; offset + MEMORY_MOVE_MAX <= size; offset += MEMORY_MOVE_MAX)
+      addMove(&plan->moves, offset, MEMORY_MOVE_MAX);
+    if (offset != size)
+      addMove(&plan->moves, size - MEMORY_MOVE_MAX, MEMORY_MOVE_MAX);
+  }
+}
+
+void memoryPlanUninit(MemoryPlan *plan) { vectorUninit(&plan->moves, free); }
+
+/**
+ * gets the struct or union a type names
+ *
+ * @param type stripped type to query
+ * @returns SK_STRUCT or SK_UNION entry, or NULL if the type isn't a struct or
+ * union
+ */
+static SymbolTableEntry const *compositeEntry(Type const *type) {
+  if (type->kind != TK_REFERENCE) return NULL;
+
+  SymbolTableEntry const *entry = type->data.reference.entry;
+  if (entry->kind == SK_OPAQUE) entry = entry->data.opaqueType.definition;
+  if (entry == NULL || (entry->kind != SK_STRUCT && entry->kind != SK_UNION))
+    return NULL;
+  return entry;
+}
+
+/**
+ * gets the type of a field of a struct or union
+ *
+ * @param composite SK_STRUCT or SK_UNION entry
+ * @param field name of the field
+ * @returns type, or NULL if there is no such field
+ */
+static Type const *fieldType(SymbolTableEntry const *composite,
+                             char const *field) {
+  if (composite->kind == SK_STRUCT)
+    return structLookupField(composite, field);
+
+  Vector const *names = &composite->data.unionType.optionNames;
+  for (size_t idx = 0; idx < names->size; ++idx) {
+    if (strcmp(names->elements[idx], field) == 0)
+      return composite->data.unionType.optionTypes.elements[idx];
+  }
+  return NULL;
+}
+
+/**
+ * gets the type of the object an expression refers to
+ *
+ * the typechecker's type is used where it has run - otherwise, the type of a
+ * variable, or an element, field, or dereference of one, is found from the
+ * symbol table
+ *
+ * @param exp expression to query
+ * @returns type, or NULL if unknown
+ */
+static Type const *objectType(Node *exp) {
+  exp = stripParens(exp);
+  switch (exp->type) {
+    case NT_ID:
+    case NT_SCOPEDID: {
+      Type const *type =
+          exp->type == NT_ID ? exp->data.id.type : exp->data.scopedId.type;
+      if (type != NULL) return type;
+      SymbolTableEntry const *entry = exp->type == NT_ID
+                                          ? exp->data.id.entry
+                                          : exp->data.scopedId.entry;
+      return entry != NULL && entry->kind == SK_VARIABLE
+                 ? entry->data.variable.type
+                 : NULL;
+    }
+    case NT_BINOPEXP: {
+      if (exp->data.binOpExp.type != NULL) return exp->data.binOpExp.type;
+      switch (exp->data.binOpExp.op) {
+        case BO_ARRAY: {
+          Type const *array = objectType(exp->data.binOpExp.lhs);
+          if (array == NULL) return NULL;
+          array = stripType(array);
+          switch (array->kind) {
+            case TK_ARRAY: {
+              return array->data.array.type;
+            }
+            case TK_POINTER: {
+              return array->data.pointer.base;
+            }
+            default: {
+              return NULL;
+            }
+          }
+        }
+        case BO_FIELD:
+        case BO_PTRFIELD: {
+          Type const *aggregate = objectType(exp->data.binOpExp.lhs);
+          if (aggregate == NULL) return NULL;
+          aggregate = stripType(aggregate);
+          if (exp->data.binOpExp.op == BO_PTRFIELD) {
+            if (aggregate->kind != TK_POINTER) return NULL;
+            aggregate = stripType(aggregate->data.pointer.base);
+          }
+          SymbolTableEntry const *composite = compositeEntry(aggregate);
+          return composite == NULL
+                     ? NULL
+                     : fieldType(composite, exp->data.binOpExp.rhs->data.id.id);
+        }
+        default: {
+          return NULL;
+        }
+      }
+    }
+    case NT_UNOPEXP: {
+      if (exp->data.unOpExp.type != NULL) return exp->data.unOpExp.type;
+      if (exp->data.unOpExp.op != UO_DEREF) return NULL;
+      Type const *pointer = objectType(exp->data.unOpExp.target);
+      if (pointer == NULL) return NULL;
+      pointer = stripType(pointer);
+      return pointer->kind == TK_POINTER ? pointer->data.pointer.base : NULL;
+    }
+    case NT_TERNARYEXP: {
+      return exp->data.ternaryExp.type;
+    }
+    case NT_FUNCALLEXP: {
+      return exp->data.funCallExp.type;
+    }
+    default: {
+      return NULL;
+    }
+  }
+}
+
+/**
+ * gets the size of an object, if it is a struct, union, or array
+ *
+ * @param exp expression referring to the object
+ * @param size output pointer to the size
+ * @returns whether the object is an aggregate of known type
+ */
+static bool aggregateSize(Node *exp, size_t *size) {
+  Type const *type = objectType(exp);
+  if (type == NULL) return false;
+  type = stripType(type);
+  if (type->kind != TK_ARRAY && compositeEntry(type) == NULL) return false;
+
+  size_t alignment;
+  typeLayout(type, size, &alignment);
+  return true;
+}
+
+bool assignmentPlanCreate(Node *exp, MemoryPlan *plan) {
+  exp = stripParens(exp);
+  size_t size;
+  if (exp->type != NT_BINOPEXP || exp->data.binOpExp.op != BO_ASSIGN ||
+      !aggregateSize(exp->data.binOpExp.lhs, &size))
+    return false;
+
+  memoryPlanCreate(size, plan);
+  return true;
+}
+
+bool argumentPlanCreate(Node *argument, MemoryPlan *plan) {
+  size_t size;
+  if (!aggregateSize(argument, &size) || size <= MEMORY_REGISTER_ARGUMENT_MAX)
+    return false;
+
+  memoryPlanCreate(size, plan);
+  return true;
+}
+
+/**
+ * adds a store to a list of stores
+ */
+static void addStore(Vector *stores, size_t offset, size_t width, Node *value,
+                     size_t element) {
+  InitStore *store = malloc(sizeof(InitStore));
+  store->offset = offset;
+  store->width = width;
+  store->value = value;
+  store->element = element;
+  vectorInsert(stores, store);
+}
+
+/**
+ * splits an initializer into the stores of its scalar elements
+ *
+ * @param type type of the initialized object
+ * @param value nullable initializer - NULL if the object is zero
+ * @param offset offset of the object
+ * @param stores vector of InitStore to add to
+ */
+static void collectStores(Type const *type, Node *value, size_t offset,
+                          Vector *stores) {
+  type = stripType(type);
+  size_t size;
+  size_t alignment;
+  typeLayout(type, &size, &alignment);
+
+  if (value == NULL || value->type != NT_LITERAL) {
+    addStore(stores, offset, size, value, 0);
+    return;
+  }
+
+  SymbolTableEntry const *composite = compositeEntry(type);
+  if (value->data.literal.literalType == LT_AGGREGATEINIT &&
+      type->kind == TK_ARRAY) {
+    Vector *elements = value->data.literal.data.aggregateInitVal;
+    Type const *elementType = type->data.array.type;
+    size_t elementSize;
+    typeLayout(elementType, &elementSize, &alignment);
+    for (size_t idx = 0; idx < type->data.array.length; ++idx)
+      collectStores(elementType,
+                    idx < elements->size ? elements->elements[idx] : NULL,
+                    offset + idx * elementSize, stores);
+  } else if (value->data.literal.literalType == LT_AGGREGATEINIT &&
+             composite != NULL && composite->kind == SK_STRUCT) {
+    Vector *elements = value->data.literal.data.aggregateInitVal;
+    Vector const *fieldTypes = &composite->data.structType.fieldTypes;
+    for (size_t idx = 0; idx < fieldTypes->size; ++idx)
+      collectStores(fieldTypes->elements[idx],
+                    idx < elements->size ? elements->elements[idx] : NULL,
+                    offset + structFieldOffset(composite, idx), stores);
+  } else if (value->data.literal.literalType == LT_PACKEDINIT &&
+             type->kind == TK_ARRAY) {
+    PackedInit const *packed = value->data.literal.data.packedInitVal;
+    size_t elementSize;
+    typeLayout(type->data.array.type, &elementSize, &alignment);
+    for (size_t idx = 0; idx < type->data.array.length; ++idx)
+      addStore(stores, offset + idx * elementSize, elementSize,
+               idx < packed->length ? value : NULL, idx);
+  } else {
+    addStore(stores, offset, size, value, 0);
+  }
+}
+
+/**
+ * does a store write only zero bits?
+ */
+static bool storeIsZero(InitStore const *store) {
+  if (store->value == NULL) return true;
+  if (store->value->type == NT_LITERAL &&
+      store->value->data.literal.literalType == LT_PACKEDINIT)
+    return packedInitGet(store->value->data.literal.data.packedInitVal,
+                         store->element) == 0;
+  return literalIsZero(store->value);
+}
+
+void initPlanCreate(Type const *type, Node *initializer, InitPlan *plan) {
+  Vector stores;
+  vectorInit(&stores);
+  collectStores(type, initializer, 0, &stores);
+
+  size_t size;
+  size_t alignment;
+  typeLayout(type, &size, &alignment);
+  size_t nonzeroSize = 0;
+  for (size_t idx = 0; idx < stores.size; ++idx) {
+    InitStore const *store = stores.elements[idx];
+    if (!storeIsZero(store)) nonzeroSize += store->width;
+  }
+
+  // mostly zero - one bulk zeroing is cheaper than storing each zero
+  plan->zeroFirst = nonzeroSize * 2 < size;
+  memoryPlanCreate(plan->zeroFirst ? size : 0, &plan->zero);
+  vectorInit(&plan->stores);
+  for (size_t idx = 0; idx < stores.size; ++idx) {
+    InitStore *store = stores.elements[idx];
+    if (plan->zeroFirst && storeIsZero(store))
+      free(store);
+    else
+      vectorInsert(&plan->stores, store);
+  }
+  vectorUninit(&stores, nullDtor);
+}
+
+void initPlanUninit(InitPlan *plan) {
+  memoryPlanUninit(&plan->zero);
+  vectorUninit(&plan->stores, free);
+}
+
+/**
+ * is a block of memory copied or zeroed with a call?
+ */
+static bool sizeNeedsCall(size_t size) {
+  MemoryPlan plan;
+  memoryPlanCreate(size, &plan);
+  bool calls = plan.strategy == MS_CALL;
+  memoryPlanUninit(&plan);
+  return calls;
+}
+
+/**
+ * does an initialization call memcpy or memset?
+ */
+static bool initNeedsCall(Type const *type, Node *initializer) {
+  InitPlan plan;
+  initPlanCreate(type, initializer, &plan);
+  bool calls = plan.zeroFirst && plan.zero.strategy == MS_CALL;
+  for (size_t idx = 0; !calls && idx < plan.stores.size; ++idx) {
+    InitStore const *store = plan.stores.elements[idx];
+    calls = store->width > MEMORY_MOVE_MAX && sizeNeedsCall(store->width);
+  }
+  initPlanUninit(&plan);
+  return calls;
+}
+
+/**
+ * looks for a bulk memory operation lowered to a call
+ */
+static bool findMemoryCall(Node *node, void *data) {
+  bool *found = data;
+  switch (node->type) {
+    case NT_BINOPEXP: {
+      MemoryPlan plan;
+      if (assignmentPlanCreate(node, &plan)) {
+        if (plan.strategy == MS_CALL) *found = true;
+        memoryPlanUninit(&plan);
+      }
+      break;
+    }
+    case NT_FUNCALLEXP: {
+      Vector *arguments = node->data.funCallExp.arguments;
+      for (size_t idx = 0; !*found && idx < arguments->size; ++idx) {
+        MemoryPlan plan;
+        if (argumentPlanCreate(arguments->elements[idx], &plan)) {
+          if (plan.strategy == MS_CALL) *found = true;
+          memoryPlanUninit(&plan);
+        }
+      }
+      break;
+    }
+    case NT_VARDEFNSTMT: {
+      Vector *names = node->data.varDefnStmt.names;
+      Vector *initializers = node->data.varDefnStmt.initializers;
+      for (size_t idx = 0; !*found && idx < names->size; ++idx) {
+        Node *name = names->elements[idx];
+        Node *initializer = initializers->elements[idx];
+        SymbolTableEntry const *entry = name->data.id.entry;
+        if (initializer != NULL && entry != NULL &&
+            entry->kind == SK_VARIABLE &&
+            initNeedsCall(entry->data.variable.type, initializer))
+          *found = true;
+      }
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+  return !*found;
+}
+bool nodeContainsMemoryCall(Node *node) {
+  bool found = false;
+  nodeVisit(node, findMemoryCall, &found);
+  return found;
+}
\ No newline at end of file
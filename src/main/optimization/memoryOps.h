@@ -0,0 +1,163 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * lowering of aggregate copies, zeroing, and initialization to bulk memory
+ * operations
+ *
+ * struct, union, and array assignments, struct arguments passed on the stack,
+ * and aggregate initializers of locals are lowered by size, not element by
+ * element
+ */
+
+#ifndef TLC_OPTIMIZATION_MEMORYOPS_H_
+#define TLC_OPTIMIZATION_MEMORYOPS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ast/ast.h"
+#include "util/container/vector.h"
+
+enum {
+  MEMORY_MOVE_MAX = 16,      /**< widest move - an SSE register */
+  MEMORY_INLINE_LIMIT = 256, /**< largest size done with inline moves */
+  MEMORY_REP_THRESHOLD = 2048, /**< smallest size done with rep movsb or rep
+                                  stosb, if the processor makes them fast */
+  MEMORY_REGISTER_ARGUMENT_MAX = 16, /**< largest aggregate argument passed in
+                                        registers - larger ones are copied to
+                                        the stack */
+};
+
+/** how a block of memory is copied or zeroed */
+typedef enum {
+  MS_INLINE, /**< a sequence of moves */
+  MS_REP,    /**< rep movsb or rep stosb */
+  MS_CALL,   /**< call to memcpy or memset */
+} MemoryStrategy;
+
+/** one load and store, or one zeroing store */
+typedef struct {
+  size_t offset; /**< bytes from the start of the block */
+  size_t width;  /**< 1, 2, 4, 8, or 16 bytes */
+} MemoryMove;
+
+/** a lowered copy or zeroing of a block of memory */
+typedef struct {
+  MemoryStrategy strategy;
+  size_t size;  /**< bytes in the block */
+  Vector moves; /**< vector of MemoryMove, empty unless strategy is MS_INLINE */
+} MemoryPlan;
+
+/** one store of an initializer */
+typedef struct {
+  size_t offset; /**< bytes from the start of the object */
+  size_t width;  /**< bytes stored */
+  Node *value;   /**< non-owning literal stored, or NULL if the bytes are zero
+                    bits not written by any literal - a store wider than
+                    MEMORY_MOVE_MAX is lowered with its own MemoryPlan */
+  size_t element; /**< index of the element stored, if value is a packed
+                     initializer */
+} InitStore;
+
+/** a lowered aggregate initialization */
+typedef struct {
+  bool zeroFirst;  /**< is the object zeroed before the stores */
+  MemoryPlan zero; /**< plan zeroing the object, if zeroFirst */
+  Vector stores;   /**< vector of InitStore, non-zero stores only if zeroFirst
+                      */
+} InitPlan;
+
+/**
+ * plans a copy or zeroing of a block of memory
+ *
+ * blocks up to MEMORY_INLINE_LIMIT bytes are moved inline - blocks that aren't
+ * a multiple of the move width finish with a move overlapping the previous
+ * one, instead of a series of narrower moves. Larger blocks use rep movsb or
+ * rep stosb when tuning for a processor with fast string instructions, and
+ * call the runtime library otherwise
+ *
+ * @param size bytes in the block
+ * @param plan output pointer to the plan, must be uninitialized with
+ * memoryPlanUninit
+ */
+void memoryPlanCreate(size_t size, MemoryPlan *plan);
+
+/**
+ * uninitializes a memory plan
+ *
+ * @param plan plan to uninitialize
+ */
+void memoryPlanUninit(MemoryPlan *plan);
+
+/**
+ * plans an assignment, if it assigns a struct, union, or array
+ *
+ * the destination may be a variable, or an element, field, or dereference of
+ * one - or anything else, once the typechecker has given it a type
+ *
+ * @param exp expression to query
+ * @param plan output pointer to the plan, initialized only if this returns
+ * true
+ * @returns whether exp is an aggregate assignment to a destination of known
+ * type
+ */
+bool assignmentPlanCreate(Node *exp, MemoryPlan *plan);
+
+/**
+ * plans the copy of an argument to the stack, if it is a struct, union, or
+ * array too large to be passed in registers
+ *
+ * @param argument argument expression of a call
+ * @param plan output pointer to the plan, initialized only if this returns
+ * true
+ * @returns whether argument is passed by copying it to the stack
+ */
+bool argumentPlanCreate(Node *argument, MemoryPlan *plan);
+
+/**
+ * plans the initialization of an object by an initializer literal
+ *
+ * mostly zero initializers zero the whole object, then store only their
+ * non-zero elements
+ *
+ * @param type type of the initialized object
+ * @param initializer literal initializing the object
+ * @param plan output pointer to the plan, must be uninitialized with
+ * initPlanUninit
+ */
+void initPlanCreate(Type const *type, Node *initializer, InitPlan *plan);
+
+/**
+ * uninitializes an initialization plan
+ *
+ * @param plan plan to uninitialize
+ */
+void initPlanUninit(InitPlan *plan);
+
+/**
+ * does a node contain an aggregate assignment, argument copy, or local
+ * initialization lowered to a call to memcpy or memset?
+ *
+ * @param node nullable node to search
+ */
+bool nodeContainsMemoryCall(Node *node);
+
+#endif  // TLC_OPTIMIZATION_MEMORYOPS_H_
@@ -0,0 +1,1000 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// mod/ref analysis implementation
+
+#include "optimization/modRef.h"
+
+#include <stdlib.h>
+
+#include "fileList.h"
+#include "optimization/common.h"
+#include "util/container/hashMap.h"
+#include "util/functional.h"
+
+/** how an expression is used */
+typedef enum {
+  AK_READ,      /**< the value is read, and may escape */
+  AK_WRITE,     /**< the storage is written */
+  AK_READWRITE, /**< the storage is read, then written */
+  AK_POINTER,   /**< the value is read, but only compared or dereferenced */
+  AK_ADDRESS,   /**< the address of the storage is taken */
+} AccessKind;
+
+/** state while summarizing a function */
+typedef struct {
+  ModRef const *modRef;
+  PointerSet const *globals; /**< set of SymbolTableEntry of every global */
+  Vector arguments;         /**< vector of nullable SymbolTableEntry - NULL if
+                               the argument isn't a pointer */
+  FunctionSummary *summary; /**< summary being built */
+  bool changed;             /**< has the summary grown? */
+} Summarizer;
+
+/**
+ * is a type, or the element type of an array type, volatile qualified?
+ *
+ * @param type type to query
+ */
+static bool typeIsVolatile(Type const *type) {
+  switch (type->kind) {
+    case TK_QUALIFIED: {
+      return type->data.qualified.volatileQual ||
+             typeIsVolatile(type->data.qualified.base);
+    }
+    case TK_ARRAY: {
+      return typeIsVolatile(type->data.array.type);
+    }
+    case TK_REFERENCE: {
+      SymbolTableEntry const *entry = type->data.reference.entry;
+      return entry->kind == SK_TYPEDEF &&
+             typeIsVolatile(entry->data.typedefType.actual);
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * gets the type a pointer or array variable points to
+ *
+ * @param variable SK_VARIABLE stab entry
+ * @returns pointed-to type, or NULL if the variable isn't a pointer or an
+ * array
+ */
+static Type const *pointedToType(SymbolTableEntry const *variable) {
+  Type const *type = stripType(variable->data.variable.type);
+  switch (type->kind) {
+    case TK_POINTER: {
+      return type->data.pointer.base;
+    }
+    case TK_ARRAY: {
+      return type->data.array.type;
+    }
+    default: {
+      return NULL;
+    }
+  }
+}
+
+/**
+ * does a pointer expression cast its pointer to a pointer to volatile memory?
+ *
+ * looks along the same path pointerRoot follows, since the root's own type
+ * doesn't show a cast's qualifiers
+ *
+ * @param exp pointer expression
+ */
+static bool pointerCastToVolatile(Node *exp) {
+  exp = stripParens(exp);
+  if (exp->type != NT_BINOPEXP) return false;
+
+  switch (exp->data.binOpExp.op) {
+    case BO_ADD: {
+      return pointerCastToVolatile(exp->data.binOpExp.lhs) ||
+             pointerCastToVolatile(exp->data.binOpExp.rhs);
+    }
+    case BO_SUB: {
+      return pointerCastToVolatile(exp->data.binOpExp.lhs);
+    }
+    case BO_CAST: {
+      Type const *type = stripType(exp->data.binOpExp.type);
+      return (type->kind == TK_POINTER &&
+              typeIsVolatile(type->data.pointer.base)) ||
+             pointerCastToVolatile(exp->data.binOpExp.rhs);
+    }
+    case BO_SEQ: {
+      return pointerCastToVolatile(exp->data.binOpExp.rhs);
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * is a variable an array, so using it as a pointer gives its own address?
+ *
+ * @param variable SK_VARIABLE stab entry
+ */
+static bool variableIsArray(SymbolTableEntry const *variable) {
+  return stripType(variable->data.variable.type)->kind == TK_ARRAY;
+}
+
+/**
+ * gets the variable referenced by an id or scoped id
+ *
+ * @param exp expression, not parenthesized
+ * @returns SK_VARIABLE stab entry, or NULL if the expression isn't a variable
+ */
+static SymbolTableEntry *variableOf(Node *exp) {
+  SymbolTableEntry *entry;
+  switch (exp->type) {
+    case NT_ID: {
+      entry = exp->data.id.entry;
+      break;
+    }
+    case NT_SCOPEDID: {
+      entry = exp->data.scopedId.entry;
+      break;
+    }
+    default: {
+      return NULL;
+    }
+  }
+  return entry != NULL && entry->kind == SK_VARIABLE ? entry : NULL;
+}
+
+static SymbolTableEntry *lvalueRoot(Node *exp, bool *addressOf);
+/**
+ * finds the variable a pointer expression is based on
+ *
+ * @param exp pointer expression
+ * @param addressOf output - does the pointer point to the variable itself,
+ * instead of to what the variable points to?
+ * @returns SK_VARIABLE stab entry, or NULL if unknown
+ */
+static SymbolTableEntry *pointerRoot(Node *exp, bool *addressOf) {
+  exp = stripParens(exp);
+  switch (exp->type) {
+    case NT_ID:
+    case NT_SCOPEDID: {
+      SymbolTableEntry *variable = variableOf(exp);
+      if (variable == NULL || pointedToType(variable) == NULL) return NULL;
+      *addressOf = variableIsArray(variable);
+      return variable;
+    }
+    case NT_BINOPEXP: {
+      switch (exp->data.binOpExp.op) {
+        case BO_ADD: {
+          // pointer arithmetic - the pointer may be on either side
+          SymbolTableEntry *root =
+              pointerRoot(exp->data.binOpExp.lhs, addressOf);
+          return root != NULL ? root
+                              : pointerRoot(exp->data.binOpExp.rhs, addressOf);
+        }
+        case BO_SUB: {
+          return pointerRoot(exp->data.binOpExp.lhs, addressOf);
+        }
+        case BO_CAST:
+        case BO_SEQ: {
+          return pointerRoot(exp->data.binOpExp.rhs, addressOf);
+        }
+        default: {
+          return NULL;
+        }
+      }
+    }
+    case NT_UNOPEXP: {
+      return exp->data.unOpExp.op == UO_ADDROF
+                 ? lvalueRoot(exp->data.unOpExp.target, addressOf)
+                 : NULL;
+    }
+    default: {
+      return NULL;
+    }
+  }
+}
+/**
+ * finds the variable an lvalue is part of
+ *
+ * @param exp lvalue expression
+ * @param addressOf output - is the lvalue part of the variable itself, instead
+ * of part of what the variable points to?
+ * @returns SK_VARIABLE stab entry, or NULL if unknown
+ */
+static SymbolTableEntry *lvalueRoot(Node *exp, bool *addressOf) {
+  exp = stripParens(exp);
+  switch (exp->type) {
+    case NT_ID:
+    case NT_SCOPEDID: {
+      *addressOf = true;
+      return variableOf(exp);
+    }
+    case NT_BINOPEXP: {
+      switch (exp->data.binOpExp.op) {
+        case BO_FIELD: {
+          return lvalueRoot(exp->data.binOpExp.lhs, addressOf);
+        }
+        case BO_PTRFIELD:
+        case BO_ARRAY: {
+          return pointerRoot(exp->data.binOpExp.lhs, addressOf);
+        }
+        default: {
+          return NULL;
+        }
+      }
+    }
+    case NT_UNOPEXP: {
+      return exp->data.unOpExp.op == UO_DEREF
+                 ? pointerRoot(exp->data.unOpExp.target, addressOf)
+                 : NULL;
+    }
+    default: {
+      return NULL;
+    }
+  }
+}
+
+/**
+ * gets the entry a declaration entry is defined by
+ *
+ * @param modRef ModRef to search
+ * @param entry entry to look up
+ * @returns definition's entry, or NULL if the entry is a definition or is
+ * never defined
+ */
+static SymbolTableEntry *definitionOf(ModRef const *modRef,
+                                      SymbolTableEntry const *entry) {
+  return pointerMapGet(&modRef->aliases, entry);
+}
+/**
+ * gets the entry that stands for a symbol in summaries
+ *
+ * @param modRef ModRef to search
+ * @param entry entry to look up
+ * @returns definition's entry, or entry if it's a definition or is never
+ * defined
+ */
+static SymbolTableEntry const *canonicalEntry(ModRef const *modRef,
+                                              SymbolTableEntry const *entry) {
+  SymbolTableEntry const *definition = definitionOf(modRef, entry);
+  return definition != NULL ? definition : entry;
+}
+
+/**
+ * adds a global to a summary's read or write set
+ *
+ * @param s summarizer to update
+ * @param set summary's reads or writes
+ * @param global canonical entry of the global
+ */
+static void addGlobal(Summarizer *s, PointerSet *set,
+                      SymbolTableEntry *global) {
+  if (pointerSetPut(set, global) == 0) s->changed = true;
+}
+
+/**
+ * sets a summary flag
+ *
+ * @param s summarizer to update
+ * @param flag flag in the summary to set
+ */
+static void setFlag(Summarizer *s, bool *flag) {
+  if (!*flag) {
+    *flag = true;
+    s->changed = true;
+  }
+}
+
+/**
+ * adds effects to an argument of the summarized function
+ *
+ * @param s summarizer to update
+ * @param variable argument's stab entry
+ * @param effects ArgumentEffect flags to add
+ * @returns whether the variable is a pointer argument
+ */
+static bool addArgumentEffects(Summarizer *s, SymbolTableEntry const *variable,
+                               unsigned effects) {
+  for (size_t idx = 0; idx < s->arguments.size; ++idx) {
+    if (s->arguments.elements[idx] == variable) {
+      unsigned *argumentEffects = &s->summary->argumentEffects[idx];
+      if ((*argumentEffects | effects) != *argumentEffects) {
+        *argumentEffects |= effects;
+        s->changed = true;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * records an access to a variable
+ *
+ * @param s summarizer to update
+ * @param variable nullable stab entry - ignored unless it's a variable
+ * @param access how the variable is accessed
+ */
+static void accessVariable(Summarizer *s, SymbolTableEntry *variable,
+                           AccessKind access) {
+  if (variable == NULL || variable->kind != SK_VARIABLE) return;
+
+  if (typeIsVolatile(variable->data.variable.type)) {
+    setFlag(s, &s->summary->opaque);
+    return;
+  }
+
+  if (pointerSetContains(s->globals, variable)) {
+    SymbolTableEntry *global = definitionOf(s->modRef, variable);
+    if (global == NULL) global = variable;
+    switch (access) {
+      case AK_READ: {
+        addGlobal(s, &s->summary->reads, global);
+        break;
+      }
+      case AK_POINTER: {
+        // an array used as a pointer is just its address
+        if (!variableIsArray(variable))
+          addGlobal(s, &s->summary->reads, global);
+        break;
+      }
+      case AK_WRITE: {
+        addGlobal(s, &s->summary->writes, global);
+        break;
+      }
+      default: {
+        // read-modify-write, or address could be used for either
+        addGlobal(s, &s->summary->reads, global);
+        addGlobal(s, &s->summary->writes, global);
+        break;
+      }
+    }
+  } else if (access == AK_READ || access == AK_ADDRESS) {
+    // the argument's value, and so the memory it points to, escapes
+    addArgumentEffects(s, variable, AE_ESCAPE);
+  }
+}
+
+/**
+ * records an access to the memory a pointer points to
+ *
+ * @param s summarizer to update
+ * @param pointer pointer expression
+ * @param access how the pointed-to memory is accessed
+ */
+static void accessMemory(Summarizer *s, Node *pointer, AccessKind access) {
+  if (pointerCastToVolatile(pointer)) {
+    // volatile access through a cast, even to an ordinary variable
+    setFlag(s, &s->summary->opaque);
+    return;
+  }
+
+  bool addressOf;
+  SymbolTableEntry *root = pointerRoot(pointer, &addressOf);
+
+  if (root != NULL && addressOf) {
+    // points to a variable - the access is to the variable itself
+    accessVariable(s, root, access == AK_POINTER ? AK_READ : access);
+    return;
+  }
+
+  if (root != NULL && typeIsVolatile(pointedToType(root))) {
+    setFlag(s, &s->summary->opaque);
+    return;
+  }
+
+  unsigned effects;
+  switch (access) {
+    case AK_WRITE: {
+      effects = AE_WRITE;
+      break;
+    }
+    case AK_READWRITE: {
+      effects = AE_READ | AE_WRITE;
+      break;
+    }
+    case AK_ADDRESS: {
+      effects = AE_ESCAPE;
+      break;
+    }
+    default: {
+      effects = AE_READ;
+      break;
+    }
+  }
+  if (root != NULL && addArgumentEffects(s, root, effects)) return;
+
+  // may point anywhere
+  if ((effects & AE_READ) != 0) setFlag(s, &s->summary->readsUnknown);
+  if ((effects & AE_WRITE) != 0) setFlag(s, &s->summary->writesUnknown);
+}
+
+static void summarizeCall(Summarizer *s, Node *call);
+/**
+ * records the accesses an expression makes
+ *
+ * @param s summarizer to update
+ * @param exp expression to summarize
+ * @param access how the result of the expression is used
+ */
+static void summarizeExpression(Summarizer *s, Node *exp, AccessKind access) {
+  switch (exp->type) {
+    case NT_ID:
+    case NT_SCOPEDID: {
+      accessVariable(s, variableOf(exp), access);
+      break;
+    }
+    case NT_BINOPEXP: {
+      Node *lhs = exp->data.binOpExp.lhs;
+      Node *rhs = exp->data.binOpExp.rhs;
+      switch (exp->data.binOpExp.op) {
+        case BO_ASSIGN: {
+          summarizeExpression(s, lhs, AK_WRITE);
+          summarizeExpression(s, rhs, AK_READ);
+          break;
+        }
+        case BO_MULASSIGN:
+        case BO_DIVASSIGN:
+        case BO_MODASSIGN:
+        case BO_ADDASSIGN:
+        case BO_SUBASSIGN:
+        case BO_LSHIFTASSIGN:
+        case BO_ARSHIFTASSIGN:
+        case BO_LRSHIFTASSIGN:
+        case BO_BITANDASSIGN:
+        case BO_BITXORASSIGN:
+        case BO_BITORASSIGN:
+        case BO_LANDASSIGN:
+        case BO_LORASSIGN: {
+          summarizeExpression(s, lhs, AK_READWRITE);
+          summarizeExpression(s, rhs, AK_READ);
+          break;
+        }
+        case BO_SEQ: {
+          summarizeExpression(s, lhs, AK_POINTER);
+          summarizeExpression(s, rhs, access);
+          break;
+        }
+        case BO_LAND:
+        case BO_LOR:
+        case BO_EQ:
+        case BO_NEQ:
+        case BO_LT:
+        case BO_GT:
+        case BO_LTEQ:
+        case BO_GTEQ:
+        case BO_SPACESHIP: {
+          summarizeExpression(s, lhs, AK_POINTER);
+          summarizeExpression(s, rhs, AK_POINTER);
+          break;
+        }
+        case BO_ADD:
+        case BO_SUB: {
+          // pointer arithmetic - the result is the pointer
+          AccessKind operandAccess =
+              access == AK_POINTER ? AK_POINTER : AK_READ;
+          summarizeExpression(s, lhs, operandAccess);
+          summarizeExpression(s, rhs, operandAccess);
+          break;
+        }
+        case BO_FIELD: {
+          // rhs is the field name
+          summarizeExpression(s, lhs, access);
+          break;
+        }
+        case BO_PTRFIELD: {
+          summarizeExpression(s, lhs, AK_POINTER);
+          accessMemory(s, lhs, access);
+          break;
+        }
+        case BO_ARRAY: {
+          summarizeExpression(s, lhs, AK_POINTER);
+          summarizeExpression(s, rhs, AK_READ);
+          accessMemory(s, lhs, access);
+          break;
+        }
+        case BO_CAST: {
+          // lhs is the type
+          summarizeExpression(s, rhs, access);
+          break;
+        }
+        default: {
+          summarizeExpression(s, lhs, AK_READ);
+          summarizeExpression(s, rhs, AK_READ);
+          break;
+        }
+      }
+      break;
+    }
+    case NT_TERNARYEXP: {
+      summarizeExpression(s, exp->data.ternaryExp.predicate, AK_POINTER);
+      summarizeExpression(s, exp->data.ternaryExp.consequent, access);
+      summarizeExpression(s, exp->data.ternaryExp.alternative, access);
+      break;
+    }
+    case NT_UNOPEXP: {
+      Node *target = exp->data.unOpExp.target;
+      switch (exp->data.unOpExp.op) {
+        case UO_DEREF: {
+          summarizeExpression(s, target, AK_POINTER);
+          accessMemory(s, target, access);
+          break;
+        }
+        case UO_ADDROF: {
+          summarizeExpression(s, target, AK_ADDRESS);
+          break;
+        }
+        case UO_PREINC:
+        case UO_PREDEC:
+        case UO_POSTINC:
+        case UO_POSTDEC:
+        case UO_NEGASSIGN:
+        case UO_LNOTASSIGN:
+        case UO_BITNOTASSIGN: {
+          summarizeExpression(s, target, AK_READWRITE);
+          break;
+        }
+        case UO_SIZEOFEXP:
+        case UO_SIZEOFTYPE: {
+          // not evaluated
+          break;
+        }
+        case UO_PARENS: {
+          summarizeExpression(s, target, access);
+          break;
+        }
+        case UO_LNOT: {
+          summarizeExpression(s, target, AK_POINTER);
+          break;
+        }
+        default: {
+          summarizeExpression(s, target, AK_READ);
+          break;
+        }
+      }
+      break;
+    }
+    case NT_FUNCALLEXP: {
+      summarizeCall(s, exp);
+      break;
+    }
+    default: {
+      // literals have no effects
+      break;
+    }
+  }
+}
+
+/**
+ * records the effects of a call
+ *
+ * @param s summarizer to update
+ * @param call NT_FUNCALLEXP node
+ */
+static void summarizeCall(Summarizer *s, Node *call) {
+  SymbolTableEntry *calleeEntry = directCallee(call);
+  FunctionSummary const *callee =
+      calleeEntry == NULL ? NULL : modRefSummaryOf(s->modRef, calleeEntry);
+
+  if (callee == NULL) {
+    // indirect call, or to a function in no file
+    summarizeExpression(s, call->data.funCallExp.function, AK_READ);
+    setFlag(s, &s->summary->opaque);
+  } else {
+    if (callee->opaque) setFlag(s, &s->summary->opaque);
+    if (callee->readsUnknown) setFlag(s, &s->summary->readsUnknown);
+    if (callee->writesUnknown) setFlag(s, &s->summary->writesUnknown);
+    for (size_t idx = 0; idx < callee->reads.capacity; ++idx) {
+      if (callee->reads.elements[idx] != NULL)
+        addGlobal(s, &s->summary->reads, callee->reads.elements[idx]);
+    }
+    for (size_t idx = 0; idx < callee->writes.capacity; ++idx) {
+      if (callee->writes.elements[idx] != NULL)
+        addGlobal(s, &s->summary->writes, callee->writes.elements[idx]);
+    }
+  }
+
+  Vector *arguments = call->data.funCallExp.arguments;
+  for (size_t idx = 0; idx < arguments->size; ++idx) {
+    Node *argument = arguments->elements[idx];
+    unsigned effects = callee == NULL || idx >= callee->numArguments
+                           ? AE_READ | AE_WRITE | AE_ESCAPE
+                           : callee->argumentEffects[idx];
+
+    summarizeExpression(s, argument, AK_POINTER);
+    if ((effects & AE_ESCAPE) != 0) accessMemory(s, argument, AK_ADDRESS);
+    if ((effects & AE_READ) != 0) accessMemory(s, argument, AK_READ);
+    if ((effects & AE_WRITE) != 0) accessMemory(s, argument, AK_WRITE);
+  }
+}
+
+/**
+ * records the effects of the statements in a function body
+ *
+ * @param node statement or top-level expression
+ * @param data Summarizer
+ */
+static bool summarizeStatement(Node *node, void *data) {
+  Summarizer *s = data;
+  switch (node->type) {
+    case NT_ASMSTMT: {
+      setFlag(s, &s->summary->opaque);
+      return false;
+    }
+    case NT_VARDEFNSTMT: {
+      Vector *names = node->data.varDefnStmt.names;
+      Vector *initializers = node->data.varDefnStmt.initializers;
+      for (size_t idx = 0; idx < names->size; ++idx) {
+        Node *initializer = initializers->elements[idx];
+        if (initializer == NULL) continue;
+        summarizeExpression(s, initializer, AK_READ);
+        accessVariable(s, variableOf(names->elements[idx]), AK_WRITE);
+      }
+      return false;
+    }
+    case NT_RETURNSTMT: {
+      if (node->data.returnStmt.value != NULL)
+        summarizeExpression(s, node->data.returnStmt.value, AK_READ);
+      return false;
+    }
+    case NT_BINOPEXP:
+    case NT_TERNARYEXP:
+    case NT_UNOPEXP:
+    case NT_FUNCALLEXP:
+    case NT_LITERAL:
+    case NT_SCOPEDID:
+    case NT_ID: {
+      // condition, increment, or expression statement - the value is unused
+      summarizeExpression(s, node, AK_POINTER);
+      return false;
+    }
+    default: {
+      return true;
+    }
+  }
+}
+
+/**
+ * does a type allow memory to be accessed through it?
+ *
+ * @param type type to query
+ */
+static bool typeIsPointer(Type const *type) {
+  return stripType(type)->kind == TK_POINTER;
+}
+
+/**
+ * creates a summary with no effects
+ *
+ * @param node NT_FUNDEFN or NT_FUNDECL
+ * @param function function's stab entry
+ */
+static FunctionSummary *functionSummaryCreate(Node *node,
+                                              SymbolTableEntry *function) {
+  FunctionSummary *summary = malloc(sizeof(FunctionSummary));
+  summary->function = function;
+  summary->node = node;
+  summary->opaque = false;
+  summary->readsUnknown = false;
+  summary->writesUnknown = false;
+  pointerSetInit(&summary->reads);
+  pointerSetInit(&summary->writes);
+  summary->numArguments = function->data.function.argumentTypes.size;
+  summary->argumentEffects = calloc(summary->numArguments, sizeof(unsigned));
+  return summary;
+}
+
+/**
+ * sets a summary for a function without a definition from its declaration
+ *
+ * @param summary summary of an NT_FUNDECL
+ */
+static void summarizeDeclaration(FunctionSummary *summary) {
+  unsigned effects;
+  switch (summary->node->data.funDecl.effect) {
+    case FE_PURE: {
+      return;
+    }
+    case FE_READONLY: {
+      summary->readsUnknown = true;
+      effects = AE_READ;
+      break;
+    }
+    default: {
+      summary->opaque = true;
+      summary->readsUnknown = true;
+      summary->writesUnknown = true;
+      effects = AE_READ | AE_WRITE | AE_ESCAPE;
+      break;
+    }
+  }
+
+  Vector const *argumentTypes = &summary->function->data.function.argumentTypes;
+  for (size_t idx = 0; idx < summary->numArguments; ++idx) {
+    if (typeIsPointer(argumentTypes->elements[idx]))
+      summary->argumentEffects[idx] = effects;
+  }
+}
+
+/**
+ * adds to a summary of a function definition, given the current summaries of
+ * its callees
+ *
+ * @param modRef ModRef being built
+ * @param globals set of SymbolTableEntry of every global
+ * @param summary summary of an NT_FUNDEFN
+ * @returns whether the summary changed
+ */
+static bool summarizeDefinition(ModRef const *modRef,
+                                PointerSet const *globals,
+                                FunctionSummary *summary) {
+  Node *function = summary->node;
+  Summarizer s = {modRef, globals, {0, 0, NULL}, summary, false};
+
+  vectorInit(&s.arguments);
+  Vector *argNames = function->data.funDefn.argNames;
+  for (size_t idx = 0; idx < argNames->size; ++idx) {
+    Node *argName = argNames->elements[idx];
+    HashMap *argStab = function->data.funDefn.argStab;
+    SymbolTableEntry *argument =
+        argName == NULL ? NULL : hashMapGet(argStab, argName->data.id.id);
+    vectorInsert(&s.arguments,
+                 argument != NULL && typeIsPointer(argument->data.variable.type)
+                     ? argument
+                     : NULL);
+  }
+
+  nodeVisit(function->data.funDefn.body, summarizeStatement, &s);
+
+  vectorUninit(&s.arguments, nullDtor);
+  return s.changed;
+}
+
+/**
+ * records a declaration entry as an alias of a definition entry, if the
+ * declaration module of a code file declares it
+ *
+ * @param modRef ModRef to add to
+ * @param declStab symbol table of the declaration module, nullable
+ * @param name name of the symbol
+ * @param definition entry of the definition
+ */
+static void addAlias(ModRef *modRef, HashMap const *declStab,
+                     char const *name, SymbolTableEntry *definition) {
+  if (declStab == NULL) return;
+
+  SymbolTableEntry *declaration = hashMapGet(declStab, name);
+  if (declaration != NULL && declaration != definition)
+    pointerMapPut(&modRef->aliases, declaration, definition);
+}
+
+/**
+ * adds a summary to a ModRef
+ *
+ * @param modRef ModRef to add to
+ * @param summary summary to add
+ */
+static void addSummary(ModRef *modRef, FunctionSummary *summary) {
+  vectorInsert(&modRef->summaries, summary);
+  pointerMapPut(&modRef->summaryMap, summary->function, summary);
+}
+
+void modRefInit(ModRef *modRef) {
+  vectorInit(&modRef->summaries);
+  pointerMapInit(&modRef->summaryMap);
+  pointerMapInit(&modRef->aliases);
+
+  PointerSet globals;
+  pointerSetInit(&globals);
+
+  // definitions, and the declarations they define
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    FileListEntry *file = &fileList.entries[fileIdx];
+    Vector *bodies = file->ast->data.file.bodies;
+    if (!file->isCode) {
+      for (size_t idx = 0; idx < bodies->size; ++idx) {
+        Node *body = bodies->elements[idx];
+        if (body->type != NT_VARDECL) continue;
+        Vector *names = body->data.varDecl.names;
+        for (size_t nameIdx = 0; nameIdx < names->size; ++nameIdx) {
+          SymbolTableEntry *global = variableOf(names->elements[nameIdx]);
+          if (global != NULL) pointerSetPut(&globals, global);
+        }
+      }
+      continue;
+    }
+
+    FileListEntry *declFile =
+        fileListFindDeclName(file->ast->data.file.module->data.module.id);
+    HashMap const *declStab =
+        declFile == NULL ? NULL : declFile->ast->data.file.stab;
+    for (size_t idx = 0; idx < bodies->size; ++idx) {
+      Node *body = bodies->elements[idx];
+      switch (body->type) {
+        case NT_FUNDEFN: {
+          Node *name = body->data.funDefn.name;
+          addSummary(modRef, functionSummaryCreate(body, name->data.id.entry));
+          addAlias(modRef, declStab, name->data.id.id, name->data.id.entry);
+          break;
+        }
+        case NT_VARDEFN: {
+          Vector *names = body->data.varDefn.names;
+          for (size_t nameIdx = 0; nameIdx < names->size; ++nameIdx) {
+            Node *name = names->elements[nameIdx];
+            pointerSetPut(&globals, name->data.id.entry);
+            addAlias(modRef, declStab, name->data.id.id, name->data.id.entry);
+          }
+          break;
+        }
+        default: {
+          break;
+        }
+      }
+    }
+  }
+
+  // declarations without definitions
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    FileListEntry *file = &fileList.entries[fileIdx];
+    if (file->isCode) continue;
+
+    Vector *bodies = file->ast->data.file.bodies;
+    for (size_t idx = 0; idx < bodies->size; ++idx) {
+      Node *body = bodies->elements[idx];
+      if (body->type != NT_FUNDECL) continue;
+
+      SymbolTableEntry *entry = body->data.funDecl.name->data.id.entry;
+      if (definitionOf(modRef, entry) != NULL) continue;
+
+      FunctionSummary *summary = functionSummaryCreate(body, entry);
+      summarizeDeclaration(summary);
+      addSummary(modRef, summary);
+    }
+  }
+
+  // summaries only grow, so iterating until nothing changes reaches the same
+  // fixed point as a bottom-up walk over the call graph's strongly connected
+  // components
+  bool changed;
+  do {
+    changed = false;
+    for (size_t idx = 0; idx < modRef->summaries.size; ++idx) {
+      FunctionSummary *summary = modRef->summaries.elements[idx];
+      if (summary->node->type == NT_FUNDEFN)
+        changed = summarizeDefinition(modRef, &globals, summary) || changed;
+    }
+  } while (changed);
+
+  pointerSetUninit(&globals);
+}
+
+FunctionSummary const *modRefSummaryOf(ModRef const *modRef,
+                                       SymbolTableEntry const *function) {
+  return pointerMapGet(&modRef->summaryMap, canonicalEntry(modRef, function));
+}
+
+/**
+ * do any of a summary's arguments have an effect?
+ *
+ * @param summary summary to query
+ * @param effects ArgumentEffect flags to look for
+ */
+static bool anyArgumentEffect(FunctionSummary const *summary,
+                              unsigned effects) {
+  for (size_t idx = 0; idx < summary->numArguments; ++idx) {
+    if ((summary->argumentEffects[idx] & effects) != 0) return true;
+  }
+  return false;
+}
+
+FunctionEffect functionSummaryEffect(FunctionSummary const *summary) {
+  if (summary->opaque || summary->writesUnknown || summary->writes.size != 0 ||
+      anyArgumentEffect(summary, AE_WRITE))
+    return FE_UNKNOWN;
+  else if (summary->readsUnknown || summary->reads.size != 0 ||
+           anyArgumentEffect(summary, AE_READ))
+    return FE_READONLY;
+  else
+    return FE_PURE;
+}
+
+bool functionSummaryIsWriteOnly(FunctionSummary const *summary) {
+  return !summary->opaque && !summary->readsUnknown &&
+         summary->reads.size == 0 && !anyArgumentEffect(summary, AE_READ);
+}
+
+bool modRefCallIsPure(ModRef const *modRef, Node *call) {
+  SymbolTableEntry *calleeEntry = directCallee(call);
+  if (calleeEntry == NULL) return false;
+
+  FunctionSummary const *callee = modRefSummaryOf(modRef, calleeEntry);
+  if (callee == NULL || functionSummaryEffect(callee) != FE_PURE) return false;
+
+  Vector *arguments = call->data.funCallExp.arguments;
+  for (size_t idx = 0; idx < arguments->size; ++idx) {
+    if (!expressionIsPure(arguments->elements[idx])) return false;
+  }
+  return true;
+}
+
+/**
+ * may a call access a global in a way described by a summary?
+ *
+ * @param modRef ModRef to query
+ * @param call NT_FUNCALLEXP node
+ * @param global stab entry of the global
+ * @param write is the access a write, or a read?
+ */
+static bool callMayAccess(ModRef const *modRef, Node *call,
+                          SymbolTableEntry const *global, bool write) {
+  SymbolTableEntry *calleeEntry = directCallee(call);
+  FunctionSummary const *callee =
+      calleeEntry == NULL ? NULL : modRefSummaryOf(modRef, calleeEntry);
+  if (callee == NULL || callee->opaque) return true;
+
+  SymbolTableEntry const *canonical = canonicalEntry(modRef, global);
+  bool unknown = write ? callee->writesUnknown : callee->readsUnknown;
+  PointerSet const *globals = write ? &callee->writes : &callee->reads;
+  if (unknown || pointerSetContains(globals, canonical)) return true;
+
+  // the global may be passed by address
+  unsigned effects = AE_ESCAPE | (write ? AE_WRITE : AE_READ);
+  Vector *arguments = call->data.funCallExp.arguments;
+  for (size_t idx = 0; idx < arguments->size && idx < callee->numArguments;
+       ++idx) {
+    bool addressOf;
+    SymbolTableEntry *root = pointerRoot(arguments->elements[idx], &addressOf);
+    if ((callee->argumentEffects[idx] & effects) != 0 &&
+        (root == NULL || !addressOf ||
+         canonicalEntry(modRef, root) == canonical))
+      return true;
+  }
+  return false;
+}
+
+bool modRefCallMayRead(ModRef const *modRef, Node *call,
+                       SymbolTableEntry const *global) {
+  return callMayAccess(modRef, call, global, false);
+}
+
+bool modRefCallMayWrite(ModRef const *modRef, Node *call,
+                        SymbolTableEntry const *global) {
+  return callMayAccess(modRef, call, global, true);
+}
+
+/**
+ * deinitializes and frees a summary
+ *
+ * @param summary summary to free
+ */
+static void functionSummaryFree(FunctionSummary *summary) {
+  pointerSetUninit(&summary->reads);
+  pointerSetUninit(&summary->writes);
+  free(summary->argumentEffects);
+  free(summary);
+}
+
+void modRefUninit(ModRef *modRef) {
+  vectorUninit(&modRef->summaries, (void (*)(void *))functionSummaryFree);
+  pointerMapUninit(&modRef->summaryMap);
+  pointerMapUninit(&modRef->aliases);
+}
@@ -0,0 +1,158 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * interprocedural mod/ref analysis
+ *
+ * summarizes which memory each function may read (ref) or write (mod), so
+ * that calls to pure functions can be treated like any other side effect free
+ * expression, and so that a call doesn't have to be assumed to clobber every
+ * global
+ */
+
+#ifndef TLC_OPTIMIZATION_MODREF_H_
+#define TLC_OPTIMIZATION_MODREF_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ast/ast.h"
+#include "ast/symbolTable.h"
+#include "util/container/pointerMap.h"
+#include "util/container/pointerSet.h"
+#include "util/container/vector.h"
+
+/** what a function may do with the memory a pointer argument points to */
+typedef enum {
+  AE_READ = 0x1,   /**< reads through the pointer */
+  AE_WRITE = 0x2,  /**< writes through the pointer */
+  AE_ESCAPE = 0x4, /**< stores, returns, or passes the pointer to unknown code,
+                      so the pointed-to memory may be accessed later */
+} ArgumentEffect;
+
+/** the memory effects of a function */
+typedef struct {
+  SymbolTableEntry *function; /**< stab entry of the definition, or of the
+                                 declaration if there is no definition */
+  Node *node;                 /**< NT_FUNDEFN or NT_FUNDECL */
+  bool opaque;        /**< contains inline assembly, volatile accesses, or
+                         calls to unknown code - may do anything */
+  bool readsUnknown;  /**< reads through pointers not from the arguments */
+  bool writesUnknown; /**< writes through pointers not from the arguments */
+  PointerSet reads;  /**< set of SymbolTableEntry, globals that may be read */
+  PointerSet writes; /**< set of SymbolTableEntry, globals that may be
+                        written */
+  size_t numArguments;
+  unsigned *argumentEffects; /**< ArgumentEffect flags for each argument, only
+                                set for pointer arguments */
+} FunctionSummary;
+
+/** summaries of every function in the file list */
+typedef struct {
+  Vector summaries;      /**< vector of FunctionSummary */
+  PointerMap summaryMap; /**< map from the function's SymbolTableEntry to its
+                            FunctionSummary */
+  PointerMap aliases;    /**< map from a declaration's SymbolTableEntry to
+                            its definition's SymbolTableEntry */
+} ModRef;
+
+/**
+ * summarizes every function in the global file list
+ *
+ * functions with definitions are summarized bottom-up over the call graph,
+ * iterating until recursive functions reach a fixed point. Functions that are
+ * only declared use their declared effects (see FunctionEffect)
+ *
+ * @param modRef ModRef to initialize
+ */
+void modRefInit(ModRef *modRef);
+
+/**
+ * gets the summary of a function
+ *
+ * @param modRef ModRef to query
+ * @param function stab entry of the function's definition or declaration
+ * @returns summary, or NULL if the function isn't in any file
+ */
+FunctionSummary const *modRefSummaryOf(ModRef const *modRef,
+                                       SymbolTableEntry const *function);
+
+/**
+ * classifies a summary
+ *
+ * @param summary summary to classify
+ * @returns FE_PURE if the function accesses no memory except its locals and
+ * has no side effects, FE_READONLY if it only reads memory, or FE_UNKNOWN
+ */
+FunctionEffect functionSummaryEffect(FunctionSummary const *summary);
+
+/**
+ * does the function only write memory, without reading anything except its
+ * arguments and locals?
+ *
+ * @param summary summary to query
+ */
+bool functionSummaryIsWriteOnly(FunctionSummary const *summary);
+
+/**
+ * can a call be treated like a side effect free expression?
+ *
+ * calls to pure functions with side effect free arguments may be combined
+ * with an equal call (GVN) and hoisted out of loops (LICM). Pure functions may
+ * still fail to terminate, so hoisting a call out of a loop that might not
+ * run must be avoided
+ *
+ * @param modRef ModRef to query
+ * @param call NT_FUNCALLEXP node
+ * @returns whether the call is direct, to a pure function, and has side effect
+ * free arguments
+ */
+bool modRefCallIsPure(ModRef const *modRef, Node *call);
+
+/**
+ * may a call read a global variable?
+ *
+ * @param modRef ModRef to query
+ * @param call NT_FUNCALLEXP node
+ * @param global stab entry of the global's definition or declaration
+ */
+bool modRefCallMayRead(ModRef const *modRef, Node *call,
+                       SymbolTableEntry const *global);
+
+/**
+ * may a call write a global variable?
+ *
+ * only the call itself is considered, not its arguments
+ *
+ * @param modRef ModRef to query
+ * @param call NT_FUNCALLEXP node
+ * @param global stab entry of the global's definition or declaration
+ */
+bool modRefCallMayWrite(ModRef const *modRef, Node *call,
+                        SymbolTableEntry const *global);
+
+/**
+ * deinitializes a ModRef
+ *
+ * @param modRef ModRef to deinitialize
+ */
+void modRefUninit(ModRef *modRef);
+
+#endif  // TLC_OPTIMIZATION_MODREF_H_
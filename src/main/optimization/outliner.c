@@ -0,0 +1,521 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// machine code outliner implementation
+
+#include "optimization/outliner.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "options.h"
+
+size_t const OUTLINE_CALL_SIZE = 5;
+size_t const OUTLINE_RETURN_SIZE = 1;
+size_t const OUTLINE_OS_MIN_BENEFIT = 16;
+size_t const OUTLINE_MAX_LENGTH = 64;
+
+size_t outlinerMinimumBenefit(void) {
+  switch (options.optimizationLevel) {
+    case OPTION_O_S: {
+      return OUTLINE_OS_MIN_BENEFIT;
+    }
+    case OPTION_O_Z: {
+      return 1;
+    }
+    default: {
+      return 0;
+    }
+  }
+}
+
+/**
+ * compares two encodings, for qsort
+ *
+ * @param a pointer to first encoding
+ * @param b pointer to second encoding
+ */
+static int encodingCompare(void const *a, void const *b) {
+  uint64_t aEncoding = *(uint64_t const *)a;
+  uint64_t bEncoding = *(uint64_t const *)b;
+  return aEncoding < bEncoding ? -1 : aEncoding > bEncoding ? 1 : 0;
+}
+
+/** the program as one string of symbols */
+typedef struct {
+  size_t length;
+  size_t *symbols;   /**< legal instructions are numbered by encoding, and
+                        everything else gets a unique separator */
+  size_t *functions; /**< function each position is in */
+  size_t *offsets;   /**< instruction each position is, or SIZE_MAX for
+                        separators */
+  OutlinerInstruction const **instructions; /**< instruction each position is,
+                                               or NULL for separators */
+} Program;
+
+/**
+ * flattens functions into one string, where repeats never cross an illegal
+ * instruction, a return, or a function boundary
+ *
+ * @param program Program to initialize
+ * @param functions functions to flatten
+ * @param numFunctions number of functions
+ */
+static void programInit(Program *program, OutlinerFunction const *functions,
+                        size_t numFunctions) {
+  // legal instructions, then a separator after each return, illegal
+  // instruction, and function
+  size_t numInstructions = 0;
+  for (size_t idx = 0; idx < numFunctions; ++idx)
+    numInstructions += functions[idx].length;
+  size_t capacity = 2 * numInstructions + numFunctions;
+
+  uint64_t *encodings = malloc(sizeof(uint64_t) * (numInstructions + 1));
+  size_t numEncodings = 0;
+  for (size_t function = 0; function < numFunctions; ++function) {
+    for (size_t idx = 0; idx < functions[function].length; ++idx) {
+      OutlinerInstruction const *instruction =
+          &functions[function].instructions[idx];
+      if (instruction->legal) encodings[numEncodings++] = instruction->encoding;
+    }
+  }
+  qsort(encodings, numEncodings, sizeof(uint64_t), encodingCompare);
+  size_t numDistinct = 0;
+  for (size_t idx = 0; idx < numEncodings; ++idx) {
+    if (numDistinct == 0 || encodings[numDistinct - 1] != encodings[idx])
+      encodings[numDistinct++] = encodings[idx];
+  }
+
+  program->length = 0;
+  program->symbols = malloc(sizeof(size_t) * capacity);
+  program->functions = malloc(sizeof(size_t) * capacity);
+  program->offsets = malloc(sizeof(size_t) * capacity);
+  program->instructions =
+      malloc(sizeof(OutlinerInstruction const *) * capacity);
+  size_t nextSeparator = numDistinct;
+  for (size_t function = 0; function < numFunctions; ++function) {
+    for (size_t idx = 0; idx < functions[function].length; ++idx) {
+      OutlinerInstruction const *instruction =
+          &functions[function].instructions[idx];
+      size_t position = program->length++;
+      program->functions[position] = function;
+      if (instruction->legal) {
+        uint64_t const *found =
+            bsearch(&instruction->encoding, encodings, numDistinct,
+                    sizeof(uint64_t), encodingCompare);
+        program->symbols[position] = (size_t)(found - encodings);
+        program->offsets[position] = idx;
+        program->instructions[position] = instruction;
+        if (!instruction->isReturn) continue;
+      } else {
+        program->symbols[position] = nextSeparator++;
+        program->offsets[position] = SIZE_MAX;
+        program->instructions[position] = NULL;
+        continue;
+      }
+
+      // returns end any sequence they're in
+      position = program->length++;
+      program->symbols[position] = nextSeparator++;
+      program->functions[position] = function;
+      program->offsets[position] = SIZE_MAX;
+      program->instructions[position] = NULL;
+    }
+
+    size_t position = program->length++;
+    program->symbols[position] = nextSeparator++;
+    program->functions[position] = function;
+    program->offsets[position] = SIZE_MAX;
+    program->instructions[position] = NULL;
+  }
+
+  free(encodings);
+}
+
+/**
+ * deinitializes a Program
+ *
+ * @param program Program to deinitialize
+ */
+static void programUninit(Program *program) {
+  free(program->symbols);
+  free(program->functions);
+  free(program->offsets);
+  free(program->instructions);
+}
+
+/** the order suffixes are sorted in, by their first 2k symbols */
+typedef struct {
+  size_t const *rank; /**< rank of each suffix by its first k symbols */
+  size_t k;
+  size_t length;
+} SuffixOrder;
+
+/**
+ * does one suffix sort before another?
+ *
+ * @param order order to sort by
+ * @param a start of first suffix
+ * @param b start of second suffix
+ */
+static bool suffixBefore(SuffixOrder const *order, size_t a, size_t b) {
+  if (order->rank[a] != order->rank[b]) return order->rank[a] < order->rank[b];
+  // suffixes that end sooner sort first
+  size_t aNext = a + order->k < order->length ? order->rank[a + order->k] + 1
+                                              : 0;
+  size_t bNext = b + order->k < order->length ? order->rank[b + order->k] + 1
+                                              : 0;
+  return aNext < bNext;
+}
+
+/**
+ * sorts suffixes, stably
+ *
+ * @param suffixes starts of suffixes to sort
+ * @param scratch space for as many suffixes
+ * @param length number of suffixes
+ * @param order order to sort by
+ */
+static void suffixSort(size_t *suffixes, size_t *scratch, size_t length,
+                       SuffixOrder const *order) {
+  if (length < 2) return;
+
+  size_t half = length / 2;
+  suffixSort(suffixes, scratch, half, order);
+  suffixSort(suffixes + half, scratch, length - half, order);
+
+  size_t left = 0;
+  size_t right = half;
+  size_t out = 0;
+  while (left < half && right < length) {
+    if (suffixBefore(order, suffixes[right], suffixes[left]))
+      scratch[out++] = suffixes[right++];
+    else
+      scratch[out++] = suffixes[left++];
+  }
+  while (left < half) scratch[out++] = suffixes[left++];
+  while (right < length) scratch[out++] = suffixes[right++];
+  memcpy(suffixes, scratch, sizeof(size_t) * length);
+}
+
+/**
+ * builds the suffix array of a program, by prefix doubling
+ *
+ * @param program program to index
+ * @returns suffix starts, in sorted order
+ */
+static size_t *suffixArrayCreate(Program const *program) {
+  size_t length = program->length;
+  size_t *suffixes = malloc(sizeof(size_t) * length);
+  size_t *scratch = malloc(sizeof(size_t) * length);
+  size_t *rank = malloc(sizeof(size_t) * length);
+  size_t *nextRank = malloc(sizeof(size_t) * length);
+  for (size_t idx = 0; idx < length; ++idx) {
+    suffixes[idx] = idx;
+    rank[idx] = program->symbols[idx];
+  }
+
+  for (size_t k = 1;; k *= 2) {
+    SuffixOrder order = {rank, k, length};
+    suffixSort(suffixes, scratch, length, &order);
+
+    nextRank[suffixes[0]] = 0;
+    for (size_t idx = 1; idx < length; ++idx) {
+      size_t previous = nextRank[suffixes[idx - 1]];
+      nextRank[suffixes[idx]] =
+          suffixBefore(&order, suffixes[idx - 1], suffixes[idx]) ? previous + 1
+                                                                 : previous;
+    }
+    memcpy(rank, nextRank, sizeof(size_t) * length);
+
+    // done once every suffix has a distinct rank
+    if (rank[suffixes[length - 1]] == length - 1 || k >= length) break;
+  }
+
+  free(scratch);
+  free(rank);
+  free(nextRank);
+  return suffixes;
+}
+
+/**
+ * computes the longest common prefixes of adjacent sorted suffixes (Kasai's
+ * algorithm)
+ *
+ * @param program program indexed
+ * @param suffixes suffix array of the program
+ * @returns lcp, where lcp[i] is the common prefix length of suffixes i - 1 and
+ * i, and lcp[0] is 0
+ */
+static size_t *lcpArrayCreate(Program const *program, size_t const *suffixes) {
+  size_t length = program->length;
+  size_t *lcp = malloc(sizeof(size_t) * length);
+  size_t *inverse = malloc(sizeof(size_t) * length);
+  for (size_t idx = 0; idx < length; ++idx) inverse[suffixes[idx]] = idx;
+
+  lcp[0] = 0;
+  size_t common = 0;
+  for (size_t idx = 0; idx < length; ++idx) {
+    if (inverse[idx] == 0) {
+      common = 0;
+      continue;
+    }
+    size_t previous = suffixes[inverse[idx] - 1];
+    while (idx + common < length && previous + common < length &&
+           program->symbols[idx + common] ==
+               program->symbols[previous + common])
+      ++common;
+    lcp[inverse[idx]] = common;
+    if (common > 0) --common;
+  }
+
+  free(inverse);
+  return lcp;
+}
+
+/** a repeated sequence - the common prefix of a range of sorted suffixes */
+typedef struct {
+  size_t length;   /**< number of instructions */
+  size_t first;    /**< first suffix in the range */
+  size_t last;     /**< last suffix in the range */
+  size_t estimate; /**< benefit if no other sequence were outlined */
+} Repeat;
+
+/** state shared while choosing sequences */
+typedef struct {
+  Program const *program;
+  size_t const *suffixes;
+  bool *used;        /**< positions already outlined */
+  size_t *positions; /**< scratch space for occurrences */
+} Chooser;
+
+/**
+ * compares two positions, for qsort
+ *
+ * @param a pointer to first position
+ * @param b pointer to second position
+ */
+static int positionCompare(void const *a, void const *b) {
+  size_t aPosition = *(size_t const *)a;
+  size_t bPosition = *(size_t const *)b;
+  return aPosition < bPosition ? -1 : aPosition > bPosition ? 1 : 0;
+}
+
+/**
+ * finds the occurrences of a repeat that don't overlap each other or
+ * anything already outlined, and what outlining them would save
+ *
+ * @param chooser chooser state - occurrences are written to positions
+ * @param repeat repeat to consider
+ * @param numPositions output pointer to the number of occurrences
+ * @returns bytes saved
+ */
+static size_t repeatBenefit(Chooser const *chooser, Repeat const *repeat,
+                            size_t *numPositions) {
+  size_t count = 0;
+  for (size_t idx = repeat->first; idx <= repeat->last; ++idx)
+    chooser->positions[count++] = chooser->suffixes[idx];
+  qsort(chooser->positions, count, sizeof(size_t), positionCompare);
+
+  size_t kept = 0;
+  for (size_t idx = 0; idx < count; ++idx) {
+    size_t position = chooser->positions[idx];
+    if (kept != 0 && chooser->positions[kept - 1] + repeat->length > position)
+      continue;
+    bool available = true;
+    for (size_t offset = 0; offset < repeat->length && available; ++offset)
+      available = !chooser->used[position + offset];
+    if (available) chooser->positions[kept++] = position;
+  }
+  *numPositions = kept;
+  if (kept < 2) return 0;
+
+  Program const *program = chooser->program;
+  size_t start = chooser->positions[0];
+  size_t size = 0;
+  for (size_t offset = 0; offset < repeat->length; ++offset)
+    size += program->instructions[start + offset]->size;
+  bool tail = program->instructions[start + repeat->length - 1]->isReturn;
+
+  size_t saved = kept * size;
+  size_t cost =
+      kept * OUTLINE_CALL_SIZE + size + (tail ? 0 : OUTLINE_RETURN_SIZE);
+  return saved > cost ? saved - cost : 0;
+}
+
+/**
+ * compares two repeats by estimated benefit, for qsort
+ *
+ * @param a pointer to pointer to first repeat
+ * @param b pointer to pointer to second repeat
+ */
+static int repeatCompare(void const *a, void const *b) {
+  Repeat const *aRepeat = *(Repeat const *const *)a;
+  Repeat const *bRepeat = *(Repeat const *const *)b;
+  // most beneficial first, then longest, then in suffix order, so the order
+  // doesn't depend on qsort
+  if (aRepeat->estimate != bRepeat->estimate)
+    return aRepeat->estimate > bRepeat->estimate ? -1 : 1;
+  else if (aRepeat->length != bRepeat->length)
+    return aRepeat->length > bRepeat->length ? -1 : 1;
+  else
+    return aRepeat->first < bRepeat->first ? -1 : 1;
+}
+
+/**
+ * records a range of sorted suffixes sharing a prefix as a repeat
+ *
+ * @param repeats vector of Repeat to add to
+ * @param length length of the shared prefix
+ * @param first first suffix in the range
+ * @param last last suffix in the range
+ */
+static void addRepeat(Vector *repeats, size_t length, size_t first,
+                      size_t last) {
+  // a sequence occurring once can't be shared
+  if (last - first < 1) return;
+
+  Repeat *repeat = malloc(sizeof(Repeat));
+  repeat->length = length;
+  repeat->first = first;
+  repeat->last = last;
+  repeat->estimate = 0;
+  vectorInsert(repeats, repeat);
+}
+
+/**
+ * finds every repeated sequence - each is an interval of the lcp array, which
+ * are the internal nodes of the suffix tree
+ *
+ * common prefixes are cut off at OUTLINE_MAX_LENGTH, so intervals nest at most
+ * that deep, and each suffix is in at most that many repeats
+ *
+ * @param lcp lcp array
+ * @param length length of the program
+ * @param repeats vector of Repeat to add to
+ */
+static void findRepeats(size_t const *lcp, size_t length, Vector *repeats) {
+  // stack of open intervals, as (prefix length, first suffix) pairs
+  size_t *lengths = malloc(sizeof(size_t) * (length + 1));
+  size_t *firsts = malloc(sizeof(size_t) * (length + 1));
+  size_t top = 0;
+  lengths[0] = 0;
+  firsts[0] = 0;
+  for (size_t idx = 1; idx <= length; ++idx) {
+    size_t common = idx < length ? lcp[idx] : 0;
+    if (common > OUTLINE_MAX_LENGTH) common = OUTLINE_MAX_LENGTH;
+    size_t first = idx - 1;
+    while (common < lengths[top]) {
+      first = firsts[top];
+      addRepeat(repeats, lengths[top], first, idx - 1);
+      --top;
+    }
+    if (common > lengths[top]) {
+      ++top;
+      lengths[top] = common;
+      firsts[top] = first;
+    }
+  }
+  free(lengths);
+  free(firsts);
+}
+
+/**
+ * frees an OutlinedSequence
+ *
+ * @param sequence sequence to free
+ */
+static void outlinedSequenceFree(OutlinedSequence *sequence) {
+  free(sequence->sites);
+  free(sequence);
+}
+
+void outlinePlanCreate(OutlinerFunction const *functions, size_t numFunctions,
+                       size_t minBenefit, OutlinePlan *plan) {
+  vectorInit(&plan->sequences);
+  // any sequence saves at least nothing, but outlining is disabled
+  if (minBenefit == 0) return;
+
+  Program program;
+  programInit(&program, functions, numFunctions);
+  if (program.length == 0) {
+    programUninit(&program);
+    return;
+  }
+  size_t *suffixes = suffixArrayCreate(&program);
+  size_t *lcp = lcpArrayCreate(&program, suffixes);
+
+  Vector repeats;
+  vectorInit(&repeats);
+  findRepeats(lcp, program.length, &repeats);
+
+  Chooser chooser;
+  chooser.program = &program;
+  chooser.suffixes = suffixes;
+  chooser.used = calloc(program.length, sizeof(bool));
+  chooser.positions = malloc(sizeof(size_t) * program.length);
+
+  size_t numPositions;
+  for (size_t idx = 0; idx < repeats.size; ++idx) {
+    Repeat *repeat = repeats.elements[idx];
+    repeat->estimate = repeatBenefit(&chooser, repeat, &numPositions);
+  }
+  qsort(repeats.elements, repeats.size, sizeof(Repeat *), repeatCompare);
+
+  // greedily outline the most beneficial repeats, dropping sites that overlap
+  // repeats already outlined
+  for (size_t idx = 0; idx < repeats.size; ++idx) {
+    Repeat *repeat = repeats.elements[idx];
+    if (repeat->estimate < minBenefit) break;
+    size_t benefit = repeatBenefit(&chooser, repeat, &numPositions);
+    if (numPositions < 2 || benefit < minBenefit) continue;
+
+    OutlinedSequence *sequence = malloc(sizeof(OutlinedSequence));
+    sequence->length = repeat->length;
+    sequence->size = 0;
+    for (size_t offset = 0; offset < repeat->length; ++offset)
+      sequence->size +=
+          program.instructions[chooser.positions[0] + offset]->size;
+    sequence->tail =
+        program.instructions[chooser.positions[0] + repeat->length - 1]
+            ->isReturn;
+    sequence->numSites = numPositions;
+    sequence->sites = malloc(sizeof(OutlinedSite) * numPositions);
+    for (size_t site = 0; site < numPositions; ++site) {
+      size_t position = chooser.positions[site];
+      sequence->sites[site].function = program.functions[position];
+      sequence->sites[site].start = program.offsets[position];
+      for (size_t offset = 0; offset < repeat->length; ++offset)
+        chooser.used[position + offset] = true;
+    }
+    sequence->benefit = benefit;
+    vectorInsert(&plan->sequences, sequence);
+  }
+
+  free(chooser.used);
+  free(chooser.positions);
+  vectorUninit(&repeats, free);
+  free(suffixes);
+  free(lcp);
+  programUninit(&program);
+}
+
+void outlinePlanUninit(OutlinePlan *plan) {
+  vectorUninit(&plan->sequences, (void (*)(void *))outlinedSequenceFree);
+}
@@ -0,0 +1,118 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * machine code outliner - replaces instruction sequences repeated across
+ * functions with calls to shared outlined functions, for size-optimized builds
+ */
+
+#ifndef TLC_OPTIMIZATION_OUTLINER_H_
+#define TLC_OPTIMIZATION_OUTLINER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "util/container/vector.h"
+
+/** an instruction, as seen by the outliner */
+typedef struct {
+  uint64_t encoding; /**< identity of the instruction, with relocations
+                        normalized - instructions with equal encodings are
+                        interchangeable */
+  size_t size;       /**< size of the instruction, in bytes */
+  bool legal;        /**< may the instruction be moved into an outlined
+                        function? false for branches and branch targets,
+                        calls, and anything that uses the stack pointer, which
+                        the call's return address would offset */
+  bool isReturn;     /**< does the instruction return from the function? */
+} OutlinerInstruction;
+
+/** the instructions of one function */
+typedef struct {
+  OutlinerInstruction const *instructions;
+  size_t length;
+} OutlinerFunction;
+
+/** an occurrence of an outlined sequence */
+typedef struct {
+  size_t function; /**< index of the function it occurs in */
+  size_t start;    /**< index of its first instruction */
+} OutlinedSite;
+
+/** an instruction sequence moved into its own function */
+typedef struct {
+  size_t length;       /**< number of instructions */
+  size_t size;         /**< size of the sequence, in bytes */
+  bool tail;           /**< does the sequence end with a return? If so, sites
+                          jump to it, and it needs no return of its own */
+  size_t numSites;     /**< number of occurrences replaced */
+  OutlinedSite *sites; /**< occurrences replaced, in program order */
+  size_t benefit;      /**< bytes saved */
+} OutlinedSequence;
+
+/** the sequences outlined from a program */
+typedef struct {
+  Vector sequences; /**< vector of OutlinedSequence, most beneficial first */
+} OutlinePlan;
+
+/** size of a call or jump to an outlined function, in bytes */
+extern size_t const OUTLINE_CALL_SIZE;
+/** size of the return added to an outlined function, in bytes */
+extern size_t const OUTLINE_RETURN_SIZE;
+/** bytes a sequence must save to be outlined at -Os */
+extern size_t const OUTLINE_OS_MIN_BENEFIT;
+/** longest sequence outlined, in instructions - bounds the work done */
+extern size_t const OUTLINE_MAX_LENGTH;
+
+/**
+ * gets the bytes a sequence must save to be outlined at the current
+ * optimization level
+ *
+ * @returns minimum benefit, or 0 if outlining is disabled
+ */
+size_t outlinerMinimumBenefit(void);
+
+/**
+ * finds repeated instruction sequences worth outlining
+ *
+ * repeats are found with a suffix array over every function's instructions.
+ * Each repeat costs a call at each site plus the body and a return once, and
+ * is outlined, most beneficial first, if it still saves enough once sites
+ * overlapping earlier repeats are dropped. Sequences are at most
+ * OUTLINE_MAX_LENGTH instructions long
+ *
+ * @param functions functions to search
+ * @param numFunctions number of functions
+ * @param minBenefit bytes a sequence must save to be outlined - if 0,
+ * outlining is disabled, and the plan is empty
+ * @param plan output pointer to the plan
+ */
+void outlinePlanCreate(OutlinerFunction const *functions, size_t numFunctions,
+                       size_t minBenefit, OutlinePlan *plan);
+
+/**
+ * deinitializes an OutlinePlan
+ *
+ * @param plan plan to deinitialize
+ */
+void outlinePlanUninit(OutlinePlan *plan);
+
+#endif  // TLC_OPTIMIZATION_OUTLINER_H_
@@ -0,0 +1,494 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// optimization pass manager implementation
+
+#include "optimization/passManager.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ast/dump.h"
+#include "optimization/common.h"
+#include "optimization/floatingPoint.h"
+#include "optimization/remarks.h"
+#include "optimization/valueRange.h"
+#include "options.h"
+#include "util/functional.h"
+#include "util/internalError.h"
+
+/** where a pass is in the program, for remarks */
+typedef struct {
+  char const *pass;    /**< name of the pass */
+  FileListEntry *file; /**< file being visited */
+  Node *function;      /**< NT_FUNDEFN being visited */
+} PassContext;
+
+/**
+ * is a binary operator a comparison that produces a bool?
+ */
+static bool isComparison(BinOpType op) {
+  switch (op) {
+    case BO_EQ:
+    case BO_NEQ:
+    case BO_LT:
+    case BO_GT:
+    case BO_LTEQ:
+    case BO_GTEQ: {
+      return true;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * replaces comparisons decided by the ranges of their operands with a boolean
+ * literal
+ */
+static bool foldComparisonsVisitor(Node *node, void *data) {
+  PassContext const *context = data;
+  if (node->type != NT_BINOPEXP || !isComparison(node->data.binOpExp.op))
+    return true;
+
+  bool value;
+  if (!comparisonFold(node, &value)) {
+    if (remarkEnabled(RK_MISSED, context->pass))
+      remark(RK_MISSED, context->pass, context->file, context->function, node,
+             expressionIsPure(node)
+                 ? "comparison isn't decided by the ranges of its operands"
+                 : "comparison has side effects");
+    return true;
+  }
+
+  remark(RK_PASSED, context->pass, context->file, context->function, node,
+         "comparison is always %s", value ? "true" : "false");
+  nodeFree(node->data.binOpExp.lhs);
+  nodeFree(node->data.binOpExp.rhs);
+  typeFree(node->data.binOpExp.type);
+  node->type = NT_LITERAL;
+  node->data.literal.literalType = LT_BOOL;
+  node->data.literal.data.boolVal = value;
+  node->data.literal.type = NULL;
+  return false;
+}
+
+/**
+ * replaces floating point operations with an identity operand with the other
+ * operand
+ */
+static bool foldFloatIdentitiesVisitor(Node *node, void *data) {
+  PassContext const *context = data;
+  if (node->type != NT_BINOPEXP) return true;
+
+  Node *result;
+  while (node->type == NT_BINOPEXP && floatIdentityFold(node, &result)) {
+    remark(RK_PASSED, context->pass, context->file, context->function, node,
+           "removed floating point operation with an identity operand");
+    Node *identity = result == node->data.binOpExp.lhs
+                         ? node->data.binOpExp.rhs
+                         : node->data.binOpExp.lhs;
+    nodeFree(identity);
+    typeFree(node->data.binOpExp.type);
+    *node = *result;
+    free(result);
+  }
+  if (node->type == NT_BINOPEXP && floatIdentityNeedsNoSignedZeros(node))
+    remark(RK_MISSED, context->pass, context->file, context->function, node,
+           "adding or subtracting this zero would turn -0.0 into 0.0; "
+           "-fno-signed-zeros allows it to be removed");
+  return true;
+}
+
+/**
+ * visits the function bodies of a file
+ */
+static void visitFunctions(FileListEntry *file,
+                           bool (*visitor)(Node *, void *), void *data) {
+  Vector *bodies = file->ast->data.file.bodies;
+  for (size_t idx = 0; idx < bodies->size; ++idx) {
+    Node *body = bodies->elements[idx];
+    if (body->type == NT_FUNDEFN)
+      nodeVisit(body->data.funDefn.body, visitor, data);
+  }
+}
+
+/**
+ * visits the function bodies of a file with a PassContext
+ */
+static void visitPassFunctions(char const *pass, FileListEntry *file,
+                               bool (*visitor)(Node *, void *)) {
+  PassContext context = {pass, file, NULL};
+  Vector *bodies = file->ast->data.file.bodies;
+  for (size_t idx = 0; idx < bodies->size; ++idx) {
+    Node *body = bodies->elements[idx];
+    if (body->type == NT_FUNDEFN) {
+      context.function = body;
+      nodeVisit(body->data.funDefn.body, visitor, &context);
+    }
+  }
+}
+
+static void foldComparisons(FileListEntry *file) {
+  visitPassFunctions("fold-comparisons", file, foldComparisonsVisitor);
+}
+static void foldFloatIdentities(FileListEntry *file) {
+  visitPassFunctions("fold-float-identities", file,
+                     foldFloatIdentitiesVisitor);
+}
+
+/** every pass, by name */
+static Pass PASSES[] = {
+    {"fold-comparisons", foldComparisons},
+    {"fold-float-identities", foldFloatIdentities},
+};
+/** number of passes */
+static size_t const NUM_PASSES = sizeof(PASSES) / sizeof(Pass);
+
+/**
+ * finds a pass by a name that may not be nul-terminated
+ *
+ * @param name start of the name
+ * @param length length of the name
+ * @returns the pass, or NULL if there is no such pass
+ */
+static Pass *passLookupLength(char const *name, size_t length) {
+  for (size_t idx = 0; idx < NUM_PASSES; ++idx) {
+    if (strlen(PASSES[idx].name) == length &&
+        strncmp(PASSES[idx].name, name, length) == 0)
+      return &PASSES[idx];
+  }
+  return NULL;
+}
+
+Pass const *passLookup(char const *name) {
+  return passLookupLength(name, strlen(name));
+}
+
+/**
+ * gets the next name in a comma separated list
+ *
+ * @param list list to read from, updated to point after the name
+ * @param length output pointer to the length of the name
+ * @returns start of the name, or NULL if the list is exhausted
+ */
+static char const *listNext(char const **list, size_t *length) {
+  if (**list == '\0') return NULL;
+
+  char const *name = *list;
+  char const *end = strchr(name, ',');
+  if (end == NULL) {
+    *length = strlen(name);
+    *list = name + *length;
+  } else {
+    *length = (size_t)(end - name);
+    *list = end + 1;
+  }
+  return name;
+}
+
+/**
+ * does a list of pass names contain a pass?
+ *
+ * @param list nullable comma separated list, may be "all"
+ * @param name name of the pass
+ */
+static bool listContains(char const *list, char const *name) {
+  if (list == NULL) return false;
+  if (strcmp(list, "all") == 0) return true;
+
+  size_t length;
+  for (char const *current = listNext(&list, &length); current != NULL;
+       current = listNext(&list, &length)) {
+    if (strlen(name) == length && strncmp(current, name, length) == 0)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * complains about every unknown pass in a list of pass names
+ *
+ * @param list nullable comma separated list
+ * @param option option the list came from
+ * @param allowAll is "all" accepted in place of a list
+ * @returns whether every name is a pass
+ */
+static bool listValid(char const *list, char const *option, bool allowAll) {
+  if (list == NULL || (allowAll && strcmp(list, "all") == 0)) return true;
+
+  bool valid = true;
+  size_t length;
+  for (char const *current = listNext(&list, &length); current != NULL;
+       current = listNext(&list, &length)) {
+    if (passLookupLength(current, length) == NULL) {
+      fprintf(stderr, "tlc: error: unknown pass '%.*s' in %s\n", (int)length,
+              current, option);
+      valid = false;
+    }
+  }
+  return valid;
+}
+
+/**
+ * gets the pipeline of the optimization level
+ */
+static char const *levelPipeline(void) {
+  switch (options.optimizationLevel) {
+    case OPTION_O_0: {
+      return "";
+    }
+    case OPTION_O_1: {
+      return "fold-comparisons";
+    }
+    case OPTION_O_2:
+    case OPTION_O_3:
+    case OPTION_O_S:
+    case OPTION_O_Z: {
+      return "fold-comparisons,fold-float-identities";
+    }
+    default: {
+      error(__FILE__, __LINE__,
+            "invalid OptimizationLevelOption enum encountered");
+    }
+  }
+}
+
+int passPipelineInit(PassPipeline *pipeline) {
+  vectorInit(&pipeline->passes);
+
+  bool valid = listValid(options.passPipeline, "-fpass-pipeline", false);
+  valid = listValid(options.disabledPasses, "-fdisable-pass", false) && valid;
+  valid = listValid(options.printBefore, "-print-before", true) && valid;
+  valid = listValid(options.printAfter, "-print-after", true) && valid;
+  if (!valid) return -1;
+
+  char const *list = options.passPipeline != NULL ? options.passPipeline
+                                                  : levelPipeline();
+  size_t length;
+  for (char const *current = listNext(&list, &length); current != NULL;
+       current = listNext(&list, &length)) {
+    Pass *pass = passLookupLength(current, length);
+    if (!listContains(options.disabledPasses, pass->name))
+      vectorInsert(&pipeline->passes, pass);
+  }
+  return 0;
+}
+
+/**
+ * dumps the AST of every file
+ *
+ * @param when "before" or "after"
+ * @param pass pass the dump is around
+ */
+static void dumpAll(char const *when, Pass const *pass) {
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    fprintf(stderr, "// AST %s %s\n", when, pass->name);
+    astDump(stderr, &fileList.entries[idx]);
+  }
+}
+
+/**
+ * counts the nodes of every file
+ */
+static size_t programSize(void) {
+  size_t size = 0;
+  for (size_t idx = 0; idx < fileList.size; ++idx)
+    size += astSize(&fileList.entries[idx]);
+  return size;
+}
+
+void passPipelineRun(PassPipeline const *pipeline, TimeReport *report) {
+  for (size_t passIdx = 0; passIdx < pipeline->passes.size; ++passIdx) {
+    Pass const *pass = pipeline->passes.elements[passIdx];
+    if (listContains(options.printBefore, pass->name)) dumpAll("before", pass);
+
+    size_t sizeBefore = report != NULL ? programSize() : 0;
+    clock_t start = clock();
+    for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx)
+      pass->run(&fileList.entries[fileIdx]);
+    clock_t end = clock();
+    if (report != NULL)
+      timeReportAddPass(report, pass->name, start, end, sizeBefore,
+                        programSize());
+
+#ifndef NDEBUG
+    for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+      if (!astVerify(&fileList.entries[fileIdx])) {
+        fprintf(stderr, "%s: note: AST is malformed after pass '%s'\n",
+                fileList.entries[fileIdx].inputFilename, pass->name);
+        error(__FILE__, __LINE__, "optimization pass produced a malformed AST");
+      }
+    }
+#endif
+
+    if (listContains(options.printAfter, pass->name)) dumpAll("after", pass);
+  }
+}
+
+void passPipelineUninit(PassPipeline *pipeline) {
+  vectorUninit(&pipeline->passes, nullDtor);
+}
+
+/**
+ * checks one node for astVerify
+ *
+ * @param node node to check
+ * @param data pointer to a bool, set false if the node is malformed
+ */
+static bool verifyVisitor(Node *node, void *data) {
+  bool *valid = data;
+  switch (node->type) {
+    case NT_COMPOUNDSTMT: {
+      if (node->data.compoundStmt.stmts == NULL) *valid = false;
+      break;
+    }
+    case NT_IFSTMT: {
+      if (node->data.ifStmt.predicate == NULL ||
+          node->data.ifStmt.consequent == NULL)
+        *valid = false;
+      break;
+    }
+    case NT_WHILESTMT: {
+      if (node->data.whileStmt.condition == NULL ||
+          node->data.whileStmt.body == NULL)
+        *valid = false;
+      break;
+    }
+    case NT_DOWHILESTMT: {
+      if (node->data.doWhileStmt.body == NULL ||
+          node->data.doWhileStmt.condition == NULL)
+        *valid = false;
+      break;
+    }
+    case NT_FORSTMT: {
+      if (node->data.forStmt.body == NULL) *valid = false;
+      break;
+    }
+    case NT_SWITCHSTMT: {
+      if (node->data.switchStmt.condition == NULL) *valid = false;
+      break;
+    }
+    case NT_EXPRESSIONSTMT: {
+      if (node->data.expressionStmt.expression == NULL) *valid = false;
+      break;
+    }
+    case NT_BINOPEXP: {
+      if (node->data.binOpExp.op > BO_CAST ||
+          node->data.binOpExp.lhs == NULL || node->data.binOpExp.rhs == NULL) {
+        *valid = false;
+      } else if (node->data.binOpExp.op == BO_FIELD ||
+                 node->data.binOpExp.op == BO_PTRFIELD) {
+        // the field name isn't a symbol
+        if (node->data.binOpExp.rhs->type != NT_ID) *valid = false;
+        nodeVisit(node->data.binOpExp.lhs, verifyVisitor, data);
+        return false;
+      }
+      break;
+    }
+    case NT_TERNARYEXP: {
+      if (node->data.ternaryExp.predicate == NULL ||
+          node->data.ternaryExp.consequent == NULL ||
+          node->data.ternaryExp.alternative == NULL)
+        *valid = false;
+      break;
+    }
+    case NT_UNOPEXP: {
+      if (node->data.unOpExp.op > UO_PARENS ||
+          node->data.unOpExp.target == NULL)
+        *valid = false;
+      break;
+    }
+    case NT_FUNCALLEXP: {
+      if (node->data.funCallExp.function == NULL ||
+          node->data.funCallExp.arguments == NULL)
+        *valid = false;
+      break;
+    }
+    case NT_LITERAL: {
+      if (node->data.literal.literalType > LT_PACKEDINIT) *valid = false;
+      break;
+    }
+    case NT_ID: {
+      if (node->data.id.entry == NULL) *valid = false;
+      break;
+    }
+    case NT_SCOPEDID: {
+      if (node->data.scopedId.entry == NULL) *valid = false;
+      break;
+    }
+    case NT_OPAQUEDECL:
+    case NT_STRUCTDECL:
+    case NT_UNIONDECL:
+    case NT_ENUMDECL:
+    case NT_TYPEDEFDECL: {
+      // block scope declarations hold types and names, not expressions
+      return false;
+    }
+    case NT_VARDEFNSTMT:
+    case NT_RETURNSTMT:
+    case NT_BREAKSTMT:
+    case NT_CONTINUESTMT:
+    case NT_ASMSTMT:
+    case NT_NULLSTMT:
+    case NT_SWITCHCASE:
+    case NT_SWITCHDEFAULT: {
+      break;
+    }
+    default: {
+      // not a statement or expression
+      *valid = false;
+      break;
+    }
+  }
+  return *valid;
+}
+
+bool astVerify(FileListEntry *file) {
+  bool valid = true;
+  Vector *bodies = file->ast->data.file.bodies;
+  for (size_t idx = 0; idx < bodies->size && valid; ++idx) {
+    Node *body = bodies->elements[idx];
+    if (body->type != NT_FUNDEFN) continue;
+
+    if (body->data.funDefn.body == NULL ||
+        body->data.funDefn.body->type != NT_COMPOUNDSTMT)
+      return false;
+    nodeVisit(body->data.funDefn.body, verifyVisitor, &valid);
+  }
+  return valid;
+}
+
+/**
+ * counts one node for astSize
+ */
+static bool countVisitor(Node *node, void *data) {
+  (void)node;
+  size_t *count = data;
+  ++*count;
+  return true;
+}
+
+size_t astSize(FileListEntry *file) {
+  size_t count = 0;
+  visitFunctions(file, countVisitor, &count);
+  return count;
+}
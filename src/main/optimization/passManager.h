@@ -0,0 +1,106 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * optimization pass manager
+ *
+ * source level optimizations are named passes over the ASTs of every file,
+ * run in a pipeline chosen by the optimization level, or given on the command
+ * line
+ */
+
+#ifndef TLC_OPTIMIZATION_PASSMANAGER_H_
+#define TLC_OPTIMIZATION_PASSMANAGER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "fileList.h"
+#include "util/container/vector.h"
+#include "util/timeReport.h"
+
+/** an optimization pass */
+typedef struct {
+  char const *name;                 /**< name used on the command line */
+  void (*run)(FileListEntry *file); /**< runs the pass over one file */
+} Pass;
+
+/** the passes to run, in order */
+typedef struct {
+  Vector passes; /**< vector of Pass, non-owning */
+} PassPipeline;
+
+/**
+ * finds a pass by name
+ *
+ * @param name name of the pass
+ * @returns the pass, or NULL if there is no such pass
+ */
+Pass const *passLookup(char const *name);
+
+/**
+ * builds the pipeline selected by the global options
+ *
+ * complains if any option names an unknown pass
+ *
+ * @param pipeline pipeline to initialize, must be uninitialized even if this
+ * fails
+ * @returns status code (0 = OK)
+ */
+int passPipelineInit(PassPipeline *pipeline);
+
+/**
+ * runs a pipeline over every file, dumping the AST around the passes given by
+ * -print-before and -print-after
+ *
+ * in debug builds, the AST is verified after each pass
+ *
+ * @param pipeline pipeline to run
+ * @param report nullable report to record the time taken by each pass in
+ */
+void passPipelineRun(PassPipeline const *pipeline, TimeReport *report);
+
+/**
+ * uninitializes a pipeline
+ *
+ * @param pipeline pipeline to uninitialize
+ */
+void passPipelineUninit(PassPipeline *pipeline);
+
+/**
+ * checks the structural invariants of an AST that passes must preserve
+ *
+ * every expression has its operands, every operator and literal type is
+ * valid, and every name in an expression refers to a symbol
+ *
+ * @param file file to check
+ * @returns whether the AST is well formed
+ */
+bool astVerify(FileListEntry *file);
+
+/**
+ * counts the statements and expressions in the function bodies of a file
+ *
+ * @param file file to measure
+ * @returns number of nodes
+ */
+size_t astSize(FileListEntry *file);
+
+#endif  // TLC_OPTIMIZATION_PASSMANAGER_H_
@@ -0,0 +1,254 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// optimization remarks implementation
+
+#include "optimization/remarks.h"
+
+#include <regex.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "options.h"
+#include "util/format.h"
+
+/** compiled -Rpass regex, if hasPassedRegex */
+static regex_t passedRegex;
+static bool hasPassedRegex = false;
+/** compiled -Rpass-missed regex, if hasMissedRegex */
+static regex_t missedRegex;
+static bool hasMissedRegex = false;
+/** vector of Remark, saved for -fsave-optimization-record */
+static Vector saved;
+
+/**
+ * compiles a remark regex option
+ *
+ * @param regex regex to compile into
+ * @param pattern nullable pattern
+ * @param option option the pattern came from
+ * @param compiled output pointer - was a regex compiled
+ * @returns status code (0 = OK)
+ */
+static int compileRegex(regex_t *regex, char const *pattern,
+                        char const *option, bool *compiled) {
+  *compiled = false;
+  if (pattern == NULL) return 0;
+
+  int retval = regcomp(regex, pattern, REG_EXTENDED | REG_NOSUB);
+  if (retval != 0) {
+    char message[256];
+    regerror(retval, regex, message, sizeof(message));
+    fprintf(stderr, "tlc: error: invalid regular expression '%s' in %s: %s\n",
+            pattern, option, message);
+    return -1;
+  }
+
+  *compiled = true;
+  return 0;
+}
+
+int remarksInit(void) {
+  vectorInit(&saved);
+  if (compileRegex(&passedRegex, options.remarksPassed, "-Rpass",
+                   &hasPassedRegex) != 0 ||
+      compileRegex(&missedRegex, options.remarksMissed, "-Rpass-missed",
+                   &hasMissedRegex) != 0) {
+    remarksUninit();
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * is a remark printed as a diagnostic?
+ */
+static bool remarkPrinted(RemarkKind kind, char const *pass) {
+  switch (kind) {
+    case RK_PASSED: {
+      return hasPassedRegex && regexec(&passedRegex, pass, 0, NULL, 0) == 0;
+    }
+    case RK_MISSED: {
+      return hasMissedRegex && regexec(&missedRegex, pass, 0, NULL, 0) == 0;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+bool remarkEnabled(RemarkKind kind, char const *pass) {
+  return options.optimizationRecord != OPTION_OR_NONE ||
+         remarkPrinted(kind, pass);
+}
+
+void remark(RemarkKind kind, char const *pass, FileListEntry *file,
+            Node const *function, Node const *node, char const *format, ...) {
+  bool printed = remarkPrinted(kind, pass);
+  bool recorded = options.optimizationRecord != OPTION_OR_NONE;
+  if (!printed && !recorded) return;
+
+  va_list args;
+  va_start(args, format);
+  char *message = vformat(format, args);
+  va_end(args);
+
+  if (printed)
+    fprintf(stderr, "%s:%zu:%zu: remark: %s [-Rpass%s=%s]\n",
+            file->inputFilename, node->line, node->character, message,
+            kind == RK_MISSED ? "-missed" : "", pass);
+
+  if (recorded) {
+    Remark *r = malloc(sizeof(Remark));
+    r->kind = kind;
+    r->pass = pass;
+    r->file = file;
+    r->function = strdup(function->data.funDefn.name->data.id.id);
+    r->line = node->line;
+    r->character = node->character;
+    r->message = message;
+    vectorInsert(&saved, r);
+  } else {
+    free(message);
+  }
+}
+
+Vector const *remarksSaved(void) { return &saved; }
+
+/**
+ * writes a YAML single quoted string
+ */
+static void writeYamlString(FILE *where, char const *string) {
+  fputc('\'', where);
+  for (; *string != '\0'; ++string) {
+    if (*string == '\'') fputc('\'', where);
+    fputc(*string, where);
+  }
+  fputc('\'', where);
+}
+
+/**
+ * writes a JSON string
+ */
+static void writeJsonString(FILE *where, char const *string) {
+  fputc('"', where);
+  for (; *string != '\0'; ++string) {
+    unsigned char c = (unsigned char)*string;
+    if (c == '"' || c == '\\')
+      fprintf(where, "\\%c", c);
+    else if (c < 0x20)
+      fprintf(where, "\\u%04x", c);
+    else
+      fputc(c, where);
+  }
+  fputc('"', where);
+}
+
+/**
+ * gets the name of a remark kind in the saved record
+ */
+static char const *remarkKindName(RemarkKind kind) {
+  return kind == RK_PASSED ? "Passed" : "Missed";
+}
+
+void remarksWrite(FILE *where, FileListEntry const *file) {
+  bool json = options.optimizationRecord == OPTION_OR_JSON;
+  bool first = true;
+  if (json) fprintf(where, "[");
+  for (size_t idx = 0; idx < saved.size; ++idx) {
+    Remark const *r = saved.elements[idx];
+    if (r->file != file) continue;
+
+    if (json) {
+      fprintf(where, "%s\n  {\"Kind\": \"%s\", \"Pass\": ", first ? "" : ",",
+              remarkKindName(r->kind));
+      writeJsonString(where, r->pass);
+      fprintf(where, ", \"DebugLoc\": {\"File\": ");
+      writeJsonString(where, r->file->inputFilename);
+      fprintf(where, ", \"Line\": %zu, \"Column\": %zu}, \"Function\": ",
+              r->line, r->character);
+      writeJsonString(where, r->function);
+      fprintf(where, ", \"Message\": ");
+      writeJsonString(where, r->message);
+      fprintf(where, "}");
+    } else {
+      fprintf(where, "--- !%s\nPass: ", remarkKindName(r->kind));
+      writeYamlString(where, r->pass);
+      fprintf(where, "\nDebugLoc: { File: ");
+      writeYamlString(where, r->file->inputFilename);
+      fprintf(where, ", Line: %zu, Column: %zu }\nFunction: ", r->line,
+              r->character);
+      writeYamlString(where, r->function);
+      fprintf(where, "\nMessage: ");
+      writeYamlString(where, r->message);
+      fprintf(where, "\n...\n");
+    }
+    first = false;
+  }
+  if (json) fprintf(where, "%s]\n", first ? "" : "\n");
+}
+
+int remarksSave(void) {
+  if (options.optimizationRecord == OPTION_OR_NONE) return 0;
+
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    FileListEntry *file = &fileList.entries[idx];
+    if (!file->isCode) continue;
+
+    // foo/bar.tc -> foo/bar.opt.yaml
+    char const *filename = file->inputFilename;
+    char const *base = strrchr(filename, '/');
+    char const *extension = strrchr(base == NULL ? filename : base, '.');
+    size_t stemLength =
+        extension == NULL ? strlen(filename) : (size_t)(extension - filename);
+    char *recordName =
+        format("%.*s.opt.%s", (int)stemLength, filename,
+               options.optimizationRecord == OPTION_OR_JSON ? "json" : "yaml");
+
+    FILE *record = fopen(recordName, "w");
+    if (record == NULL) {
+      fprintf(stderr, "%s: error: could not open optimization record\n",
+              recordName);
+      free(recordName);
+      return -1;
+    }
+    remarksWrite(record, file);
+    fclose(record);
+    free(recordName);
+  }
+  return 0;
+}
+
+/**
+ * frees a remark
+ */
+static void remarkFree(Remark *r) {
+  free(r->function);
+  free(r->message);
+  free(r);
+}
+
+void remarksUninit(void) {
+  if (hasPassedRegex) regfree(&passedRegex);
+  hasPassedRegex = false;
+  if (hasMissedRegex) regfree(&missedRegex);
+  hasMissedRegex = false;
+  vectorUninit(&saved, (void (*)(void *))remarkFree);
+}
@@ -0,0 +1,118 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * optimization remarks - reports of optimizations applied and missed
+ *
+ * remarks from passes matching -Rpass or -Rpass-missed are printed as
+ * diagnostics, and with -fsave-optimization-record, every remark is saved next
+ * to the file it's about
+ */
+
+#ifndef TLC_OPTIMIZATION_REMARKS_H_
+#define TLC_OPTIMIZATION_REMARKS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "ast/ast.h"
+#include "fileList.h"
+#include "util/container/vector.h"
+
+/** the kind of a remark */
+typedef enum {
+  RK_PASSED, /**< an optimization was applied */
+  RK_MISSED, /**< an optimization was considered, but not applied */
+} RemarkKind;
+
+/** an optimization remark */
+typedef struct {
+  RemarkKind kind;
+  char const *pass;    /**< non-owning name of the pass */
+  FileListEntry *file; /**< file the remark is about */
+  char *function;      /**< name of the function the remark is about */
+  size_t line;         /**< position of the node the remark is about */
+  size_t character;
+  char *message; /**< why the optimization was or wasn't applied */
+} Remark;
+
+/**
+ * prepares to report remarks
+ *
+ * complains if -Rpass or -Rpass-missed isn't a valid regular expression
+ *
+ * @returns status code (0 = OK)
+ */
+int remarksInit(void);
+
+/**
+ * are remarks of a kind from a pass reported?
+ *
+ * @param kind kind of remark
+ * @param pass name of the pass
+ * @returns whether the remark would be printed or saved
+ */
+bool remarkEnabled(RemarkKind kind, char const *pass);
+
+/**
+ * reports a remark
+ *
+ * @param kind kind of remark
+ * @param pass name of the pass making the remark, must outlive the remarks
+ * @param file file the remark is about
+ * @param function NT_FUNDEFN the remark is about
+ * @param node node the remark is about
+ * @param format printf format string of the message
+ */
+void remark(RemarkKind kind, char const *pass, FileListEntry *file,
+            Node const *function, Node const *node, char const *format, ...)
+    __attribute__((format(printf, 6, 7)));
+
+/**
+ * gets the saved remarks
+ *
+ * @returns vector of Remark, in the order they were made
+ */
+Vector const *remarksSaved(void);
+
+/**
+ * writes the saved remarks about a file in the format given by
+ * -fsave-optimization-record
+ *
+ * @param where file to write to
+ * @param file file to write the remarks of
+ */
+void remarksWrite(FILE *where, FileListEntry const *file);
+
+/**
+ * writes the saved remarks about each file to a .opt.yaml or .opt.json file
+ * beside it
+ *
+ * @returns status code (0 = OK)
+ */
+int remarksSave(void);
+
+/**
+ * discards all remarks
+ */
+void remarksUninit(void);
+
+#endif  // TLC_OPTIMIZATION_REMARKS_H_
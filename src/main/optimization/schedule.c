@@ -0,0 +1,507 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// list scheduling implementation
+
+#include "optimization/schedule.h"
+
+#include <stdlib.h>
+
+#include "util/internalError.h"
+
+size_t const NO_REGISTER = SIZE_MAX;
+
+enum {
+  MAX_UNITS = 4, /**< most units any instruction class has */
+};
+
+void instructionTiming(TuneOption tune, InstructionClass kind,
+                       InstructionTiming *timing) {
+  switch (tune) {
+    case OPTION_MT_GENERIC: {
+      // conservative numbers that hold for most processors
+      switch (kind) {
+        case IC_ALU: {
+          *timing = (InstructionTiming){1, 1, 3};
+          return;
+        }
+        case IC_IMUL: {
+          *timing = (InstructionTiming){3, 1, 1};
+          return;
+        }
+        case IC_IDIV: {
+          *timing = (InstructionTiming){40, 20, 1};
+          return;
+        }
+        case IC_LOAD: {
+          *timing = (InstructionTiming){5, 1, 2};
+          return;
+        }
+        case IC_STORE: {
+          *timing = (InstructionTiming){1, 1, 1};
+          return;
+        }
+        case IC_FADD: {
+          *timing = (InstructionTiming){4, 1, 1};
+          return;
+        }
+        case IC_FMUL: {
+          *timing = (InstructionTiming){5, 1, 1};
+          return;
+        }
+        case IC_FDIV: {
+          *timing = (InstructionTiming){20, 8, 1};
+          return;
+        }
+        case IC_BRANCH: {
+          *timing = (InstructionTiming){1, 1, 1};
+          return;
+        }
+        default: {
+          error(__FILE__, __LINE__,
+                "invalid InstructionClass enum encountered");
+        }
+      }
+    }
+    case OPTION_MT_SKYLAKE: {
+      switch (kind) {
+        case IC_ALU: {
+          *timing = (InstructionTiming){1, 1, 4};
+          return;  // ports 0, 1, 5, and 6
+        }
+        case IC_IMUL: {
+          *timing = (InstructionTiming){3, 1, 1};
+          return;  // port 1
+        }
+        case IC_IDIV: {
+          *timing = (InstructionTiming){26, 6, 1};
+          return;
+        }
+        case IC_LOAD: {
+          *timing = (InstructionTiming){5, 1, 2};
+          return;  // ports 2 and 3
+        }
+        case IC_STORE: {
+          *timing = (InstructionTiming){1, 1, 1};
+          return;  // port 4
+        }
+        case IC_FADD: {
+          *timing = (InstructionTiming){4, 1, 2};
+          return;  // ports 0 and 1
+        }
+        case IC_FMUL: {
+          *timing = (InstructionTiming){4, 1, 2};
+          return;  // ports 0 and 1
+        }
+        case IC_FDIV: {
+          *timing = (InstructionTiming){14, 4, 1};
+          return;  // port 0
+        }
+        case IC_BRANCH: {
+          *timing = (InstructionTiming){1, 1, 2};
+          return;  // ports 0 and 6
+        }
+        default: {
+          error(__FILE__, __LINE__,
+                "invalid InstructionClass enum encountered");
+        }
+      }
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid TuneOption enum encountered");
+    }
+  }
+}
+
+size_t instructionLatency(TuneOption tune, InstructionClass kind) {
+  InstructionTiming timing;
+  instructionTiming(tune, kind, &timing);
+  return timing.latency;
+}
+
+size_t issueWidth(TuneOption tune) {
+  switch (tune) {
+    case OPTION_MT_GENERIC:
+    case OPTION_MT_SKYLAKE: {
+      return 4;
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid TuneOption enum encountered");
+    }
+  }
+}
+
+/** a dependence of an instruction on an earlier one */
+typedef struct {
+  size_t from;    /**< index of the earlier instruction */
+  size_t latency; /**< cycles between issuing the two */
+  bool flow;      /**< does the instruction use a value defined by from */
+} Dependence;
+
+/** dependences between the instructions of a block */
+typedef struct {
+  size_t count;
+  size_t *start; /**< count + 1 indices into edges - the dependences of
+                    instruction i are edges[start[i]] to edges[start[i + 1]] */
+  Dependence *edges;
+} DependenceGraph;
+
+/**
+ * does an instruction use a register?
+ */
+static bool usesRegister(ScheduleInstruction const *instruction, size_t reg) {
+  for (size_t idx = 0; idx < instruction->numUses; ++idx)
+    if (instruction->uses[idx] == reg) return true;
+  return false;
+}
+/**
+ * adds a dependence, keeping the longest latency
+ */
+static void addDependence(size_t *existing, size_t latency) {
+  if (*existing == SIZE_MAX || *existing < latency) *existing = latency;
+}
+/**
+ * builds the dependence graph of a block
+ */
+static void dependenceGraphInit(DependenceGraph *graph,
+                                ScheduleInstruction const *instructions,
+                                size_t count, TuneOption tune) {
+  graph->count = count;
+  graph->start = malloc((count + 1) * sizeof(size_t));
+  size_t capacity = count;
+  graph->edges = malloc(capacity * sizeof(Dependence));
+  size_t numEdges = 0;
+
+  for (size_t to = 0; to < count; ++to) {
+    ScheduleInstruction const *consumer = &instructions[to];
+    graph->start[to] = numEdges;
+
+    // the latest definition of each register used has been seen
+    bool defSeen[MAX_SCHEDULE_USES] = {false};
+    for (size_t from = to; from-- > 0;) {
+      ScheduleInstruction const *producer = &instructions[from];
+      size_t latency = SIZE_MAX;
+      bool flow = false;
+      if (consumer->kind == IC_BRANCH) addDependence(&latency, 0);
+
+      // register dependences - the use must read the latest definition
+      if (producer->def != NO_REGISTER) {
+        for (size_t use = 0; use < consumer->numUses; ++use) {
+          if (consumer->uses[use] == producer->def && !defSeen[use]) {
+            defSeen[use] = true;
+            flow = true;
+          }
+        }
+        if (flow)
+          addDependence(&latency, instructionLatency(tune, producer->kind));
+      }
+      if (consumer->def != NO_REGISTER &&
+          (producer->def == consumer->def ||
+           usesRegister(producer, consumer->def)))
+        addDependence(&latency, 0);
+
+      // memory dependences - addresses aren't known, so any store conflicts
+      if (producer->kind == IC_STORE &&
+          (consumer->kind == IC_LOAD || consumer->kind == IC_STORE))
+        addDependence(&latency, instructionLatency(tune, producer->kind));
+      else if (producer->kind == IC_LOAD && consumer->kind == IC_STORE)
+        addDependence(&latency, 0);
+
+      if (latency == SIZE_MAX) continue;
+      if (numEdges == capacity) {
+        capacity *= 2;
+        graph->edges = realloc(graph->edges, capacity * sizeof(Dependence));
+      }
+      graph->edges[numEdges++] = (Dependence){from, latency, flow};
+    }
+  }
+  graph->start[count] = numEdges;
+}
+/**
+ * frees a dependence graph
+ */
+static void dependenceGraphUninit(DependenceGraph *graph) {
+  free(graph->start);
+  free(graph->edges);
+}
+
+/** the execution resources in use */
+typedef struct {
+  TuneOption tune;
+  size_t cycle;  /**< current cycle */
+  size_t issued; /**< number of instructions issued this cycle */
+  size_t busyUntil[IC_BRANCH + 1][MAX_UNITS]; /**< cycle each unit frees up */
+} ResourceState;
+
+/**
+ * initializes the resources
+ */
+static void resourceStateInit(ResourceState *state, TuneOption tune) {
+  state->tune = tune;
+  state->cycle = 0;
+  state->issued = 0;
+  for (size_t kind = 0; kind <= IC_BRANCH; ++kind)
+    for (size_t unit = 0; unit < MAX_UNITS; ++unit)
+      state->busyUntil[kind][unit] = 0;
+}
+/**
+ * moves to the next cycle
+ */
+static void resourceStateAdvance(ResourceState *state) {
+  ++state->cycle;
+  state->issued = 0;
+}
+/**
+ * finds a free unit for an instruction this cycle
+ *
+ * @returns index of the unit, or SIZE_MAX if there is no free unit or issue
+ * slot
+ */
+static size_t resourceStateFreeUnit(ResourceState const *state,
+                                    InstructionClass kind) {
+  if (state->issued == issueWidth(state->tune)) return SIZE_MAX;
+
+  InstructionTiming timing;
+  instructionTiming(state->tune, kind, &timing);
+  for (size_t unit = 0; unit < timing.units; ++unit)
+    if (state->busyUntil[kind][unit] <= state->cycle) return unit;
+  return SIZE_MAX;
+}
+/**
+ * issues an instruction this cycle
+ *
+ * @param unit free unit, from resourceStateFreeUnit
+ */
+static void resourceStateIssue(ResourceState *state, InstructionClass kind,
+                               size_t unit) {
+  InstructionTiming timing;
+  instructionTiming(state->tune, kind, &timing);
+  state->busyUntil[kind][unit] = state->cycle + timing.occupancy;
+  ++state->issued;
+}
+
+/**
+ * are all the dependences of an instruction scheduled?
+ */
+static bool dependencesScheduled(DependenceGraph const *graph,
+                                 size_t instruction, bool const *scheduled) {
+  for (size_t edge = graph->start[instruction];
+       edge < graph->start[instruction + 1]; ++edge)
+    if (!scheduled[graph->edges[edge].from]) return false;
+  return true;
+}
+/**
+ * are the results an instruction depends on ready? (all dependences must be
+ * scheduled)
+ */
+static bool resultsReady(DependenceGraph const *graph, size_t instruction,
+                         size_t const *issueCycle, size_t cycle) {
+  for (size_t edge = graph->start[instruction];
+       edge < graph->start[instruction + 1]; ++edge) {
+    Dependence const *dependence = &graph->edges[edge];
+    if (issueCycle[dependence->from] + dependence->latency > cycle)
+      return false;
+  }
+  return true;
+}
+/**
+ * gets the change in the number of live values if an instruction is scheduled
+ */
+static long pressureDelta(DependenceGraph const *graph, size_t instruction,
+                          size_t const *remainingUsers) {
+  long delta = remainingUsers[instruction] != 0 ? 1 : 0;
+  for (size_t edge = graph->start[instruction];
+       edge < graph->start[instruction + 1]; ++edge) {
+    Dependence const *dependence = &graph->edges[edge];
+    if (dependence->flow && remainingUsers[dependence->from] == 1) --delta;
+  }
+  return delta;
+}
+
+/**
+ * schedules a region of a basic block
+ *
+ * @param order output array of count indices, relative to the start of the
+ * region
+ */
+static void scheduleRegion(ScheduleInstruction const *instructions,
+                           size_t count, TuneOption tune, size_t maxPressure,
+                           size_t *order) {
+  DependenceGraph graph;
+  dependenceGraphInit(&graph, instructions, count, tune);
+
+  // priority - longest latency path to the end of the region
+  size_t *height = malloc(count * sizeof(size_t));
+  for (size_t idx = 0; idx < count; ++idx)
+    height[idx] = instructionLatency(tune, instructions[idx].kind);
+  for (size_t succ = count; succ-- > 0;) {
+    for (size_t edge = graph.start[succ]; edge < graph.start[succ + 1];
+         ++edge) {
+      Dependence const *dependence = &graph.edges[edge];
+      if (dependence->latency + height[succ] > height[dependence->from])
+        height[dependence->from] = dependence->latency + height[succ];
+    }
+  }
+
+  // number of unscheduled users of each value
+  size_t *remainingUsers = malloc(count * sizeof(size_t));
+  for (size_t idx = 0; idx < count; ++idx) remainingUsers[idx] = 0;
+  for (size_t edge = 0; edge < graph.start[count]; ++edge)
+    if (graph.edges[edge].flow) ++remainingUsers[graph.edges[edge].from];
+  bool *scheduled = malloc(count * sizeof(bool));
+  size_t *issueCycle = malloc(count * sizeof(size_t));
+  for (size_t idx = 0; idx < count; ++idx) scheduled[idx] = false;
+
+  ResourceState state;
+  resourceStateInit(&state, tune);
+  size_t live = 0;
+  for (size_t numScheduled = 0; numScheduled < count;) {
+    size_t best = SIZE_MAX;
+    size_t bestUnit = SIZE_MAX;
+    long bestDelta = 0;
+    bool relieverWaiting = false;
+    for (size_t candidate = 0; candidate < count; ++candidate) {
+      if (scheduled[candidate] ||
+          !dependencesScheduled(&graph, candidate, scheduled))
+        continue;
+      long delta = pressureDelta(&graph, candidate, remainingUsers);
+      size_t unit = resourceStateFreeUnit(&state, instructions[candidate].kind);
+      if (!resultsReady(&graph, candidate, issueCycle, state.cycle) ||
+          unit == SIZE_MAX) {
+        if (delta <= 0) relieverWaiting = true;
+        continue;
+      }
+
+      bool better;
+      if (best == SIZE_MAX)
+        better = true;
+      else if (live >= maxPressure && delta != bestDelta)
+        better = delta < bestDelta;
+      else
+        better = height[candidate] > height[best];
+      if (better) {
+        best = candidate;
+        bestUnit = unit;
+        bestDelta = delta;
+      }
+    }
+
+    // rather than make pressure worse, wait for something that relieves it
+    if (best == SIZE_MAX ||
+        (live >= maxPressure && bestDelta > 0 && relieverWaiting)) {
+      resourceStateAdvance(&state);
+      continue;
+    }
+
+    resourceStateIssue(&state, instructions[best].kind, bestUnit);
+    scheduled[best] = true;
+    issueCycle[best] = state.cycle;
+    order[numScheduled++] = best;
+    live = (size_t)((long)live + bestDelta);
+    for (size_t edge = graph.start[best]; edge < graph.start[best + 1];
+         ++edge)
+      if (graph.edges[edge].flow) --remainingUsers[graph.edges[edge].from];
+  }
+
+  free(issueCycle);
+  free(scheduled);
+  free(remainingUsers);
+  free(height);
+  dependenceGraphUninit(&graph);
+}
+
+void scheduleBlock(ScheduleInstruction const *instructions, size_t count,
+                   TuneOption tune, size_t maxPressure, size_t *order) {
+  // regions are scheduled one after the other, so nothing moves between them
+  for (size_t start = 0; start < count; start += MAX_SCHEDULE_REGION) {
+    size_t size = count - start < MAX_SCHEDULE_REGION ? count - start
+                                                      : MAX_SCHEDULE_REGION;
+    scheduleRegion(instructions + start, size, tune, maxPressure,
+                   order + start);
+    for (size_t idx = start; idx < start + size; ++idx) order[idx] += start;
+  }
+}
+
+size_t scheduleLength(ScheduleInstruction const *instructions, size_t count,
+                      size_t const *order, TuneOption tune) {
+  DependenceGraph graph;
+  dependenceGraphInit(&graph, instructions, count, tune);
+
+  bool *scheduled = malloc(count * sizeof(bool));
+  size_t *issueCycle = malloc(count * sizeof(size_t));
+  for (size_t idx = 0; idx < count; ++idx) scheduled[idx] = false;
+
+  ResourceState state;
+  resourceStateInit(&state, tune);
+  size_t length = 0;
+  for (size_t idx = 0; idx < count; ++idx) {
+    size_t instruction = order[idx];
+    if (!dependencesScheduled(&graph, instruction, scheduled))
+      error(__FILE__, __LINE__, "schedule order violates a dependence");
+
+    InstructionClass kind = instructions[instruction].kind;
+    size_t unit = SIZE_MAX;
+    while (!resultsReady(&graph, instruction, issueCycle, state.cycle) ||
+           (unit = resourceStateFreeUnit(&state, kind)) == SIZE_MAX)
+      resourceStateAdvance(&state);
+
+    resourceStateIssue(&state, kind, unit);
+    scheduled[instruction] = true;
+    issueCycle[instruction] = state.cycle;
+    size_t done = state.cycle + instructionLatency(tune, kind);
+    if (done > length) length = done;
+  }
+
+  free(issueCycle);
+  free(scheduled);
+  dependenceGraphUninit(&graph);
+  return length;
+}
+
+size_t schedulePressure(ScheduleInstruction const *instructions, size_t count,
+                        size_t const *order) {
+  // position of each instruction in the order
+  size_t *position = malloc(count * sizeof(size_t));
+  for (size_t idx = 0; idx < count; ++idx) position[order[idx]] = idx;
+
+  // a value is live from its definition to its last use
+  size_t *lastUse = malloc(count * sizeof(size_t));
+  for (size_t def = 0; def < count; ++def) {
+    lastUse[def] = position[def];
+    if (instructions[def].def == NO_REGISTER) continue;
+    for (size_t use = def + 1; use < count; ++use) {
+      if (usesRegister(&instructions[use], instructions[def].def) &&
+          position[use] > lastUse[def])
+        lastUse[def] = position[use];
+      if (instructions[use].def == instructions[def].def) break;
+    }
+  }
+
+  size_t maxLive = 0;
+  for (size_t at = 0; at < count; ++at) {
+    size_t live = 0;
+    for (size_t def = 0; def < count; ++def)
+      if (position[def] <= at && lastUse[def] > at) ++live;
+    if (live > maxLive) maxLive = live;
+  }
+
+  free(lastUse);
+  free(position);
+  return maxLive;
+}
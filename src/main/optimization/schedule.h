@@ -0,0 +1,141 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * latency-aware list scheduling of a basic block
+ *
+ * instructions are described by their class and the virtual registers they
+ * define and use, so the scheduler can run before register allocation
+ */
+
+#ifndef TLC_OPTIMIZATION_SCHEDULE_H_
+#define TLC_OPTIMIZATION_SCHEDULE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "options.h"
+
+/** the kind of execution resource an instruction needs */
+typedef enum {
+  IC_ALU,    /**< integer arithmetic, logic, and moves */
+  IC_IMUL,   /**< integer multiplication */
+  IC_IDIV,   /**< integer division */
+  IC_LOAD,   /**< memory read */
+  IC_STORE,  /**< memory write */
+  IC_FADD,   /**< floating point addition and subtraction */
+  IC_FMUL,   /**< floating point multiplication */
+  IC_FDIV,   /**< floating point division and square root */
+  IC_BRANCH, /**< block terminator - always scheduled last */
+} InstructionClass;
+
+/** timing of an instruction class on a microarchitecture */
+typedef struct {
+  size_t latency;   /**< cycles until the result is available */
+  size_t occupancy; /**< cycles a unit is busy - one if pipelined */
+  size_t units;     /**< number of units (ports) that can execute it */
+} InstructionTiming;
+
+enum {
+  MAX_SCHEDULE_USES = 3,     /**< maximum number of registers an instruction
+                                uses */
+  MAX_SCHEDULE_REGION = 128, /**< most instructions scheduled together */
+};
+
+/** marks an instruction that doesn't define a register */
+extern size_t const NO_REGISTER;
+
+/** an instruction to schedule */
+typedef struct {
+  InstructionClass kind;
+  size_t def;                     /**< virtual register, or NO_REGISTER */
+  size_t uses[MAX_SCHEDULE_USES]; /**< virtual registers */
+  size_t numUses;
+} ScheduleInstruction;
+
+/**
+ * gets the timing of an instruction class
+ *
+ * @param tune microarchitecture to get timing for
+ * @param kind instruction class
+ * @param timing output pointer to the timing
+ */
+void instructionTiming(TuneOption tune, InstructionClass kind,
+                       InstructionTiming *timing);
+/**
+ * gets the latency of an instruction class
+ *
+ * @param tune microarchitecture to get the latency for
+ * @param kind instruction class
+ */
+size_t instructionLatency(TuneOption tune, InstructionClass kind);
+/**
+ * gets the number of instructions that can be issued per cycle
+ *
+ * @param tune microarchitecture to get the issue width of
+ */
+size_t issueWidth(TuneOption tune);
+
+/**
+ * schedules a basic block
+ *
+ * instructions are scheduled top-down in order of the longest latency path
+ * to the end of the block, except that when more than maxPressure values are
+ * live, instructions that end live ranges are preferred, to avoid spills
+ *
+ * longer blocks are split into regions of MAX_SCHEDULE_REGION instructions,
+ * which are scheduled separately, so scheduling time stays linear in the
+ * length of the block
+ *
+ * @param instructions instructions of the block, in their original order
+ * @param count number of instructions
+ * @param tune microarchitecture to schedule for
+ * @param maxPressure number of registers available
+ * @param order output array of count indices into instructions, in scheduled
+ * order
+ */
+void scheduleBlock(ScheduleInstruction const *instructions, size_t count,
+                   TuneOption tune, size_t maxPressure, size_t *order);
+
+/**
+ * estimates the number of cycles a block takes when issued in order
+ *
+ * @param instructions instructions of the block
+ * @param count number of instructions
+ * @param order order to issue the instructions in
+ * @param tune microarchitecture to estimate for
+ */
+size_t scheduleLength(ScheduleInstruction const *instructions, size_t count,
+                      size_t const *order, TuneOption tune);
+
+/**
+ * gets the maximum number of values simultaneously live within a block
+ *
+ * values live into the block aren't counted
+ *
+ * @param instructions instructions of the block
+ * @param count number of instructions
+ * @param order order to issue the instructions in
+ */
+size_t schedulePressure(ScheduleInstruction const *instructions, size_t count,
+                        size_t const *order);
+
+#endif  // TLC_OPTIMIZATION_SCHEDULE_H_
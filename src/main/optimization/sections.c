@@ -0,0 +1,249 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// section placement implementation
+
+#include "optimization/sections.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "optimization/common.h"
+#include "optimization/layout.h"
+#include "options.h"
+#include "util/conversions.h"
+#include "util/format.h"
+#include "util/internalError.h"
+
+/**
+ * is every element of a type const?
+ *
+ * @param type type to query
+ */
+static bool typeIsConst(Type const *type) {
+  while (true) {
+    switch (type->kind) {
+      case TK_QUALIFIED: {
+        if (type->data.qualified.constQual) return true;
+        type = type->data.qualified.base;
+        break;
+      }
+      case TK_ARRAY: {
+        type = type->data.array.type;
+        break;
+      }
+      case TK_REFERENCE: {
+        if (type->data.reference.entry->kind != SK_TYPEDEF) return false;
+        type = type->data.reference.entry->data.typedefType.actual;
+        break;
+      }
+      default: {
+        return false;
+      }
+    }
+  }
+}
+
+SectionKind variableSectionKind(Type const *type, Node *initializer,
+                                bool threadLocal) {
+  bool zero = initializer == NULL || literalIsZero(initializer);
+  if (threadLocal)
+    return zero ? SEC_TBSS : SEC_TDATA;
+  else if (typeIsConst(type))
+    return SEC_RODATA;
+  else if (zero)
+    return SEC_BSS;
+  else
+    return SEC_DATA;
+}
+
+char *sectionName(SectionKind kind, char const *symbol) {
+  char const *base;
+  bool separate;
+  switch (kind) {
+    case SEC_TEXT: {
+      base = ".text";
+      separate = options.functionSections == OPTION_FS_SEPARATE;
+      break;
+    }
+    case SEC_RODATA: {
+      base = ".rodata";
+      separate = options.dataSections == OPTION_DS_SEPARATE;
+      break;
+    }
+    case SEC_DATA: {
+      base = ".data";
+      separate = options.dataSections == OPTION_DS_SEPARATE;
+      break;
+    }
+    case SEC_BSS: {
+      base = ".bss";
+      separate = options.dataSections == OPTION_DS_SEPARATE;
+      break;
+    }
+    case SEC_TDATA: {
+      base = ".tdata";
+      separate = options.dataSections == OPTION_DS_SEPARATE;
+      break;
+    }
+    case SEC_TBSS: {
+      base = ".tbss";
+      separate = options.dataSections == OPTION_DS_SEPARATE;
+      break;
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid SectionKind enum encountered");
+    }
+  }
+  return separate ? format("%s.%s", base, symbol) : strdup(base);
+}
+
+/**
+ * gets the flags and type of a kind of section, as given to .section
+ *
+ * @param kind kind of data section
+ * @returns flags and type, without the leading comma
+ */
+static char const *sectionAttributes(SectionKind kind) {
+  switch (kind) {
+    case SEC_RODATA: {
+      return "\"a\",@progbits";
+    }
+    case SEC_DATA: {
+      return "\"aw\",@progbits";
+    }
+    case SEC_BSS: {
+      return "\"aw\",@nobits";
+    }
+    case SEC_TDATA: {
+      return "\"awT\",@progbits";
+    }
+    case SEC_TBSS: {
+      return "\"awT\",@nobits";
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid SectionKind enum encountered");
+    }
+  }
+}
+
+/**
+ * gets the directive that writes out a value of some width
+ *
+ * @param width width in bytes - 1, 2, 4, or 8
+ */
+static char const *valueDirective(size_t width) {
+  switch (width) {
+    case 1: {
+      return ".byte";
+    }
+    case 2: {
+      return ".short";
+    }
+    case 4: {
+      return ".long";
+    }
+    case 8: {
+      return ".quad";
+    }
+    default: {
+      error(__FILE__, __LINE__, "packed element has no directive");
+    }
+  }
+}
+
+/**
+ * gets the bits of an element of a packed initializer, converted to the type
+ * of the array element it initializes
+ *
+ * @param keyword keyword of the array's element type, or TK_VOID if it isn't a
+ * keyword type
+ * @param init initializer to read from
+ * @param idx index of the element
+ * @returns converted bits - integers are truncated by the caller
+ */
+static uint64_t convertedElementBits(TypeKeyword keyword,
+                                     PackedInit const *init, size_t idx) {
+  uint64_t bits = packedInitGet(init, idx);
+  if (keyword != TK_FLOAT && keyword != TK_DOUBLE) return bits;
+
+  double value;
+  switch (packedInitElementType(init, idx)) {
+    case LT_FLOAT: {
+      value = bitsToFloat((uint32_t)bits);
+      break;
+    }
+    case LT_DOUBLE: {
+      value = bitsToDouble(bits);
+      break;
+    }
+    case LT_BYTE:
+    case LT_SHORT:
+    case LT_INT:
+    case LT_LONG: {
+      value = (double)(int64_t)bits;
+      break;
+    }
+    default: {
+      value = (double)bits;
+      break;
+    }
+  }
+  return keyword == TK_FLOAT ? floatToBits((float)value) : doubleToBits(value);
+}
+
+void packedArrayEmit(FILE *where, char const *symbol, Type const *type,
+                     Node *initializer, bool threadLocal) {
+  SectionKind kind = variableSectionKind(type, initializer, threadLocal);
+  char *section = sectionName(kind, symbol);
+  fprintf(where, "\t.section\t%s,%s\n", section, sectionAttributes(kind));
+  free(section);
+
+  size_t size;
+  size_t alignment;
+  typeLayout(type, &size, &alignment);
+  fprintf(where, "\t.balign\t%zu\n%s:\n", alignment, symbol);
+  if (kind == SEC_BSS || kind == SEC_TBSS) {
+    fprintf(where, "\t.zero\t%zu\n", size);
+    return;
+  }
+
+  Type const *array = stripType(type);
+  Type const *elementType = stripType(array->data.array.type);
+  size_t elementSize;
+  typeLayout(elementType, &elementSize, &alignment);
+  TypeKeyword keyword = elementType->kind == TK_KEYWORD
+                            ? elementType->data.keyword.keyword
+                            : TK_VOID;
+  uint64_t mask = elementSize == sizeof(uint64_t)
+                      ? UINT64_MAX
+                      : (UINT64_C(1) << elementSize * 8) - 1;
+
+  PackedInit const *init = initializer->data.literal.data.packedInitVal;
+  size_t length = init->length < array->data.array.length
+                      ? init->length
+                      : array->data.array.length;
+  fprintf(where, "\t%s\t", valueDirective(elementSize));
+  for (size_t idx = 0; idx < length; ++idx)
+    fprintf(where, idx == 0 ? "%lu" : ", %lu",
+            convertedElementBits(keyword, init, idx) & mask);
+  fprintf(where, "\n");
+  if (length * elementSize != size)
+    fprintf(where, "\t.zero\t%zu\n", size - length * elementSize);
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * section placement of functions and global variables
+ */
+
+#ifndef TLC_OPTIMIZATION_SECTIONS_H_
+#define TLC_OPTIMIZATION_SECTIONS_H_
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "ast/ast.h"
+
+/** the kind of section a symbol is placed in */
+typedef enum {
+  SEC_TEXT,   /**< code */
+  SEC_RODATA, /**< constant initialized data */
+  SEC_DATA,   /**< mutable initialized data */
+  SEC_BSS,    /**< zero-initialized data */
+  SEC_TDATA,  /**< initialized thread-local data */
+  SEC_TBSS,   /**< zero-initialized thread-local data */
+} SectionKind;
+
+/**
+ * decides which kind of section a global variable belongs in
+ *
+ * thread-local variables are never read-only - each thread's copy lives at a
+ * different address, so there's no single copy to share
+ *
+ * @param type type of the variable
+ * @param initializer nullable initializer of the variable, a literal
+ * @param threadLocal is the variable threadlocal?
+ * @returns section kind - never SEC_TEXT
+ */
+SectionKind variableSectionKind(Type const *type, Node *initializer,
+                                bool threadLocal);
+
+/**
+ * gets the name of the section a symbol is placed in
+ *
+ * with -ffunction-sections or -fdata-sections, each symbol gets its own
+ * section, named after the symbol, so the linker can discard it if it's unused
+ *
+ * @param kind kind of section the symbol belongs in
+ * @param symbol assembly name of the symbol
+ * @returns section name, owned by the caller
+ */
+char *sectionName(SectionKind kind, char const *symbol);
+
+/**
+ * writes out a global array initialized by a packed initializer as GNU
+ * assembler directives
+ *
+ * the array is placed in the section variableSectionKind picks, and each
+ * element is converted to the array's element type and written at that width.
+ * Elements past the end of the initializer are zero, and an all zero array
+ * only reserves space in .bss or .tbss. Only the label is defined - its binding
+ * is up to the caller
+ *
+ * @param where file to write to
+ * @param symbol assembly name of the array
+ * @param type type of the array
+ * @param initializer LT_PACKEDINIT literal initializing the array
+ * @param threadLocal is the array threadlocal?
+ */
+void packedArrayEmit(FILE *where, char const *symbol, Type const *type,
+                     Node *initializer, bool threadLocal);
+
+#endif  // TLC_OPTIMIZATION_SECTIONS_H_
@@ -0,0 +1,443 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// arithmetic strength reduction implementation
+//
+// magic numbers are found using the algorithms from Hacker's Delight, chapter
+// 10, generalized to any width up to 64 bits
+
+#include "optimization/strengthReduction.h"
+
+#include "optimization/common.h"
+#include "util/internalError.h"
+
+/**
+ * gets a mask of the low width bits
+ */
+static uint64_t lowMask(size_t width) {
+  return width == 64 ? UINT64_MAX : (UINT64_C(1) << width) - 1;
+}
+/**
+ * sign extends the low width bits of a value
+ */
+static int64_t signExtend(uint64_t value, size_t width) {
+  uint64_t sign = UINT64_C(1) << (width - 1);
+  return (int64_t)(((value & lowMask(width)) ^ sign) - sign);
+}
+/**
+ * is the value a power of two?
+ */
+static bool isPowerOfTwo(uint64_t value) {
+  return value != 0 && (value & (value - 1)) == 0;
+}
+/**
+ * gets the base two logarithm of a power of two
+ */
+static size_t log2Exact(uint64_t value) {
+  size_t log = 0;
+  while (value >>= 1) ++log;
+  return log;
+}
+/**
+ * gets the high 64 bits of the 128 bit product of two unsigned numbers
+ */
+static uint64_t mulhu64(uint64_t a, uint64_t b) {
+  uint64_t aLow = a & UINT32_MAX;
+  uint64_t aHigh = a >> 32;
+  uint64_t bLow = b & UINT32_MAX;
+  uint64_t bHigh = b >> 32;
+
+  uint64_t lowLow = aLow * bLow;
+  uint64_t lowHigh = aLow * bHigh;
+  uint64_t highLow = aHigh * bLow;
+  uint64_t highHigh = aHigh * bHigh;
+
+  uint64_t middle =
+      (lowLow >> 32) + (lowHigh & UINT32_MAX) + (highLow & UINT32_MAX);
+  return highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+}
+/**
+ * gets the high half of the product of two unsigned width bit numbers
+ */
+static uint64_t mulhu(uint64_t a, uint64_t b, size_t width) {
+  if (width == 64)
+    return mulhu64(a, b);
+  else
+    return (a * b) >> width;
+}
+/**
+ * gets the high half of the product of two signed width bit numbers,
+ * truncated to width bits
+ */
+static uint64_t mulhs(uint64_t a, uint64_t b, size_t width) {
+  if (width == 64) {
+    return mulhu64(a, b) - (a >> 63 ? b : 0) - (b >> 63 ? a : 0);
+  } else {
+    int64_t product = signExtend(a, width) * signExtend(b, width);
+    return (uint64_t)(product >> width) & lowMask(width);
+  }
+}
+
+/**
+ * finds the magic number for an unsigned division (Hacker's Delight 10-8)
+ *
+ * @param plan plan with divisor and width set
+ */
+static void unsignedMagic(DivisionPlan *plan) {
+  size_t width = plan->width;
+  uint64_t mask = lowMask(width);
+  uint64_t d = plan->divisor;
+  uint64_t topBit = UINT64_C(1) << (width - 1);
+
+  bool add = false;
+  uint64_t nc = (mask - ((-d & mask) % d)) & mask;
+  size_t p = width - 1;
+  uint64_t q1 = topBit / nc;
+  uint64_t r1 = topBit - q1 * nc;
+  uint64_t q2 = (topBit - 1) / d;
+  uint64_t r2 = (topBit - 1) - q2 * d;
+  uint64_t delta;
+  do {
+    ++p;
+    if (r1 >= nc - r1) {
+      if (q1 >= topBit - 1) add = true;
+      q1 = (2 * q1 + 1) & mask;
+      r1 = (2 * r1 - nc) & mask;
+    } else {
+      q1 = (2 * q1) & mask;
+      r1 = 2 * r1;
+    }
+    if (r2 + 1 >= d - r2) {
+      if (q2 >= topBit - 1) add = true;
+      q2 = (2 * q2 + 1) & mask;
+      r2 = (2 * r2 + 1 - d) & mask;
+    } else {
+      if (q2 >= topBit) add = true;
+      q2 = (2 * q2) & mask;
+      r2 = 2 * r2 + 1;
+    }
+    delta = d - 1 - r2;
+  } while (p < 2 * width && (q1 < delta || (q1 == delta && r1 == 0)));
+
+  plan->kind = add ? DK_MAGICADD : DK_MAGIC;
+  plan->multiplier = (q2 + 1) & mask;
+  plan->shift = p - width;
+}
+/**
+ * finds the magic number for a signed division (Hacker's Delight 10-1)
+ *
+ * @param plan plan with divisor and width set
+ */
+static void signedMagic(DivisionPlan *plan) {
+  size_t width = plan->width;
+  uint64_t mask = lowMask(width);
+  uint64_t d = plan->divisor;
+  uint64_t topBit = UINT64_C(1) << (width - 1);
+
+  uint64_t ad = signExtend(d, width) < 0 ? -d & mask : d;
+  uint64_t t = topBit + (d >> (width - 1));
+  uint64_t anc = t - 1 - t % ad;
+  size_t p = width - 1;
+  uint64_t q1 = topBit / anc;
+  uint64_t r1 = topBit - q1 * anc;
+  uint64_t q2 = topBit / ad;
+  uint64_t r2 = topBit - q2 * ad;
+  uint64_t delta;
+  do {
+    ++p;
+    q1 = (2 * q1) & mask;
+    r1 = 2 * r1;
+    if (r1 >= anc) {
+      ++q1;
+      r1 -= anc;
+    }
+    q2 = (2 * q2) & mask;
+    r2 = 2 * r2;
+    if (r2 >= ad) {
+      ++q2;
+      r2 -= ad;
+    }
+    delta = ad - r2;
+  } while (q1 < delta || (q1 == delta && r1 == 0));
+
+  uint64_t multiplier = (q2 + 1) & mask;
+  if (signExtend(d, width) < 0) multiplier = -multiplier & mask;
+
+  plan->kind = DK_MAGIC;
+  plan->multiplier = multiplier;
+  plan->shift = p - width;
+}
+
+void divisionPlanCreate(uint64_t divisor, size_t width, bool isSigned,
+                        DivisionPlan *plan) {
+  plan->width = width;
+  plan->isSigned = isSigned;
+  plan->divisor = divisor & lowMask(width);
+  plan->multiplier = 0;
+  plan->shift = 0;
+
+  if (plan->divisor == 0)
+    error(__FILE__, __LINE__, "attempted to plan a division by zero");
+
+  if (isSigned) {
+    int64_t value = signExtend(plan->divisor, width);
+    uint64_t magnitude = value < 0 ? -plan->divisor & lowMask(width)
+                                   : plan->divisor;
+    if (value == 1) {
+      plan->kind = DK_IDENTITY;
+    } else if (value == -1) {
+      plan->kind = DK_NEGATE;
+    } else if (isPowerOfTwo(magnitude)) {
+      plan->kind = DK_SIGNEDSHIFT;
+      plan->shift = log2Exact(magnitude);
+    } else {
+      signedMagic(plan);
+    }
+  } else {
+    if (plan->divisor == 1) {
+      plan->kind = DK_IDENTITY;
+    } else if (isPowerOfTwo(plan->divisor)) {
+      plan->kind = DK_SHIFT;
+      plan->shift = log2Exact(plan->divisor);
+    } else if (plan->divisor > lowMask(width) >> 1) {
+      plan->kind = DK_COMPARE;
+    } else {
+      unsignedMagic(plan);
+    }
+  }
+}
+
+uint64_t divisionPlanQuotient(DivisionPlan const *plan, uint64_t dividend) {
+  size_t width = plan->width;
+  uint64_t mask = lowMask(width);
+  uint64_t n = dividend & mask;
+  switch (plan->kind) {
+    case DK_IDENTITY: {
+      return n;
+    }
+    case DK_NEGATE: {
+      return -n & mask;
+    }
+    case DK_SHIFT: {
+      return n >> plan->shift;
+    }
+    case DK_SIGNEDSHIFT: {
+      // sar to get all ones if negative, then shr to get 2^shift - 1
+      uint64_t sign = signExtend(n, width) < 0 ? mask : 0;
+      uint64_t bias = sign >> (width - plan->shift);
+      int64_t quotient = signExtend(n + bias, width) >> plan->shift;
+      if (signExtend(plan->divisor, width) < 0) quotient = -quotient;
+      return (uint64_t)quotient & mask;
+    }
+    case DK_COMPARE: {
+      return n >= plan->divisor;
+    }
+    case DK_MAGIC: {
+      if (plan->isSigned) {
+        uint64_t quotient = mulhs(plan->multiplier, n, width);
+        int64_t divisor = signExtend(plan->divisor, width);
+        int64_t multiplier = signExtend(plan->multiplier, width);
+        if (divisor > 0 && multiplier < 0)
+          quotient += n;
+        else if (divisor < 0 && multiplier > 0)
+          quotient -= n;
+        quotient = (uint64_t)(signExtend(quotient, width) >> plan->shift);
+        // round towards zero by adding one if negative
+        quotient += (quotient & mask) >> (width - 1);
+        return quotient & mask;
+      } else {
+        return mulhu(plan->multiplier, n, width) >> plan->shift;
+      }
+    }
+    case DK_MAGICADD: {
+      uint64_t high = mulhu(plan->multiplier, n, width);
+      return ((((n - high) & mask) >> 1) + high) >> (plan->shift - 1);
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid DivisionKind enum encountered");
+    }
+  }
+}
+
+uint64_t divisionPlanRemainder(DivisionPlan const *plan, uint64_t dividend) {
+  uint64_t mask = lowMask(plan->width);
+  uint64_t n = dividend & mask;
+  if (plan->kind == DK_SHIFT) return n & (plan->divisor - 1);
+  uint64_t quotient = divisionPlanQuotient(plan, n);
+  return (n - quotient * plan->divisor) & mask;
+}
+
+/**
+ * plans a multiplication by a positive constant in at most maxSteps steps
+ *
+ * @param multiplier constant to multiply by, must be positive
+ * @param steps output array of steps
+ * @param maxSteps maximum number of steps to use
+ * @returns number of steps used, or SIZE_MAX if it can't be done
+ */
+static size_t planMagnitude(uint64_t multiplier, MultiplicationStep *steps,
+                            size_t maxSteps) {
+  if (multiplier == 1) return 0;
+  if (maxSteps == 0) return SIZE_MAX;
+
+  MultiplicationStep candidates[6];
+  uint64_t prefixes[6];
+  size_t numCandidates = 0;
+
+  if (multiplier % 2 == 0) {
+    size_t shift = 0;
+    while ((multiplier >> shift) % 2 == 0) ++shift;
+    candidates[numCandidates] = (MultiplicationStep){MS_SHIFT, shift};
+    prefixes[numCandidates++] = multiplier >> shift;
+  }
+  for (size_t scale = 1; scale <= 3; ++scale) {
+    uint64_t factor = (UINT64_C(1) << scale) + 1;
+    if (multiplier % factor == 0) {
+      candidates[numCandidates] = (MultiplicationStep){MS_LEA, scale};
+      prefixes[numCandidates++] = multiplier / factor;
+    }
+  }
+  if (multiplier % 2 == 1) {
+    size_t shift = 0;
+    while (((multiplier - 1) >> shift) % 2 == 0) ++shift;
+    candidates[numCandidates] = (MultiplicationStep){MS_SHIFTADD, shift};
+    prefixes[numCandidates++] = (multiplier - 1) >> shift;
+
+    shift = 0;
+    while (((multiplier + 1) >> shift) % 2 == 0) ++shift;
+    candidates[numCandidates] = (MultiplicationStep){MS_SHIFTSUB, shift};
+    prefixes[numCandidates++] = (multiplier + 1) >> shift;
+  }
+
+  size_t best = SIZE_MAX;
+  MultiplicationStep prefixSteps[MAX_MULTIPLICATION_STEPS];
+  for (size_t idx = 0; idx < numCandidates; ++idx) {
+    size_t limit = best == SIZE_MAX ? maxSteps : best - 1;
+    if (limit == 0) break;
+    size_t numPrefixSteps =
+        planMagnitude(prefixes[idx], prefixSteps, limit - 1);
+    if (numPrefixSteps == SIZE_MAX) continue;
+    for (size_t step = 0; step < numPrefixSteps; ++step)
+      steps[step] = prefixSteps[step];
+    steps[numPrefixSteps] = candidates[idx];
+    best = numPrefixSteps + 1;
+  }
+  return best;
+}
+
+bool multiplicationPlanCreate(int64_t multiplier, MultiplicationPlan *plan) {
+  if (multiplier == 0 || multiplier == 1)
+    error(__FILE__, __LINE__, "attempted to plan a trivial multiplication");
+
+  bool negative = multiplier < 0;
+  uint64_t magnitude = negative ? -(uint64_t)multiplier : (uint64_t)multiplier;
+  size_t maxSteps = MAX_MULTIPLICATION_STEPS - (negative ? 1 : 0);
+
+  size_t numSteps = planMagnitude(magnitude, plan->steps, maxSteps);
+  if (numSteps == SIZE_MAX) return false;
+  if (negative) plan->steps[numSteps++] = (MultiplicationStep){MS_NEGATE, 0};
+  plan->numSteps = numSteps;
+  return true;
+}
+
+uint64_t multiplicationPlanProduct(MultiplicationPlan const *plan, uint64_t x) {
+  uint64_t acc = x;
+  for (size_t idx = 0; idx < plan->numSteps; ++idx) {
+    MultiplicationStep const *step = &plan->steps[idx];
+    switch (step->kind) {
+      case MS_SHIFT: {
+        acc <<= step->amount;
+        break;
+      }
+      case MS_LEA: {
+        acc += acc << step->amount;
+        break;
+      }
+      case MS_SHIFTADD: {
+        acc = (acc << step->amount) + x;
+        break;
+      }
+      case MS_SHIFTSUB: {
+        acc = (acc << step->amount) - x;
+        break;
+      }
+      case MS_NEGATE: {
+        acc = -acc;
+        break;
+      }
+      default: {
+        error(__FILE__, __LINE__,
+              "invalid MultiplicationStepKind enum encountered");
+      }
+    }
+  }
+  return acc;
+}
+
+bool strengthReductionCandidate(Node *exp, BinOpType *op, Node **operand,
+                                int64_t *constant) {
+  exp = stripParens(exp);
+  if (exp->type != NT_BINOPEXP) return false;
+
+  bool isAssignment = false;
+  switch (exp->data.binOpExp.op) {
+    case BO_MULASSIGN: {
+      isAssignment = true;
+      *op = BO_MUL;
+      break;
+    }
+    case BO_DIVASSIGN: {
+      isAssignment = true;
+      *op = BO_DIV;
+      break;
+    }
+    case BO_MODASSIGN: {
+      isAssignment = true;
+      *op = BO_MOD;
+      break;
+    }
+    case BO_MUL:
+    case BO_DIV:
+    case BO_MOD: {
+      *op = exp->data.binOpExp.op;
+      break;
+    }
+    default: {
+      return false;
+    }
+  }
+
+  if (integerLiteralValue(exp->data.binOpExp.rhs, constant)) {
+    *operand = exp->data.binOpExp.lhs;
+  } else if (*op == BO_MUL && !isAssignment &&
+             integerLiteralValue(exp->data.binOpExp.lhs, constant)) {
+    *operand = exp->data.binOpExp.rhs;
+  } else {
+    return false;
+  }
+
+  // zero and one are left to constant folding
+  if (*constant == 0) return false;
+  if (*op == BO_MUL) {
+    MultiplicationPlan plan;
+    return *constant != 1 && multiplicationPlanCreate(*constant, &plan);
+  } else {
+    return true;
+  }
+}
@@ -0,0 +1,151 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * arithmetic strength reduction - replaces multiplication, division, and
+ * modulo by constants with cheaper instruction sequences
+ *
+ * plans are computed for a given width (8, 16, 32, or 64 bits) and signedness,
+ * and each plan can be evaluated, to simulate the instruction sequence it
+ * stands for
+ */
+
+#ifndef TLC_OPTIMIZATION_STRENGTHREDUCTION_H_
+#define TLC_OPTIMIZATION_STRENGTHREDUCTION_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ast/ast.h"
+
+/** how a division by a constant is done */
+typedef enum {
+  DK_IDENTITY,    /**< divisor is one - quotient is the dividend */
+  DK_NEGATE,      /**< signed divisor is negative one - neg */
+  DK_SHIFT,       /**< unsigned power of two - shr */
+  DK_SIGNEDSHIFT, /**< signed power of two - bias negative dividends towards
+                     zero, then sar, then neg if the divisor is negative */
+  DK_COMPARE,     /**< unsigned divisor with the top bit set - quotient is
+                     dividend >= divisor */
+  DK_MAGIC,       /**< multiply by the magic number, keep the high half, then
+                     shift */
+  DK_MAGICADD,    /**< unsigned magic number is one bit too wide - multiply,
+                     then add back half the difference, then shift */
+} DivisionKind;
+
+/** a division by a constant */
+typedef struct {
+  DivisionKind kind;
+  size_t width;        /**< width of the operation in bits */
+  bool isSigned;       /**< is this a signed division */
+  uint64_t divisor;    /**< divisor, truncated to width bits */
+  uint64_t multiplier; /**< magic number, truncated to width bits */
+  size_t shift;        /**< shift after the multiplication, or power of two */
+} DivisionPlan;
+
+/** a step in a multiplication by a constant, applied to an accumulator */
+typedef enum {
+  MS_SHIFT,    /**< acc <<= amount - shl */
+  MS_LEA,      /**< acc += acc << amount - lea with scale 2, 4, or 8 */
+  MS_SHIFTADD, /**< acc = (acc << amount) + x - shl and add */
+  MS_SHIFTSUB, /**< acc = (acc << amount) - x - shl and sub */
+  MS_NEGATE,   /**< acc = -acc - neg */
+} MultiplicationStepKind;
+
+/** a step in a multiplication by a constant */
+typedef struct {
+  MultiplicationStepKind kind;
+  size_t amount;
+} MultiplicationStep;
+
+enum {
+  MAX_MULTIPLICATION_STEPS = 3, /**< longest sequence cheaper than imul */
+};
+
+/** a multiplication by a constant, as steps starting with acc = x */
+typedef struct {
+  size_t numSteps;
+  MultiplicationStep steps[MAX_MULTIPLICATION_STEPS];
+} MultiplicationPlan;
+
+/**
+ * plans a division by a constant
+ *
+ * @param divisor divisor, truncated to width bits - must not be zero
+ * @param width width of the division in bits
+ * @param isSigned is the division signed
+ * @param plan output pointer to the plan
+ */
+void divisionPlanCreate(uint64_t divisor, size_t width, bool isSigned,
+                        DivisionPlan *plan);
+/**
+ * simulates a planned division
+ *
+ * @param plan plan to simulate
+ * @param dividend dividend, truncated to the plan's width
+ * @returns quotient, truncated to the plan's width
+ */
+uint64_t divisionPlanQuotient(DivisionPlan const *plan, uint64_t dividend);
+/**
+ * simulates a planned modulo - the planned quotient multiplied by the divisor
+ * and subtracted from the dividend, or a mask for unsigned powers of two
+ *
+ * @param plan plan to simulate
+ * @param dividend dividend, truncated to the plan's width
+ * @returns remainder, truncated to the plan's width
+ */
+uint64_t divisionPlanRemainder(DivisionPlan const *plan, uint64_t dividend);
+
+/**
+ * plans a multiplication by a constant
+ *
+ * multiplication by zero or one is left to constant folding, and should never
+ * be planned
+ *
+ * @param multiplier constant to multiply by
+ * @param plan output pointer to the plan
+ * @returns whether the multiplication is cheaper than an imul
+ */
+bool multiplicationPlanCreate(int64_t multiplier, MultiplicationPlan *plan);
+/**
+ * simulates a planned multiplication
+ *
+ * @param plan plan to simulate
+ * @param x value to multiply
+ * @returns product, modulo 2^64 - truncate to get narrower products
+ */
+uint64_t multiplicationPlanProduct(MultiplicationPlan const *plan, uint64_t x);
+
+/**
+ * finds a multiplication, division, or modulo by a constant
+ *
+ * compound assignments are treated as their underlying operation
+ *
+ * @param exp expression to consider
+ * @param op output pointer to the operation - BO_MUL, BO_DIV, or BO_MOD
+ * @param operand output pointer to the non-constant operand
+ * @param constant output pointer to the constant operand
+ * @returns whether the expression can be strength reduced
+ */
+bool strengthReductionCandidate(Node *exp, BinOpType *op, Node **operand,
+                                int64_t *constant);
+
+#endif  // TLC_OPTIMIZATION_STRENGTHREDUCTION_H_
@@ -0,0 +1,254 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// string pool implementation
+
+#include "optimization/stringPool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/functional.h"
+#include "util/internalError.h"
+#include "util/string.h"
+
+void stringPoolInit(StringPool *pool) {
+  vectorInit(&pool->strings);
+  hashMapInit(&pool->stringMap);
+  vectorInit(&pool->wstrings);
+  hashMapInit(&pool->wstringMap);
+}
+
+/**
+ * creates a pooled string
+ *
+ * @param string owned string
+ * @param key owned key, or null if string is the key
+ * @param length length of the string
+ * @param id label number
+ */
+static PooledString *pooledStringCreate(void *string, char *key, size_t length,
+                                        size_t id) {
+  PooledString *s = malloc(sizeof(PooledString));
+  s->string = string;
+  s->key = key;
+  s->length = length;
+  s->id = id;
+  s->root = s;
+  s->offset = 0;
+  return s;
+}
+/**
+ * frees a pooled string
+ *
+ * @param s string to free
+ */
+static void pooledStringFree(PooledString *s) {
+  free(s->string);
+  free(s->key);
+  free(s);
+}
+
+PooledString *stringPoolAdd(StringPool *pool, uint8_t const *string) {
+  PooledString *existing = hashMapGet(&pool->stringMap, (char const *)string);
+  if (existing != NULL) return existing;
+
+  size_t length = strlen((char const *)string);
+  uint8_t *copy = malloc(length + 1);
+  memcpy(copy, string, length + 1);
+  PooledString *s = pooledStringCreate(copy, NULL, length, pool->strings.size);
+  vectorInsert(&pool->strings, s);
+  hashMapPut(&pool->stringMap, (char const *)copy, s);
+  return s;
+}
+PooledString *wstringPoolAdd(StringPool *pool, uint32_t const *string) {
+  char *key = escapeTWString(string);
+  PooledString *existing = hashMapGet(&pool->wstringMap, key);
+  if (existing != NULL) {
+    free(key);
+    return existing;
+  }
+
+  size_t length = 0;
+  while (string[length] != 0) ++length;
+  uint32_t *copy = malloc((length + 1) * sizeof(uint32_t));
+  memcpy(copy, string, (length + 1) * sizeof(uint32_t));
+  PooledString *s = pooledStringCreate(copy, key, length, pool->wstrings.size);
+  vectorInsert(&pool->wstrings, s);
+  hashMapPut(&pool->wstringMap, key, s);
+  return s;
+}
+PooledString *stringPoolAddLiteral(StringPool *pool, Node const *literal) {
+  switch (literal->data.literal.literalType) {
+    case LT_STRING: {
+      return stringPoolAdd(pool, literal->data.literal.data.stringVal);
+    }
+    case LT_WSTRING: {
+      return wstringPoolAdd(pool, literal->data.literal.data.wstringVal);
+    }
+    default: {
+      error(__FILE__, __LINE__, "non-string literal given to string pool");
+    }
+  }
+}
+
+/**
+ * compares narrow pooled strings by their reversed contents
+ */
+static int reversedStringCompare(void const *aPtr, void const *bPtr) {
+  PooledString const *a = *(PooledString *const *)aPtr;
+  PooledString const *b = *(PooledString *const *)bPtr;
+  uint8_t const *aString = a->string;
+  uint8_t const *bString = b->string;
+  size_t aIdx = a->length;
+  size_t bIdx = b->length;
+  while (aIdx != 0 && bIdx != 0) {
+    --aIdx;
+    --bIdx;
+    if (aString[aIdx] != bString[bIdx])
+      return aString[aIdx] < bString[bIdx] ? -1 : 1;
+  }
+  return aIdx == bIdx ? 0 : aIdx == 0 ? -1 : 1;
+}
+/**
+ * compares wide pooled strings by their reversed contents
+ */
+static int reversedWStringCompare(void const *aPtr, void const *bPtr) {
+  PooledString const *a = *(PooledString *const *)aPtr;
+  PooledString const *b = *(PooledString *const *)bPtr;
+  uint32_t const *aString = a->string;
+  uint32_t const *bString = b->string;
+  size_t aIdx = a->length;
+  size_t bIdx = b->length;
+  while (aIdx != 0 && bIdx != 0) {
+    --aIdx;
+    --bIdx;
+    if (aString[aIdx] != bString[bIdx])
+      return aString[aIdx] < bString[bIdx] ? -1 : 1;
+  }
+  return aIdx == bIdx ? 0 : aIdx == 0 ? -1 : 1;
+}
+/**
+ * is one string a suffix of another?
+ *
+ * @param suffix potential suffix
+ * @param s string to check
+ * @param width width of a character in either string
+ */
+static bool isSuffix(PooledString const *suffix, PooledString const *s,
+                     size_t width) {
+  return suffix->length <= s->length &&
+         memcmp((uint8_t const *)s->string +
+                    (s->length - suffix->length) * width,
+                suffix->string, suffix->length * width) == 0;
+}
+/**
+ * merges a vector of strings of the same width
+ *
+ * sorted by reversed contents, a string that is a suffix of any other string
+ * is a suffix of the string right after it, so one backwards pass finds the
+ * longest string each string can be stored in
+ *
+ * @param strings strings to merge
+ * @param compare reversed comparison function
+ * @param width width of a character in the strings
+ */
+static void mergeStrings(Vector const *strings,
+                         int (*compare)(void const *, void const *),
+                         size_t width) {
+  if (strings->size == 0) return;
+
+  PooledString **sorted = malloc(strings->size * sizeof(PooledString *));
+  memcpy(sorted, strings->elements, strings->size * sizeof(PooledString *));
+  qsort(sorted, strings->size, sizeof(PooledString *), compare);
+
+  PooledString *last = sorted[strings->size - 1];
+  last->root = last;
+  last->offset = 0;
+  for (size_t idx = strings->size - 1; idx-- > 0;) {
+    PooledString *current = sorted[idx];
+    PooledString *next = sorted[idx + 1];
+    if (isSuffix(current, next, width)) {
+      current->root = next->root;
+      current->offset = next->offset + (next->length - current->length);
+    } else {
+      current->root = current;
+      current->offset = 0;
+    }
+  }
+
+  free(sorted);
+}
+void stringPoolMerge(StringPool *pool) {
+  mergeStrings(&pool->strings, reversedStringCompare, sizeof(uint8_t));
+  mergeStrings(&pool->wstrings, reversedWStringCompare, sizeof(uint32_t));
+}
+
+void stringPoolEmit(FILE *where, StringPool const *pool) {
+  if (pool->strings.size != 0) {
+    fprintf(where, "\t.section\t.rodata.str1.1,\"aMS\",@progbits,1\n");
+    for (size_t idx = 0; idx < pool->strings.size; ++idx) {
+      PooledString const *s = pool->strings.elements[idx];
+      if (s->root != s) continue;
+      fprintf(where, ".LSTR%zu:\n\t.asciz\t\"", s->id);
+      uint8_t const *string = s->string;
+      for (size_t charIdx = 0; charIdx < s->length; ++charIdx) {
+        uint8_t c = string[charIdx];
+        if (c >= ' ' && c <= '~' && c != '"' && c != '\\')
+          fputc(c, where);
+        else
+          fprintf(where, "\\%03o", c);
+      }
+      fprintf(where, "\"\n");
+    }
+    for (size_t idx = 0; idx < pool->strings.size; ++idx) {
+      PooledString const *s = pool->strings.elements[idx];
+      if (s->root == s) continue;
+      fprintf(where, "\t.set\t.LSTR%zu, .LSTR%zu+%zu\n", s->id, s->root->id,
+              s->offset);
+    }
+  }
+
+  if (pool->wstrings.size != 0) {
+    fprintf(where, "\t.section\t.rodata.str4.4,\"aMS\",@progbits,4\n");
+    fprintf(where, "\t.balign\t4\n");
+    for (size_t idx = 0; idx < pool->wstrings.size; ++idx) {
+      PooledString const *s = pool->wstrings.elements[idx];
+      if (s->root != s) continue;
+      fprintf(where, ".LWSTR%zu:\n\t.long\t", s->id);
+      uint32_t const *string = s->string;
+      for (size_t charIdx = 0; charIdx < s->length; ++charIdx)
+        fprintf(where, "%u, ", string[charIdx]);
+      fprintf(where, "0\n");
+    }
+    for (size_t idx = 0; idx < pool->wstrings.size; ++idx) {
+      PooledString const *s = pool->wstrings.elements[idx];
+      if (s->root == s) continue;
+      fprintf(where, "\t.set\t.LWSTR%zu, .LWSTR%zu+%zu\n", s->id, s->root->id,
+              s->offset * sizeof(uint32_t));
+    }
+  }
+}
+
+void stringPoolUninit(StringPool *pool) {
+  hashMapUninit(&pool->stringMap, nullDtor);
+  vectorUninit(&pool->strings, (void (*)(void *))pooledStringFree);
+  hashMapUninit(&pool->wstringMap, nullDtor);
+  vectorUninit(&pool->wstrings, (void (*)(void *))pooledStringFree);
+}
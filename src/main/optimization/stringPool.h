@@ -0,0 +1,116 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * string literal pool
+ */
+
+#ifndef TLC_OPTIMIZATION_STRINGPOOL_H_
+#define TLC_OPTIMIZATION_STRINGPOOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ast/ast.h"
+#include "util/container/hashMap.h"
+#include "util/container/vector.h"
+
+/** a string stored in a string pool */
+typedef struct PooledString {
+  void *string;  /**< owned uint8_t * or uint32_t *, NUL terminated */
+  char *key;     /**< owned key in the pool's map - null for narrow strings,
+                    which are their own key */
+  size_t length; /**< number of characters, not including the terminator */
+  size_t id;     /**< label number, unique within the pool for this width */
+  struct PooledString *root; /**< string this is stored at the end of - self
+                                if not merged. Only set after merging */
+  size_t offset; /**< offset into root, in characters. Only set after merging */
+} PooledString;
+
+/**
+ * a pool of string literals for one module
+ *
+ * identical literals are stored once, and literals that are suffixes of other
+ * literals are stored as part of the longer literal. The emitted sections are
+ * marked as mergeable strings, so the linker does the same across modules
+ */
+typedef struct {
+  Vector strings;     /**< vector of PooledString, narrow strings */
+  HashMap stringMap;  /**< map from narrow string to PooledString */
+  Vector wstrings;    /**< vector of PooledString, wide strings */
+  HashMap wstringMap; /**< map from escaped wide string to PooledString */
+} StringPool;
+
+/**
+ * initializes a string pool
+ *
+ * @param pool pool to initialize
+ */
+void stringPoolInit(StringPool *pool);
+/**
+ * adds a narrow string to the pool
+ *
+ * @param pool pool to add to
+ * @param string string to add - copied if not already in the pool
+ * @returns pooled string, shared with any identical string
+ */
+PooledString *stringPoolAdd(StringPool *pool, uint8_t const *string);
+/**
+ * adds a wide string to the pool
+ *
+ * @param pool pool to add to
+ * @param string string to add - copied if not already in the pool
+ * @returns pooled string, shared with any identical string
+ */
+PooledString *wstringPoolAdd(StringPool *pool, uint32_t const *string);
+/**
+ * adds the value of a string literal to the pool
+ *
+ * @param pool pool to add to
+ * @param literal NT_LITERAL of type LT_STRING or LT_WSTRING
+ * @returns pooled string
+ */
+PooledString *stringPoolAddLiteral(StringPool *pool, Node const *literal);
+/**
+ * merges strings that are suffixes of other strings into those other strings
+ *
+ * must be called after all strings are added, and before emitting
+ *
+ * @param pool pool to merge
+ */
+void stringPoolMerge(StringPool *pool);
+/**
+ * writes out the pool as GNU assembler directives
+ *
+ * narrow string n is labelled .LSTRn, and wide string n is labelled .LWSTRn
+ *
+ * @param where file to write to
+ * @param pool merged pool to write out
+ */
+void stringPoolEmit(FILE *where, StringPool const *pool);
+/**
+ * uninitializes a string pool
+ *
+ * @param pool pool to uninitialize
+ */
+void stringPoolUninit(StringPool *pool);
+
+#endif  // TLC_OPTIMIZATION_STRINGPOOL_H_
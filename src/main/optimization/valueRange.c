@@ -0,0 +1,831 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// value range analysis implementation
+
+#include "optimization/valueRange.h"
+
+#include "optimization/common.h"
+
+/**
+ * gets the width and signedness of an integral type
+ *
+ * @param keyword type to query
+ * @param width output pointer to the width, in bits
+ * @param isSigned output pointer to the signedness
+ * @returns whether the type is integral
+ */
+static bool integralInfo(TypeKeyword keyword, size_t *width, bool *isSigned) {
+  switch (keyword) {
+    case TK_UBYTE:
+    case TK_CHAR:
+    case TK_BOOL: {
+      *width = 8;
+      *isSigned = false;
+      return true;
+    }
+    case TK_BYTE: {
+      *width = 8;
+      *isSigned = true;
+      return true;
+    }
+    case TK_USHORT: {
+      *width = 16;
+      *isSigned = false;
+      return true;
+    }
+    case TK_SHORT: {
+      *width = 16;
+      *isSigned = true;
+      return true;
+    }
+    case TK_UINT:
+    case TK_WCHAR: {
+      *width = 32;
+      *isSigned = false;
+      return true;
+    }
+    case TK_INT: {
+      *width = 32;
+      *isSigned = true;
+      return true;
+    }
+    case TK_ULONG: {
+      *width = 64;
+      *isSigned = false;
+      return true;
+    }
+    case TK_LONG: {
+      *width = 64;
+      *isSigned = true;
+      return true;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+bool typeKeywordRange(TypeKeyword keyword, ValueRange *range) {
+  size_t width;
+  bool isSigned;
+  if (!integralInfo(keyword, &width, &isSigned)) return false;
+
+  if (keyword == TK_BOOL) {
+    range->min = 0;
+    range->max = 1;
+  } else if (isSigned) {
+    range->max = (int64_t)(UINT64_MAX >> (65 - width));
+    range->min = -range->max - 1;
+  } else if (width < 64) {
+    range->min = 0;
+    range->max = (int64_t)((UINT64_C(1) << width) - 1);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * gets the keyword of a keyword type
+ *
+ * @param type nullable type to query
+ * @returns keyword, or TK_VOID if the type isn't a keyword type
+ */
+static TypeKeyword keywordOf(Type const *type) {
+  if (type == NULL) return TK_VOID;
+  type = stripType(type);
+  return type->kind == TK_KEYWORD ? type->data.keyword.keyword : TK_VOID;
+}
+
+/**
+ * can every value of one integral type be represented by another?
+ *
+ * @param to type to convert to
+ * @param from type to convert from
+ */
+static bool typeContains(TypeKeyword to, TypeKeyword from) {
+  size_t toWidth;
+  bool toSigned;
+  size_t fromWidth;
+  bool fromSigned;
+  if (!integralInfo(to, &toWidth, &toSigned) ||
+      !integralInfo(from, &fromWidth, &fromSigned))
+    return false;
+  return toSigned == fromSigned ? toWidth >= fromWidth
+                                : toSigned && toWidth > fromWidth;
+}
+
+/**
+ * gets the type two integral operands are converted to for arithmetic
+ *
+ * @param lhs type of the left operand
+ * @param rhs type of the right operand
+ * @returns common type, or TK_VOID if there is none
+ */
+static TypeKeyword mergeTypes(TypeKeyword lhs, TypeKeyword rhs) {
+  static TypeKeyword const CANDIDATES[] = {
+      TK_UBYTE, TK_BYTE, TK_USHORT, TK_SHORT,
+      TK_UINT,  TK_INT,  TK_ULONG,  TK_LONG,
+  };
+  if (lhs == rhs) return lhs;
+  for (size_t idx = 0; idx < sizeof(CANDIDATES) / sizeof(TypeKeyword);
+       ++idx) {
+    if (typeContains(CANDIDATES[idx], lhs) &&
+        typeContains(CANDIDATES[idx], rhs) && lhs != TK_CHAR &&
+        lhs != TK_WCHAR && lhs != TK_BOOL && rhs != TK_CHAR &&
+        rhs != TK_WCHAR && rhs != TK_BOOL)
+      return CANDIDATES[idx];
+  }
+  return TK_VOID;
+}
+
+/**
+ * converts the exact range of a computation to the range of its result,
+ * accounting for wraparound
+ *
+ * @param type type of the result
+ * @param range range to convert, replaced with the range of the result
+ * @returns whether the result's range is known
+ */
+static bool fitType(TypeKeyword type, ValueRange *range) {
+  ValueRange full;
+  if (typeKeywordRange(type, &full)) {
+    if (range->min < full.min || range->max > full.max) *range = full;
+    return true;
+  } else {
+    return type == TK_ULONG && range->min >= 0;
+  }
+}
+
+/**
+ * adds two longs
+ *
+ * @param a first summand
+ * @param b second summand
+ * @param result output pointer to the sum
+ * @returns whether the sum overflowed
+ */
+static bool addOverflows(int64_t a, int64_t b, int64_t *result) {
+  if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b))
+    return true;
+  *result = a + b;
+  return false;
+}
+
+/**
+ * subtracts two longs
+ *
+ * @param a minuend
+ * @param b subtrahend
+ * @param result output pointer to the difference
+ * @returns whether the difference overflowed
+ */
+static bool subOverflows(int64_t a, int64_t b, int64_t *result) {
+  if ((b > 0 && a < INT64_MIN + b) || (b < 0 && a > INT64_MAX + b))
+    return true;
+  *result = a - b;
+  return false;
+}
+
+/**
+ * multiplies two longs
+ *
+ * @param a first factor
+ * @param b second factor
+ * @param result output pointer to the product
+ * @returns whether the product overflowed
+ */
+static bool mulOverflows(int64_t a, int64_t b, int64_t *result) {
+  if (a > 0) {
+    if (b > 0 ? a > INT64_MAX / b : b < INT64_MIN / a) return true;
+  } else {
+    if (b > 0 ? a < INT64_MIN / b : a != 0 && b < INT64_MAX / a) return true;
+  }
+  *result = a * b;
+  return false;
+}
+
+/**
+ * gets the magnitude of the value of largest magnitude in a range
+ *
+ * @param range range to query
+ * @param magnitude output pointer to the magnitude
+ * @returns whether the magnitude fits in a long
+ */
+static bool rangeMagnitude(ValueRange const *range, int64_t *magnitude) {
+  if (range->min == INT64_MIN) return false;
+  *magnitude = -range->min > range->max ? -range->min : range->max;
+  return true;
+}
+
+/**
+ * gets the smallest value of the form 2^n - 1 that is at least a value
+ *
+ * @param value non-negative value
+ */
+static int64_t bitCeiling(int64_t value) {
+  uint64_t mask = (uint64_t)value;
+  mask |= mask >> 1;
+  mask |= mask >> 2;
+  mask |= mask >> 4;
+  mask |= mask >> 8;
+  mask |= mask >> 16;
+  mask |= mask >> 32;
+  return (int64_t)mask;
+}
+
+/**
+ * shifts a long right, rounding towards negative infinity
+ *
+ * @param value value to shift
+ * @param amount amount to shift by, less than 64
+ */
+static int64_t arithmeticShift(int64_t value, int64_t amount) {
+  return value >= 0 ? value >> amount : -1 - ((-1 - value) >> amount);
+}
+
+/**
+ * gets the single value in a range
+ *
+ * @param range range to query
+ * @param value output pointer to the value
+ * @returns whether the range has exactly one value
+ */
+static bool rangeConstant(ValueRange const *range, int64_t *value) {
+  *value = range->min;
+  return range->min == range->max;
+}
+
+static bool analyze(Node *exp, TypeKeyword *type, ValueRange *range);
+
+/**
+ * computes the exact range of a binary arithmetic expression, before
+ * wraparound
+ *
+ * @param op operator
+ * @param type type of the lhs, for shifts
+ * @param lhs range of the left operand
+ * @param rhs range of the right operand
+ * @param range output pointer to the range
+ * @returns whether the range could be computed
+ */
+static bool arithmeticRange(BinOpType op, TypeKeyword type,
+                            ValueRange const *lhs, ValueRange const *rhs,
+                            ValueRange *range) {
+  switch (op) {
+    case BO_ADD: {
+      return !addOverflows(lhs->min, rhs->min, &range->min) &&
+             !addOverflows(lhs->max, rhs->max, &range->max);
+    }
+    case BO_SUB: {
+      return !subOverflows(lhs->min, rhs->max, &range->min) &&
+             !subOverflows(lhs->max, rhs->min, &range->max);
+    }
+    case BO_MUL: {
+      int64_t corners[4];
+      if (mulOverflows(lhs->min, rhs->min, &corners[0]) ||
+          mulOverflows(lhs->min, rhs->max, &corners[1]) ||
+          mulOverflows(lhs->max, rhs->min, &corners[2]) ||
+          mulOverflows(lhs->max, rhs->max, &corners[3]))
+        return false;
+      range->min = range->max = corners[0];
+      for (size_t idx = 1; idx < 4; ++idx) {
+        if (corners[idx] < range->min) range->min = corners[idx];
+        if (corners[idx] > range->max) range->max = corners[idx];
+      }
+      return true;
+    }
+    case BO_DIV: {
+      if (lhs->min == INT64_MIN && rhs->min <= -1 && rhs->max >= -1)
+        return false;
+      if (rhs->min > 0 || rhs->max < 0) {
+        // quotient is monotonic in each operand if the divisor keeps its sign
+        int64_t corners[4] = {
+            lhs->min / rhs->min,
+            lhs->min / rhs->max,
+            lhs->max / rhs->min,
+            lhs->max / rhs->max,
+        };
+        range->min = range->max = corners[0];
+        for (size_t idx = 1; idx < 4; ++idx) {
+          if (corners[idx] < range->min) range->min = corners[idx];
+          if (corners[idx] > range->max) range->max = corners[idx];
+        }
+        return true;
+      } else {
+        // quotient is no larger in magnitude than the dividend
+        int64_t magnitude;
+        if (!rangeMagnitude(lhs, &magnitude)) return false;
+        range->min = lhs->min >= 0 && rhs->min >= 0 ? 0 : -magnitude;
+        range->max = magnitude;
+        return true;
+      }
+    }
+    case BO_MOD: {
+      // remainder is smaller in magnitude than the divisor, no larger in
+      // magnitude than the dividend, and has the sign of the dividend
+      int64_t dividend;
+      int64_t divisor;
+      if (!rangeMagnitude(lhs, &dividend) || !rangeMagnitude(rhs, &divisor) ||
+          divisor == 0)
+        return false;
+      int64_t magnitude = divisor - 1 < dividend ? divisor - 1 : dividend;
+      range->min = lhs->min >= 0 ? 0 : -magnitude;
+      range->max = lhs->max <= 0 ? 0 : magnitude;
+      return true;
+    }
+    case BO_BITAND: {
+      if (lhs->min >= 0 && rhs->min >= 0) {
+        range->min = 0;
+        range->max = lhs->max < rhs->max ? lhs->max : rhs->max;
+        return true;
+      } else if (lhs->min >= 0 || rhs->min >= 0) {
+        range->min = 0;
+        range->max = lhs->min >= 0 ? lhs->max : rhs->max;
+        return true;
+      } else {
+        return false;
+      }
+    }
+    case BO_BITOR:
+    case BO_BITXOR: {
+      if (lhs->min < 0 || rhs->min < 0) return false;
+      range->min = op == BO_BITXOR            ? 0
+                   : lhs->min > rhs->min ? lhs->min
+                                         : rhs->min;
+      range->max = bitCeiling(lhs->max > rhs->max ? lhs->max : rhs->max);
+      return true;
+    }
+    case BO_LSHIFT: {
+      int64_t amount;
+      if (!rangeConstant(rhs, &amount) || amount < 0 || amount >= 63 ||
+          lhs->min < 0 || lhs->max > INT64_MAX >> amount)
+        return false;
+      range->min = lhs->min << amount;
+      range->max = lhs->max << amount;
+      return true;
+    }
+    case BO_ARSHIFT: {
+      int64_t amount;
+      if (!rangeConstant(rhs, &amount) || amount < 0 || amount >= 64)
+        return false;
+      range->min = arithmeticShift(lhs->min, amount);
+      range->max = arithmeticShift(lhs->max, amount);
+      return true;
+    }
+    case BO_LRSHIFT: {
+      int64_t amount;
+      size_t width;
+      bool isSigned;
+      if (!rangeConstant(rhs, &amount) || amount < 0 || amount >= 64 ||
+          !integralInfo(type, &width, &isSigned))
+        return false;
+      if (lhs->min >= 0) {
+        range->min = lhs->min >> amount;
+        range->max = lhs->max >> amount;
+        return true;
+      } else if (width < 64 || amount > 0) {
+        // negative values are shifted as if they were unsigned
+        range->min = 0;
+        range->max = (int64_t)((UINT64_MAX >> (64 - width)) >> amount);
+        return true;
+      } else {
+        return false;
+      }
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * computes the range of a binary operator expression
+ *
+ * @param exp NT_BINOPEXP to analyze
+ * @param type output pointer to the type of the expression
+ * @param range output pointer to the range
+ * @returns whether the range is known
+ */
+static bool analyzeBinOp(Node *exp, TypeKeyword *type, ValueRange *range) {
+  BinOpType op = exp->data.binOpExp.op;
+  TypeKeyword lhsType;
+  ValueRange lhs;
+  TypeKeyword rhsType;
+  ValueRange rhs;
+  switch (op) {
+    case BO_SEQ: {
+      return analyze(exp->data.binOpExp.rhs, type, range);
+    }
+    case BO_ASSIGN: {
+      analyze(exp->data.binOpExp.lhs, type, &lhs);
+      if (analyze(exp->data.binOpExp.rhs, &rhsType, range))
+        return fitType(*type, range);
+      else
+        return typeKeywordRange(*type, range);
+    }
+    case BO_MULASSIGN:
+    case BO_DIVASSIGN:
+    case BO_MODASSIGN:
+    case BO_ADDASSIGN:
+    case BO_SUBASSIGN:
+    case BO_LSHIFTASSIGN:
+    case BO_ARSHIFTASSIGN:
+    case BO_LRSHIFTASSIGN:
+    case BO_BITANDASSIGN:
+    case BO_BITXORASSIGN:
+    case BO_BITORASSIGN:
+    case BO_LANDASSIGN:
+    case BO_LORASSIGN: {
+      analyze(exp->data.binOpExp.lhs, type, &lhs);
+      return typeKeywordRange(*type, range);
+    }
+    case BO_LAND:
+    case BO_LOR:
+    case BO_EQ:
+    case BO_NEQ:
+    case BO_LT:
+    case BO_GT:
+    case BO_LTEQ:
+    case BO_GTEQ: {
+      *type = TK_BOOL;
+      return typeKeywordRange(*type, range);
+    }
+    case BO_SPACESHIP: {
+      *type = TK_BYTE;
+      range->min = -1;
+      range->max = 1;
+      return true;
+    }
+    case BO_LSHIFT:
+    case BO_ARSHIFT:
+    case BO_LRSHIFT:
+    case BO_ADD:
+    case BO_SUB:
+    case BO_MUL:
+    case BO_DIV:
+    case BO_MOD:
+    case BO_BITAND:
+    case BO_BITOR:
+    case BO_BITXOR: {
+      bool lhsKnown = analyze(exp->data.binOpExp.lhs, &lhsType, &lhs);
+      bool rhsKnown = analyze(exp->data.binOpExp.rhs, &rhsType, &rhs);
+      bool shift = op == BO_LSHIFT || op == BO_ARSHIFT || op == BO_LRSHIFT;
+      *type = shift ? lhsType : mergeTypes(lhsType, rhsType);
+      if (lhsKnown && rhsKnown &&
+          arithmeticRange(op, lhsType, &lhs, &rhs, range))
+        return fitType(*type, range);
+      else
+        return typeKeywordRange(*type, range);
+    }
+    case BO_CAST: {
+      *type = keywordOf(exp->data.binOpExp.type);
+      if (analyze(exp->data.binOpExp.rhs, &rhsType, range) &&
+          rhsType != TK_VOID)
+        return fitType(*type, range);
+      else
+        return typeKeywordRange(*type, range);
+    }
+    default: {
+      // fields and array elements - not tracked
+      *type = TK_VOID;
+      return false;
+    }
+  }
+}
+
+/**
+ * computes the range of a unary operator expression
+ *
+ * @param exp NT_UNOPEXP to analyze
+ * @param type output pointer to the type of the expression
+ * @param range output pointer to the range
+ * @returns whether the range is known
+ */
+static bool analyzeUnOp(Node *exp, TypeKeyword *type, ValueRange *range) {
+  ValueRange target;
+  switch (exp->data.unOpExp.op) {
+    case UO_PARENS: {
+      return analyze(exp->data.unOpExp.target, type, range);
+    }
+    case UO_NEG: {
+      bool known = analyze(exp->data.unOpExp.target, type, &target);
+      // negating an unsigned value produces the next larger signed type
+      switch (*type) {
+        case TK_UBYTE: {
+          *type = TK_SHORT;
+          break;
+        }
+        case TK_USHORT: {
+          *type = TK_INT;
+          break;
+        }
+        case TK_UINT: {
+          *type = TK_LONG;
+          break;
+        }
+        case TK_ULONG: {
+          *type = TK_VOID;
+          break;
+        }
+        default: {
+          break;
+        }
+      }
+      if (known && target.min != INT64_MIN) {
+        range->min = -target.max;
+        range->max = -target.min;
+        return fitType(*type, range);
+      } else {
+        return typeKeywordRange(*type, range);
+      }
+    }
+    case UO_BITNOT: {
+      size_t width;
+      bool isSigned;
+      if (!analyze(exp->data.unOpExp.target, type, &target) ||
+          !integralInfo(*type, &width, &isSigned))
+        return false;
+      if (isSigned) {
+        range->min = ~target.max;
+        range->max = ~target.min;
+        return true;
+      } else if (width < 64) {
+        int64_t mask = (int64_t)((UINT64_C(1) << width) - 1);
+        range->min = mask - target.max;
+        range->max = mask - target.min;
+        return true;
+      } else {
+        return false;
+      }
+    }
+    case UO_LNOT: {
+      *type = TK_BOOL;
+      return typeKeywordRange(*type, range);
+    }
+    case UO_PREINC:
+    case UO_PREDEC:
+    case UO_POSTINC:
+    case UO_POSTDEC:
+    case UO_NEGASSIGN:
+    case UO_LNOTASSIGN:
+    case UO_BITNOTASSIGN: {
+      analyze(exp->data.unOpExp.target, type, &target);
+      return typeKeywordRange(*type, range);
+    }
+    default: {
+      // dereferences, addresses and sizes - not tracked
+      *type = TK_VOID;
+      return false;
+    }
+  }
+}
+
+/**
+ * computes the range of a literal
+ *
+ * @param exp NT_LITERAL to analyze
+ * @param type output pointer to the type of the literal
+ * @param range output pointer to the range
+ * @returns whether the range is known
+ */
+static bool analyzeLiteral(Node *exp, TypeKeyword *type, ValueRange *range) {
+  static TypeKeyword const INTEGRAL_TYPES[] = {
+      TK_UBYTE, TK_BYTE, TK_USHORT, TK_SHORT,
+      TK_UINT,  TK_INT,  TK_ULONG,  TK_LONG,
+  };
+  LiteralType literalType = exp->data.literal.literalType;
+  switch (literalType) {
+    case LT_UBYTE:
+    case LT_BYTE:
+    case LT_USHORT:
+    case LT_SHORT:
+    case LT_UINT:
+    case LT_INT:
+    case LT_ULONG:
+    case LT_LONG: {
+      *type = INTEGRAL_TYPES[literalType - LT_UBYTE];
+      if (!integerLiteralValue(exp, &range->min)) return false;
+      range->max = range->min;
+      return true;
+    }
+    case LT_CHAR: {
+      *type = TK_CHAR;
+      range->min = range->max = exp->data.literal.data.charVal;
+      return true;
+    }
+    case LT_WCHAR: {
+      *type = TK_WCHAR;
+      range->min = range->max = exp->data.literal.data.wcharVal;
+      return true;
+    }
+    case LT_BOOL: {
+      *type = TK_BOOL;
+      range->min = range->max = exp->data.literal.data.boolVal;
+      return true;
+    }
+    default: {
+      *type = TK_VOID;
+      return false;
+    }
+  }
+}
+
+/**
+ * computes the type and range of an expression
+ *
+ * @param exp expression to analyze
+ * @param type output pointer to the type of the expression, TK_VOID if it
+ * isn't known to be a keyword type
+ * @param range output pointer to the range
+ * @returns whether the range is known
+ */
+static bool analyze(Node *exp, TypeKeyword *type, ValueRange *range) {
+  switch (exp->type) {
+    case NT_BINOPEXP: {
+      return analyzeBinOp(exp, type, range);
+    }
+    case NT_UNOPEXP: {
+      return analyzeUnOp(exp, type, range);
+    }
+    case NT_TERNARYEXP: {
+      TypeKeyword consequentType;
+      ValueRange consequent;
+      TypeKeyword alternativeType;
+      ValueRange alternative;
+      bool consequentKnown = analyze(exp->data.ternaryExp.consequent,
+                                     &consequentType, &consequent);
+      bool alternativeKnown = analyze(exp->data.ternaryExp.alternative,
+                                      &alternativeType, &alternative);
+      *type = mergeTypes(consequentType, alternativeType);
+      if (consequentKnown && alternativeKnown) {
+        range->min = consequent.min < alternative.min ? consequent.min
+                                                      : alternative.min;
+        range->max = consequent.max > alternative.max ? consequent.max
+                                                      : alternative.max;
+        return fitType(*type, range);
+      } else {
+        return typeKeywordRange(*type, range);
+      }
+    }
+    case NT_FUNCALLEXP: {
+      SymbolTableEntry *callee = directCallee(exp);
+      *type = callee == NULL ? TK_VOID
+                             : keywordOf(callee->data.function.returnType);
+      return typeKeywordRange(*type, range);
+    }
+    case NT_LITERAL: {
+      return analyzeLiteral(exp, type, range);
+    }
+    case NT_ID:
+    case NT_SCOPEDID: {
+      SymbolTableEntry *entry = exp->type == NT_ID
+                                    ? exp->data.id.entry
+                                    : exp->data.scopedId.entry;
+      *type = entry != NULL && entry->kind == SK_VARIABLE
+                  ? keywordOf(entry->data.variable.type)
+                  : TK_VOID;
+      return typeKeywordRange(*type, range);
+    }
+    default: {
+      *type = TK_VOID;
+      return false;
+    }
+  }
+}
+
+bool valueRangeOf(Node *exp, ValueRange *range) {
+  TypeKeyword type;
+  return analyze(exp, &type, range);
+}
+
+ExtensionKind extensionKindOf(Node *exp, TypeKeyword from, TypeKeyword to) {
+  size_t fromWidth;
+  bool fromSigned;
+  size_t toWidth;
+  bool toSigned;
+  if (!integralInfo(from, &fromWidth, &fromSigned) ||
+      !integralInfo(to, &toWidth, &toSigned) || fromWidth >= toWidth)
+    return EK_NONE;
+
+  ValueRange range;
+  if (fromSigned && !(valueRangeOf(exp, &range) && range.min >= 0))
+    return EK_SIGN;
+  return fromWidth == 32 ? EK_NONE : EK_ZERO;
+}
+
+bool comparisonFold(Node *exp, bool *value) {
+  exp = stripParens(exp);
+  if (exp->type != NT_BINOPEXP) return false;
+
+  BinOpType op = exp->data.binOpExp.op;
+  switch (op) {
+    case BO_EQ:
+    case BO_NEQ:
+    case BO_LT:
+    case BO_GT:
+    case BO_LTEQ:
+    case BO_GTEQ: {
+      break;
+    }
+    default: {
+      return false;
+    }
+  }
+
+  ValueRange lhs;
+  ValueRange rhs;
+  if (!expressionIsPure(exp) || !valueRangeOf(exp->data.binOpExp.lhs, &lhs) ||
+      !valueRangeOf(exp->data.binOpExp.rhs, &rhs))
+    return false;
+
+  // comparisons are done in a type that holds every value of both operands,
+  // so the mathematical ranges can be compared directly
+  switch (op) {
+    case BO_EQ:
+    case BO_NEQ: {
+      if (lhs.max < rhs.min || rhs.max < lhs.min) {
+        *value = op == BO_NEQ;
+        return true;
+      } else if (lhs.min == lhs.max && rhs.min == rhs.max) {
+        *value = op == BO_EQ;
+        return true;
+      } else {
+        return false;
+      }
+    }
+    case BO_LT:
+    case BO_GTEQ: {
+      if (lhs.max < rhs.min) {
+        *value = op == BO_LT;
+        return true;
+      } else if (lhs.min >= rhs.max) {
+        *value = op == BO_GTEQ;
+        return true;
+      } else {
+        return false;
+      }
+    }
+    default: {
+      // BO_GT and BO_LTEQ
+      if (lhs.min > rhs.max) {
+        *value = op == BO_GT;
+        return true;
+      } else if (lhs.max <= rhs.min) {
+        *value = op == BO_LTEQ;
+        return true;
+      } else {
+        return false;
+      }
+    }
+  }
+}
+
+size_t arithmeticWidth(Node *exp) {
+  TypeKeyword type;
+  ValueRange range;
+  size_t width;
+  bool isSigned;
+  bool known = analyze(exp, &type, &range);
+  if (!integralInfo(type, &width, &isSigned)) return 64;
+  if (width <= 32) return 32;
+
+  exp = stripParens(exp);
+  if (!known || exp->type != NT_BINOPEXP ||
+      (exp->data.binOpExp.op != BO_DIV && exp->data.binOpExp.op != BO_MOD))
+    return 64;
+
+  ValueRange lhs;
+  ValueRange rhs;
+  if (!valueRangeOf(exp->data.binOpExp.lhs, &lhs) ||
+      !valueRangeOf(exp->data.binOpExp.rhs, &rhs))
+    return 64;
+  return lhs.min >= INT32_MIN && lhs.max <= INT32_MAX &&
+                 rhs.min >= INT32_MIN && rhs.max <= INT32_MAX &&
+                 range.min >= INT32_MIN && range.max <= INT32_MAX
+             ? 32
+             : 64;
+}
+
+bool switchNeedsBoundsCheck(Node *condition, int64_t low, int64_t high) {
+  ValueRange range;
+  return !valueRangeOf(condition, &range) || range.min < low ||
+         range.max > high;
+}
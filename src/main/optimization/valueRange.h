@@ -0,0 +1,123 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * value range analysis
+ *
+ * computes the range of values integral expressions may take, so that
+ * redundant extensions can be dropped, comparisons can be folded, arithmetic
+ * can be done at the cheapest width, and switches can skip bounds checks
+ */
+
+#ifndef TLC_OPTIMIZATION_VALUERANGE_H_
+#define TLC_OPTIMIZATION_VALUERANGE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ast/ast.h"
+#include "ast/type.h"
+
+/** an inclusive range of integer values */
+typedef struct {
+  int64_t min;
+  int64_t max;
+} ValueRange;
+
+/** how a value is widened */
+typedef enum {
+  EK_NONE, /**< no instruction needed - the value is already as wide, or is a
+              32 bit value being zero extended, which every 32 bit register
+              write does */
+  EK_ZERO, /**< zero extension - movzx */
+  EK_SIGN, /**< sign extension - movsx or movsxd */
+} ExtensionKind;
+
+/**
+ * gets the range of values of an integral type
+ *
+ * @param keyword type to query
+ * @param range output pointer to the range
+ * @returns whether the type is integral and its range fits in a long - false
+ * for ulong
+ */
+bool typeKeywordRange(TypeKeyword keyword, ValueRange *range);
+
+/**
+ * computes the range of values an integral expression may take
+ *
+ * variables may hold any value of their type, and arithmetic that may overflow
+ * may produce any value of its type
+ *
+ * @param exp expression to query
+ * @param range output pointer to the range
+ * @returns whether a range is known - false for non-integral expressions, and
+ * for ulong expressions that may exceed the range of a long
+ */
+bool valueRangeOf(Node *exp, ValueRange *range);
+
+/**
+ * decides how an integral expression should be widened
+ *
+ * signed values known to be non-negative are zero extended instead of sign
+ * extended, which is free from 32 to 64 bits
+ *
+ * @param exp expression to widen
+ * @param from integral type of the expression
+ * @param to integral type to widen to
+ * @returns extension to use
+ */
+ExtensionKind extensionKindOf(Node *exp, TypeKeyword from, TypeKeyword to);
+
+/**
+ * folds a comparison whose result is decided by the ranges of its operands
+ *
+ * comparisons with side effects are never folded
+ *
+ * @param exp expression to fold
+ * @param value output pointer to the result
+ * @returns whether exp is a comparison and was folded
+ */
+bool comparisonFold(Node *exp, bool *value);
+
+/**
+ * gets the width, in bits, an arithmetic expression should be computed at
+ *
+ * byte and short arithmetic is widened to avoid partial register writes, and
+ * long division and modulo whose operands and result fit in an int are
+ * narrowed, since 32 bit division is much faster than 64 bit division
+ *
+ * @param exp binary or unary arithmetic expression
+ * @returns 32 or 64
+ */
+size_t arithmeticWidth(Node *exp);
+
+/**
+ * does a switch need a bounds check before indexing its jump table?
+ *
+ * @param condition switch condition
+ * @param low smallest value in the jump table
+ * @param high largest value in the jump table
+ * @returns false if the condition is known to be within the table
+ */
+bool switchNeedsBoundsCheck(Node *condition, int64_t low, int64_t high);
+
+#endif  // TLC_OPTIMIZATION_VALUERANGE_H_
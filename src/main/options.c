@@ -23,12 +23,45 @@
 #include <string.h>
 
 Options options = {
+    OPTION_O_0,
+    OPTION_PD_PDC,
+    OPTION_FP_OMIT,
+    OPTION_FS_COMBINED,
+    OPTION_DS_COMBINED,
+    OPTION_TM_GLOBAL_DYNAMIC,
+    OPTION_EW_NARROWEST,
+    OPTION_MT_GENERIC,
+    OPTION_AM_STRICT,
+    OPTION_SZ_HONOR,
+    OPTION_RM_STRICT,
+    OPTION_FPC_OFF,
     OPTION_W_ERROR,
     OPTION_W_ERROR,
     OPTION_W_ERROR,
     OPTION_DD_NONE,
+    OPTION_TR_NONE,
+    OPTION_OR_NONE,
+    OPTION_RUN_NONE,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
 };
 
+/**
+ * gets the value of an option of the form prefix=value
+ *
+ * @param arg argument to query
+ * @param prefix option name, including the equals sign
+ * @returns the value, or NULL if arg isn't the given option
+ */
+static char const *optionValue(char const *arg, char const *prefix) {
+  size_t length = strlen(prefix);
+  return strncmp(arg, prefix, length) == 0 ? arg + length : NULL;
+}
+
 int parseArgs(size_t argc, char const *const *argv, size_t *numFilesOut) {
   size_t numFiles = 0;
 
@@ -40,6 +73,82 @@ int parseArgs(size_t argc, char const *const *argv, size_t *numFilesOut) {
       // remaining options are all files
       numFiles += argc - idx - 1;
       break;
+    } else if (strcmp(argv[idx], "-O0") == 0) {
+      options.optimizationLevel = OPTION_O_0;
+    } else if (strcmp(argv[idx], "-O1") == 0) {
+      options.optimizationLevel = OPTION_O_1;
+    } else if (strcmp(argv[idx], "-O2") == 0) {
+      options.optimizationLevel = OPTION_O_2;
+    } else if (strcmp(argv[idx], "-O3") == 0) {
+      options.optimizationLevel = OPTION_O_3;
+    } else if (strcmp(argv[idx], "-Os") == 0) {
+      options.optimizationLevel = OPTION_O_S;
+    } else if (strcmp(argv[idx], "-Oz") == 0) {
+      options.optimizationLevel = OPTION_O_Z;
+    } else if (strcmp(argv[idx], "-fPDC") == 0) {
+      options.positionDependence = OPTION_PD_PDC;
+    } else if (strcmp(argv[idx], "-fPIE") == 0) {
+      options.positionDependence = OPTION_PD_PIE;
+    } else if (strcmp(argv[idx], "-fPIC") == 0) {
+      options.positionDependence = OPTION_PD_PIC;
+    } else if (strcmp(argv[idx], "-fomit-frame-pointer") == 0) {
+      options.framePointer = OPTION_FP_OMIT;
+    } else if (strcmp(argv[idx], "-fno-omit-frame-pointer") == 0) {
+      options.framePointer = OPTION_FP_KEEP;
+    } else if (strcmp(argv[idx], "-ffunction-sections") == 0) {
+      options.functionSections = OPTION_FS_SEPARATE;
+    } else if (strcmp(argv[idx], "-fno-function-sections") == 0) {
+      options.functionSections = OPTION_FS_COMBINED;
+    } else if (strcmp(argv[idx], "-fdata-sections") == 0) {
+      options.dataSections = OPTION_DS_SEPARATE;
+    } else if (strcmp(argv[idx], "-fno-data-sections") == 0) {
+      options.dataSections = OPTION_DS_COMBINED;
+    } else if (strcmp(argv[idx], "-ftls-model=global-dynamic") == 0) {
+      options.tlsModel = OPTION_TM_GLOBAL_DYNAMIC;
+    } else if (strcmp(argv[idx], "-ftls-model=initial-exec") == 0) {
+      options.tlsModel = OPTION_TM_INITIAL_EXEC;
+    } else if (strcmp(argv[idx], "-ftls-model=local-exec") == 0) {
+      options.tlsModel = OPTION_TM_LOCAL_EXEC;
+    } else if (strcmp(argv[idx], "-fenum-width=narrowest") == 0) {
+      options.enumWidth = OPTION_EW_NARROWEST;
+    } else if (strcmp(argv[idx], "-fenum-width=8") == 0) {
+      options.enumWidth = OPTION_EW_8;
+    } else if (strcmp(argv[idx], "-fenum-width=16") == 0) {
+      options.enumWidth = OPTION_EW_16;
+    } else if (strcmp(argv[idx], "-fenum-width=32") == 0) {
+      options.enumWidth = OPTION_EW_32;
+    } else if (strcmp(argv[idx], "-fenum-width=64") == 0) {
+      options.enumWidth = OPTION_EW_64;
+    } else if (strcmp(argv[idx], "-ffast-math") == 0) {
+      options.associativeMath = OPTION_AM_REASSOCIATE;
+      options.signedZeros = OPTION_SZ_IGNORE;
+      options.reciprocalMath = OPTION_RM_APPROXIMATE;
+      options.fpContract = OPTION_FPC_FAST;
+    } else if (strcmp(argv[idx], "-fno-fast-math") == 0) {
+      options.associativeMath = OPTION_AM_STRICT;
+      options.signedZeros = OPTION_SZ_HONOR;
+      options.reciprocalMath = OPTION_RM_STRICT;
+      options.fpContract = OPTION_FPC_OFF;
+    } else if (strcmp(argv[idx], "-fassociative-math") == 0) {
+      options.associativeMath = OPTION_AM_REASSOCIATE;
+    } else if (strcmp(argv[idx], "-fno-associative-math") == 0) {
+      options.associativeMath = OPTION_AM_STRICT;
+    } else if (strcmp(argv[idx], "-fsigned-zeros") == 0) {
+      options.signedZeros = OPTION_SZ_HONOR;
+    } else if (strcmp(argv[idx], "-fno-signed-zeros") == 0) {
+      options.signedZeros = OPTION_SZ_IGNORE;
+    } else if (strcmp(argv[idx], "-freciprocal-math") == 0) {
+      options.reciprocalMath = OPTION_RM_APPROXIMATE;
+    } else if (strcmp(argv[idx], "-fno-reciprocal-math") == 0) {
+      options.reciprocalMath = OPTION_RM_STRICT;
+    } else if (strcmp(argv[idx], "-ffp-contract=off") == 0) {
+      options.fpContract = OPTION_FPC_OFF;
+    } else if (strcmp(argv[idx], "-ffp-contract=fast") == 0) {
+      options.fpContract = OPTION_FPC_FAST;
+    } else if (strcmp(argv[idx], "-mtune=generic") == 0) {
+      options.tune = OPTION_MT_GENERIC;
+    } else if (strcmp(argv[idx], "-mtune=skylake") == 0) {
+      options.tune = OPTION_MT_SKYLAKE;
     } else if (strcmp(argv[idx], "-Wduplicate-file=error") == 0) {
       options.duplicateFile = OPTION_W_ERROR;
     } else if (strcmp(argv[idx], "-Wduplicate-file=warn") == 0) {
@@ -64,6 +173,29 @@ int parseArgs(size_t argc, char const *const *argv, size_t *numFilesOut) {
       options.dump = OPTION_DD_LEX;
     } else if (strcmp(argv[idx], "--debug-dump=parse") == 0) {
       options.dump = OPTION_DD_PARSE;
+    } else if (strcmp(argv[idx], "--time-report") == 0) {
+      options.timeReport = OPTION_TR_REPORT;
+    } else if (strcmp(argv[idx], "--run") == 0) {
+      options.run = OPTION_RUN_INTERPRET;
+    } else if (optionValue(argv[idx], "-fpass-pipeline=") != NULL) {
+      options.passPipeline = optionValue(argv[idx], "-fpass-pipeline=");
+    } else if (optionValue(argv[idx], "-fdisable-pass=") != NULL) {
+      options.disabledPasses = optionValue(argv[idx], "-fdisable-pass=");
+    } else if (optionValue(argv[idx], "-print-before=") != NULL) {
+      options.printBefore = optionValue(argv[idx], "-print-before=");
+    } else if (optionValue(argv[idx], "-print-after=") != NULL) {
+      options.printAfter = optionValue(argv[idx], "-print-after=");
+    } else if (optionValue(argv[idx], "-Rpass=") != NULL) {
+      options.remarksPassed = optionValue(argv[idx], "-Rpass=");
+    } else if (optionValue(argv[idx], "-Rpass-missed=") != NULL) {
+      options.remarksMissed = optionValue(argv[idx], "-Rpass-missed=");
+    } else if (strcmp(argv[idx], "-fsave-optimization-record") == 0 ||
+               strcmp(argv[idx], "-fsave-optimization-record=yaml") == 0) {
+      options.optimizationRecord = OPTION_OR_YAML;
+    } else if (strcmp(argv[idx], "-fsave-optimization-record=json") == 0) {
+      options.optimizationRecord = OPTION_OR_JSON;
+    } else if (strcmp(argv[idx], "-fno-save-optimization-record") == 0) {
+      options.optimizationRecord = OPTION_OR_NONE;
     } else {
       fprintf(stderr, "tlc: error: options '%s' not recognized\n", argv[idx]);
       return -1;
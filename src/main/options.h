@@ -27,6 +27,76 @@
 
 #include <stddef.h>
 
+/** Optimization level */
+typedef enum {
+  OPTION_O_0, /**< no optimization */
+  OPTION_O_1, /**< optimizations that don't take much compile time */
+  OPTION_O_2, /**< optimizations that don't trade size for speed */
+  OPTION_O_3, /**< all optimizations for speed */
+  OPTION_O_S, /**< optimize for size, unless that is much slower */
+  OPTION_O_Z, /**< optimize for size at any cost */
+} OptimizationLevelOption;
+/** Position dependence of generated code */
+typedef enum {
+  OPTION_PD_PDC, /**< fixed-position code */
+  OPTION_PD_PIE, /**< position independent executable */
+  OPTION_PD_PIC, /**< position independent code, for shared libraries */
+} PositionDependenceOption;
+/** Frame pointer use */
+typedef enum {
+  OPTION_FP_OMIT, /**< frame pointer is only used if needed */
+  OPTION_FP_KEEP, /**< every function sets up a frame pointer */
+} FramePointerOption;
+/** Placement of functions in sections */
+typedef enum {
+  OPTION_FS_COMBINED, /**< every function goes in .text */
+  OPTION_FS_SEPARATE, /**< each function gets its own .text.name section */
+} FunctionSectionsOption;
+/** Placement of global variables in sections */
+typedef enum {
+  OPTION_DS_COMBINED, /**< every variable goes in .data, .rodata or .bss */
+  OPTION_DS_SEPARATE, /**< each variable gets its own section */
+} DataSectionsOption;
+/** Most general thread-local storage access model code may use */
+typedef enum {
+  OPTION_TM_GLOBAL_DYNAMIC, /**< any model the code needs */
+  OPTION_TM_INITIAL_EXEC,   /**< the module is loaded at startup, so its
+                               thread-locals are at fixed offsets */
+  OPTION_TM_LOCAL_EXEC,     /**< the module is linked into the executable */
+} TlsModelOption;
+/** Storage width of enum types */
+typedef enum {
+  OPTION_EW_NARROWEST, /**< narrowest integer covering every constant */
+  OPTION_EW_8,         /**< at least 8 bits */
+  OPTION_EW_16,        /**< at least 16 bits */
+  OPTION_EW_32,        /**< at least 32 bits */
+  OPTION_EW_64,        /**< always 64 bits */
+} EnumWidthOption;
+/** Microarchitecture to tune for */
+typedef enum {
+  OPTION_MT_GENERIC, /**< any x86_64 processor */
+  OPTION_MT_SKYLAKE, /**< Intel Skylake and its derivatives */
+} TuneOption;
+/** Reassociation of floating point arithmetic */
+typedef enum {
+  OPTION_AM_STRICT,      /**< evaluate in source order */
+  OPTION_AM_REASSOCIATE, /**< reorder additions and multiplications */
+} AssociativeMathOption;
+/** Treatment of the sign of floating point zeros */
+typedef enum {
+  OPTION_SZ_HONOR,  /**< -0.0 and 0.0 are distinct */
+  OPTION_SZ_IGNORE, /**< the sign of a zero may change */
+} SignedZerosOption;
+/** Division of floating point numbers */
+typedef enum {
+  OPTION_RM_STRICT,      /**< division is correctly rounded */
+  OPTION_RM_APPROXIMATE, /**< division may use an inexact reciprocal */
+} ReciprocalMathOption;
+/** Contraction of floating point expressions */
+typedef enum {
+  OPTION_FPC_OFF,  /**< every operation is rounded */
+  OPTION_FPC_FAST, /**< multiplications and additions may be fused */
+} FPContractOption;
 /** Warning levels */
 typedef enum {
   OPTION_W_IGNORE,
@@ -39,12 +109,55 @@ typedef enum {
   OPTION_DD_LEX,
   OPTION_DD_PARSE,
 } DebugDumpOption;
+/** Compile time reporting */
+typedef enum {
+  OPTION_TR_NONE,   /**< don't report compile times */
+  OPTION_TR_REPORT, /**< report the time taken by each phase and pass */
+} TimeReportOption;
+/** Saving of optimization remarks */
+typedef enum {
+  OPTION_OR_NONE, /**< don't save remarks */
+  OPTION_OR_YAML, /**< save remarks as a stream of YAML documents */
+  OPTION_OR_JSON, /**< save remarks as a JSON array */
+} OptimizationRecordOption;
+/** What to do with the compiled program */
+typedef enum {
+  OPTION_RUN_NONE,      /**< compile the program */
+  OPTION_RUN_INTERPRET, /**< run the program's main function in the
+                           interpreter */
+} RunOption;
 /** Holds options */
 typedef struct {
+  OptimizationLevelOption optimizationLevel;
+  PositionDependenceOption positionDependence;
+  FramePointerOption framePointer;
+  FunctionSectionsOption functionSections;
+  DataSectionsOption dataSections;
+  TlsModelOption tlsModel;
+  EnumWidthOption enumWidth;
+  TuneOption tune;
+  AssociativeMathOption associativeMath;
+  SignedZerosOption signedZeros;
+  ReciprocalMathOption reciprocalMath;
+  FPContractOption fpContract;
   WarningOption duplicateFile;
   WarningOption duplicateImport;
   WarningOption unrecognizedFile;
   DebugDumpOption dump;
+  TimeReportOption timeReport;
+  OptimizationRecordOption optimizationRecord;
+  RunOption run;
+  char const *passPipeline; /**< comma separated pass names replacing the
+                               pipeline of the optimization level, nullable */
+  char const *disabledPasses; /**< comma separated pass names, nullable */
+  char const *printBefore; /**< comma separated pass names, or "all", to dump
+                              the AST before, nullable */
+  char const *printAfter;  /**< comma separated pass names, or "all", to dump
+                              the AST after, nullable */
+  char const *remarksPassed; /**< regex of passes to report applied
+                                optimizations of, nullable */
+  char const *remarksMissed; /**< regex of passes to report missed
+                                optimizations of, nullable */
 } Options;
 
 /**
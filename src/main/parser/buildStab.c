@@ -19,6 +19,7 @@
 
 #include "parser/buildStab.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -50,10 +51,29 @@ static bool nameArrayContains(Node **arry, size_t size, Node *n) {
 int resolveImports(void) {
   bool errored = false;
 
+  // index the decl modules by name - if two have the same name, fall back to
+  // comparing every pair to report all of the duplicates
+  HashMap modules;  // map from module name to FileListEntry, non-owning
+  Vector moduleNames;  // vector of char *, owning
+  hashMapInit(&modules);
+  vectorInit(&moduleNames);
+  bool duplicateModules = false;
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    if (!fileList.entries[fileIdx].isCode) {
+      char *name = stringifyId(
+          fileList.entries[fileIdx].ast->data.file.module->data.module.id);
+      vectorInsert(&moduleNames, name);
+      duplicateModules = hashMapPut(&modules, name,
+                                    &fileList.entries[fileIdx]) != 0 ||
+                         duplicateModules;
+    }
+  }
+
   // check for duplciate decl modules
   FileListEntry **processed = malloc(sizeof(FileListEntry *) * fileList.size);
   size_t numProcessed = 0;
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+  for (size_t fileIdx = 0; duplicateModules && fileIdx < fileList.size;
+       ++fileIdx) {
     if (!fileList.entries[fileIdx].isCode &&
         !fileListEntryArrayContains(processed, numProcessed,
                                     &fileList.entries[fileIdx])) {
@@ -97,7 +117,11 @@ int resolveImports(void) {
   }
   free(processed);
 
-  if (errored) return -1;
+  if (errored) {
+    hashMapUninit(&modules, nullDtor);
+    vectorUninit(&moduleNames, free);
+    return -1;
+  }
 
   // link imports
   for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
@@ -152,17 +176,32 @@ int resolveImports(void) {
       }
     }
 
-    // check for duplicate imports
+    // check for duplicate imports - only compare every pair if there are any
+    HashSet importNames;
+    Vector importNameStrings;  // vector of char *, owning
+    hashSetInit(&importNames);
+    vectorInit(&importNameStrings);
+    bool duplicateImports = false;
+    for (size_t importIdx = 0; importIdx < imports->size; ++importIdx) {
+      Node *import = imports->elements[importIdx];
+      char *name = stringifyId(import->data.import.id);
+      vectorInsert(&importNameStrings, name);
+      duplicateImports =
+          hashSetPut(&importNames, name) != 0 || duplicateImports;
+    }
+    hashSetUninit(&importNames);
+
     for (size_t importIdx = 0; importIdx < imports->size; ++importIdx) {
       Node *import = imports->elements[importIdx];
 
       // note - we don't always abort after a duplicate, so this prevents
       // double-importing
-      if (!nameArrayContains(processed, numProcessed, import->data.import.id)) {
+      if (!duplicateImports ||
+          !nameArrayContains(processed, numProcessed, import->data.import.id)) {
         // check for upcoming duplicates
         numColliding = 0;
-        for (size_t checkIdx = importIdx + 1; checkIdx < imports->size;
-             ++checkIdx) {
+        for (size_t checkIdx = importIdx + 1;
+             duplicateImports && checkIdx < imports->size; ++checkIdx) {
           Node *toCheck = imports->elements[checkIdx];
           if (nameNodeEqual(import->data.import.id, toCheck->data.import.id))
             colliding[numColliding++] = toCheck;
@@ -203,7 +242,7 @@ int resolveImports(void) {
         }
 
         import->data.import.referenced =
-            fileListFindDeclName(import->data.import.id);
+            hashMapGet(&modules, importNameStrings.elements[importIdx]);
 
         if (import->data.import.referenced == NULL) {
           char *name = stringifyId(import->data.import.id);
@@ -218,9 +257,12 @@ int resolveImports(void) {
         ++numProcessed;
       }
     }
+    vectorUninit(&importNameStrings, free);
     free(colliding);
     free(processed);
   }
+  hashMapUninit(&modules, nullDtor);
+  vectorUninit(&moduleNames, free);
 
   if (errored)
     return -1;
@@ -417,6 +459,8 @@ void startTopLevelStab(FileListEntry *entry) {
           } else {
             name->data.id.entry =
                 variableStabEntryCreate(entry, name->line, name->character);
+            name->data.id.entry->data.variable.threadLocal =
+                body->data.varDecl.threadLocal;
             hashMapPut(stab, nameString, name->data.id.entry);
           }
         }
@@ -440,6 +484,8 @@ void startTopLevelStab(FileListEntry *entry) {
             if (existing->kind == SK_VARIABLE && fromImplicit) {
               name->data.id.entry =
                   variableStabEntryCreate(entry, name->line, name->character);
+              name->data.id.entry->data.variable.threadLocal =
+                  body->data.varDefn.threadLocal;
               hashMapPut(stab, nameString, name->data.id.entry);
             } else {
               errorRedeclaration(entry, name->line, name->character, nameString,
@@ -449,6 +495,8 @@ void startTopLevelStab(FileListEntry *entry) {
           } else {
             name->data.id.entry =
                 variableStabEntryCreate(entry, name->line, name->character);
+            name->data.id.entry->data.variable.threadLocal =
+                body->data.varDefn.threadLocal;
             hashMapPut(stab, nameString, name->data.id.entry);
           }
         }
@@ -507,213 +555,145 @@ void startTopLevelStab(FileListEntry *entry) {
   }
 }
 
+/** an enum constant and its index in the list of enum constants */
+typedef struct {
+  SymbolTableEntry *entry;
+  size_t idx;
+} ConstantIndex;
+
+/** orders ConstantIndexes by the address of their entry */
+static int constantIndexCompare(void const *a, void const *b) {
+  uintptr_t lhs = (uintptr_t)((ConstantIndex const *)a)->entry;
+  uintptr_t rhs = (uintptr_t)((ConstantIndex const *)b)->entry;
+  return lhs < rhs ? -1 : lhs > rhs ? 1 : 0;
+}
+
 /**
- * find the index of e in enumConstants
+ * builds an index of enumConstants for constantEntryFind
  *
- * e must be in enumConstants
+ * @param enumConstants vector of SymbolTableEntry to index
+ * @returns array of ConstantIndex sorted by entry, owning
  */
-static size_t constantEntryFind(Vector *enumConstants, SymbolTableEntry *e) {
+static ConstantIndex *constantIndexCreate(Vector const *enumConstants) {
+  ConstantIndex *index =
+      malloc(sizeof(ConstantIndex) * (enumConstants->size + 1));
   for (size_t idx = 0; idx < enumConstants->size; ++idx) {
-    if (enumConstants->elements[idx] == e) return idx;
+    index[idx].entry = enumConstants->elements[idx];
+    index[idx].idx = idx;
   }
-  error(__FILE__, __LINE__,
-        "constantEntryFind called with an e not in enumConstants");
+  qsort(index, enumConstants->size, sizeof(ConstantIndex),
+        constantIndexCompare);
+  return index;
 }
-int buildTopLevelEnumStab(void) {
-  Vector enumConstants;  // vector of SymbolTableEntry, non-owning
-  Vector dependencies;   // vector of SymbolTableEntry, non-owning, nullable
-  Vector enumValues;  // vector of extended int literals, non-owning, nullable
-  bool errored = false;
-  vectorInit(&enumConstants);
-  vectorInit(&dependencies);
-  vectorInit(&enumValues);
-
-  // for each enum in each file, create the enumConstant entries
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    FileListEntry *entry = &fileList.entries[fileIdx];
-    Vector *bodies = entry->ast->data.file.bodies;
-
-    // for each top level
-    for (size_t bodyIdx = 0; bodyIdx < bodies->size; ++bodyIdx) {
-      Node *body = bodies->elements[bodyIdx];
-      // if it's an enum
-      if (body->type == NT_ENUMDECL) {
-        SymbolTableEntry *thisEnum = body->data.enumDecl.name->data.id.entry;
-        Vector *constantSymbols = &thisEnum->data.enumType.constantValues;
-        // for each constant, record it in the graph
-        for (size_t constantIdx = 0; constantIdx < constantSymbols->size;
-             ++constantIdx) {
-          vectorInsert(&enumConstants, constantSymbols->elements[constantIdx]);
-          vectorInsert(&dependencies, NULL);
-          vectorInsert(
-              &enumValues,
-              body->data.enumDecl.constantValues->elements[constantIdx]);
-        }
-      }
-    }
-  }
-
-  // for each enum in each file
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    FileListEntry *entry = &fileList.entries[fileIdx];
-    Vector *bodies = entry->ast->data.file.bodies;
-    Environment env;
-    environmentInit(&env, entry);
-
-    // for each enum in the file
-    for (size_t bodyIdx = 0; bodyIdx < bodies->size; ++bodyIdx) {
-      Node *body = bodies->elements[bodyIdx];
-      if (body->type == NT_ENUMDECL) {
-        SymbolTableEntry *thisEnum = body->data.enumDecl.name->data.id.entry;
-        Vector *constantValues = &thisEnum->data.enumType.constantValues;
 
-        // for each constant
-        for (size_t constantIdx = 0; constantIdx < constantValues->size;
-             ++constantIdx) {
-          Node *constantValueNode =
-              body->data.enumDecl.constantValues->elements[constantIdx];
-          size_t constantEntryIdx = constantEntryFind(
-              &enumConstants, constantValues->elements[constantIdx]);
-          if (constantValueNode == NULL) {
-            // depends on previous
-            if (constantIdx == 0) {
-              // no previous entry in this enum - depends on nothing
-              dependencies.elements[constantEntryIdx] = NULL;
-            } else {
-              // depends on previous entry (is always at current - 1)
-              dependencies.elements[constantEntryIdx] =
-                  enumConstants.elements[constantEntryIdx - 1];
-            }
-          } else {
-            // entry = ...
-            if (constantValueNode->type == NT_LITERAL) {
-              // must be int, char, wchar literal
-              // depends on nothing
-              dependencies.elements[constantEntryIdx] = NULL;
-            } else {
-              // depends on another enum - constantValue is a SCOPED_ID
-              // find the enum
-              SymbolTableEntry *stabEntry =
-                  environmentLookup(&env, constantValueNode, false);
-              if (stabEntry == NULL) {
-                // error - no such enum
-                errored = true;
-              } else if (stabEntry->kind != SK_ENUMCONST) {
-                fprintf(stderr,
-                        "%s:%zu:%zu: error: expected an extended integer "
-                        "literal, found %s\n",
-                        entry->inputFilename, constantValueNode->line,
-                        constantValueNode->character,
-                        symbolKindToString(stabEntry->kind));
-                errored = true;
-              } else {
-                dependencies.elements[constantEntryIdx] = stabEntry;
-              }
-            }
-          }
-        }
-      }
-    }
+/**
+ * find the index of e in enumConstants
+ *
+ * @param index index of enumConstants from constantIndexCreate
+ * @param size number of enum constants
+ * @param e constant to find
+ * @returns index of e, or size if e isn't in enumConstants
+ */
+static size_t constantEntryFind(ConstantIndex const *index, size_t size,
+                                SymbolTableEntry *e) {
+  ConstantIndex key = {e, 0};
+  ConstantIndex const *found =
+      bsearch(&key, index, size, sizeof(ConstantIndex), constantIndexCompare);
+  return found == NULL ? size : found->idx;
+}
 
-    environmentUninit(&env);
-  }
+/**
+ * checks enum constants for circular references, and computes their values
+ *
+ * @param enumConstants vector of SymbolTableEntry, the constants to compute
+ * @param dependencies vector of SymbolTableEntry, nullable - the constant each
+ * constant depends on. Dependencies that aren't in enumConstants must already
+ * have their values
+ * @param enumValues vector of extended int literals, nullable - the value each
+ * constant is initialized with
+ * @returns whether an error was reported
+ */
+static bool resolveEnumConstants(Vector const *enumConstants,
+                                 Vector const *dependencies,
+                                 Vector const *enumValues) {
+  bool errored = false;
 
-  if (errored) {
-    vectorUninit(&enumConstants, nullDtor);
-    vectorUninit(&dependencies, nullDtor);
-    vectorUninit(&enumValues, nullDtor);
-    return -1;
+  // find the index of each constant's dependency - enumConstants->size if it
+  // has none, or it's from elsewhere
+  ConstantIndex *index = constantIndexCreate(enumConstants);
+  size_t *dependencyIdxs = malloc(sizeof(size_t) * (enumConstants->size + 1));
+  for (size_t idx = 0; idx < enumConstants->size; ++idx) {
+    dependencyIdxs[idx] =
+        dependencies->elements[idx] == NULL
+            ? enumConstants->size
+            : constantEntryFind(index, enumConstants->size,
+                                dependencies->elements[idx]);
   }
+  free(index);
+
+  // walk the dependency chains, checking for loops and putting dependencies
+  // before the constants that depend on them - every constant has at most one
+  // dependency, so each constant is walked over once
+  // 0 = unvisited, 1 = on the current chain, 2 = done
+  char *state = calloc(enumConstants->size + 1, sizeof(char));
+  size_t *chain = malloc(sizeof(size_t) * (enumConstants->size + 1));
+  size_t *order = malloc(sizeof(size_t) * (enumConstants->size + 1));
+  size_t orderSize = 0;
+  for (size_t startIdx = 0; startIdx < enumConstants->size; ++startIdx) {
+    size_t chainSize = 0;
+    size_t curr = startIdx;
+    while (curr != enumConstants->size && state[curr] == 0) {
+      state[curr] = 1;
+      chain[chainSize++] = curr;
+      curr = dependencyIdxs[curr];
+    }
 
-  bool *processed = calloc(enumConstants.size, sizeof(bool));
-  for (size_t startIdx = 0; startIdx < enumConstants.size; ++startIdx) {
-    if (!processed[startIdx]) {
-      typedef struct PathNode {
-        size_t curr;
-        struct PathNode *prev;
-      } PathNode;
-
-      PathNode *path = malloc(sizeof(PathNode));
-      path->curr = startIdx;
-      path->prev = NULL;
-
-      processed[startIdx] = true;
-      if (dependencies.elements[startIdx] != NULL) {
-        size_t curr =
-            constantEntryFind(&enumConstants, dependencies.elements[startIdx]);
-        while (true) {
-          // loop that's my problem detected - complain
-          if (curr == startIdx) {
-            errored = true;
-            SymbolTableEntry *start = enumConstants.elements[startIdx];
-            fprintf(stderr,
-                    "%s:%zu:%zu: error: circular reference in enumeration "
-                    "constants\n",
-                    start->file->inputFilename, start->line, start->character);
-            PathNode *currPathNode = path;
-            while (currPathNode != NULL) {
-              currPathNode = currPathNode->prev;
-              SymbolTableEntry *currEntry =
-                  enumConstants.elements[currPathNode->curr];
-              fprintf(stderr, "%s:%zu:%zu: note: references above\n",
-                      currEntry->file->inputFilename, currEntry->line,
-                      currEntry->character);
-            }
-            break;
-          }
-
-          // loop that's not my problem detected - stop early
-          PathNode *currPathNode = path;
-          bool willBreak = false;
-          while (currPathNode != NULL) {
-            if (currPathNode->curr == curr) {
-              // is in a loop - break
-              willBreak = true;
-              break;
-            }
-            currPathNode = path->prev;
-          }
-          if (willBreak) break;
-
-          PathNode *newPath = malloc(sizeof(PathNode));
-          newPath->curr = curr;
-          newPath->prev = path;
-          path = newPath;
-
-          SymbolTableEntry *dependency = dependencies.elements[startIdx];
-          if (dependency == NULL) break;
-          curr = constantEntryFind(&enumConstants, dependency);
-        }
+    if (curr != enumConstants->size && state[curr] == 1) {
+      // loop detected - complain
+      errored = true;
+      SymbolTableEntry *start = enumConstants->elements[curr];
+      fprintf(stderr,
+              "%s:%zu:%zu: error: circular reference in enumeration "
+              "constants\n",
+              start->file->inputFilename, start->line, start->character);
+      for (size_t chainIdx = chainSize; chainIdx-- > 0;) {
+        SymbolTableEntry *currEntry = enumConstants->elements[chain[chainIdx]];
+        fprintf(stderr, "%s:%zu:%zu: note: references above\n",
+                currEntry->file->inputFilename, currEntry->line,
+                currEntry->character);
+        if (chain[chainIdx] == curr) break;
       }
+    }
 
-      while (path != NULL) {
-        PathNode *prev = path->prev;
-        free(path);
-        path = prev;
-      }
+    while (chainSize > 0) {
+      size_t done = chain[--chainSize];
+      state[done] = 2;
+      order[orderSize++] = done;
     }
   }
+  free(chain);
+  free(state);
 
   if (errored) {
-    free(processed);
-    vectorUninit(&enumConstants, nullDtor);
-    vectorUninit(&dependencies, nullDtor);
-    vectorUninit(&enumValues, nullDtor);
-    return -1;
+    free(order);
+    free(dependencyIdxs);
+    return true;
   }
 
-  // build the enum values
+  // build the enum values, in dependency order
+  bool *processed = calloc(enumConstants->size + 1, sizeof(bool));
+  processed[enumConstants->size] = true;  // constants from elsewhere
   size_t numProcessed = 0;
-  memset(processed, 0, sizeof(bool) * enumConstants.size);
-  while (numProcessed < enumConstants.size && !errored) {
-    for (size_t idx = 0; idx < enumConstants.size; ++idx) {
+  while (numProcessed < enumConstants->size && !errored) {
+    for (size_t orderIdx = 0; orderIdx < enumConstants->size; ++orderIdx) {
+      size_t idx = order[orderIdx];
       // for each unprocessed enum
       if (!processed[idx]) {
-        SymbolTableEntry *current = enumConstants.elements[idx];
-        SymbolTableEntry *dependency = dependencies.elements[idx];
+        SymbolTableEntry *current = enumConstants->elements[idx];
+        SymbolTableEntry *dependency = dependencies->elements[idx];
         if (dependency == NULL) {
           // no dependency
-          Node *literal = enumValues.elements[idx];
+          Node *literal = enumValues->elements[idx];
           if (literal == NULL) {
             // has no literal value - must be equal to zero at the start of an
             // enum
@@ -797,10 +777,10 @@ int buildTopLevelEnumStab(void) {
           ++numProcessed;
         } else {
           // depends on something
-          size_t dependencyIdx = constantEntryFind(&enumConstants, dependency);
+          size_t dependencyIdx = dependencyIdxs[idx];
           if (processed[dependencyIdx]) {
             // and dependency is satisfied
-            Node *literal = enumValues.elements[idx];
+            Node *literal = enumValues->elements[idx];
             if (literal == NULL) {
               // is previous plus one
               if (dependency->data.enumConst.signedness) {
@@ -848,6 +828,117 @@ int buildTopLevelEnumStab(void) {
     }
   }
   free(processed);
+  free(order);
+  free(dependencyIdxs);
+  return errored;
+}
+int buildTopLevelEnumStab(void) {
+  Vector enumConstants;  // vector of SymbolTableEntry, non-owning
+  Vector dependencies;   // vector of SymbolTableEntry, non-owning, nullable
+  Vector enumValues;  // vector of extended int literals, non-owning, nullable
+  bool errored = false;
+  vectorInit(&enumConstants);
+  vectorInit(&dependencies);
+  vectorInit(&enumValues);
+
+  // for each enum in each file, create the enumConstant entries
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    FileListEntry *entry = &fileList.entries[fileIdx];
+    Vector *bodies = entry->ast->data.file.bodies;
+
+    // for each top level
+    for (size_t bodyIdx = 0; bodyIdx < bodies->size; ++bodyIdx) {
+      Node *body = bodies->elements[bodyIdx];
+      // if it's an enum
+      if (body->type == NT_ENUMDECL) {
+        SymbolTableEntry *thisEnum = body->data.enumDecl.name->data.id.entry;
+        Vector *constantSymbols = &thisEnum->data.enumType.constantValues;
+        // for each constant, record it in the graph
+        for (size_t constantIdx = 0; constantIdx < constantSymbols->size;
+             ++constantIdx) {
+          vectorInsert(&enumConstants, constantSymbols->elements[constantIdx]);
+          vectorInsert(&dependencies, NULL);
+          vectorInsert(
+              &enumValues,
+              body->data.enumDecl.constantValues->elements[constantIdx]);
+        }
+      }
+    }
+  }
+
+  // for each enum in each file, in the same order the constants were recorded
+  size_t nextConstantIdx = 0;
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    FileListEntry *entry = &fileList.entries[fileIdx];
+    Vector *bodies = entry->ast->data.file.bodies;
+    Environment env;
+    environmentInit(&env, entry);
+
+    // for each enum in the file
+    for (size_t bodyIdx = 0; bodyIdx < bodies->size; ++bodyIdx) {
+      Node *body = bodies->elements[bodyIdx];
+      if (body->type == NT_ENUMDECL) {
+        SymbolTableEntry *thisEnum = body->data.enumDecl.name->data.id.entry;
+        Vector *constantValues = &thisEnum->data.enumType.constantValues;
+
+        // for each constant
+        for (size_t constantIdx = 0; constantIdx < constantValues->size;
+             ++constantIdx) {
+          Node *constantValueNode =
+              body->data.enumDecl.constantValues->elements[constantIdx];
+          size_t constantEntryIdx = nextConstantIdx++;
+          if (constantValueNode == NULL) {
+            // depends on previous
+            if (constantIdx == 0) {
+              // no previous entry in this enum - depends on nothing
+              dependencies.elements[constantEntryIdx] = NULL;
+            } else {
+              // depends on previous entry (is always at current - 1)
+              dependencies.elements[constantEntryIdx] =
+                  enumConstants.elements[constantEntryIdx - 1];
+            }
+          } else {
+            // entry = ...
+            if (constantValueNode->type == NT_LITERAL) {
+              // must be int, char, wchar literal
+              // depends on nothing
+              dependencies.elements[constantEntryIdx] = NULL;
+            } else {
+              // depends on another enum - constantValue is a SCOPED_ID
+              // find the enum
+              SymbolTableEntry *stabEntry =
+                  environmentLookup(&env, constantValueNode, false);
+              if (stabEntry == NULL) {
+                // error - no such enum
+                errored = true;
+              } else if (stabEntry->kind != SK_ENUMCONST) {
+                fprintf(stderr,
+                        "%s:%zu:%zu: error: expected an extended integer "
+                        "literal, found %s\n",
+                        entry->inputFilename, constantValueNode->line,
+                        constantValueNode->character,
+                        symbolKindToString(stabEntry->kind));
+                errored = true;
+              } else {
+                dependencies.elements[constantEntryIdx] = stabEntry;
+              }
+            }
+          }
+        }
+      }
+    }
+
+    environmentUninit(&env);
+  }
+
+  if (errored) {
+    vectorUninit(&enumConstants, nullDtor);
+    vectorUninit(&dependencies, nullDtor);
+    vectorUninit(&enumValues, nullDtor);
+    return -1;
+  }
+
+  errored = resolveEnumConstants(&enumConstants, &dependencies, &enumValues);
 
   vectorUninit(&enumConstants, nullDtor);
   vectorUninit(&dependencies, nullDtor);
@@ -1055,23 +1146,46 @@ void checkScopedIdCollisions(FileListEntry *entry) {
   // and PREFIX describes a module, and FIRSTELM describes an enum within that
   // module and SECONDELM is an element of that module
 
-  // for each import
+  // index the imports by name - only the import named PREFIX::FIRSTELM can
+  // collide with PREFIX
   Vector *imports = entry->ast->data.file.imports;
+  HashMap byName;      // map from import name to import, non-owning
+  Vector importNames;  // vector of char *, owning
+  hashMapInit(&byName);
+  vectorInit(&importNames);
+  for (size_t idx = 0; idx < imports->size; ++idx) {
+    Node *import = imports->elements[idx];
+    char *name = stringifyId(import->data.import.id);
+    vectorInsert(&importNames, name);
+    hashMapPut(&byName, name, import);  // keeps the first of any duplicates
+  }
+
+  // for each import
   for (size_t longIdx = 0; longIdx < imports->size; ++longIdx) {
     Node *longImport = imports->elements[longIdx];
-    // search the rest of the list for imports that have all but the last
-    // element matching
-    for (size_t shortIdx = 0; shortIdx < imports->size; ++shortIdx) {
-      Node *shortImport = imports->elements[shortIdx];
-      entry->errored =
-          entry->errored || checkScopedIdCollisionsBetween(
-                                longImport, shortImport, entry->inputFilename);
+    // find the import that has all but the last element matching
+    Node *longName = longImport->data.import.id;
+    if (longName->type == NT_SCOPEDID) {
+      Vector *components = longName->data.scopedId.components;
+      Node *last = components->elements[components->size - 1];
+      char *prefix = strdup(importNames.elements[longIdx]);
+      prefix[strlen(prefix) - strlen(last->data.id.id) - 2] = '\0';  // "::"
+      Node *shortImport = hashMapGet(&byName, prefix);
+      free(prefix);
+      if (shortImport != NULL)
+        entry->errored =
+            entry->errored ||
+            checkScopedIdCollisionsBetween(longImport, shortImport,
+                                           entry->inputFilename);
     }
 
     // check for problems with current module
     entry->errored =
         entry->errored || checkScopedIdCollisionsWithCurrent(longImport, entry);
   }
+
+  hashMapUninit(&byName, nullDtor);
+  vectorUninit(&importNames, free);
 }
 
 void finishStructStab(FileListEntry *entry, Node *body,
@@ -1181,8 +1295,7 @@ void finishEnumStab(FileListEntry *entry, Node *body,
   Vector *constantValues = &stabEntry->data.enumType.constantValues;
   for (size_t idx = 0; idx < constantValues->size; ++idx) {
     Node *constantValueNode = body->data.enumDecl.constantValues->elements[idx];
-    size_t constantEntryIdx =
-        constantEntryFind(&enumConstants, constantValues->elements[idx]);
+    size_t constantEntryIdx = idx;  // no errors, so every constant was added
     if (constantValueNode == NULL) {
       // depends on previous
       if (idx == 0) {
@@ -1229,229 +1342,7 @@ void finishEnumStab(FileListEntry *entry, Node *body,
     return;
   }
 
-  bool *processed = calloc(enumConstants.size, sizeof(bool));
-  for (size_t startIdx = 0; startIdx < enumConstants.size; ++startIdx) {
-    if (!processed[startIdx]) {
-      typedef struct PathNode {
-        size_t curr;
-        struct PathNode *prev;
-      } PathNode;
-
-      PathNode *path = malloc(sizeof(PathNode));
-      path->curr = startIdx;
-      path->prev = NULL;
-
-      processed[startIdx] = true;
-      if (dependencies.elements[startIdx] != NULL) {
-        size_t curr =
-            constantEntryFind(&enumConstants, dependencies.elements[startIdx]);
-        while (true) {
-          // loop that's my problem detected - complain
-          if (curr == startIdx) {
-            errored = true;
-            SymbolTableEntry *start = enumConstants.elements[startIdx];
-            fprintf(stderr,
-                    "%s:%zu:%zu: error: circular reference in enumeration "
-                    "constants\n",
-                    start->file->inputFilename, start->line, start->character);
-            PathNode *currPathNode = path;
-            while (currPathNode != NULL) {
-              currPathNode = currPathNode->prev;
-              SymbolTableEntry *currEntry =
-                  enumConstants.elements[currPathNode->curr];
-              fprintf(stderr, "%s:%zu:%zu: note: references above\n",
-                      currEntry->file->inputFilename, currEntry->line,
-                      currEntry->character);
-            }
-            break;
-          }
-
-          // loop that's not my problem detected - stop early
-          PathNode *currPathNode = path;
-          bool willBreak = false;
-          while (currPathNode != NULL) {
-            if (currPathNode->curr == curr) {
-              // is in a loop - break
-              willBreak = true;
-              break;
-            }
-            currPathNode = path->prev;
-          }
-          if (willBreak) break;
-
-          PathNode *newPath = malloc(sizeof(PathNode));
-          newPath->curr = curr;
-          newPath->prev = path;
-          path = newPath;
-
-          SymbolTableEntry *dependency = dependencies.elements[startIdx];
-          if (dependency == NULL) break;
-          curr = constantEntryFind(&enumConstants, dependency);
-        }
-      }
-
-      while (path != NULL) {
-        PathNode *prev = path->prev;
-        free(path);
-        path = prev;
-      }
-    }
-  }
-
-  if (errored) {
-    free(processed);
-    vectorUninit(&enumConstants, nullDtor);
-    vectorUninit(&dependencies, nullDtor);
-    vectorUninit(&enumValues, nullDtor);
-    return;
-  }
-
-  // build the enum values
-  size_t numProcessed = 0;
-  memset(processed, 0, sizeof(bool) * enumConstants.size);
-  while (numProcessed < enumConstants.size && !errored) {
-    for (size_t idx = 0; idx < enumConstants.size; ++idx) {
-      // for each unprocessed enum
-      if (!processed[idx]) {
-        SymbolTableEntry *current = enumConstants.elements[idx];
-        SymbolTableEntry *dependency = dependencies.elements[idx];
-        if (dependency == NULL) {
-          // no dependency
-          Node *literal = enumValues.elements[idx];
-          if (literal == NULL) {
-            // has no literal value - must be equal to zero at the start of an
-            // enum
-            current->data.enumConst.signedness = false;
-            current->data.enumConst.data.unsignedValue = 0;
-          } else {
-            // must be a plain (int, char, etc.) literal
-            switch (literal->data.literal.literalType) {
-              case LT_UBYTE: {
-                current->data.enumConst.signedness = false;
-                current->data.enumConst.data.unsignedValue =
-                    literal->data.literal.data.ubyteVal;
-                break;
-              }
-              case LT_BYTE: {
-                current->data.enumConst.signedness =
-                    literal->data.literal.data.byteVal < 0;
-                current->data.enumConst.data.signedValue =
-                    literal->data.literal.data.byteVal;
-                break;
-              }
-              case LT_USHORT: {
-                current->data.enumConst.signedness = false;
-                current->data.enumConst.data.unsignedValue =
-                    literal->data.literal.data.ushortVal;
-                break;
-              }
-              case LT_SHORT: {
-                current->data.enumConst.signedness =
-                    literal->data.literal.data.shortVal < 0;
-                current->data.enumConst.data.signedValue =
-                    literal->data.literal.data.shortVal;
-                break;
-              }
-              case LT_UINT: {
-                current->data.enumConst.signedness = false;
-                current->data.enumConst.data.unsignedValue =
-                    literal->data.literal.data.uintVal;
-                break;
-              }
-              case LT_INT: {
-                current->data.enumConst.signedness =
-                    literal->data.literal.data.intVal < 0;
-                current->data.enumConst.data.signedValue =
-                    literal->data.literal.data.intVal;
-                break;
-              }
-              case LT_ULONG: {
-                current->data.enumConst.signedness = false;
-                current->data.enumConst.data.unsignedValue =
-                    literal->data.literal.data.ulongVal;
-                break;
-              }
-              case LT_LONG: {
-                current->data.enumConst.signedness =
-                    literal->data.literal.data.longVal < 0;
-                current->data.enumConst.data.signedValue =
-                    literal->data.literal.data.longVal;
-                break;
-              }
-              case LT_CHAR: {
-                current->data.enumConst.signedness = false;
-                current->data.enumConst.data.unsignedValue =
-                    literal->data.literal.data.charVal;
-                break;
-              }
-              case LT_WCHAR: {
-                current->data.enumConst.signedness = false;
-                current->data.enumConst.data.unsignedValue =
-                    literal->data.literal.data.wcharVal;
-                break;
-              }
-              default: {
-                error(__FILE__, __LINE__,
-                      "invalid extended int literal used to initialize enum "
-                      "constant");
-              }
-            }
-          }
-          processed[idx] = true;
-          ++numProcessed;
-        } else {
-          // depends on something
-          size_t dependencyIdx = constantEntryFind(&enumConstants, dependency);
-          if (processed[dependencyIdx]) {
-            // and dependency is satisfied
-            Node *literal = enumValues.elements[idx];
-            if (literal == NULL) {
-              // is previous plus one
-              if (dependency->data.enumConst.signedness) {
-                if (dependency->data.enumConst.data.signedValue == -1) {
-                  // next becomes unsigned
-                  current->data.enumConst.signedness = false;
-                  current->data.enumConst.data.unsignedValue = 0;
-                } else {
-                  current->data.enumConst.signedness = true;
-                  current->data.enumConst.data.signedValue =
-                      dependency->data.enumConst.data.signedValue + 1;
-                }
-              } else {
-                if (dependency->data.enumConst.data.unsignedValue ==
-                    ULONG_MAX) {
-                  errored = true;
-                  fprintf(stderr,
-                          "%s:%zu:%zu: error: unrepresentable enumeration "
-                          "constant value - value would overflow a ulong",
-                          current->file->inputFilename, current->line,
-                          current->character);
-                  break;
-                }
-
-                current->data.enumConst.signedness = false;
-                current->data.enumConst.data.unsignedValue =
-                    dependency->data.enumConst.data.unsignedValue + 1;
-              }
-            } else {
-              // is equal to the literal
-              current->data.enumConst.signedness =
-                  dependency->data.enumConst.signedness;
-              if (current->data.enumConst.signedness)
-                current->data.enumConst.data.signedValue =
-                    dependency->data.enumConst.data.signedValue;
-              else
-                current->data.enumConst.data.unsignedValue =
-                    dependency->data.enumConst.data.unsignedValue;
-            }
-            processed[idx] = true;
-            ++numProcessed;
-          }
-        }
-      }
-    }
-  }
-  free(processed);
+  errored = resolveEnumConstants(&enumConstants, &dependencies, &enumValues);
 
   vectorUninit(&enumConstants, nullDtor);
   vectorUninit(&dependencies, nullDtor);
@@ -1590,6 +1481,19 @@ void finishTopLevelStab(FileListEntry *entry) {
                     existing->character);
             entry->errored = true;
           }
+          if (existing != NULL && existing->kind == SK_VARIABLE &&
+              existing->data.variable.threadLocal !=
+                  body->data.varDefn.threadLocal) {
+            fprintf(stderr,
+                    "%s:%zu:%zu: error: redeclaration of %s with a different "
+                    "threadlocal qualifier\n",
+                    entry->inputFilename, name->line, name->character,
+                    nameString);
+            fprintf(stderr, "%s:%zu:%zu: note: previously declared here\n",
+                    existing->file->inputFilename, existing->line,
+                    existing->character);
+            entry->errored = true;
+          }
 
           name->data.id.entry->data.variable.type = typeCopy(type);
 
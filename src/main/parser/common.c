@@ -67,6 +67,10 @@ static char const *const TOKEN_NAMES[] = {
     "the keyword 'bool'",
     "the keyword 'const'",
     "the keyword 'volatile'",
+    "the keyword 'pure'",
+    "the keyword 'likely'",
+    "the keyword 'unlikely'",
+    "the keyword 'threadlocal'",
     "a semicolon",
     "a comma",
     "a left parenthesis",
@@ -494,7 +494,8 @@ static Node *parseLiteral(FileListEntry *entry, Node *unparsed,
  */
 static Node *parseAggregateInitializer(FileListEntry *entry, Node *unparsed,
                                        Environment *env, Token *start) {
-  Vector *literals = vectorCreate();
+  AggregateInitBuilder builder;
+  aggregateInitBuilderInit(&builder);
   while (true) {
     Token peek;
     next(unparsed, &peek);
@@ -523,18 +524,16 @@ static Node *parseAggregateInitializer(FileListEntry *entry, Node *unparsed,
         prev(unparsed, &peek);
         Node *literal = parseLiteral(entry, unparsed, env);
         if (literal == NULL) {
-          nodeVectorFree(literals);
+          aggregateInitBuilderUninit(&builder);
           return NULL;
         }
-        vectorInsert(literals, literal);
+        aggregateInitBuilderAdd(&builder, literal);
 
         next(unparsed, &peek);
         switch (peek.type) {
           case TT_RSQUARE: {
             // end of the init
-            Node *n = literalNodeCreate(LT_AGGREGATEINIT, start);
-            n->data.literal.data.aggregateInitVal = literals;
-            return n;
+            return aggregateInitBuilderFinish(&builder, start);
           }
           case TT_COMMA: {
             break;  // continue on
@@ -545,7 +544,7 @@ static Node *parseAggregateInitializer(FileListEntry *entry, Node *unparsed,
 
             prev(unparsed, &peek);
 
-            nodeVectorFree(literals);
+            aggregateInitBuilderUninit(&builder);
             return NULL;
           }
         }
@@ -553,16 +552,14 @@ static Node *parseAggregateInitializer(FileListEntry *entry, Node *unparsed,
       }
       case TT_RSQUARE: {
         // end of the init
-        Node *n = literalNodeCreate(LT_AGGREGATEINIT, start);
-        n->data.literal.data.aggregateInitVal = literals;
-        return n;
+        return aggregateInitBuilderFinish(&builder, start);
       }
       default: {
         errorExpectedString(entry, "a literal", &peek);
 
         prev(unparsed, &peek);
 
-        nodeVectorFree(literals);
+        aggregateInitBuilderUninit(&builder);
         return NULL;
       }
     }
@@ -2031,7 +2028,7 @@ static Node *parseCompoundStmt(FileListEntry *entry, Node *unparsed,
 }
 
 /**
- * parses an if statement
+ * parses an if statement, with an optional likely or unlikely hint
  *
  * @param entry entry containing this node
  * @param unparsed unparsed node to read from
@@ -2042,8 +2039,13 @@ static Node *parseCompoundStmt(FileListEntry *entry, Node *unparsed,
  */
 static Node *parseIfStmt(FileListEntry *entry, Node *unparsed, Environment *env,
                          Token *start) {
+  BranchHint hint = BH_NONE;
   Token lparen;
   next(unparsed, &lparen);
+  if (lparen.type == TT_LIKELY || lparen.type == TT_UNLIKELY) {
+    hint = lparen.type == TT_LIKELY ? BH_LIKELY : BH_UNLIKELY;
+    next(unparsed, &lparen);
+  }
   if (lparen.type != TT_LPAREN) {
     errorExpectedToken(entry, TT_LPAREN, &lparen);
 
@@ -2083,8 +2085,8 @@ static Node *parseIfStmt(FileListEntry *entry, Node *unparsed, Environment *env,
   next(unparsed, &elseKwd);
   if (elseKwd.type != TT_ELSE) {
     prev(unparsed, &elseKwd);
-    return ifStmtNodeCreate(start, predicate, consequent, consequentStab, NULL,
-                            NULL);
+    return ifStmtNodeCreate(start, hint, predicate, consequent, consequentStab,
+                            NULL, NULL);
   }
 
   environmentPush(env, hashMapCreate());
@@ -2098,7 +2100,7 @@ static Node *parseIfStmt(FileListEntry *entry, Node *unparsed, Environment *env,
     return NULL;
   }
 
-  return ifStmtNodeCreate(start, predicate, consequent, consequentStab,
+  return ifStmtNodeCreate(start, hint, predicate, consequent, consequentStab,
                           alternative, alternativeStab);
 }
 
@@ -19,11 +19,108 @@
 
 #include "parser/parser.h"
 
+#include <stdlib.h>
+
 #include "fileList.h"
 #include "parser/buildStab.h"
 #include "parser/functionBody.h"
 #include "parser/miscCheck.h"
 #include "parser/topLevel.h"
+#include "util/container/hashSet.h"
+#include "util/container/vector.h"
+
+/** a decl module added to the file list from a bundle */
+typedef struct {
+  Bundle const *bundle; /**< bundle the module is in */
+  size_t member;        /**< index of the module in the bundle */
+} BundledModule;
+
+/**
+ * adds and parses the decl modules from bundles that are imported, directly or
+ * indirectly, and aren't in the file list already
+ *
+ * @returns whether any of the added modules errored
+ */
+static bool parseBundledImports(void) {
+  bool errored = false;
+  size_t numListed = fileList.size;
+
+  // each member of a bundle is added at most once, so the file list is grown
+  // once, up front, and doesn't move while its entries are being visited
+  size_t maxAdded = 0;
+  for (size_t idx = 0; idx < fileList.numBundles; ++idx)
+    maxAdded += fileList.bundles[idx].numMembers;
+  BundledModule *modules = malloc(sizeof(BundledModule) * maxAdded);
+  fileList.entries = realloc(fileList.entries,
+                             sizeof(FileListEntry) * (numListed + maxAdded));
+
+  // the modules that are in the file list, or will be added to it
+  HashSet provided;
+  Vector providedNames;  // vector of char *, owning
+  hashSetInit(&provided);
+  vectorInit(&providedNames);
+  for (size_t idx = 0; idx < numListed; ++idx) {
+    if (!fileList.entries[idx].isCode) {
+      char *name = stringifyId(
+          fileList.entries[idx].ast->data.file.module->data.module.id);
+      vectorInsert(&providedNames, name);
+      hashSetPut(&provided, name);
+    }
+  }
+
+  // adding a module might import more modules, so this visits the added
+  // modules too
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    FileListEntry *entry = &fileList.entries[idx];
+    if (idx >= numListed) {
+      BundledModule *module = &modules[idx - numListed];
+      size_t length;
+      char *contents =
+          bundleMemberContents(module->bundle, module->member, &length);
+      lexerStateInitBundled(entry, contents, length);
+      entry->ast = parseFile(entry);
+      lexerStateUninit(entry);
+      if (entry->errored) {
+        errored = true;
+        continue;
+      }
+    }
+
+    Vector *imports = entry->ast->data.file.imports;
+    for (size_t importIdx = 0; importIdx < imports->size; ++importIdx) {
+      Node *import = imports->elements[importIdx];
+      char *name = stringifyId(import->data.import.id);
+      if (hashSetContains(&provided, name)) {
+        free(name);
+        continue;
+      }
+
+      // the first bundle given that has the module provides it - if none do,
+      // resolveImports reports the missing module
+      for (size_t bundleIdx = 0; bundleIdx < fileList.numBundles;
+           ++bundleIdx) {
+        Bundle const *bundle = &fileList.bundles[bundleIdx];
+        size_t member = bundleFind(bundle, name);
+        if (member != bundle->numMembers) {
+          size_t numAdded = fileList.size - numListed;
+          modules[numAdded].bundle = bundle;
+          modules[numAdded].member = member;
+          fileListEntryInit(&fileList.entries[fileList.size],
+                            bundleMemberPath(bundle, member), false);
+          ++fileList.size;
+          break;
+        }
+      }
+      vectorInsert(&providedNames, name);
+      hashSetPut(&provided, name);
+    }
+  }
+
+  hashSetUninit(&provided);
+  vectorUninit(&providedNames, free);
+  free(modules);
+  return errored;
+}
 
 int parse(void) {
   // IMPLEMENTATION NOTES
@@ -32,7 +129,8 @@ int parse(void) {
   // parse and symbol table builder are merged together.
   //
   // Pass one parses everything but function bodies - so the AST exists, but may
-  // contain unparsed nodes.
+  // contain unparsed nodes. Decl modules in bundles are parsed in this pass
+  // only if something imports them.
   //
   // Pass two resolves imports, by first making sure each decl file uniquely
   // names an import, then linking each import with it's referenced
@@ -93,6 +191,7 @@ int parse(void) {
 
     lexerStateUninit(&fileList.entries[idx]);
   }
+  if (!errored && fileList.numBundles != 0) errored = parseBundledImports();
   lexerUninitMaps();
   if (errored) return -1;
 
@@ -65,6 +65,7 @@ static void panicTopLevel(FileListEntry *entry) {
       case TT_UNION:
       case TT_ENUM:
       case TT_TYPEDEF:
+      case TT_THREADLOCAL:
       case TT_EOF: {
         unLex(entry, &token);
         return;
@@ -364,7 +365,8 @@ static Node *parseLiteral(FileListEntry *entry);
  * @returns AST node or NULL if fatal error happened
  */
 static Node *parseAggregateInitializer(FileListEntry *entry, Token *start) {
-  Vector *literals = vectorCreate();
+  AggregateInitBuilder builder;
+  aggregateInitBuilderInit(&builder);
   while (true) {
     Token peek;
     lex(entry, &peek);
@@ -393,17 +395,35 @@ static Node *parseAggregateInitializer(FileListEntry *entry, Token *start) {
         unLex(entry, &peek);
         Node *literal = parseLiteral(entry);
         if (literal == NULL) {
-          nodeVectorFree(literals);
+          aggregateInitBuilderUninit(&builder);
           return NULL;
         }
-        vectorInsert(literals, literal);
+        aggregateInitBuilderAdd(&builder, literal);
+
+        lex(entry, &peek);
+        switch (peek.type) {
+          case TT_RSQUARE: {
+            // end of the init
+            return aggregateInitBuilderFinish(&builder, start);
+          }
+          case TT_COMMA: {
+            break;  // continue on
+          }
+          default: {
+            errorExpectedString(entry, "a comma or a right square bracket",
+                                &peek);
+
+            unLex(entry, &peek);
+
+            aggregateInitBuilderUninit(&builder);
+            return NULL;
+          }
+        }
         break;
       }
       case TT_RSQUARE: {
         // end of the init
-        Node *n = literalNodeCreate(LT_AGGREGATEINIT, start);
-        n->data.literal.data.aggregateInitVal = literals;
-        return n;
+        return aggregateInitBuilderFinish(&builder, start);
       }
       default: {
         errorExpectedString(entry, "a right square bracket or a literal",
@@ -411,7 +431,7 @@ static Node *parseAggregateInitializer(FileListEntry *entry, Token *start) {
 
         unLex(entry, &peek);
 
-        nodeVectorFree(literals);
+        aggregateInitBuilderUninit(&builder);
         return NULL;
       }
     }
@@ -640,7 +660,7 @@ static Node *parseType(FileListEntry *entry) {
             case TT_DOUBLE:
             case TT_BOOL:
             case TT_ID: {
-              unLex(entry, &start);
+              unLex(entry, &next2);
               Node *argType = parseType(entry);
               if (argType == NULL) {
                 nodeVectorFree(argTypes);
@@ -677,6 +697,7 @@ static Node *parseType(FileListEntry *entry) {
                   unLex(entry, &next3);
 
                   nodeVectorFree(argTypes);
+                  nodeVectorFree(argNames);
                   nodeFree(type);
                   return NULL;
                 }
@@ -689,6 +710,7 @@ static Node *parseType(FileListEntry *entry) {
               unLex(entry, &next2);
 
               nodeVectorFree(argTypes);
+              nodeVectorFree(argNames);
               nodeFree(type);
               return NULL;
             }
@@ -1036,8 +1058,17 @@ static Node *finishFunDecl(FileListEntry *entry, Node *returnType, Node *name) {
     }
   }
 
+  // declared effects - pure implies const
+  FunctionEffect effect = FE_UNKNOWN;
   Token semicolon;
   lex(entry, &semicolon);
+  while (semicolon.type == TT_PURE || semicolon.type == TT_CONST) {
+    if (semicolon.type == TT_PURE)
+      effect = FE_PURE;
+    else if (effect == FE_UNKNOWN)
+      effect = FE_READONLY;
+    lex(entry, &semicolon);
+  }
   if (semicolon.type != TT_SEMI) {
     errorExpectedToken(entry, TT_SEMI, &semicolon);
 
@@ -1051,7 +1082,7 @@ static Node *finishFunDecl(FileListEntry *entry, Node *returnType, Node *name) {
     return NULL;
   }
 
-  return funDeclNodeCreate(returnType, name, argTypes, argNames);
+  return funDeclNodeCreate(returnType, name, argTypes, argNames, effect);
 }
 
 /**
@@ -1218,6 +1249,7 @@ static Node *finishVarDefn(FileListEntry *entry, Node *type, Vector *names,
       }
       case TT_SEMI: {
         // done
+        vectorInsert(initializers, NULL);
         return varDefnNodeCreate(type, names, initializers);
       }
       default: {
@@ -1282,6 +1314,15 @@ static Node *parseFuncBody(FileListEntry *entry, Token *start) {
     }
     vectorInsert(tokens, token);
   }
+
+  // end with an EOF, so error recovery can't run off the end of the body
+  Token const *rbrace = tokens->elements[tokens->size - 1];
+  Token *eof = malloc(sizeof(Token));
+  eof->type = TT_EOF;
+  eof->line = rbrace->line;
+  eof->character = rbrace->character;
+  eof->string = NULL;
+  vectorInsert(tokens, eof);
   return unparsedNodeCreate(tokens);
 }
 
@@ -1506,6 +1547,40 @@ static Node *parseFunOrVarDefn(FileListEntry *entry, Token *start) {
   }
 }
 
+/**
+ * parses a threadlocal variable declaration or definition
+ *
+ * @param entry entry to lex from
+ * @param keyword threadlocal keyword
+ * @returns declaration, definition, or null if fatal error
+ */
+static Node *parseThreadLocal(FileListEntry *entry, Token *keyword) {
+  Token start;
+  lex(entry, &start);
+  Node *decl = entry->isCode ? parseFunOrVarDefn(entry, &start)
+                             : parseFunOrVarDecl(entry, &start);
+  if (decl == NULL) return NULL;
+
+  switch (decl->type) {
+    case NT_VARDEFN: {
+      decl->data.varDefn.threadLocal = true;
+      return decl;
+    }
+    case NT_VARDECL: {
+      decl->data.varDecl.threadLocal = true;
+      return decl;
+    }
+    default: {
+      fprintf(stderr, "%s:%zu:%zu: error: only variables may be threadlocal\n",
+              entry->inputFilename, keyword->line, keyword->character);
+      entry->errored = true;
+
+      nodeFree(decl);
+      return NULL;
+    }
+  }
+}
+
 /**
  * parses an opaque declaration
  *
@@ -1957,6 +2032,11 @@ static Vector *parseBodies(FileListEntry *entry) {
         if (decl != NULL) vectorInsert(bodies, decl);
         break;
       }
+      case TT_THREADLOCAL: {
+        Node *decl = parseThreadLocal(entry, &start);
+        if (decl != NULL) vectorInsert(bodies, decl);
+        break;
+      }
       case TT_OPAQUE: {
         Node *decl = parseOpaqueDecl(entry, &start);
         if (decl != NULL) vectorInsert(bodies, decl);
@@ -1989,6 +2069,7 @@ static Vector *parseBodies(FileListEntry *entry) {
       default: {
         // unexpected token
         errorExpectedString(entry, "a declaration", &start);
+        tokenUninit(&start);
         panicTopLevel(entry);
         continue;
       }
@@ -75,8 +75,8 @@ int hashSetPut(HashSet *set, char const *s) {
     size_t oldSize = set->capacity;  // unavoidable collision
     char const **oldElements = set->elements;
     set->capacity *= 2;
-    set->elements = calloc(set->capacity, sizeof(char const *));
-    set->elements = malloc(set->capacity * sizeof(void *));  // resize the set
+    set->elements =
+        calloc(set->capacity, sizeof(char const *));  // resize the set
     set->size = 0;
     for (size_t idx = 0; idx < oldSize; ++idx) {
       if (oldElements[idx] != NULL) hashSetPut(set, oldElements[idx]);
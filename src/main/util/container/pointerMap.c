@@ -0,0 +1,87 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Implementation of a map from pointers to pointers
+
+#include "util/container/pointerMap.h"
+
+#include <stdlib.h>
+
+#include "optimization.h"
+#include "util/hash.h"
+
+void pointerMapInit(PointerMap *map) {
+  map->size = 0;
+  map->capacity = PTR_VECTOR_INIT_CAPACITY;
+  map->keys = calloc(map->capacity, sizeof(void const *));
+  map->values = malloc(map->capacity * sizeof(void *));
+}
+
+/**
+ * finds the slot a key is in, or the empty slot it would go in
+ *
+ * the capacity is always a power of two, so the table is probed linearly
+ * with a mask
+ */
+static size_t pointerMapSlot(PointerMap const *map, void const *key) {
+  size_t mask = map->capacity - 1;
+  size_t idx = ptrHash(key) & mask;
+  while (map->keys[idx] != NULL && map->keys[idx] != key)
+    idx = (idx + 1) & mask;
+  return idx;
+}
+
+void *pointerMapGet(PointerMap const *map, void const *key) {
+  size_t idx = pointerMapSlot(map, key);
+  return map->keys[idx] != NULL ? map->values[idx] : NULL;
+}
+
+int pointerMapPut(PointerMap *map, void const *key, void *value) {
+  if (map->keys[pointerMapSlot(map, key)] != NULL) return -1;
+
+  if ((map->size + 1) * 2 > map->capacity) {
+    // keep the table at most half full, so probe sequences stay short
+    size_t oldCapacity = map->capacity;
+    void const **oldKeys = map->keys;
+    void **oldValues = map->values;
+    map->capacity *= 2;
+    map->keys = calloc(map->capacity, sizeof(void const *));
+    map->values = malloc(map->capacity * sizeof(void *));
+    for (size_t idx = 0; idx < oldCapacity; ++idx) {
+      if (oldKeys[idx] != NULL) {
+        size_t slot = pointerMapSlot(map, oldKeys[idx]);
+        map->keys[slot] = oldKeys[idx];
+        map->values[slot] = oldValues[idx];
+      }
+    }
+    free(oldKeys);
+    free(oldValues);
+  }
+
+  size_t slot = pointerMapSlot(map, key);
+  map->keys[slot] = key;
+  map->values[slot] = value;
+  ++map->size;
+  return 0;
+}
+
+void pointerMapUninit(PointerMap *map) {
+  free(map->keys);
+  free(map->values);
+}
\ No newline at end of file
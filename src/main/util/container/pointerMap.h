@@ -0,0 +1,76 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * A map from pointers to pointers
+ */
+
+#ifndef TLC_UTIL_CONTAINER_POINTERMAP_H_
+#define TLC_UTIL_CONTAINER_POINTERMAP_H_
+
+#include <stddef.h>
+
+/**
+ * A map from non-null pointers, with neither keys nor values owned by this
+ *
+ * keys and values are tables with capacity slots - empty slots have a NULL
+ * key
+ */
+typedef struct {
+  size_t size;
+  size_t capacity;
+  void const **keys;
+  void **values;
+} PointerMap;
+
+/**
+ * initialize map in-place
+ *
+ * @param map map to initialize
+ */
+void pointerMapInit(PointerMap *map);
+
+/**
+ * Returns the value, or NULL if the key is not in the map. Constant time
+ * operation
+ *
+ * @param map map to search in
+ * @param key key to search for
+ */
+void *pointerMapGet(PointerMap const *map, void const *key);
+
+/**
+ * Tries to insert a key into the map. Amortized constant time operation
+ *
+ * @param map map to insert into
+ * @param key non-null key to insert
+ * @param value value to insert
+ * @returns 0 if insertion is successful, -1 if the key exists
+ */
+int pointerMapPut(PointerMap *map, void const *key, void *value);
+
+/**
+ * deinitialize map in-place
+ *
+ * @param map map to deinitialize
+ */
+void pointerMapUninit(PointerMap *map);
+
+#endif  // TLC_UTIL_CONTAINER_POINTERMAP_H_
\ No newline at end of file
@@ -0,0 +1,75 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Implementation of a set of pointers
+
+#include "util/container/pointerSet.h"
+
+#include <stdlib.h>
+
+#include "optimization.h"
+#include "util/hash.h"
+
+void pointerSetInit(PointerSet *set) {
+  set->size = 0;
+  set->capacity = PTR_VECTOR_INIT_CAPACITY;
+  set->elements = calloc(set->capacity, sizeof(void *));
+}
+
+/**
+ * finds the slot a pointer is in, or the empty slot it would go in
+ *
+ * the capacity is always a power of two, so the table is probed linearly
+ * with a mask
+ */
+static size_t pointerSetSlot(PointerSet const *set, void const *p) {
+  size_t mask = set->capacity - 1;
+  size_t idx = ptrHash(p) & mask;
+  while (set->elements[idx] != NULL && set->elements[idx] != p)
+    idx = (idx + 1) & mask;
+  return idx;
+}
+
+bool pointerSetContains(PointerSet const *set, void const *p) {
+  return set->elements[pointerSetSlot(set, p)] != NULL;
+}
+
+int pointerSetPut(PointerSet *set, void *p) {
+  if (pointerSetContains(set, p)) return -1;
+
+  if ((set->size + 1) * 2 > set->capacity) {
+    // keep the table at most half full, so probe sequences stay short
+    size_t oldCapacity = set->capacity;
+    void **oldElements = set->elements;
+    set->capacity *= 2;
+    set->elements = calloc(set->capacity, sizeof(void *));
+    for (size_t idx = 0; idx < oldCapacity; ++idx) {
+      if (oldElements[idx] != NULL)
+        set->elements[pointerSetSlot(set, oldElements[idx])] =
+            oldElements[idx];
+    }
+    free(oldElements);
+  }
+
+  set->elements[pointerSetSlot(set, p)] = p;
+  ++set->size;
+  return 0;
+}
+
+void pointerSetUninit(PointerSet *set) { free(set->elements); }
\ No newline at end of file
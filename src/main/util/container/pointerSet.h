@@ -0,0 +1,73 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * A set of pointers
+ */
+
+#ifndef TLC_UTIL_CONTAINER_POINTERSET_H_
+#define TLC_UTIL_CONTAINER_POINTERSET_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A set of non-null pointers, not owned by this
+ *
+ * elements is a table with capacity slots, some of which are NULL
+ */
+typedef struct {
+  size_t size;
+  size_t capacity;
+  void **elements;
+} PointerSet;
+
+/**
+ * initialize set in-place
+ *
+ * @param set set to initialize
+ */
+void pointerSetInit(PointerSet *set);
+
+/**
+ * Returns whether the set contains the pointer. Constant time operation
+ *
+ * @param set set to search in
+ * @param p pointer to search for
+ */
+bool pointerSetContains(PointerSet const *set, void const *p);
+
+/**
+ * Tries to insert a pointer into the set. Amortized constant time operation
+ *
+ * @param set set to insert into
+ * @param p non-null pointer to insert
+ * @returns 0 if insertion is successful, -1 if the pointer exists
+ */
+int pointerSetPut(PointerSet *set, void *p);
+
+/**
+ * deinitialize set in-place
+ *
+ * @param set set to deinitialize
+ */
+void pointerSetUninit(PointerSet *set);
+
+#endif  // TLC_UTIL_CONTAINER_POINTERSET_H_
\ No newline at end of file
@@ -43,6 +43,12 @@ void vectorInsert(Vector *vector, void *element) {
   }
   vector->elements[vector->size++] = element;
 }
+bool vectorContains(Vector const *vector, void const *element) {
+  for (size_t idx = 0; idx < vector->size; ++idx) {
+    if (vector->elements[idx] == element) return true;
+  }
+  return false;
+}
 void vectorUninit(Vector *vector, void (*dtor)(void *)) {
   for (size_t idx = 0; idx < vector->size; ++idx) dtor(vector->elements[idx]);
   free(vector->elements);
@@ -55,6 +55,14 @@ Vector *vectorCreate(void);
  * @param elm element to add
  */
 void vectorInsert(Vector *v, void *elm);
+/**
+ * search for an element - linear time, so only for short vectors
+ *
+ * @param v Vector to search
+ * @param elm element to look for
+ * @returns whether any element is elm
+ */
+bool vectorContains(Vector const *v, void const *elm);
 /**
  * in place dtor
  *
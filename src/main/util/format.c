@@ -29,19 +29,25 @@
 #include "internalError.h"
 
 char *format(char const *format, ...) {
-  va_list args1, args2;
-  va_start(args1, format);
-  va_copy(args2, args1);
+  va_list args;
+  va_start(args, format);
+  char *buffer = vformat(format, args);
+  va_end(args);
+  return buffer;
+}
+
+char *vformat(char const *format, va_list args) {
+  va_list args2;
+  va_copy(args2, args);
 
-  int retval = vsnprintf(NULL, 0, format, args1);
+  int retval = vsnprintf(NULL, 0, format, args);
   if (retval < 0) error(__FILE__, __LINE__, "could not format string");
 
   size_t bufferSize = 1 + (size_t)retval;
-  va_end(args1);
 
   char *buffer = malloc(bufferSize);
   vsnprintf(buffer, bufferSize, format, args2);
   va_end(args2);
 
   return buffer;
-}
\ No newline at end of file
+}
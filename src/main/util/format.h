@@ -25,6 +25,7 @@
 #ifndef TLC_UTIL_FORMAT_H_
 #define TLC_UTIL_FORMAT_H_
 
+#include <stdarg.h>
 #include <stdio.h>
 
 /**
@@ -34,4 +35,14 @@
  */
 char *format(char const *format, ...) __attribute__((format(printf, 1, 2)));
 
+/**
+ * create a string (caller owns the memory) from a printf format string and a
+ * list of arguments
+ *
+ * @param format printf format string
+ * @param args arguments to format, consumed by this call
+ */
+char *vformat(char const *format, va_list args)
+    __attribute__((format(printf, 1, 0)));
+
 #endif  // TLC_UTIL_FORMAT_H_
\ No newline at end of file
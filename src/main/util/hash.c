@@ -35,4 +35,10 @@ uint64_t djb2add(char const *s) {
     hash += (uint64_t)*s;
   }
   return hash;
+}
+
+uint64_t ptrHash(void const *p) {
+  // Fibonacci hashing - alignment leaves the low bits of a pointer zero
+  uint64_t hash = (uint64_t)(uintptr_t)p * 0x9e3779b97f4a7c15;
+  return hash ^ (hash >> 32);
 }
\ No newline at end of file
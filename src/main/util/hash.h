@@ -19,7 +19,7 @@
 
 /**
  * @file
- * string hash functions
+ * string and pointer hash functions
  */
 
 #ifndef TLC_UTIL_HASH_H_
@@ -43,4 +43,13 @@ uint64_t djb2xor(char const *s);
  */
 uint64_t djb2add(char const *s);
 
+/**
+ * hash a pointer
+ *
+ * @param p pointer
+ * @returns hash of the pointer's value, with every bit of it mixed into the
+ * low bits
+ */
+uint64_t ptrHash(void const *p);
+
 #endif  // TLC_UTIL_HASH_H_
\ No newline at end of file
@@ -0,0 +1,79 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Implementation of compile time reporting
+
+#include "util/timeReport.h"
+
+#include <stdlib.h>
+
+void timeReportInit(TimeReport *report) { vectorInit(&report->entries); }
+
+/**
+ * adds an entry to a report
+ */
+static TimeReportEntry *timeReportAdd(TimeReport *report, char const *name,
+                                      clock_t start, clock_t end) {
+  TimeReportEntry *entry = malloc(sizeof(TimeReportEntry));
+  entry->name = name;
+  entry->seconds = (double)(end - start) / CLOCKS_PER_SEC;
+  entry->hasSizes = false;
+  entry->sizeBefore = 0;
+  entry->sizeAfter = 0;
+  vectorInsert(&report->entries, entry);
+  return entry;
+}
+
+void timeReportAddPhase(TimeReport *report, char const *name, clock_t start,
+                        clock_t end) {
+  timeReportAdd(report, name, start, end);
+}
+
+void timeReportAddPass(TimeReport *report, char const *name, clock_t start,
+                       clock_t end, size_t sizeBefore, size_t sizeAfter) {
+  TimeReportEntry *entry = timeReportAdd(report, name, start, end);
+  entry->hasSizes = true;
+  entry->sizeBefore = sizeBefore;
+  entry->sizeAfter = sizeAfter;
+}
+
+void timeReportPrint(FILE *where, TimeReport const *report) {
+  double total = 0;
+  for (size_t idx = 0; idx < report->entries.size; ++idx) {
+    TimeReportEntry const *entry = report->entries.elements[idx];
+    total += entry->seconds;
+  }
+
+  fprintf(where, "%-24s %10s %6s %12s\n", "phase", "time (s)", "%", "nodes");
+  for (size_t idx = 0; idx < report->entries.size; ++idx) {
+    TimeReportEntry const *entry = report->entries.elements[idx];
+    fprintf(where, "%-24s %10.6f %6.1f", entry->name, entry->seconds,
+            total > 0 ? entry->seconds / total * 100 : 0);
+    if (entry->hasSizes) {
+      fprintf(where, " %+12lld",
+              (long long)entry->sizeAfter - (long long)entry->sizeBefore);
+    }
+    fprintf(where, "\n");
+  }
+  fprintf(where, "%-24s %10.6f\n", "total", total);
+}
+
+void timeReportUninit(TimeReport *report) {
+  vectorUninit(&report->entries, free);
+}
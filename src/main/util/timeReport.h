@@ -0,0 +1,95 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * Compile time reporting
+ */
+
+#ifndef TLC_UTIL_TIMEREPORT_H_
+#define TLC_UTIL_TIMEREPORT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "util/container/vector.h"
+
+/** the time taken by one phase or pass */
+typedef struct {
+  char const *name;  /**< non-owning name of the phase or pass */
+  double seconds;    /**< processor time taken */
+  bool hasSizes;     /**< were the AST sizes measured */
+  size_t sizeBefore; /**< AST nodes before the pass */
+  size_t sizeAfter;  /**< AST nodes after the pass */
+} TimeReportEntry;
+
+/** the times taken by each phase and pass, in the order they ran */
+typedef struct {
+  Vector entries; /**< vector of TimeReportEntry */
+} TimeReport;
+
+/**
+ * initializes an empty report
+ *
+ * @param report report to initialize
+ */
+void timeReportInit(TimeReport *report);
+
+/**
+ * records the time taken by a phase
+ *
+ * @param report report to add to
+ * @param name name of the phase, must outlive the report
+ * @param start processor time at the start of the phase
+ * @param end processor time at the end of the phase
+ */
+void timeReportAddPhase(TimeReport *report, char const *name, clock_t start,
+                        clock_t end);
+
+/**
+ * records the time taken by a pass, and how it changed the size of the AST
+ *
+ * @param report report to add to
+ * @param name name of the pass, must outlive the report
+ * @param start processor time at the start of the pass
+ * @param end processor time at the end of the pass
+ * @param sizeBefore AST nodes before the pass
+ * @param sizeAfter AST nodes after the pass
+ */
+void timeReportAddPass(TimeReport *report, char const *name, clock_t start,
+                       clock_t end, size_t sizeBefore, size_t sizeAfter);
+
+/**
+ * prints a report as a table
+ *
+ * @param where file to print to
+ * @param report report to print
+ */
+void timeReportPrint(FILE *where, TimeReport const *report);
+
+/**
+ * uninitializes a report
+ *
+ * @param report report to uninitialize
+ */
+void timeReportUninit(TimeReport *report);
+
+#endif  // TLC_UTIL_TIMEREPORT_H_
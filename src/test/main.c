@@ -34,12 +34,19 @@ int main(int argc, char *argv[]) {
 
   if (argc < 2 || strcmp(argv[1], "bigInteger") == 0) testBigInteger();
   if (argc < 2 || strcmp(argv[1], "conversions") == 0) testConversions();
+  if (argc < 2 || strcmp(argv[1], "container") == 0) testContainer();
 
   if (argc < 2 || strcmp(argv[1], "commandLineArgs") == 0)
     testCommandLineArgs();
   if (argc < 2 || strcmp(argv[1], "lexer") == 0) testLexer();
   if (argc < 2 || strcmp(argv[1], "parser") == 0) testParser();
   if (argc < 2 || strcmp(argv[1], "typechecker") == 0) testTypechecker();
+  if (argc < 2 || strcmp(argv[1], "optimization") == 0) testOptimization();
+  if (argc < 2 || strcmp(argv[1], "interpreter") == 0) testInterpreter();
+  if (argc < 2 || strcmp(argv[1], "fuzz") == 0) testFuzz();
+
+  // timing depends on the machine, so it's only checked when asked for
+  if (argc == 2 && strcmp(argv[1], "perf") == 0) testPerf();
 
   return testStatusStatus();
 }
\ No newline at end of file
@@ -29,6 +29,8 @@
 void testBigInteger(void);
 /** tests numeric conversions */
 void testConversions(void);
+/** tests containers */
+void testContainer(void);
 /** tests command line argument parsing */
 void testCommandLineArgs(void);
 /** tests lexing */
@@ -37,5 +39,13 @@ void testLexer(void);
 void testParser(void);
 /** tests the typechecker */
 void testTypechecker(void);
+/** tests source-level optimizations */
+void testOptimization(void);
+/** tests the interpreter */
+void testInterpreter(void);
+/** tests front end scaling on generated programs, with timing advisory */
+void testFuzz(void);
+/** tests front end scaling on generated programs, with timing enforced */
+void testPerf(void);
 
 #endif  // TLC_TEST_TESTS_H_
\ No newline at end of file
@@ -106,44 +106,44 @@ static void testOptions(void) {
   // test("arch=x86_64-linux option is correctly set",
   //      options.arch == OPTION_A_X86_64_LINUX);
 
-  // // -fPDC
-  // argc = 3;
-  // char const *const argv2[] = {
-  //     "./tlc",
-  //     "-fPDC",
-  //     "foo.tc",
-  // };
-  // retval = parseArgs(argc, argv2, &numFiles);
+  // -fPDC
+  argc = 3;
+  char const *const argv2[] = {
+      "./tlc",
+      "-fPDC",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv2, &numFiles);
 
-  // test("command line with PDC passes", retval == 0);
-  // test("PDC option is correctly set",
-  //      options.positionDependence == OPTION_PD_PDC);
+  test("command line with PDC passes", retval == 0);
+  test("PDC option is correctly set",
+       options.positionDependence == OPTION_PD_PDC);
 
-  // // -fPIE
-  // argc = 3;
-  // char const *const argv3[] = {
-  //     "./tlc",
-  //     "-fPIE",
-  //     "foo.tc",
-  // };
-  // retval = parseArgs(argc, argv3, &numFiles);
+  // -fPIE
+  argc = 3;
+  char const *const argv3[] = {
+      "./tlc",
+      "-fPIE",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv3, &numFiles);
 
-  // test("command line with PIE passes", retval == 0);
-  // test("PIE option is correctly set",
-  //      options.positionDependence == OPTION_PD_PIE);
+  test("command line with PIE passes", retval == 0);
+  test("PIE option is correctly set",
+       options.positionDependence == OPTION_PD_PIE);
 
-  // // -fPIC
-  // argc = 3;
-  // char const *const argv4[] = {
-  //     "./tlc",
-  //     "-fPIC",
-  //     "foo.tc",
-  // };
-  // retval = parseArgs(argc, argv4, &numFiles);
+  // -fPIC
+  argc = 3;
+  char const *const argv4[] = {
+      "./tlc",
+      "-fPIC",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv4, &numFiles);
 
-  // test("command line with PIC passes", retval == 0);
-  // test("PIE option is correctly set",
-  //      options.positionDependence == OPTION_PD_PIC);
+  test("command line with PIC passes", retval == 0);
+  test("PIC option is correctly set",
+       options.positionDependence == OPTION_PD_PIC);
 
   // -Wduplicate-file=error
   argc = 3;
@@ -258,6 +258,304 @@ static void testOptions(void) {
 
   test("command line with debug-dump=parse passes", retval == 0);
   test("debug-dump option is correctly set", options.dump == OPTION_DD_PARSE);
+
+  // -fno-omit-frame-pointer
+  argc = 3;
+  char const *const argv14[] = {
+      "./tlc",
+      "-fno-omit-frame-pointer",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv14, &numFiles);
+
+  test("command line with no-omit-frame-pointer passes", retval == 0);
+  test("frame pointer option is correctly set",
+       options.framePointer == OPTION_FP_KEEP);
+
+  // -fomit-frame-pointer
+  argc = 3;
+  char const *const argv15[] = {
+      "./tlc",
+      "-fomit-frame-pointer",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv15, &numFiles);
+
+  test("command line with omit-frame-pointer passes", retval == 0);
+  test("frame pointer option is correctly set",
+       options.framePointer == OPTION_FP_OMIT);
+
+  // -mtune=skylake
+  argc = 3;
+  char const *const argv16[] = {
+      "./tlc",
+      "-mtune=skylake",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv16, &numFiles);
+
+  test("command line with tune=skylake passes", retval == 0);
+  test("tune option is correctly set", options.tune == OPTION_MT_SKYLAKE);
+
+  // -mtune=generic
+  argc = 3;
+  char const *const argv17[] = {
+      "./tlc",
+      "-mtune=generic",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv17, &numFiles);
+
+  test("command line with tune=generic passes", retval == 0);
+  test("tune option is correctly set", options.tune == OPTION_MT_GENERIC);
+
+  // -ffast-math
+  argc = 3;
+  char const *const argv18[] = {
+      "./tlc",
+      "-ffast-math",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv18, &numFiles);
+
+  test("command line with fast-math passes", retval == 0);
+  test("fast-math options are correctly set",
+       options.associativeMath == OPTION_AM_REASSOCIATE &&
+           options.signedZeros == OPTION_SZ_IGNORE &&
+           options.reciprocalMath == OPTION_RM_APPROXIMATE &&
+           options.fpContract == OPTION_FPC_FAST);
+
+  // -fno-signed-zeros after -fno-fast-math
+  argc = 4;
+  char const *const argv19[] = {
+      "./tlc",
+      "-fno-fast-math",
+      "-fno-signed-zeros",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv19, &numFiles);
+
+  test("command line with no-fast-math and no-signed-zeros passes",
+       retval == 0);
+  test("floating point options are correctly set",
+       options.associativeMath == OPTION_AM_STRICT &&
+           options.signedZeros == OPTION_SZ_IGNORE &&
+           options.reciprocalMath == OPTION_RM_STRICT &&
+           options.fpContract == OPTION_FPC_OFF);
+
+  // individual floating point options
+  argc = 6;
+  char const *const argv20[] = {
+      "./tlc",
+      "-fassociative-math",
+      "-freciprocal-math",
+      "-ffp-contract=fast",
+      "-fsigned-zeros",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv20, &numFiles);
+
+  test("command line with individual floating point options passes",
+       retval == 0);
+  test("floating point options are correctly set",
+       options.associativeMath == OPTION_AM_REASSOCIATE &&
+           options.signedZeros == OPTION_SZ_HONOR &&
+           options.reciprocalMath == OPTION_RM_APPROXIMATE &&
+           options.fpContract == OPTION_FPC_FAST);
+
+  // negated individual floating point options
+  argc = 5;
+  char const *const argv21[] = {
+      "./tlc",
+      "-fno-associative-math",
+      "-fno-reciprocal-math",
+      "-ffp-contract=off",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv21, &numFiles);
+
+  test("command line with negated floating point options passes",
+       retval == 0);
+  test("floating point options are correctly set",
+       options.associativeMath == OPTION_AM_STRICT &&
+           options.reciprocalMath == OPTION_RM_STRICT &&
+           options.fpContract == OPTION_FPC_OFF);
+
+  // -ffunction-sections -fdata-sections
+  argc = 4;
+  char const *const argv22[] = {
+      "./tlc",
+      "-ffunction-sections",
+      "-fdata-sections",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv22, &numFiles);
+
+  test("command line with function-sections and data-sections passes",
+       retval == 0);
+  test("section options are correctly set",
+       options.functionSections == OPTION_FS_SEPARATE &&
+           options.dataSections == OPTION_DS_SEPARATE);
+
+  // -fno-function-sections -fno-data-sections
+  argc = 4;
+  char const *const argv23[] = {
+      "./tlc",
+      "-fno-function-sections",
+      "-fno-data-sections",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv23, &numFiles);
+
+  test("command line with no-function-sections and no-data-sections passes",
+       retval == 0);
+  test("section options are correctly set",
+       options.functionSections == OPTION_FS_COMBINED &&
+           options.dataSections == OPTION_DS_COMBINED);
+
+  // -Os
+  argc = 3;
+  char const *const argv24[] = {
+      "./tlc",
+      "-Os",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv24, &numFiles);
+
+  test("command line with Os passes", retval == 0);
+  test("optimization level is correctly set",
+       options.optimizationLevel == OPTION_O_S);
+
+  // -Oz
+  argc = 3;
+  char const *const argv25[] = {
+      "./tlc",
+      "-Oz",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv25, &numFiles);
+
+  test("command line with Oz passes", retval == 0);
+  test("optimization level is correctly set",
+       options.optimizationLevel == OPTION_O_Z);
+
+  // -O2
+  argc = 3;
+  char const *const argv26[] = {
+      "./tlc",
+      "-O2",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv26, &numFiles);
+
+  test("command line with O2 passes", retval == 0);
+  test("optimization level is correctly set",
+       options.optimizationLevel == OPTION_O_2);
+
+  // -O0
+  argc = 3;
+  char const *const argv27[] = {
+      "./tlc",
+      "-O0",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv27, &numFiles);
+
+  test("command line with O0 passes", retval == 0);
+  test("optimization level is correctly set",
+       options.optimizationLevel == OPTION_O_0);
+
+  // -fenum-width
+  argc = 3;
+  char const *const argv28[] = {
+      "./tlc",
+      "-fenum-width=16",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv28, &numFiles);
+
+  test("command line with fenum-width=16 passes", retval == 0);
+  test("enum width is correctly set", options.enumWidth == OPTION_EW_16);
+
+  // -fenum-width=narrowest
+  argc = 3;
+  char const *const argv29[] = {
+      "./tlc",
+      "-fenum-width=narrowest",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv29, &numFiles);
+
+  test("command line with fenum-width=narrowest passes", retval == 0);
+  test("enum width is correctly set", options.enumWidth == OPTION_EW_NARROWEST);
+
+  // pass manager options
+  argc = 7;
+  char const *const argv30[] = {
+      "./tlc",
+      "-fpass-pipeline=fold-comparisons",
+      "-fdisable-pass=fold-float-identities",
+      "-print-before=all",
+      "-print-after=fold-comparisons",
+      "--time-report",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv30, &numFiles);
+
+  test("command line with pass manager options passes", retval == 0);
+  test("pass pipeline is correctly set",
+       strcmp(options.passPipeline, "fold-comparisons") == 0);
+  test("disabled passes are correctly set",
+       strcmp(options.disabledPasses, "fold-float-identities") == 0);
+  test("print before is correctly set",
+       strcmp(options.printBefore, "all") == 0);
+  test("print after is correctly set",
+       strcmp(options.printAfter, "fold-comparisons") == 0);
+  test("time report is correctly set", options.timeReport == OPTION_TR_REPORT);
+
+  // the values point into argv30, which is about to go out of scope
+  options.passPipeline = NULL;
+  options.disabledPasses = NULL;
+  options.printBefore = NULL;
+  options.printAfter = NULL;
+  options.timeReport = OPTION_TR_NONE;
+
+  // optimization remarks
+  argc = 5;
+  char const *const argv31[] = {
+      "./tlc",
+      "-Rpass=fold-.*",
+      "-Rpass-missed=fold-comparisons",
+      "-fsave-optimization-record=json",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv31, &numFiles);
+
+  test("command line with remark options passes", retval == 0);
+  test("passed remarks are correctly set",
+       strcmp(options.remarksPassed, "fold-.*") == 0);
+  test("missed remarks are correctly set",
+       strcmp(options.remarksMissed, "fold-comparisons") == 0);
+  test("optimization record is correctly set",
+       options.optimizationRecord == OPTION_OR_JSON);
+
+  // the values point into argv31, which is about to go out of scope
+  options.remarksPassed = NULL;
+  options.remarksMissed = NULL;
+  options.optimizationRecord = OPTION_OR_NONE;
+
+  // --run
+  argc = 3;
+  char const *const argv32[] = {
+      "./tlc",
+      "--run",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv32, &numFiles);
+
+  test("command line with --run passes", retval == 0);
+  test("run is correctly set", options.run == OPTION_RUN_INTERPRET);
+  options.run = OPTION_RUN_NONE;
 }
 
 void testCommandLineArgs(void) {
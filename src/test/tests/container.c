@@ -0,0 +1,158 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * tests for containers
+ */
+
+#include <stdlib.h>
+
+#include "engine.h"
+#include "tests.h"
+#include "util/container/hashSet.h"
+#include "util/container/pointerMap.h"
+#include "util/container/pointerSet.h"
+#include "util/container/vector.h"
+#include "util/format.h"
+#include "util/functional.h"
+
+/** elements put in each container - enough to force several resizes */
+static size_t const NUM_ELEMENTS = 1000;
+
+static void testVector(void) {
+  size_t *elements = malloc(NUM_ELEMENTS * sizeof(size_t));
+
+  Vector v;
+  vectorInit(&v);
+  for (size_t idx = 0; idx < NUM_ELEMENTS; ++idx)
+    vectorInsert(&v, &elements[idx]);
+  test("vector counts its elements", v.size == NUM_ELEMENTS);
+
+  bool found = true;
+  for (size_t idx = 0; idx < NUM_ELEMENTS; ++idx)
+    found = found && v.elements[idx] == &elements[idx] &&
+            vectorContains(&v, &elements[idx]);
+  test("vector keeps its elements in order when it grows", found);
+  test("vector doesn't contain other elements",
+       !vectorContains(&v, &elements[NUM_ELEMENTS]) &&
+           !vectorContains(&v, &v));
+
+  vectorUninit(&v, nullDtor);
+  free(elements);
+}
+
+static void testHashSet(void) {
+  char **strings = malloc(NUM_ELEMENTS * sizeof(char *));
+  for (size_t idx = 0; idx < NUM_ELEMENTS; ++idx)
+    strings[idx] = format("string%zu", idx);
+
+  HashSet set;
+  hashSetInit(&set);
+
+  bool inserted = true;
+  for (size_t idx = 0; idx < NUM_ELEMENTS; ++idx)
+    inserted = inserted && hashSetPut(&set, strings[idx]) == 0;
+  test("hash set accepts new strings", inserted);
+  test("hash set counts its strings", set.size == NUM_ELEMENTS);
+
+  bool found = true;
+  bool duplicatesRejected = true;
+  for (size_t idx = 0; idx < NUM_ELEMENTS; ++idx) {
+    found = found && hashSetContains(&set, strings[idx]);
+    duplicatesRejected =
+        duplicatesRejected && hashSetPut(&set, strings[idx]) == -1;
+  }
+  test("hash set keeps its strings when it grows", found);
+  test("hash set rejects duplicates", duplicatesRejected);
+  test("hash set doesn't contain other strings",
+       !hashSetContains(&set, "string1000") &&
+           !hashSetContains(&set, "other"));
+
+  hashSetUninit(&set);
+  for (size_t idx = 0; idx < NUM_ELEMENTS; ++idx) free(strings[idx]);
+  free(strings);
+}
+
+static void testPointerSet(void) {
+  size_t *elements = malloc(NUM_ELEMENTS * sizeof(size_t));
+
+  PointerSet set;
+  pointerSetInit(&set);
+
+  bool inserted = true;
+  for (size_t idx = 0; idx < NUM_ELEMENTS; ++idx)
+    inserted = inserted && pointerSetPut(&set, &elements[idx]) == 0;
+  test("pointer set accepts new pointers", inserted);
+  test("pointer set counts its pointers", set.size == NUM_ELEMENTS);
+
+  bool found = true;
+  bool duplicatesRejected = true;
+  for (size_t idx = 0; idx < NUM_ELEMENTS; ++idx) {
+    found = found && pointerSetContains(&set, &elements[idx]);
+    duplicatesRejected =
+        duplicatesRejected && pointerSetPut(&set, &elements[idx]) == -1;
+  }
+  test("pointer set keeps its pointers when it grows", found);
+  test("pointer set rejects duplicates", duplicatesRejected);
+  test("pointer set doesn't contain other pointers",
+       !pointerSetContains(&set, &elements[NUM_ELEMENTS]) &&
+           !pointerSetContains(&set, &set));
+
+  pointerSetUninit(&set);
+  free(elements);
+}
+
+static void testPointerMap(void) {
+  size_t *keys = malloc(NUM_ELEMENTS * sizeof(size_t));
+  size_t *values = malloc(NUM_ELEMENTS * sizeof(size_t));
+
+  PointerMap map;
+  pointerMapInit(&map);
+
+  bool inserted = true;
+  for (size_t idx = 0; idx < NUM_ELEMENTS; ++idx)
+    inserted = inserted && pointerMapPut(&map, &keys[idx], &values[idx]) == 0;
+  test("pointer map accepts new keys", inserted);
+  test("pointer map counts its keys", map.size == NUM_ELEMENTS);
+
+  bool found = true;
+  bool duplicatesRejected = true;
+  for (size_t idx = 0; idx < NUM_ELEMENTS; ++idx) {
+    found = found && pointerMapGet(&map, &keys[idx]) == &values[idx];
+    duplicatesRejected =
+        duplicatesRejected && pointerMapPut(&map, &keys[idx], NULL) == -1;
+  }
+  test("pointer map keeps its values when it grows", found);
+  test("pointer map rejects duplicates", duplicatesRejected);
+  test("pointer map doesn't contain other keys",
+       pointerMapGet(&map, &keys[NUM_ELEMENTS]) == NULL &&
+           pointerMapGet(&map, &values[0]) == NULL);
+
+  pointerMapUninit(&map);
+  free(values);
+  free(keys);
+}
+
+void testContainer(void) {
+  testVector();
+  testHashSet();
+  testPointerSet();
+  testPointerMap();
+}
\ No newline at end of file
@@ -0,0 +1,359 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * grammar-driven fuzz tests for front end throughput
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "engine.h"
+#include "fileList.h"
+#include "parser/parser.h"
+#include "tests.h"
+#include "util/allocations.h"
+#include "util/format.h"
+#include "util/fuzzer.h"
+#include "util/random.h"
+
+/** limits on how compile time may scale */
+enum {
+  NUM_TRIALS = 3,    /**< parses of each program timed - the fastest is kept */
+  MAX_SLOWDOWN = 3,  /**< most tokens/sec may drop as a program grows */
+  MAX_ALLOCATION_GROWTH = 2, /**< most allocations/token may grow */
+  NUM_MUTANTS = 16,          /**< near-valid programs generated */
+  MUTATION_RATE = 8,         /**< chance of mutating a token, out of 1024 */
+};
+
+/** sizes programs are generated at - each is four times the last */
+static size_t const SIZES[] = {64, 256, 1024};
+/** number of sizes */
+static size_t const NUM_SIZES = sizeof(SIZES) / sizeof(size_t);
+
+/** cost of parsing one program */
+typedef struct {
+  bool accepted;      /**< did the parser accept the program */
+  size_t tokens;      /**< number of tokens in the program */
+  size_t allocations; /**< number of allocations made while parsing */
+  clock_t ticks;      /**< processor time taken to parse, at least one */
+} Measurement;
+
+/**
+ * counts the tokens in the global file list
+ *
+ * @returns number of tokens, excluding end of file tokens
+ */
+static size_t countTokens(void) {
+  size_t tokens = 0;
+  lexerInitMaps();
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    if (lexerStateInit(&fileList.entries[idx]) != 0) continue;
+    Token token;
+    for (lex(&fileList.entries[idx], &token); token.type != TT_EOF;
+         lex(&fileList.entries[idx], &token)) {
+      tokenUninit(&token);
+      ++tokens;
+    }
+    lexerStateUninit(&fileList.entries[idx]);
+  }
+  lexerUninitMaps();
+  return tokens;
+}
+
+/**
+ * parses every file in a directory, measuring the cost of doing so
+ *
+ * @param directory directory to parse
+ * @param m output measurement
+ */
+static void measure(char const *directory, Measurement *m) {
+  char **filenames;
+  size_t numFiles = fuzzListFiles(directory, &filenames);
+  FileListEntry *entries = malloc(numFiles * sizeof(FileListEntry));
+  fileList.entries = entries;
+  fileList.size = numFiles;
+
+  for (size_t idx = 0; idx < numFiles; ++idx)
+    fileListEntryInit(&entries[idx], filenames[idx],
+                      filenames[idx][strlen(filenames[idx]) - 1] == 'c');
+  m->tokens = countTokens();
+
+  for (size_t trial = 0; trial < NUM_TRIALS; ++trial) {
+    for (size_t idx = 0; idx < numFiles; ++idx) {
+      entries[idx].errored = false;
+      entries[idx].ast = NULL;
+    }
+
+    size_t allocations = allocationCount();
+    clock_t start = clock();
+    m->accepted = parse() == 0;
+    clock_t ticks = clock() - start;
+    m->allocations = allocationCount() - allocations;
+
+    if (ticks < 1) ticks = 1;
+    if (trial == 0 || ticks < m->ticks) m->ticks = ticks;
+
+    for (size_t idx = 0; idx < numFiles; ++idx) nodeFree(entries[idx].ast);
+  }
+
+  free(entries);
+  fuzzFilenamesFree(filenames, numFiles);
+}
+
+/**
+ * reports a measurement on stderr
+ *
+ * @param name name of the program measured
+ * @param m measurement to report
+ */
+static void report(char const *name, Measurement const *m) {
+  fprintf(stderr,
+          "fuzz: %s: %zu tokens, %.0f tokens/sec, %.2f allocations/token\n",
+          name, m->tokens,
+          (double)m->tokens * CLOCKS_PER_SEC / (double)m->ticks,
+          (double)m->allocations / (double)m->tokens);
+}
+
+/**
+ * is the larger program slower to parse per token, beyond the allowed limit
+ *
+ * @param small measurement of the smaller program
+ * @param large measurement of the larger program
+ * @returns whether throughput dropped by more than MAX_SLOWDOWN
+ */
+static bool tooSlow(Measurement const *small, Measurement const *large) {
+  return (uint64_t)large->ticks * small->tokens >
+         (uint64_t)MAX_SLOWDOWN * (uint64_t)small->ticks * large->tokens;
+}
+
+/**
+ * does the larger program allocate more per token, beyond the allowed limit
+ *
+ * @param small measurement of the smaller program
+ * @param large measurement of the larger program
+ * @returns whether allocations per token grew by more than
+ * MAX_ALLOCATION_GROWTH
+ */
+static bool tooManyAllocations(Measurement const *small,
+                               Measurement const *large) {
+  return (uint64_t)large->allocations * small->tokens >
+         (uint64_t)MAX_ALLOCATION_GROWTH * small->allocations * large->tokens;
+}
+
+/**
+ * makes a fresh scratch directory
+ *
+ * @returns name of the directory, owning, or NULL on failure
+ */
+static char *scratchDirectory(void) {
+  char *directory = strcpy(malloc(sizeof("/tmp/tlc-fuzz-XXXXXX")),
+                           "/tmp/tlc-fuzz-XXXXXX");
+  if (mkdtemp(directory) == NULL) {
+    free(directory);
+    return NULL;
+  }
+  return directory;
+}
+
+/**
+ * generates and measures a program
+ *
+ * the random number generator is seeded with the size so that a program can be
+ * regenerated on its own
+ *
+ * @param shape shape of program to generate
+ * @param size size of program to generate
+ * @param mutationRate chance of mutating each token
+ * @param m output measurement
+ * @returns status code (0 = OK)
+ */
+static int generateAndMeasure(FuzzShape shape, size_t size,
+                              unsigned mutationRate, Measurement *m) {
+  char *directory = scratchDirectory();
+  if (directory == NULL) return -1;
+
+  srand((unsigned)size);
+  int retval = fuzzGenerate(directory, shape, size, mutationRate);
+  if (retval == 0) {
+    measure(directory, m);
+    char *name = format("%s at size %zu", fuzzShapeName(shape), size);
+    report(name, m);
+    free(name);
+  }
+
+  fuzzRemove(directory);
+  free(directory);
+  return retval;
+}
+
+/**
+ * reports a pathological pair of programs
+ *
+ * generated programs are reproducible from their shape and size, and every
+ * shape is regenerated at the same sizes on each run, so the case needn't be
+ * saved
+ *
+ * @param shape shape of the programs
+ * @param smallSize size of the small program
+ * @param largeSize size of the large program
+ */
+static void reportPathological(FuzzShape shape, size_t smallSize,
+                               size_t largeSize) {
+  fprintf(stderr, "fuzz: %s doesn't scale from size %zu to %zu\n",
+          fuzzShapeName(shape), smallSize, largeSize);
+}
+
+/**
+ * checks the time a program took to parse
+ *
+ * processor time depends on the machine and its load, so it only fails a test
+ * in the perf suite - otherwise, a slowdown is only reported
+ *
+ * @param name name of the test
+ * @param linearTime was throughput within MAX_SLOWDOWN
+ * @param timed is timing enforced
+ */
+static void testTiming(char const *name, bool linearTime, bool timed) {
+  if (timed)
+    test(name, linearTime);
+  else if (!linearTime)
+    fprintf(stderr,
+            "fuzz: advisory: \"%s\" failed - timing is only enforced by the "
+            "perf suite\n",
+            name);
+}
+
+/**
+ * generates programs of one shape at increasing sizes, and checks that parsing
+ * them scales linearly
+ *
+ * the first size at which a program is flagged is the minimized pathological
+ * case, and is reported
+ *
+ * @param shape shape to check
+ * @param accepted output - were all the programs accepted
+ * @param linearTime output - did throughput stay within MAX_SLOWDOWN
+ * @param linearAllocations output - did allocations per token stay within
+ * MAX_ALLOCATION_GROWTH
+ */
+static void checkShape(FuzzShape shape, bool *accepted, bool *linearTime,
+                       bool *linearAllocations) {
+  *accepted = true;
+  *linearTime = true;
+  *linearAllocations = true;
+
+  Measurement small;
+  if (generateAndMeasure(shape, SIZES[0], 0, &small) != 0) {
+    *accepted = false;
+    return;
+  }
+  *accepted = small.accepted;
+
+  for (size_t idx = 1; idx < NUM_SIZES; ++idx) {
+    Measurement large;
+    if (generateAndMeasure(shape, SIZES[idx], 0, &large) != 0) {
+      *accepted = false;
+      return;
+    }
+    *accepted = *accepted && large.accepted;
+
+    bool slow = tooSlow(&small, &large);
+    bool allocating = tooManyAllocations(&small, &large);
+    if (slow || allocating) {
+      *linearTime = !slow;
+      *linearAllocations = !allocating;
+      reportPathological(shape, SIZES[0], SIZES[idx]);
+      return;
+    }
+  }
+}
+
+/**
+ * checks every shape
+ *
+ * @param timed is timing enforced
+ */
+static void testShapes(bool timed) {
+  bool accepted;
+  bool linearTime;
+  bool linearAllocations;
+
+  checkShape(FS_GRAMMAR, &accepted, &linearTime, &linearAllocations);
+  test("generated programs are accepted", accepted);
+  testTiming("generated programs parse in linear time", linearTime, timed);
+  test("generated programs allocate linearly", linearAllocations);
+
+  checkShape(FS_IMPORTS, &accepted, &linearTime, &linearAllocations);
+  test("programs with many imports are accepted", accepted);
+  testTiming("many imports resolve in linear time", linearTime, timed);
+  test("many imports allocate linearly", linearAllocations);
+
+  checkShape(FS_ENUM_CHAIN, &accepted, &linearTime, &linearAllocations);
+  test("chained enums are accepted", accepted);
+  testTiming("chained enums resolve in linear time", linearTime, timed);
+  test("chained enums allocate linearly", linearAllocations);
+
+  checkShape(FS_WIDE_SCOPE, &accepted, &linearTime, &linearAllocations);
+  test("programs with wide scopes are accepted", accepted);
+  testTiming("wide scopes fill in linear time", linearTime, timed);
+  test("wide scopes allocate linearly", linearAllocations);
+}
+
+/**
+ * checks that near-valid programs are rejected
+ *
+ * @param timed is timing enforced
+ */
+static void testMutants(bool timed) {
+  Measurement valid;
+  if (generateAndMeasure(FS_GRAMMAR, SIZES[1], 0, &valid) != 0) {
+    test("near-valid programs are generated", false);
+    return;
+  }
+
+  bool rejected = true;
+  bool linearTime = true;
+  for (size_t idx = 0; idx < NUM_MUTANTS; ++idx) {
+    Measurement mutant;
+    if (generateAndMeasure(FS_GRAMMAR, SIZES[1] + idx, MUTATION_RATE,
+                           &mutant) != 0) {
+      test("near-valid programs are generated", false);
+      return;
+    }
+    rejected = rejected && !mutant.accepted;
+    linearTime = linearTime && !tooSlow(&valid, &mutant);
+  }
+  test("near-valid programs are rejected", rejected);
+  testTiming("error recovery runs in linear time", linearTime, timed);
+}
+
+void testFuzz(void) {
+  testShapes(false);
+  testMutants(false);
+}
+
+void testPerf(void) {
+  testShapes(true);
+  testMutants(true);
+}
\ No newline at end of file
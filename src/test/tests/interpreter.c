@@ -0,0 +1,257 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * tests for the interpreter
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+#include "fileList.h"
+#include "interpreter/interpreter.h"
+#include "optimization/passManager.h"
+#include "options.h"
+#include "parser/parser.h"
+#include "tests.h"
+
+/**
+ * calls a function taking one argument
+ *
+ * @param interpreter interpreter to run in
+ * @param name name of the function
+ * @param arg argument, already of the type of the parameter
+ * @param result output pointer to the return value
+ * @returns status code (0 = OK)
+ */
+static int call1(Interpreter *interpreter, char const *name, uint64_t arg,
+                 Value *result) {
+  Value args[1];
+  args[0].bits = arg;
+  return interpreterCall(interpreter, name, args, 1, result);
+}
+
+static void testRun(void) {
+  FileListEntry entries[2];
+  fileList.entries = &entries[0];
+  fileList.size = 2;
+
+  entries[0].inputFilename = "testFiles/interpreter/run.tc";
+  entries[0].isCode = true;
+  entries[0].errored = false;
+  entries[1].inputFilename = "testFiles/interpreter/libc.td";
+  entries[1].isCode = false;
+  entries[1].errored = false;
+  test("interpreted files parse", parse() == 0);
+  if (entries[0].errored || entries[1].errored) return;
+
+  char *output;
+  size_t length;
+  FILE *out = open_memstream(&output, &length);
+  Interpreter interpreter;
+  test("interpreted program compiles",
+       interpreterInit(&interpreter, stdin, out) == 0);
+
+  Value result;
+  test("recursive calls are interpreted",
+       call1(&interpreter, "factorial", 10, &result) == 0 &&
+           result.bits == 3628800);
+  test("for loops are interpreted",
+       call1(&interpreter, "fibonacci", 90, &result) == 0 &&
+           result.bits == UINT64_C(2880067194370816120));
+  test("while loops and compound assignments are interpreted",
+       call1(&interpreter, "collatz", 27, &result) == 0 && result.bits == 111);
+  test("switch cases fall through until a break",
+       call1(&interpreter, "classify", 1, &result) == 0 && result.bits == 11);
+  test("switch jumps to the default without a matching case",
+       call1(&interpreter, "classify", 5, &result) == 0 && result.bits == 100);
+  test("switch cases may fall through into the default",
+       call1(&interpreter, "classify", 3, &result) == 0 && result.bits == 1100);
+  test("continue and break leave do-while loops",
+       call1(&interpreter, "firstMultiple", 3, &result) == 0 &&
+           result.bits == 21);
+  test("unsigned arithmetic wraps",
+       interpreterCall(&interpreter, "wrap", NULL, 0, &result) == 0 &&
+           result.bits == 4);
+  test("negating an unsigned value widens it",
+       call1(&interpreter, "negate", 200, &result) == 0 &&
+           result.bits == (uint64_t)INT64_C(-200));
+  test("globals are initialized",
+       interpreterCall(&interpreter, "bump", NULL, 0, &result) == 0 &&
+           result.bits == 15);
+  test("globals keep their values between calls",
+       interpreterCall(&interpreter, "bump", NULL, 0, &result) == 0 &&
+           result.bits == 20);
+  test("integers are converted to doubles",
+       call1(&interpreter, "half", 3, &result) == 0 &&
+           memcmp(&result.doubleVal, &(double){(double)1.5f},
+                  sizeof(double)) == 0);
+  test("logical operators short circuit",
+       call1(&interpreter, "safeDivides", 0, &result) == 0 &&
+           result.bits == 0);
+  test("logical operators evaluate both sides when needed",
+       call1(&interpreter, "safeDivides", 2, &result) == 0 &&
+           result.bits == 1);
+  Value arg;
+  arg.doubleVal = (double)-2.75f;
+  test("doubles are truncated toward zero",
+       interpreterCall(&interpreter, "truncate", &arg, 1, &result) == 0 &&
+           result.bits == (uint64_t)INT64_C(-2));
+  test("logical right shifts fill with zeroes",
+       call1(&interpreter, "logicalShift", (uint64_t)INT64_C(-1), &result) ==
+               0 &&
+           result.bits == 15);
+
+  test("C library functions are called",
+       call1(&interpreter, "shout", 'a', &result) == 0 && result.bits == 'A');
+  test("C functions take integral and floating point arguments",
+       interpreterCall(&interpreter, "scaleUp",
+                       (Value[]){{.bits = 4}, {.doubleVal = (double)0.75f}}, 2,
+                       &result) == 0 &&
+           memcmp(&result.doubleVal, &(double){(double)12.0f},
+                  sizeof(double)) == 0);
+  arg.bits = 0;
+  arg.floatVal = 1.5f;
+  test("C functions take and return floats",
+       interpreterCall(&interpreter, "scaleUpFloat", &arg, 1, &result) == 0 &&
+           memcmp(&result.floatVal, &(float){12.0f}, sizeof(float)) == 0);
+
+  test("division by zero traps",
+       interpreterCall(&interpreter, "divide",
+                       (Value[]){{.bits = 1}, {.bits = 0}}, 2, &result) != 0);
+  test("out of range conversions trap",
+       interpreterCall(&interpreter, "truncate",
+                       &(Value){.doubleVal = (double)1e10f}, 1, &result) != 0);
+  test("falling off the end of a non-void function traps",
+       call1(&interpreter, "noReturn", 0, &result) != 0);
+  test("unbounded recursion traps",
+       call1(&interpreter, "recurse", 0, &result) != 0);
+  test("interpreter recovers from traps",
+       call1(&interpreter, "noReturn", 4, &result) == 0 && result.bits == 4);
+  test("unknown functions can't be called",
+       interpreterCall(&interpreter, "missing", NULL, 0, &result) != 0);
+
+  test("exit stops the program with its status",
+       interpreterCall(&interpreter, "main", (Value[]){{.bits = 1}}, 1,
+                       &result) == 0 &&
+           result.bits == 3);
+  fclose(out);
+  test("host functions write to the output stream",
+       strcmp(output, "hi\n") == 0);
+  free(output);
+
+  interpreterUninit(&interpreter);
+  nodeFree(entries[0].ast);
+  nodeFree(entries[1].ast);
+}
+
+static void testUnsupported(void) {
+  FileListEntry entry;
+  fileList.entries = &entry;
+  fileList.size = 1;
+
+  entry.inputFilename = "testFiles/interpreter/unsupported.tc";
+  entry.isCode = true;
+  entry.errored = false;
+  test("unsupported file parses", parse() == 0);
+  if (entry.errored) return;
+
+  Interpreter interpreter;
+  test("pointers are rejected",
+       interpreterInit(&interpreter, stdin, stdout) != 0);
+  interpreterUninit(&interpreter);
+  nodeFree(entry.ast);
+}
+
+/**
+ * runs every function without parameters in the global file list
+ *
+ * @param results output vector of Value, owning
+ * @returns status code (0 = OK)
+ */
+static int runAll(Vector *results) {
+  Interpreter interpreter;
+  if (interpreterInit(&interpreter, stdin, stdout) != 0) {
+    interpreterUninit(&interpreter);
+    return -1;
+  }
+
+  int retval = 0;
+  Vector *bodies = fileList.entries[0].ast->data.file.bodies;
+  for (size_t idx = 0; idx < bodies->size; ++idx) {
+    Node *body = bodies->elements[idx];
+    if (body->type != NT_FUNDEFN || body->data.funDefn.argNames->size != 0)
+      continue;
+    Value *result = malloc(sizeof(Value));
+    if (interpreterCall(&interpreter, body->data.funDefn.name->data.id.id,
+                        NULL, 0, result) != 0)
+      retval = -1;
+    vectorInsert(results, result);
+  }
+
+  interpreterUninit(&interpreter);
+  return retval;
+}
+
+static void testDifferential(void) {
+  FileListEntry entry;
+  fileList.entries = &entry;
+  fileList.size = 1;
+
+  entry.inputFilename = "testFiles/interpreter/differential.tc";
+  entry.isCode = true;
+  entry.errored = false;
+  test("differential test file parses", parse() == 0);
+  if (entry.errored) return;
+
+  // the unoptimized program is the oracle for the optimized one
+  Vector unoptimized;
+  vectorInit(&unoptimized);
+  test("unoptimized program runs", runAll(&unoptimized) == 0);
+
+  Options saved = options;
+  options.optimizationLevel = OPTION_O_2;
+  PassPipeline pipeline;
+  passPipelineInit(&pipeline);
+  passPipelineRun(&pipeline, NULL);
+  passPipelineUninit(&pipeline);
+  options = saved;
+
+  Vector optimized;
+  vectorInit(&optimized);
+  test("optimized program runs", runAll(&optimized) == 0);
+  bool same = unoptimized.size == optimized.size && unoptimized.size == 4;
+  for (size_t idx = 0; same && idx < unoptimized.size; ++idx) {
+    same = memcmp(unoptimized.elements[idx], optimized.elements[idx],
+                  sizeof(Value)) == 0;
+  }
+  test("optimizations preserve results", same);
+
+  vectorUninit(&unoptimized, free);
+  vectorUninit(&optimized, free);
+  nodeFree(entry.ast);
+}
+
+void testInterpreter(void) {
+  testRun();
+  testUnsupported();
+  testDifferential();
+}
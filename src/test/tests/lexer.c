@@ -40,50 +40,52 @@ static void testAllTokens(void) {
   test("lexer initializes okay", lexerStateInit(&entry) == 0);
 
   TokenType const types[] = {
-      TT_MODULE,        TT_IMPORT,       TT_OPAQUE,
-      TT_STRUCT,        TT_UNION,        TT_ENUM,
-      TT_TYPEDEF,       TT_IF,           TT_ELSE,
-      TT_WHILE,         TT_DO,           TT_FOR,
-      TT_SWITCH,        TT_CASE,         TT_DEFAULT,
-      TT_BREAK,         TT_CONTINUE,     TT_RETURN,
-      TT_ASM,           TT_CAST,         TT_SIZEOF,
-      TT_TRUE,          TT_FALSE,        TT_NULL,
-      TT_VOID,          TT_UBYTE,        TT_BYTE,
-      TT_CHAR,          TT_USHORT,       TT_SHORT,
-      TT_UINT,          TT_INT,          TT_WCHAR,
-      TT_ULONG,         TT_LONG,         TT_FLOAT,
-      TT_DOUBLE,        TT_BOOL,         TT_CONST,
-      TT_VOLATILE,      TT_SEMI,         TT_COMMA,
-      TT_LPAREN,        TT_RPAREN,       TT_LSQUARE,
-      TT_RSQUARE,       TT_LBRACE,       TT_RBRACE,
-      TT_DOT,           TT_ARROW,        TT_INC,
-      TT_DEC,           TT_STAR,         TT_AMP,
-      TT_PLUS,          TT_MINUS,        TT_BANG,
-      TT_TILDE,         TT_NEGASSIGN,    TT_LNOTASSIGN,
-      TT_BITNOTASSIGN,  TT_SLASH,        TT_PERCENT,
-      TT_LSHIFT,        TT_ARSHIFT,      TT_LRSHIFT,
-      TT_SPACESHIP,     TT_LANGLE,       TT_RANGLE,
-      TT_LTEQ,          TT_GTEQ,         TT_EQ,
-      TT_NEQ,           TT_BAR,          TT_CARET,
-      TT_LAND,          TT_LOR,          TT_QUESTION,
-      TT_COLON,         TT_ASSIGN,       TT_MULASSIGN,
-      TT_DIVASSIGN,     TT_MODASSIGN,    TT_ADDASSIGN,
-      TT_SUBASSIGN,     TT_LSHIFTASSIGN, TT_ARSHIFTASSIGN,
-      TT_LRSHIFTASSIGN, TT_BITANDASSIGN, TT_BITXORASSIGN,
-      TT_BITORASSIGN,   TT_LANDASSIGN,   TT_LORASSIGN,
-      TT_SCOPE,         TT_ID,           TT_ID,
-      TT_LIT_STRING,    TT_LIT_WSTRING,  TT_LIT_CHAR,
-      TT_LIT_WCHAR,     TT_LIT_INT_D,    TT_LIT_INT_H,
-      TT_LIT_INT_B,     TT_LIT_INT_O,    TT_LIT_INT_0,
-      TT_LIT_DOUBLE,    TT_LIT_FLOAT,    TT_LIT_STRING,
-      TT_LIT_INT_D,     TT_LIT_STRING,   TT_EOF,
+      TT_MODULE,        TT_IMPORT,        TT_OPAQUE,
+      TT_STRUCT,        TT_UNION,         TT_ENUM,
+      TT_TYPEDEF,       TT_IF,            TT_ELSE,
+      TT_WHILE,         TT_DO,            TT_FOR,
+      TT_SWITCH,        TT_CASE,          TT_DEFAULT,
+      TT_BREAK,         TT_CONTINUE,      TT_RETURN,
+      TT_ASM,           TT_CAST,          TT_SIZEOF,
+      TT_TRUE,          TT_FALSE,         TT_NULL,
+      TT_VOID,          TT_UBYTE,         TT_BYTE,
+      TT_CHAR,          TT_USHORT,        TT_SHORT,
+      TT_UINT,          TT_INT,           TT_WCHAR,
+      TT_ULONG,         TT_LONG,          TT_FLOAT,
+      TT_DOUBLE,        TT_BOOL,          TT_CONST,
+      TT_VOLATILE,      TT_PURE,          TT_LIKELY,
+      TT_UNLIKELY,      TT_THREADLOCAL,   TT_SEMI,
+      TT_COMMA,         TT_LPAREN,        TT_RPAREN,
+      TT_LSQUARE,       TT_RSQUARE,       TT_LBRACE,
+      TT_RBRACE,        TT_DOT,           TT_ARROW,
+      TT_INC,           TT_DEC,           TT_STAR,
+      TT_AMP,           TT_PLUS,          TT_MINUS,
+      TT_BANG,          TT_TILDE,         TT_NEGASSIGN,
+      TT_LNOTASSIGN,    TT_BITNOTASSIGN,  TT_SLASH,
+      TT_PERCENT,       TT_LSHIFT,        TT_ARSHIFT,
+      TT_LRSHIFT,       TT_SPACESHIP,     TT_LANGLE,
+      TT_RANGLE,        TT_LTEQ,          TT_GTEQ,
+      TT_EQ,            TT_NEQ,           TT_BAR,
+      TT_CARET,         TT_LAND,          TT_LOR,
+      TT_QUESTION,      TT_COLON,         TT_ASSIGN,
+      TT_MULASSIGN,     TT_DIVASSIGN,     TT_MODASSIGN,
+      TT_ADDASSIGN,     TT_SUBASSIGN,     TT_LSHIFTASSIGN,
+      TT_ARSHIFTASSIGN, TT_LRSHIFTASSIGN, TT_BITANDASSIGN,
+      TT_BITXORASSIGN,  TT_BITORASSIGN,   TT_LANDASSIGN,
+      TT_LORASSIGN,     TT_SCOPE,         TT_ID,
+      TT_ID,            TT_LIT_STRING,    TT_LIT_WSTRING,
+      TT_LIT_CHAR,      TT_LIT_WCHAR,     TT_LIT_INT_D,
+      TT_LIT_INT_H,     TT_LIT_INT_B,     TT_LIT_INT_O,
+      TT_LIT_INT_0,     TT_LIT_DOUBLE,    TT_LIT_FLOAT,
+      TT_LIT_STRING,    TT_LIT_INT_D,     TT_LIT_STRING,
+      TT_EOF,
   };
   size_t const characters[] = {
       1,  8,  15, 22, 29, 35, 40, 48, 51, 56, 62, 65, 69, 76,
 
       1,  9,  15, 24, 31, 35, 40, 47, 52, 58, 63, 68, 74,
 
-      1,  6,  13, 19, 24, 28, 34, 40, 45, 51, 58, 63, 69,
+      1,  6,  13, 19, 24, 28, 34, 40, 45, 51, 58, 63, 69, 78, 83, 90, 99,
 
       1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 12, 14, 16, 17, 18, 19,
       20, 21, 22, 24, 26, 28, 29, 30, 32, 35, 38, 41, 42, 43, 46, 48,
@@ -104,7 +106,7 @@ static void testAllTokens(void) {
 
       2,  2,  2,  2,  2,  2,  2,  2,  2, 2, 2, 2, 2,
 
-      3,  3,  3,  3,  3,  3,  3,  3,  3, 3, 3, 3, 3,
+      3,  3,  3,  3,  3,  3,  3,  3,  3, 3, 3, 3, 3, 3, 3, 3, 3,
 
       5,  5,  5,  5,  5,  5,  5,  5,  5, 5, 5, 5, 5, 5, 5, 5,
       5,  5,  5,  5,  5,  5,  5,  5,  5, 5, 5, 5, 5, 5, 5, 5,
@@ -163,6 +165,10 @@ static void testAllTokens(void) {
       NULL,
       NULL,
       NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
 
       NULL,
       NULL,
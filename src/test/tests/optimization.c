@@ -0,0 +1,1949 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * tests for source-level optimizations
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+#include "fileList.h"
+#include "optimization/addressing.h"
+#include "optimization/callPromotion.h"
+#include "optimization/callingConvention.h"
+#include "optimization/codeFolding.h"
+#include "optimization/floatingPoint.h"
+#include "optimization/frame.h"
+#include "optimization/idioms.h"
+#include "optimization/ifConversion.h"
+#include "optimization/layout.h"
+#include "optimization/memoryOps.h"
+#include "optimization/modRef.h"
+#include "optimization/outliner.h"
+#include "optimization/passManager.h"
+#include "optimization/remarks.h"
+#include "optimization/schedule.h"
+#include "optimization/sections.h"
+#include "optimization/strengthReduction.h"
+#include "optimization/stringPool.h"
+#include "optimization/valueRange.h"
+#include "options.h"
+#include "parser/parser.h"
+#include "tests.h"
+#include "util/fuzzer.h"
+
+/**
+ * reads the contents of a temporary file
+ *
+ * @param file file to read - closed by this function
+ * @returns contents, as an owned c-string
+ */
+static char *readTmpfile(FILE *file) {
+  fflush(file);
+  long length = ftell(file);
+  rewind(file);
+  char *buffer = malloc((size_t)length + 1);
+  size_t readLength = fread(buffer, sizeof(char), (size_t)length, file);
+  buffer[readLength] = '\0';
+  fclose(file);
+  return buffer;
+}
+
+static void testStringPool(void) {
+  StringPool pool;
+  stringPoolInit(&pool);
+
+  PooledString *foobar = stringPoolAdd(&pool, (uint8_t const *)"foobar");
+  PooledString *bar = stringPoolAdd(&pool, (uint8_t const *)"bar");
+  PooledString *baz = stringPoolAdd(&pool, (uint8_t const *)"baz");
+  PooledString *quote = stringPoolAdd(&pool, (uint8_t const *)"\"q\\\n");
+  test("identical strings are pooled",
+       stringPoolAdd(&pool, (uint8_t const *)"foobar") == foobar);
+  test("distinct strings are not pooled", foobar != bar && bar != baz);
+  test("pooled strings are numbered in order",
+       foobar->id == 0 && bar->id == 1 && baz->id == 2 && quote->id == 3);
+
+  uint32_t const wideFoobar[] = {'f', 'o', 'o', 'b', 'a', 'r', 0x1f600, 0};
+  uint32_t const wideBar[] = {'b', 'a', 'r', 0x1f600, 0};
+  uint32_t const wideEmpty[] = {0};
+  PooledString *wfoobar = wstringPoolAdd(&pool, wideFoobar);
+  PooledString *wbar = wstringPoolAdd(&pool, wideBar);
+  PooledString *wempty = wstringPoolAdd(&pool, wideEmpty);
+  test("identical wide strings are pooled",
+       wstringPoolAdd(&pool, wideBar) == wbar);
+  test("wide strings are numbered separately",
+       wfoobar->id == 0 && wbar->id == 1 && wempty->id == 2);
+
+  stringPoolMerge(&pool);
+  test("suffix is merged into longer string",
+       bar->root == foobar && bar->offset == 3);
+  test("longest string is its own root",
+       foobar->root == foobar && foobar->offset == 0);
+  test("string without a matching suffix is not merged",
+       baz->root == baz && quote->root == quote);
+  test("wide suffix is merged into longer string",
+       wbar->root == wfoobar && wbar->offset == 3);
+  test("empty wide string is merged",
+       wempty->root == wfoobar && wempty->offset == 7);
+
+  FILE *emitted = tmpfile();
+  stringPoolEmit(emitted, &pool);
+  char *actual = readTmpfile(emitted);
+  test("pool is emitted into mergeable sections",
+       strcmp(actual,
+              "\t.section\t.rodata.str1.1,\"aMS\",@progbits,1\n"
+              ".LSTR0:\n"
+              "\t.asciz\t\"foobar\"\n"
+              ".LSTR2:\n"
+              "\t.asciz\t\"baz\"\n"
+              ".LSTR3:\n"
+              "\t.asciz\t\"\\042q\\134\\012\"\n"
+              "\t.set\t.LSTR1, .LSTR0+3\n"
+              "\t.section\t.rodata.str4.4,\"aMS\",@progbits,4\n"
+              "\t.balign\t4\n"
+              ".LWSTR0:\n"
+              "\t.long\t102, 111, 111, 98, 97, 114, 128512, 0\n"
+              "\t.set\t.LWSTR1, .LWSTR0+12\n"
+              "\t.set\t.LWSTR2, .LWSTR0+28\n") == 0);
+  free(actual);
+
+  stringPoolUninit(&pool);
+}
+
+/**
+ * parses a file containing a single function and gets its body statements
+ *
+ * @param entry entry to fill in and parse
+ * @param filename name of file to parse
+ * @returns vector of statements in the function, or NULL if parsing failed
+ */
+static Vector *parseFunctionBody(FileListEntry *entry, char const *filename) {
+  fileList.entries = entry;
+  fileList.size = 1;
+
+  entry->inputFilename = filename;
+  entry->isCode = true;
+  entry->errored = false;
+  if (parse() != 0) return NULL;
+
+  Node *function = entry->ast->data.file.bodies->elements[0];
+  return function->data.funDefn.body->data.compoundStmt.stmts;
+}
+
+static void testIdioms(void) {
+  FileListEntry entry;
+  Vector *stmts = parseFunctionBody(&entry, "testFiles/optimization/idioms.tc");
+  test("idiom file parses", stmts != NULL);
+  if (stmts == NULL) return;
+
+  Idiom idiom;
+  Node *exp;
+
+  exp = ((Node *)stmts->elements[0])->data.expressionStmt.expression;
+  test("constant rotate is recognized",
+       idiomRecognizeExpression(exp, &idiom) && idiom.kind == IK_ROTL &&
+           idiom.width == 32);
+
+  exp = ((Node *)stmts->elements[1])->data.expressionStmt.expression;
+  test("variable left rotate is recognized",
+       idiomRecognizeExpression(exp, &idiom) && idiom.kind == IK_ROTL &&
+           idiom.width == 32 && idiom.operands[1]->type == NT_ID);
+
+  exp = ((Node *)stmts->elements[2])->data.expressionStmt.expression;
+  test("variable right rotate is recognized",
+       idiomRecognizeExpression(exp, &idiom) && idiom.kind == IK_ROTR &&
+           idiom.width == 32);
+
+  exp = ((Node *)stmts->elements[3])->data.expressionStmt.expression;
+  test("big-endian byte assembly is recognized",
+       idiomRecognizeExpression(exp, &idiom) && idiom.kind == IK_LOADBE &&
+           idiom.width == 16 && idiom.offset == 0);
+
+  exp = ((Node *)stmts->elements[4])->data.expressionStmt.expression;
+  test("little-endian byte assembly is recognized",
+       idiomRecognizeExpression(exp, &idiom) && idiom.kind == IK_LOADLE &&
+           idiom.width == 32 && idiom.offset == 4);
+
+  exp = ((Node *)stmts->elements[5])->data.expressionStmt.expression;
+  test("reset lowest bit is recognized",
+       idiomRecognizeExpression(exp, &idiom) && idiom.kind == IK_BLSR);
+
+  exp = ((Node *)stmts->elements[6])->data.expressionStmt.expression;
+  test("isolate lowest bit is recognized",
+       idiomRecognizeExpression(exp, &idiom) && idiom.kind == IK_BLSI);
+
+  exp = ((Node *)stmts->elements[7])->data.expressionStmt.expression;
+  test("mask to lowest bit is recognized",
+       idiomRecognizeExpression(exp, &idiom) && idiom.kind == IK_BLSMSK);
+
+  exp = ((Node *)stmts->elements[8])->data.expressionStmt.expression;
+  test("and-not is recognized",
+       idiomRecognizeExpression(exp, &idiom) && idiom.kind == IK_ANDN &&
+           idiom.operands[0]->type == NT_ID &&
+           strcmp(idiom.operands[0]->data.id.id, "x") == 0);
+
+  exp = ((Node *)stmts->elements[9])->data.expressionStmt.expression;
+  test("three way comparison is recognized",
+       idiomRecognizeExpression(exp, &idiom) && idiom.kind == IK_THREEWAY &&
+           strcmp(idiom.operands[0]->data.id.id, "a") == 0);
+
+  test("popcount while loop is recognized",
+       idiomRecognizeStatement(stmts->elements[10], &idiom) &&
+           idiom.kind == IK_POPCOUNT &&
+           strcmp(idiom.operands[1]->data.id.id, "count") == 0);
+  test("popcount for loop is recognized",
+       idiomRecognizeStatement(stmts->elements[11], &idiom) &&
+           idiom.kind == IK_POPCOUNT &&
+           strcmp(idiom.operands[0]->data.id.id, "y") == 0);
+
+  for (size_t idx = 12; idx < 18; ++idx) {
+    exp = ((Node *)stmts->elements[idx])->data.expressionStmt.expression;
+    test("near-miss expression is not recognized",
+         !idiomRecognizeExpression(exp, &idiom));
+  }
+  test("near-miss loop is not recognized",
+       !idiomRecognizeStatement(stmts->elements[18], &idiom));
+
+  nodeFree(entry.ast);
+}
+
+static void testIfConversion(void) {
+  FileListEntry entry;
+  Vector *stmts =
+      parseFunctionBody(&entry, "testFiles/optimization/ifConversion.tc");
+  test("if-conversion file parses", stmts != NULL);
+  if (stmts == NULL) return;
+
+  IfConversion conversion;
+  Node *exp;
+
+  exp = ((Node *)stmts->elements[0])->data.expressionStmt.expression;
+  test("constant ternary becomes setcc",
+       ifConvertExpression(exp, &conversion) && conversion.kind == ICK_SETCC);
+
+  exp = ((Node *)stmts->elements[1])->data.expressionStmt.expression;
+  test("zero or all ones ternary becomes mask",
+       ifConvertExpression(exp, &conversion) && conversion.kind == ICK_MASK);
+
+  exp = ((Node *)stmts->elements[2])->data.expressionStmt.expression;
+  test("cheap ternary becomes select",
+       ifConvertExpression(exp, &conversion) && conversion.kind == ICK_SELECT);
+
+  exp = ((Node *)stmts->elements[3])->data.expressionStmt.expression;
+  test("nested ternary becomes three way comparison",
+       ifConvertExpression(exp, &conversion) &&
+           conversion.kind == ICK_THREEWAY &&
+           strcmp(conversion.predicate->data.id.id, "a") == 0 &&
+           strcmp(conversion.consequent->data.id.id, "b") == 0);
+
+  exp = ((Node *)stmts->elements[4])->data.expressionStmt.expression;
+  test("reversed nested ternary becomes three way comparison",
+       ifConvertExpression(exp, &conversion) &&
+           conversion.kind == ICK_THREEWAY);
+
+  exp = ((Node *)stmts->elements[5])->data.expressionStmt.expression;
+  test("spaceship becomes three way comparison",
+       ifConvertExpression(exp, &conversion) &&
+           conversion.kind == ICK_THREEWAY);
+
+  test("if-else assignment becomes select",
+       ifConvertStatement(stmts->elements[6], &conversion) &&
+           conversion.kind == ICK_SELECT &&
+           strcmp(conversion.destination->data.id.id, "x") == 0 &&
+           strcmp(conversion.alternative->data.id.id, "b") == 0);
+  test("if assignment becomes select",
+       ifConvertStatement(stmts->elements[7], &conversion) &&
+           conversion.kind == ICK_SELECT &&
+           conversion.alternative == conversion.destination);
+  test("if-else with different destinations is not converted",
+       !ifConvertStatement(stmts->elements[8], &conversion));
+  test("if with trapping destination is not converted",
+       !ifConvertStatement(stmts->elements[9], &conversion));
+
+  exp = ((Node *)stmts->elements[10])->data.expressionStmt.expression;
+  test("ternary with a dereference is not converted",
+       !ifConvertExpression(exp, &conversion));
+
+  exp = ((Node *)stmts->elements[11])->data.expressionStmt.expression;
+  test("ternary with a division is not converted",
+       !ifConvertExpression(exp, &conversion));
+
+  exp = ((Node *)stmts->elements[12])->data.expressionStmt.expression;
+  test("expensive ternary is not converted",
+       !ifConvertExpression(exp, &conversion));
+
+  exp = ((Node *)stmts->elements[13])->data.expressionStmt.expression;
+  test("inverted three way comparison is not a three way comparison",
+       !ifConvertExpression(exp, &conversion) ||
+           conversion.kind != ICK_THREEWAY);
+
+  test("if with a function call is not converted",
+       !ifConvertStatement(stmts->elements[14], &conversion));
+  test("hinted if-else assignment is not converted",
+       !ifConvertStatement(stmts->elements[15], &conversion));
+  test("hinted if-else constant assignment becomes setcc",
+       ifConvertStatement(stmts->elements[16], &conversion) &&
+           conversion.kind == ICK_SETCC);
+
+  nodeFree(entry.ast);
+}
+
+/**
+ * checks a division plan against native division for the given dividends
+ *
+ * @returns whether all quotients and remainders match
+ */
+static bool divisionMatches(uint64_t divisor, size_t width, bool isSigned,
+                            uint64_t firstDividend, uint64_t stride) {
+  DivisionPlan plan;
+  divisionPlanCreate(divisor, width, isSigned, &plan);
+  uint64_t mask = (UINT64_C(1) << width) - 1;
+  for (uint64_t n = firstDividend; n <= mask; n += stride) {
+    uint64_t quotient;
+    uint64_t remainder;
+    if (isSigned) {
+      int32_t a = width == 8 ? (int8_t)n : (int16_t)n;
+      int32_t b = width == 8 ? (int8_t)divisor : (int16_t)divisor;
+      quotient = (uint64_t)(a / b) & mask;
+      remainder = (uint64_t)(a % b) & mask;
+    } else {
+      quotient = n / divisor;
+      remainder = n % divisor;
+    }
+    if (divisionPlanQuotient(&plan, n) != quotient ||
+        divisionPlanRemainder(&plan, n) != remainder)
+      return false;
+  }
+  return true;
+}
+
+static void testStrengthReduction(void) {
+  bool matches = true;
+  for (uint64_t d = 1; d <= UINT8_MAX; ++d)
+    matches = matches && divisionMatches(d, 8, false, 0, 1);
+  test("unsigned 8 bit division matches for all values", matches);
+
+  matches = true;
+  for (uint64_t d = 1; d <= UINT8_MAX; ++d)
+    matches = matches && divisionMatches(d, 8, true, 0, 1);
+  test("signed 8 bit division matches for all values", matches);
+
+  matches = true;
+  for (uint64_t d = 1; d <= UINT16_MAX; ++d)
+    matches = matches && divisionMatches(d, 16, false, d % 509, 509);
+  test("unsigned 16 bit division matches for all divisors", matches);
+
+  matches = true;
+  for (uint64_t d = 1; d <= UINT16_MAX; ++d)
+    matches = matches && divisionMatches(d, 16, true, d % 509, 509);
+  test("signed 16 bit division matches for all divisors", matches);
+
+  matches = true;
+  for (uint64_t d = 1; d <= 64; ++d)
+    matches = matches && divisionMatches(d, 16, false, 0, 1) &&
+              divisionMatches(UINT16_MAX + 1 - d, 16, false, 0, 1);
+  test("unsigned 16 bit division matches for all dividends", matches);
+
+  matches = true;
+  for (uint64_t d = 1; d <= 64; ++d)
+    matches = matches && divisionMatches(d, 16, true, 0, 1) &&
+              divisionMatches(UINT16_MAX + 1 - d, 16, true, 0, 1);
+  test("signed 16 bit division matches for all dividends", matches);
+
+  DivisionPlan plan;
+  divisionPlanCreate(7, 32, false, &plan);
+  test("unsigned 32 bit division by 7 needs an add",
+       plan.kind == DK_MAGICADD &&
+           divisionPlanQuotient(&plan, UINT32_MAX) == UINT32_MAX / 7);
+  divisionPlanCreate(3, 32, true, &plan);
+  test("signed 32 bit division by 3 uses the known magic number",
+       plan.kind == DK_MAGIC && plan.multiplier == 0x55555556 &&
+           plan.shift == 0 &&
+           divisionPlanQuotient(&plan, (uint32_t)-7) == (uint32_t)-2);
+  divisionPlanCreate(10, 64, false, &plan);
+  test("unsigned 64 bit division by 10 is correct",
+       plan.kind == DK_MAGIC &&
+           divisionPlanQuotient(&plan, UINT64_MAX) == UINT64_MAX / 10 &&
+           divisionPlanRemainder(&plan, UINT64_MAX) == UINT64_MAX % 10);
+  divisionPlanCreate((uint64_t)-7, 64, true, &plan);
+  test("signed 64 bit division by -7 is correct",
+       plan.kind == DK_MAGIC &&
+           divisionPlanQuotient(&plan, (uint64_t)INT64_MIN) ==
+               (uint64_t)(INT64_MIN / -7) &&
+           divisionPlanRemainder(&plan, (uint64_t)INT64_MIN) ==
+               (uint64_t)(INT64_MIN % -7));
+  divisionPlanCreate((uint64_t)-8, 64, true, &plan);
+  test("signed division by a negative power of two is a shift",
+       plan.kind == DK_SIGNEDSHIFT && plan.shift == 3 &&
+           divisionPlanQuotient(&plan, (uint64_t)-9) == 1 &&
+           divisionPlanRemainder(&plan, (uint64_t)-9) == (uint64_t)-1);
+  divisionPlanCreate(UINT64_MAX - 1, 64, false, &plan);
+  test("unsigned division by a huge divisor is a comparison",
+       plan.kind == DK_COMPARE && divisionPlanQuotient(&plan, UINT64_MAX) == 1);
+
+  matches = true;
+  for (int64_t c = -1024; c <= 1024; ++c) {
+    MultiplicationPlan multiplication;
+    if (c == 0 || c == 1 || !multiplicationPlanCreate(c, &multiplication))
+      continue;
+    for (uint64_t x = 0; x <= UINT16_MAX; x += 17)
+      matches = matches && multiplicationPlanProduct(&multiplication, x) ==
+                               x * (uint64_t)c;
+  }
+  test("multiplication plans match multiplication", matches);
+
+  MultiplicationPlan multiplication;
+  test("multiplication by 9 is one lea",
+       multiplicationPlanCreate(9, &multiplication) &&
+           multiplication.numSteps == 1 &&
+           multiplication.steps[0].kind == MS_LEA);
+  test("multiplication by 45 is two leas",
+       multiplicationPlanCreate(45, &multiplication) &&
+           multiplication.numSteps == 2);
+  test("multiplication by -3 is a lea and a negation",
+       multiplicationPlanCreate(-3, &multiplication) &&
+           multiplication.numSteps == 2 &&
+           multiplication.steps[1].kind == MS_NEGATE);
+  test("multiplication by INT64_MIN is a shift and a negation",
+       multiplicationPlanCreate(INT64_MIN, &multiplication) &&
+           multiplicationPlanProduct(&multiplication, 3) == (uint64_t)1 << 63);
+  test("multiplication by 12345 is left to imul",
+       !multiplicationPlanCreate(12345, &multiplication));
+
+  FileListEntry entry;
+  Vector *stmts =
+      parseFunctionBody(&entry, "testFiles/optimization/strengthReduction.tc");
+  test("strength reduction file parses", stmts != NULL);
+  if (stmts == NULL) return;
+
+  BinOpType op;
+  Node *operand;
+  int64_t constant;
+  Node *exp;
+
+  exp = ((Node *)stmts->elements[0])->data.expressionStmt.expression;
+  test("division by a constant is a candidate",
+       strengthReductionCandidate(exp, &op, &operand, &constant) &&
+           op == BO_DIV && constant == 7);
+  exp = ((Node *)stmts->elements[1])->data.expressionStmt.expression;
+  test("modulo by a constant is a candidate",
+       strengthReductionCandidate(exp, &op, &operand, &constant) &&
+           op == BO_MOD && constant == 10);
+  exp = ((Node *)stmts->elements[2])->data.expressionStmt.expression;
+  test("multiplication of a constant is a candidate",
+       strengthReductionCandidate(exp, &op, &operand, &constant) &&
+           op == BO_MUL && constant == 5 && operand->type == NT_ID);
+  exp = ((Node *)stmts->elements[3])->data.expressionStmt.expression;
+  test("compound multiplication is a candidate",
+       strengthReductionCandidate(exp, &op, &operand, &constant) &&
+           op == BO_MUL && constant == 10);
+  exp = ((Node *)stmts->elements[4])->data.expressionStmt.expression;
+  test("compound division by a negative constant is a candidate",
+       strengthReductionCandidate(exp, &op, &operand, &constant) &&
+           op == BO_DIV && constant == -3);
+  for (size_t idx = 5; idx < 10; ++idx) {
+    exp = ((Node *)stmts->elements[idx])->data.expressionStmt.expression;
+    test("non-candidate is not strength reduced",
+         !strengthReductionCandidate(exp, &op, &operand, &constant));
+  }
+
+  nodeFree(entry.ast);
+}
+
+static void testCallingConvention(void) {
+  FileListEntry entries[2];
+  fileList.entries = &entries[0];
+  fileList.size = 2;
+
+  entries[0].inputFilename = "testFiles/optimization/callingConvention.tc";
+  entries[0].isCode = true;
+  entries[0].errored = false;
+  entries[1].inputFilename = "testFiles/optimization/callingConvention.td";
+  entries[1].isCode = false;
+  entries[1].errored = false;
+  test("calling convention files parse", parse() == 0);
+  if (entries[0].errored || entries[1].errored) return;
+
+  Vector *bodies = entries[0].ast->data.file.bodies;
+  test("exported function uses System V",
+       callingConventionOf(&entries[0], bodies->elements[0]) == CC_SYSV);
+  test("private function uses the internal convention",
+       callingConventionOf(&entries[0], bodies->elements[1]) == CC_INTERNAL);
+  test("private leaf function uses the internal convention",
+       callingConventionOf(&entries[0], bodies->elements[2]) == CC_INTERNAL);
+  test("private function with its address taken uses System V",
+       callingConventionOf(&entries[0], bodies->elements[3]) == CC_SYSV);
+  test("private function with its address taken by a scoped name uses "
+       "System V",
+       callingConventionOf(&entries[0], bodies->elements[5]) == CC_SYSV);
+  test("undeclared main uses System V",
+       callingConventionOf(&entries[0], bodies->elements[7]) == CC_SYSV);
+  test("declared function uses System V",
+       callingConventionOf(&entries[1],
+                           entries[1].ast->data.file.bodies->elements[0]) ==
+           CC_SYSV);
+
+  test("function with calls is not a leaf",
+       !functionIsLeaf(bodies->elements[0]));
+  test("function without calls is a leaf", functionIsLeaf(bodies->elements[2]));
+
+  nodeFree(entries[0].ast);
+  nodeFree(entries[1].ast);
+
+  Vector types;
+  vectorInit(&types);
+  for (size_t idx = 0; idx < 9; ++idx)
+    vectorInsert(&types, keywordTypeCreate(TK_INT));
+  vectorInsert(&types, keywordTypeCreate(TK_DOUBLE));
+  ArgumentLocation locations[10];
+
+  test("System V passes six integers in registers",
+       callingConventionAssignArguments(CC_SYSV, &types, locations) == 3 &&
+           locations[5].reg == REG_R9 && locations[6].reg == REG_NONE &&
+           locations[8].stackIndex == 2 && locations[9].reg == REG_XMM0);
+  test("internal convention passes eight integers in registers",
+       callingConventionAssignArguments(CC_INTERNAL, &types, locations) == 1 &&
+           locations[7].reg == REG_R11 && locations[8].reg == REG_NONE &&
+           locations[8].stackIndex == 0 && locations[9].reg == REG_XMM0);
+
+  vectorUninit(&types, (void (*)(void *))typeFree);
+
+  test("System V preserves only callee-saved registers",
+       callingConventionPreserved(CC_SYSV, 0) ==
+           (1U << REG_RBX | 1U << REG_RBP | 1U << REG_RSP | 1U << REG_R12 |
+            1U << REG_R13 | 1U << REG_R14 | 1U << REG_R15));
+  RegisterSet preserved =
+      callingConventionPreserved(CC_INTERNAL, 1U << REG_RAX | 1U << REG_RDI);
+  test("internal convention preserves registers the callee doesn't clobber",
+       (preserved & (1U << REG_RAX | 1U << REG_RDI)) == 0 &&
+           (preserved & 1U << REG_R10) != 0 &&
+           (preserved & 1U << REG_XMM15) != 0);
+  test("leaf internal call needs no stack alignment",
+       !callingConventionNeedsAlignment(CC_INTERNAL, true) &&
+           callingConventionNeedsAlignment(CC_INTERNAL, false) &&
+           callingConventionNeedsAlignment(CC_SYSV, true));
+}
+
+static void testAddressing(void) {
+  FileListEntry entries[3];
+  fileList.entries = &entries[0];
+  fileList.size = 3;
+
+  entries[0].inputFilename = "testFiles/optimization/addressing.tc";
+  entries[0].isCode = true;
+  entries[0].errored = false;
+  entries[1].inputFilename = "testFiles/optimization/addressing.td";
+  entries[1].isCode = false;
+  entries[1].errored = false;
+  entries[2].inputFilename = "testFiles/optimization/other.td";
+  entries[2].isCode = false;
+  entries[2].errored = false;
+  test("addressing files parse", parse() == 0);
+  if (entries[0].errored || entries[1].errored || entries[2].errored) return;
+
+  FileListEntry *file = &entries[0];
+  SymbolTableEntry *exported =
+      hashMapGet(entries[0].ast->data.file.stab, "exported");
+  SymbolTableEntry *declared =
+      hashMapGet(entries[1].ast->data.file.stab, "exported");
+  SymbolTableEntry *hidden =
+      hashMapGet(entries[0].ast->data.file.stab, "hidden");
+  SymbolTableEntry *external =
+      hashMapGet(entries[2].ast->data.file.stab, "external");
+  SymbolTableEntry *externalFunction =
+      hashMapGet(entries[2].ast->data.file.stab, "externalFunction");
+  SymbolTableEntry *exportedCounter =
+      hashMapGet(entries[0].ast->data.file.stab, "exportedCounter");
+  SymbolTableEntry *hiddenCounter =
+      hashMapGet(entries[0].ast->data.file.stab, "hiddenCounter");
+  SymbolTableEntry *externalCounter =
+      hashMapGet(entries[2].ast->data.file.stab, "externalCounter");
+
+  test("fixed-position code uses absolute addresses",
+       dataAddressingOf(OPTION_PD_PDC, file, external) == DA_ABSOLUTE &&
+           callTargetOf(OPTION_PD_PDC, file, externalFunction) == CT_DIRECT);
+  test("position independent executables never use the GOT or PLT",
+       dataAddressingOf(OPTION_PD_PIE, file, external) == DA_RIPRELATIVE &&
+           callTargetOf(OPTION_PD_PIE, file, externalFunction) == CT_DIRECT);
+  test("position independent code addresses private variables directly",
+       dataAddressingOf(OPTION_PD_PIC, file, hidden) == DA_RIPRELATIVE);
+  test("position independent code uses the GOT for exported variables",
+       dataAddressingOf(OPTION_PD_PIC, file, exported) == DA_GOT &&
+           dataAddressingOf(OPTION_PD_PIC, file, declared) == DA_GOT);
+  test("position independent code uses the GOT and PLT for other modules",
+       dataAddressingOf(OPTION_PD_PIC, file, external) == DA_GOT &&
+           callTargetOf(OPTION_PD_PIC, file, externalFunction) == CT_PLT);
+
+  test("private symbols are local",
+       symbolBindingOf(OPTION_PD_PIC, file, "hidden") == SB_LOCAL);
+  test("exported symbols are global",
+       symbolBindingOf(OPTION_PD_PIE, file, "exported") == SB_GLOBAL);
+  test("exported symbols are protected in position independent code",
+       symbolBindingOf(OPTION_PD_PIC, file, "exported") == SB_PROTECTED);
+  test("undeclared main is global",
+       symbolBindingOf(OPTION_PD_PIE, file, "main") == SB_GLOBAL);
+
+  test("executables use local-exec in the module",
+       tlsModelOf(OPTION_PD_PDC, OPTION_TM_GLOBAL_DYNAMIC, file,
+                  hiddenCounter) == TLS_LOCAL_EXEC &&
+           tlsModelOf(OPTION_PD_PIE, OPTION_TM_GLOBAL_DYNAMIC, file,
+                      exportedCounter) == TLS_LOCAL_EXEC);
+  test("executables use initial-exec for other modules",
+       tlsModelOf(OPTION_PD_PDC, OPTION_TM_GLOBAL_DYNAMIC, file,
+                  externalCounter) == TLS_INITIAL_EXEC &&
+           tlsModelOf(OPTION_PD_PIE, OPTION_TM_GLOBAL_DYNAMIC, file,
+                      externalCounter) == TLS_INITIAL_EXEC);
+  test("position independent code uses local-dynamic in the module",
+       tlsModelOf(OPTION_PD_PIC, OPTION_TM_GLOBAL_DYNAMIC, file,
+                  exportedCounter) == TLS_LOCAL_DYNAMIC &&
+           tlsModelOf(OPTION_PD_PIC, OPTION_TM_GLOBAL_DYNAMIC, file,
+                      hiddenCounter) == TLS_LOCAL_DYNAMIC);
+  test("position independent code uses general-dynamic for other modules",
+       tlsModelOf(OPTION_PD_PIC, OPTION_TM_GLOBAL_DYNAMIC, file,
+                  externalCounter) == TLS_GENERAL_DYNAMIC);
+  test("initial-exec limits the thread-local model",
+       tlsModelOf(OPTION_PD_PIC, OPTION_TM_INITIAL_EXEC, file,
+                  externalCounter) == TLS_INITIAL_EXEC &&
+           tlsModelOf(OPTION_PD_PIC, OPTION_TM_INITIAL_EXEC, file,
+                      hiddenCounter) == TLS_INITIAL_EXEC &&
+           tlsModelOf(OPTION_PD_PIE, OPTION_TM_INITIAL_EXEC, file,
+                      hiddenCounter) == TLS_LOCAL_EXEC);
+  test("local-exec limits the thread-local model",
+       tlsModelOf(OPTION_PD_PIC, OPTION_TM_LOCAL_EXEC, file,
+                  externalCounter) == TLS_LOCAL_EXEC);
+
+  char *operand = dataAddressOperand(DA_GOT, "foo");
+  test("GOT operand is formatted", strcmp(operand, "foo@GOTPCREL(%rip)") == 0);
+  free(operand);
+  operand = dataAddressOperand(DA_RIPRELATIVE, "foo");
+  test("relative operand is formatted", strcmp(operand, "foo(%rip)") == 0);
+  free(operand);
+  operand = tlsAddressOperand(TLS_LOCAL_EXEC, "foo");
+  test("local-exec operand is formatted",
+       strcmp(operand, "%fs:foo@tpoff") == 0);
+  free(operand);
+  operand = tlsAddressOperand(TLS_GENERAL_DYNAMIC, "foo");
+  test("general-dynamic operand is formatted",
+       strcmp(operand, "foo@tlsgd(%rip)") == 0);
+  free(operand);
+  operand = callTargetOperand(CT_PLT, "foo");
+  test("PLT operand is formatted", strcmp(operand, "foo@PLT") == 0);
+  free(operand);
+
+  nodeFree(entries[0].ast);
+  nodeFree(entries[1].ast);
+  nodeFree(entries[2].ast);
+}
+
+/**
+ * gets the summary of a function by name
+ *
+ * @param modRef ModRef to query
+ * @param file file the function is defined or declared in
+ * @param name name of the function
+ */
+static FunctionSummary const *summaryNamed(ModRef const *modRef,
+                                           FileListEntry *file,
+                                           char const *name) {
+  return modRefSummaryOf(modRef, hashMapGet(file->ast->data.file.stab, name));
+}
+
+/**
+ * gets the body of a function by name
+ *
+ * @param file file the function is defined in
+ * @param name name of the function
+ * @returns vector of statements
+ */
+static Vector *bodyNamed(FileListEntry *file, char const *name) {
+  Vector *bodies = file->ast->data.file.bodies;
+  for (size_t idx = 0; idx < bodies->size; ++idx) {
+    Node *body = bodies->elements[idx];
+    if (body->type == NT_FUNDEFN &&
+        strcmp(body->data.funDefn.name->data.id.id, name) == 0)
+      return body->data.funDefn.body->data.compoundStmt.stmts;
+  }
+  return NULL;
+}
+
+static void testModRef(void) {
+  FileListEntry entries[3];
+  fileList.entries = &entries[0];
+  fileList.size = 3;
+
+  entries[0].inputFilename = "testFiles/optimization/modRef.tc";
+  entries[0].isCode = true;
+  entries[0].errored = false;
+  entries[1].inputFilename = "testFiles/optimization/modRef.td";
+  entries[1].isCode = false;
+  entries[1].errored = false;
+  entries[2].inputFilename = "testFiles/optimization/lib.td";
+  entries[2].isCode = false;
+  entries[2].errored = false;
+  test("mod/ref files parse", parse() == 0);
+  if (entries[0].errored || entries[1].errored || entries[2].errored) return;
+
+  ModRef modRef;
+  modRefInit(&modRef);
+
+  FileListEntry *file = &entries[0];
+  HashMap *stab = entries[0].ast->data.file.stab;
+  SymbolTableEntry *total = hashMapGet(stab, "total");
+  SymbolTableEntry *counter = hashMapGet(entries[1].ast->data.file.stab,
+                                         "counter");
+  SymbolTableEntry *table = hashMapGet(stab, "table");
+  FunctionSummary const *summary;
+
+  test("function without memory accesses is pure",
+       functionSummaryEffect(summaryNamed(&modRef, file, "square")) == FE_PURE);
+  test("recursive function calling pure functions is pure",
+       functionSummaryEffect(summaryNamed(&modRef, file, "sumSquares")) ==
+           FE_PURE);
+
+  summary = summaryNamed(&modRef, file, "getTotal");
+  test("function reading a global is read-only",
+       functionSummaryEffect(summary) == FE_READONLY &&
+           summary->reads.size == 1 &&
+           pointerSetContains(&summary->reads, total) &&
+           summary->writes.size == 0);
+  summary = summaryNamed(&modRef, file, "setTotal");
+  test("function writing a global is write-only",
+       functionSummaryEffect(summary) == FE_UNKNOWN &&
+           functionSummaryIsWriteOnly(summary) && summary->reads.size == 0 &&
+           summary->writes.size == 1 &&
+           pointerSetContains(&summary->writes, total));
+
+  summary = summaryNamed(&modRef, &entries[1], "bump");
+  test("declaration uses the definition's summary",
+       summary != NULL && summary->node->type == NT_FUNDEFN &&
+           summary->reads.size == 2 && summary->writes.size == 1 &&
+           !summary->opaque);
+
+  summary = summaryNamed(&modRef, file, "copy");
+  test("pointer arguments are read and written through",
+       summary->argumentEffects[0] == AE_WRITE &&
+           summary->argumentEffects[1] == AE_READ &&
+           summary->argumentEffects[2] == 0 && !summary->writesUnknown &&
+           !summary->readsUnknown);
+  summary = summaryNamed(&modRef, file, "identity");
+  test("returned argument escapes",
+       summary->argumentEffects[0] == AE_ESCAPE &&
+           functionSummaryEffect(summary) == FE_PURE);
+  summary = summaryNamed(&modRef, file, "keep");
+  test("stored argument escapes",
+       summary->argumentEffects[0] == AE_ESCAPE && summary->writes.size == 1);
+
+  test("inline assembly taints a function",
+       summaryNamed(&modRef, file, "nop")->opaque);
+  test("volatile access taints a function",
+       summaryNamed(&modRef, file, "poll")->opaque);
+  test("access through a volatile cast taints a function",
+       summaryNamed(&modRef, file, "pollCast")->opaque &&
+           summaryNamed(&modRef, file, "pokeCast")->opaque);
+
+  test("declared pure function is pure",
+       functionSummaryEffect(summaryNamed(&modRef, &entries[2], "abs")) ==
+           FE_PURE);
+  summary = summaryNamed(&modRef, file, "measure");
+  test("declared read-only function propagates",
+       functionSummaryEffect(summary) == FE_READONLY &&
+           summary->argumentEffects[0] == AE_READ);
+  test("undeclared external function taints a function",
+       summaryNamed(&modRef, file, "shout")->opaque);
+
+  summary = summaryNamed(&modRef, file, "clearTable");
+  test("writes through the address of a global are tracked",
+       summary->writes.size == 1 &&
+           pointerSetContains(&summary->writes, table) &&
+           !summary->writesUnknown);
+
+  Vector *stmts = bodyNamed(file, "callers");
+  Node *sum = ((Node *)stmts->elements[0])->data.returnStmt.value;
+  Node *pureCall = sum->data.binOpExp.lhs;
+  Node *readCall = sum->data.binOpExp.rhs;
+  test("call to a pure function is pure",
+       modRefCallIsPure(&modRef, pureCall));
+  test("call to a read-only function isn't pure",
+       !modRefCallIsPure(&modRef, readCall));
+  test("call reads only what the callee reads",
+       modRefCallMayRead(&modRef, readCall, total) &&
+           !modRefCallMayRead(&modRef, readCall, counter) &&
+           !modRefCallMayWrite(&modRef, readCall, total));
+
+  stmts = bodyNamed(file, "writer");
+  Node *setCall = ((Node *)stmts->elements[0])->data.expressionStmt.expression;
+  Node *clearCall =
+      ((Node *)stmts->elements[1])->data.expressionStmt.expression;
+  test("call writes only what the callee writes",
+       modRefCallMayWrite(&modRef, setCall, total) &&
+           !modRefCallMayWrite(&modRef, setCall, counter) &&
+           !modRefCallMayWrite(&modRef, setCall, table) &&
+           modRefCallMayWrite(&modRef, clearCall, table) &&
+           !modRefCallMayWrite(&modRef, clearCall, total));
+
+  modRefUninit(&modRef);
+
+  nodeFree(entries[0].ast);
+  nodeFree(entries[1].ast);
+  nodeFree(entries[2].ast);
+}
+
+/**
+ * plans the promotion of the call returned by a function
+ *
+ * @param targets possible targets
+ * @param file file the function is defined in
+ * @param name name of the function, whose last statement returns a call
+ * @param promotion output pointer to the decision
+ */
+static void planReturnedCall(CallTargets const *targets, FileListEntry *file,
+                             char const *name, CallPromotion *promotion) {
+  Vector *stmts = bodyNamed(file, name);
+  Node *ret = stmts->elements[stmts->size - 1];
+  callPromotionPlan(targets, ret->data.returnStmt.value, promotion);
+}
+
+static void testCallPromotion(void) {
+  FileListEntry entries[2];
+  fileList.entries = &entries[0];
+  fileList.size = 2;
+
+  entries[0].inputFilename = "testFiles/optimization/callPromotion.tc";
+  entries[0].isCode = true;
+  entries[0].errored = false;
+  entries[1].inputFilename = "testFiles/optimization/callPromotion.td";
+  entries[1].isCode = false;
+  entries[1].errored = false;
+  test("call promotion files parse", parse() == 0);
+  if (entries[0].errored || entries[1].errored) return;
+
+  FileListEntry *file = &entries[0];
+  HashMap *stab = file->ast->data.file.stab;
+  SymbolTableEntry *add = hashMapGet(stab, "add");
+  SymbolTableEntry *sub = hashMapGet(stab, "sub");
+  SymbolTableEntry *mul = hashMapGet(stab, "mul");
+
+  CallTargets targets;
+  callTargetsInit(&targets);
+  CallPromotion promotion;
+
+  planReturnedCall(&targets, file, "direct", &promotion);
+  test("direct call isn't promoted", promotion.kind == CPK_NONE);
+  planReturnedCall(&targets, file, "global", &promotion);
+  test("call through private global is promoted exhaustively",
+       promotion.kind == CPK_EXHAUSTIVE && promotion.numTargets == 2 &&
+           promotion.targets[0] == add && promotion.targets[1] == sub);
+  planReturnedCall(&targets, file, "local", &promotion);
+  test("call through local is promoted exhaustively",
+       promotion.kind == CPK_EXHAUSTIVE && promotion.numTargets == 1 &&
+           promotion.targets[0] == mul);
+  planReturnedCall(&targets, file, "exported", &promotion);
+  test("call through exported global is guarded by type",
+       promotion.kind == CPK_GUARDED && promotion.numTargets == 3 &&
+           promotion.targets[0] == add && promotion.targets[1] == sub &&
+           promotion.targets[2] == mul);
+  planReturnedCall(&targets, file, "dispatch", &promotion);
+  test("call through dispatch table is guarded by type",
+       promotion.kind == CPK_GUARDED && promotion.numTargets == 3);
+  planReturnedCall(&targets, file, "field", &promotion);
+  test("call through struct field is guarded by type",
+       promotion.kind == CPK_GUARDED && promotion.numTargets == 3);
+  planReturnedCall(&targets, file, "argument", &promotion);
+  test("call with no matching targets isn't promoted",
+       promotion.kind == CPK_NONE);
+  planReturnedCall(&targets, file, "many", &promotion);
+  test("call through local with too many targets isn't promoted",
+       promotion.kind == CPK_NONE);
+
+  SymbolTableEntry *observed[] = {add, sub, mul};
+  uint64_t dominant[] = {10, 900, 90};
+  callPromotionFromProfile(observed, dominant, 3, &promotion);
+  test("dominant profiled targets are promoted",
+       promotion.kind == CPK_GUARDED && promotion.numTargets == 2 &&
+           promotion.targets[0] == sub && promotion.targets[1] == mul);
+  uint64_t even[] = {100, 100, 100};
+  callPromotionFromProfile(observed, even, 3, &promotion);
+  test("evenly spread profiled targets aren't promoted",
+       promotion.kind == CPK_NONE);
+
+  callTargetsUninit(&targets);
+
+  nodeFree(entries[0].ast);
+  nodeFree(entries[1].ast);
+}
+
+static void testValueRange(void) {
+  FileListEntry entry;
+  test("value range file parses",
+       parseFunctionBody(&entry, "testFiles/optimization/valueRange.tc") !=
+           NULL);
+  if (entry.errored) return;
+  Vector *stmts = bodyNamed(&entry, "bar");
+
+  Node *exps[16];
+  for (size_t idx = 0; idx < 16; ++idx)
+    exps[idx] = ((Node *)stmts->elements[idx])->data.expressionStmt.expression;
+  ValueRange range;
+  bool value;
+
+  test("widened addition doesn't wrap",
+       valueRangeOf(exps[0], &range) && range.min == 1 && range.max == 256);
+  test("remainder is bounded by the divisor",
+       valueRangeOf(exps[1], &range) && range.min == -9 && range.max == 9);
+  test("comparison against an out of range constant is folded",
+       comparisonFold(exps[2], &value) && value);
+  test("mask bounds a signed value",
+       valueRangeOf(exps[3], &range) && range.min == 0 && range.max == 255);
+  test("multiplication by a constant scales the range",
+       valueRangeOf(exps[4], &range) && range.min == 0 &&
+           range.max == 255000);
+  test("wrapping addition covers the whole type",
+       valueRangeOf(exps[5], &range) && range.min == 0 && range.max == 255);
+  test("unsigned value is never negative",
+       comparisonFold(exps[6], &value) && value);
+  test("comparison decided at runtime isn't folded",
+       !comparisonFold(exps[7], &value));
+  test("comparison with a call isn't folded",
+       !comparisonFold(exps[8], &value));
+
+  test("long division of longs stays 64 bit", arithmeticWidth(exps[9]) == 64);
+  test("long division of ints is narrowed", arithmeticWidth(exps[10]) == 32);
+  test("long division that may overflow an int isn't narrowed",
+       arithmeticWidth(exps[11]) == 64);
+  test("short arithmetic is widened", arithmeticWidth(exps[12]) == 32);
+
+  test("switch over a known range needs no bounds check",
+       !switchNeedsBoundsCheck(exps[13], 0, 15));
+  test("switch over a wider range needs a bounds check",
+       switchNeedsBoundsCheck(exps[13], 0, 7));
+
+  test("ubyte is zero extended",
+       extensionKindOf(exps[14], TK_UBYTE, TK_LONG) == EK_ZERO);
+  test("int is sign extended",
+       extensionKindOf(exps[15], TK_INT, TK_LONG) == EK_SIGN);
+  test("non-negative int needs no extension",
+       extensionKindOf(exps[3], TK_INT, TK_LONG) == EK_NONE);
+  test("narrowing needs no extension",
+       extensionKindOf(exps[15], TK_INT, TK_SHORT) == EK_NONE);
+  test("short is sign extended",
+       extensionKindOf(exps[12], TK_SHORT, TK_INT) == EK_SIGN);
+
+  Node *neg = ((Node *)stmts->elements[16])->data.expressionStmt.expression;
+  test("negation mirrors the range", valueRangeOf(neg, &range) &&
+                                         range.min == -32767 &&
+                                         range.max == 32768);
+  Node *shift = ((Node *)stmts->elements[17])->data.expressionStmt.expression;
+  test("logical shift bounds the range",
+       valueRangeOf(shift, &range) && range.min == 0 && range.max == 15);
+  Node *unsignedNeg =
+      ((Node *)stmts->elements[18])->data.expressionStmt.expression;
+  test("negating an unsigned value doesn't wrap",
+       valueRangeOf(unsignedNeg, &range) && range.min == -255 &&
+           range.max == 0);
+
+  nodeFree(entry.ast);
+}
+
+static void testFloatingPoint(void) {
+  FileListEntry entry;
+  Vector *stmts =
+      parseFunctionBody(&entry, "testFiles/optimization/floatingPoint.tc");
+  test("floating point file parses", stmts != NULL);
+  if (stmts == NULL) return;
+
+  Node *exps[16];
+  for (size_t idx = 0; idx < 16; ++idx)
+    exps[idx] = ((Node *)stmts->elements[idx])->data.expressionStmt.expression;
+  Options saved = options;
+  uint64_t reciprocal;
+  FusedMultiplyAdd fma;
+  ReductionUpdate update;
+  Node *folded;
+
+  options.associativeMath = OPTION_AM_STRICT;
+  options.signedZeros = OPTION_SZ_HONOR;
+  options.reciprocalMath = OPTION_RM_STRICT;
+  options.fpContract = OPTION_FPC_OFF;
+  test("division by a power of two always uses the reciprocal",
+       floatReciprocalDivision(exps[0], &reciprocal) &&
+           reciprocal == UINT64_C(0x4010000000000000));
+  test("division by an inexact reciprocal is kept",
+       !floatReciprocalDivision(exps[1], &reciprocal));
+  test("double division by a power of two always uses the reciprocal",
+       floatReciprocalDivision(exps[14], &reciprocal) &&
+           reciprocal == UINT64_C(0x4000000000000000));
+  test("strict mode doesn't contract", !floatContraction(exps[4], &fma));
+  test("strict mode doesn't reassociate float reductions",
+       !reductionUpdateRecognize(exps[7], &update));
+  test("integral reductions are always reassociated",
+       reductionUpdateRecognize(exps[8], &update) && update.op == BO_ADD);
+  test("adding negative zero is always folded",
+       floatIdentityFold(exps[10], &folded) && folded->type == NT_ID);
+  test("adding positive zero is kept with signed zeros",
+       !floatIdentityFold(exps[11], &folded));
+  test("multiplying by one is folded", floatIdentityFold(exps[12], &folded));
+  test("multiplying by one in a wider type is kept",
+       !floatIdentityFold(exps[13], &folded));
+
+  options.associativeMath = OPTION_AM_REASSOCIATE;
+  options.signedZeros = OPTION_SZ_IGNORE;
+  options.reciprocalMath = OPTION_RM_APPROXIMATE;
+  options.fpContract = OPTION_FPC_FAST;
+  test("reciprocal math replaces division by constants",
+       floatReciprocalDivision(exps[1], &reciprocal));
+  test("division by zero is never replaced",
+       !floatReciprocalDivision(exps[2], &reciprocal));
+  test("widened product isn't contracted", !floatContraction(exps[3], &fma));
+  test("sum with an operand of unknown type isn't contracted",
+       !floatContraction(exps[15], &fma));
+  test("multiply-add is contracted",
+       floatContraction(exps[4], &fma) && !fma.negateProduct &&
+           !fma.negateAddend);
+  test("subtracted product is contracted",
+       floatContraction(exps[5], &fma) && fma.negateProduct &&
+           !fma.negateAddend);
+  test("subtracted addend is contracted",
+       floatContraction(exps[6], &fma) && !fma.negateProduct &&
+           fma.negateAddend);
+  test("associative math reassociates float reductions",
+       reductionUpdateRecognize(exps[7], &update) && update.op == BO_ADD &&
+           update.operand->type == NT_BINOPEXP);
+  test("update using the accumulator isn't a reduction",
+       !reductionUpdateRecognize(exps[9], &update));
+  test("adding positive zero is folded without signed zeros",
+       floatIdentityFold(exps[11], &folded));
+
+  options = saved;
+  nodeFree(entry.ast);
+}
+
+static void testSections(void) {
+  FileListEntry entry;
+  fileList.entries = &entry;
+  fileList.size = 1;
+  entry.inputFilename = "testFiles/optimization/sections.tc";
+  entry.isCode = true;
+  entry.errored = false;
+  test("sections file parses", parse() == 0);
+  if (entry.errored) return;
+
+  Vector *bodies = entry.ast->data.file.bodies;
+  SectionKind kinds[9];
+  for (size_t idx = 0; idx < 9; ++idx) {
+    Node *body = bodies->elements[idx];
+    Node *name = body->data.varDefn.names->elements[0];
+    Node *initializer = body->data.varDefn.initializers->elements[0];
+    SymbolTableEntry *variable = name->data.id.entry;
+    kinds[idx] = variableSectionKind(variable->data.variable.type, initializer,
+                                     variable->data.variable.threadLocal);
+  }
+  test("uninitialized variable goes in bss", kinds[0] == SEC_BSS);
+  test("zero-initialized variable goes in bss", kinds[1] == SEC_BSS);
+  test("initialized variable goes in data", kinds[2] == SEC_DATA);
+  test("constant goes in rodata", kinds[3] == SEC_RODATA);
+  test("zero-initialized array goes in bss", kinds[4] == SEC_BSS);
+  test("initialized array goes in data", kinds[5] == SEC_DATA);
+  test("uninitialized thread-local goes in tbss", kinds[6] == SEC_TBSS);
+  test("initialized thread-local goes in tdata", kinds[7] == SEC_TDATA);
+  test("constant thread-local goes in tdata", kinds[8] == SEC_TDATA);
+
+  Options saved = options;
+  char *name;
+  options.functionSections = OPTION_FS_COMBINED;
+  options.dataSections = OPTION_DS_COMBINED;
+  name = sectionName(SEC_TEXT, "foo");
+  test("functions share .text by default", strcmp(name, ".text") == 0);
+  free(name);
+  name = sectionName(SEC_BSS, "foo");
+  test("variables share .bss by default", strcmp(name, ".bss") == 0);
+  free(name);
+
+  options.functionSections = OPTION_FS_SEPARATE;
+  name = sectionName(SEC_TEXT, "foo");
+  test("function sections are named after the function",
+       strcmp(name, ".text.foo") == 0);
+  free(name);
+  name = sectionName(SEC_RODATA, "foo");
+  test("function sections don't separate variables",
+       strcmp(name, ".rodata") == 0);
+  free(name);
+
+  options.dataSections = OPTION_DS_SEPARATE;
+  name = sectionName(SEC_DATA, "foo");
+  test("data sections are named after the variable",
+       strcmp(name, ".data.foo") == 0);
+  free(name);
+  name = sectionName(SEC_TBSS, "foo");
+  test("data sections separate thread-locals", strcmp(name, ".tbss.foo") == 0);
+  free(name);
+
+  options.dataSections = OPTION_DS_COMBINED;
+  char *emitted[4];
+  for (size_t idx = 0; idx < 4; ++idx) {
+    Node *body = bodies->elements[9 + idx];
+    Node *id = body->data.varDefn.names->elements[0];
+    SymbolTableEntry *variable = id->data.id.entry;
+    FILE *file = tmpfile();
+    packedArrayEmit(file, id->data.id.id, variable->data.variable.type,
+                    body->data.varDefn.initializers->elements[0],
+                    variable->data.variable.threadLocal);
+    emitted[idx] = readTmpfile(file);
+  }
+  test("packed array is emitted at its element width",
+       strcmp(emitted[0],
+              "\t.section\t.data,\"aw\",@progbits\n"
+              "\t.balign\t4\n"
+              "table:\n"
+              "\t.long\t4294967295, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, "
+              "13, 200\n") == 0);
+  test("packed array is zero padded",
+       strstr(emitted[1], "\t.quad\t1, 2, ") != NULL &&
+           strstr(emitted[1], ", 16\n\t.zero\t32\n") != NULL);
+  test("packed integers are converted to floating point",
+       strstr(emitted[2], "\t.quad\t4607182418800017408, ") != NULL &&
+           strstr(emitted[2], ", 13830554455654793216\n") != NULL);
+  test("zero packed array only reserves space",
+       strcmp(emitted[3],
+              "\t.section\t.tbss,\"awT\",@nobits\n"
+              "\t.balign\t1\n"
+              "flags:\n"
+              "\t.zero\t16\n") == 0);
+  for (size_t idx = 0; idx < 4; ++idx) free(emitted[idx]);
+
+  options = saved;
+  nodeFree(entry.ast);
+}
+
+static void testCodeFolding(void) {
+  FileListEntry entries[2];
+  fileList.entries = &entries[0];
+  fileList.size = 2;
+
+  entries[0].inputFilename = "testFiles/optimization/codeFolding.tc";
+  entries[0].isCode = true;
+  entries[0].errored = false;
+  entries[1].inputFilename = "testFiles/optimization/codeFolding.td";
+  entries[1].isCode = false;
+  entries[1].errored = false;
+  test("code folding files parse", parse() == 0);
+  if (entries[0].errored || entries[1].errored) return;
+
+  HashMap *stab = entries[0].ast->data.file.stab;
+  CodeFolding folding;
+
+  codeFoldingInit(&folding, false);
+  test("identical accessor is folded",
+       codeFoldingTargetOf(&folding, hashMapGet(stab, "getXAgain")) ==
+           hashMapGet(stab, "getX"));
+  test("first copy keeps its code",
+       codeFoldingTargetOf(&folding, hashMapGet(stab, "getX")) == NULL);
+  test("accessor of another field isn't folded",
+       codeFoldingTargetOf(&folding, hashMapGet(stab, "getY")) == NULL);
+  test("identical recursive function is folded",
+       codeFoldingTargetOf(&folding, hashMapGet(stab, "total")) ==
+           hashMapGet(stab, "sum"));
+  test("function with renamed locals is folded",
+       codeFoldingTargetOf(&folding, hashMapGet(stab, "doubled")) ==
+           hashMapGet(stab, "scaled"));
+  test("function returning a different local isn't folded",
+       codeFoldingTargetOf(&folding, hashMapGet(stab, "swapped")) == NULL);
+  test("function with a different local type isn't folded",
+       codeFoldingTargetOf(&folding, hashMapGet(stab, "widened")) == NULL);
+  test("address-taken function isn't folded",
+       codeFoldingTargetOf(&folding, hashMapGet(stab, "taken")) == NULL);
+  test("exported function isn't folded outside whole-program mode",
+       codeFoldingTargetOf(&folding, hashMapGet(stab, "exportedGetX")) == NULL);
+  codeFoldingUninit(&folding);
+
+  codeFoldingInit(&folding, true);
+  test("exported function is folded in whole-program mode",
+       codeFoldingTargetOf(&folding, hashMapGet(stab, "exportedGetX")) ==
+           hashMapGet(stab, "getX"));
+  codeFoldingUninit(&folding);
+
+  nodeFree(entries[0].ast);
+  nodeFree(entries[1].ast);
+}
+
+static void testLayout(void) {
+  FileListEntry entry;
+  fileList.entries = &entry;
+  fileList.size = 1;
+
+  entry.inputFilename = "testFiles/optimization/layout.tc";
+  entry.isCode = true;
+  entry.errored = false;
+  test("layout file parses", parse() == 0);
+  if (entry.errored) return;
+
+  HashMap *stab = entry.ast->data.file.stab;
+  SymbolTableEntry *small = hashMapGet(stab, "Small");
+  SymbolTableEntry *negative = hashMapGet(stab, "Negative");
+  SymbolTableEntry *medium = hashMapGet(stab, "Medium");
+  SymbolTableEntry *large = hashMapGet(stab, "Large");
+  SymbolTableEntry *negativeMedium = hashMapGet(stab, "NegativeMedium");
+  SymbolTableEntry *message = hashMapGet(stab, "Message");
+  SymbolTableEntry *choice = hashMapGet(stab, "Choice");
+  SymbolTableEntry *kinds = hashMapGet(stab, "kinds");
+  SymbolTableEntry *messages = hashMapGet(stab, "messages");
+
+  test("small enum is a ubyte", enumStorageType(small) == TK_UBYTE);
+  test("enum with a negative constant is signed",
+       enumStorageType(negative) == TK_BYTE);
+  test("enum over 255 is a ushort", enumStorageType(medium) == TK_USHORT);
+  test("enum over 65535 is a uint", enumStorageType(large) == TK_UINT);
+  test("enum under -128 is a short",
+       enumStorageType(negativeMedium) == TK_SHORT);
+
+  size_t size;
+  size_t alignment;
+  typeLayout(kinds->data.variable.type, &size, &alignment);
+  test("array of small enums takes a byte per element",
+       size == 12 && alignment == 1);
+  test("enum fields are packed", structFieldOffset(message, 1) == 1);
+  test("int field is aligned after enum fields",
+       structFieldOffset(message, 2) == 4);
+  test("wider enum field is aligned to its width",
+       structFieldOffset(message, 3) == 8);
+  typeLayout(messages->data.variable.type, &size, &alignment);
+  test("struct of enums is padded to its alignment",
+       size == 2 * 12 && alignment == 4);
+  Type *choiceType = referenceTypeCreate(choice, NULL);
+  typeLayout(choiceType, &size, &alignment);
+  test("union takes its widest option", size == 8 && alignment == 8);
+  typeFree(choiceType);
+
+  Options saved = options;
+  options.enumWidth = OPTION_EW_32;
+  test("pinned width widens small enums", enumStorageType(small) == TK_UINT);
+  test("pinned width keeps signedness",
+       enumStorageType(negative) == TK_INT);
+  options.enumWidth = OPTION_EW_8;
+  test("pinned narrow width still fits every constant",
+       enumStorageType(large) == TK_UINT);
+  options.enumWidth = OPTION_EW_64;
+  test("pinned 64 bit width matches the old layout",
+       enumStorageType(small) == TK_ULONG);
+  typeLayout(messages->data.variable.type, &size, &alignment);
+  test("pinned width applies to fields", size == 2 * 32 && alignment == 8);
+  options = saved;
+
+  nodeFree(entry.ast);
+}
+
+static bool memoryPlanHasMoves(MemoryPlan const *plan,
+                               MemoryMove const *expected, size_t count) {
+  if (plan->strategy != MS_INLINE || plan->moves.size != count) return false;
+  for (size_t idx = 0; idx < count; ++idx) {
+    MemoryMove const *move = plan->moves.elements[idx];
+    if (move->offset != expected[idx].offset ||
+        move->width != expected[idx].width)
+      return false;
+  }
+  return true;
+}
+
+static void initPlanOf(Node *stmt, InitPlan *plan) {
+  Node *name = stmt->data.varDefnStmt.names->elements[0];
+  initPlanCreate(name->data.id.entry->data.variable.type,
+                 stmt->data.varDefnStmt.initializers->elements[0], plan);
+}
+
+static void testMemoryOps(void) {
+  MemoryPlan plan;
+
+  memoryPlanCreate(0, &plan);
+  test("empty copy has no moves", memoryPlanHasMoves(&plan, NULL, 0));
+  memoryPlanUninit(&plan);
+
+  memoryPlanCreate(8, &plan);
+  MemoryMove const single[] = {{0, 8}};
+  test("power of two copy is one move",
+       memoryPlanHasMoves(&plan, single, 1));
+  memoryPlanUninit(&plan);
+
+  memoryPlanCreate(12, &plan);
+  MemoryMove const twelve[] = {{0, 8}, {4, 8}};
+  test("small copy uses overlapping moves",
+       memoryPlanHasMoves(&plan, twelve, 2));
+  memoryPlanUninit(&plan);
+
+  memoryPlanCreate(3, &plan);
+  MemoryMove const three[] = {{0, 2}, {1, 2}};
+  test("tiny copy uses overlapping moves", memoryPlanHasMoves(&plan, three, 2));
+  memoryPlanUninit(&plan);
+
+  memoryPlanCreate(40, &plan);
+  MemoryMove const forty[] = {{0, 16}, {16, 16}, {24, 16}};
+  test("medium copy ends with an overlapping tail",
+       memoryPlanHasMoves(&plan, forty, 3));
+  memoryPlanUninit(&plan);
+
+  memoryPlanCreate(MEMORY_INLINE_LIMIT, &plan);
+  test("copy at the inline limit is inline",
+       plan.strategy == MS_INLINE &&
+           plan.moves.size == MEMORY_INLINE_LIMIT / MEMORY_MOVE_MAX);
+  memoryPlanUninit(&plan);
+
+  Options saved = options;
+  options.tune = OPTION_MT_SKYLAKE;
+  memoryPlanCreate(4096, &plan);
+  test("large copy uses rep movsb with fast string instructions",
+       plan.strategy == MS_REP && plan.moves.size == 0);
+  memoryPlanUninit(&plan);
+  memoryPlanCreate(1024, &plan);
+  test("copy under the rep threshold calls the runtime",
+       plan.strategy == MS_CALL);
+  memoryPlanUninit(&plan);
+  options.tune = OPTION_MT_GENERIC;
+  memoryPlanCreate(4096, &plan);
+  test("large generic copy calls the runtime", plan.strategy == MS_CALL);
+  memoryPlanUninit(&plan);
+  options = saved;
+
+  FileListEntry entry;
+  fileList.entries = &entry;
+  fileList.size = 1;
+
+  entry.inputFilename = "testFiles/optimization/memoryOps.tc";
+  entry.isCode = true;
+  entry.errored = false;
+  test("memory operation file parses", parse() == 0);
+  if (entry.errored) return;
+
+  Vector *stmts = bodyNamed(&entry, "assign");
+  Node *exp;
+
+  exp = ((Node *)stmts->elements[2])->data.expressionStmt.expression;
+  test("record assignment is a bulk copy",
+       assignmentPlanCreate(exp, &plan) && plan.size == 4096 &&
+           plan.strategy != MS_INLINE);
+  memoryPlanUninit(&plan);
+  exp = ((Node *)stmts->elements[5])->data.expressionStmt.expression;
+  test("struct assignment is a copy",
+       assignmentPlanCreate(exp, &plan) && plan.size == 16 &&
+           plan.moves.size == 1);
+  memoryPlanUninit(&plan);
+  exp = ((Node *)stmts->elements[8])->data.expressionStmt.expression;
+  MemoryMove const array[] = {{0, 16}, {8, 16}};
+  test("array assignment is a copy", assignmentPlanCreate(exp, &plan) &&
+                                         memoryPlanHasMoves(&plan, array, 2));
+  memoryPlanUninit(&plan);
+  exp = ((Node *)stmts->elements[11])->data.expressionStmt.expression;
+  test("scalar assignment isn't a copy", !assignmentPlanCreate(exp, &plan));
+  exp = ((Node *)stmts->elements[12])->data.expressionStmt.expression;
+  test("compound assignment isn't a copy", !assignmentPlanCreate(exp, &plan));
+  exp = ((Node *)stmts->elements[14])->data.expressionStmt.expression;
+  test("assignment through a pointer is a copy",
+       assignmentPlanCreate(exp, &plan) && plan.size == 16);
+  memoryPlanUninit(&plan);
+  exp = ((Node *)stmts->elements[16])->data.expressionStmt.expression;
+  test("assignment to a field through a pointer is a copy",
+       assignmentPlanCreate(exp, &plan) && plan.size == 16);
+  memoryPlanUninit(&plan);
+  exp = ((Node *)stmts->elements[18])->data.expressionStmt.expression;
+  test("assignment to an element is a copy",
+       assignmentPlanCreate(exp, &plan) && plan.size == 16);
+  memoryPlanUninit(&plan);
+  exp = ((Node *)stmts->elements[20])->data.expressionStmt.expression;
+  test("assignment to a union option is a copy",
+       assignmentPlanCreate(exp, &plan) && plan.size == 16);
+  memoryPlanUninit(&plan);
+  exp = ((Node *)stmts->elements[21])->data.expressionStmt.expression;
+  test("assignment to a scalar field isn't a copy",
+       !assignmentPlanCreate(exp, &plan));
+
+  stmts = bodyNamed(&entry, "pass");
+  Vector *arguments = ((Node *)stmts->elements[2])
+                          ->data.expressionStmt.expression->data.funCallExp
+                          .arguments;
+  test("large struct argument is copied to the stack",
+       argumentPlanCreate(arguments->elements[0], &plan) &&
+           plan.size == 4096 && plan.strategy != MS_INLINE);
+  memoryPlanUninit(&plan);
+  test("small struct argument is passed in registers",
+       !argumentPlanCreate(arguments->elements[1], &plan));
+
+  stmts = bodyNamed(&entry, "init");
+  InitPlan init;
+  InitStore const *store;
+
+  initPlanOf(stmts->elements[0], &init);
+  test("dense initializer stores every field",
+       !init.zeroFirst && init.stores.size == 3);
+  store = init.stores.size == 3 ? init.stores.elements[2] : NULL;
+  test("field stores are placed by the layout",
+       store != NULL && store->offset == 8 && store->width == 8);
+  initPlanUninit(&init);
+
+  initPlanOf(stmts->elements[1], &init);
+  store = init.stores.size == 1 ? init.stores.elements[0] : NULL;
+  test("sparse initializer zeroes then patches",
+       init.zeroFirst && init.zero.size == 64 && store != NULL &&
+           store->offset == 20 && store->width == 4);
+  initPlanUninit(&init);
+
+  initPlanOf(stmts->elements[2], &init);
+  store = init.stores.size == 1 ? init.stores.elements[0] : NULL;
+  test("sparse packed initializer zeroes then patches",
+       init.zeroFirst && store != NULL && store->offset == 76 &&
+           store->element == 19);
+  initPlanUninit(&init);
+
+  initPlanOf(stmts->elements[3], &init);
+  test("zero initializer is only zeroing",
+       init.zeroFirst && init.stores.size == 0 && init.zero.moves.size == 2);
+  initPlanUninit(&init);
+
+  nodeFree(entry.ast);
+}
+
+static Pass const *pipelinePass(PassPipeline const *pipeline, size_t idx) {
+  return idx < pipeline->passes.size ? pipeline->passes.elements[idx] : NULL;
+}
+
+static void testPassManager(void) {
+  test("passes are found by name",
+       passLookup("fold-comparisons") != NULL &&
+           strcmp(passLookup("fold-comparisons")->name, "fold-comparisons") ==
+               0);
+  test("unknown pass isn't found", passLookup("fold") == NULL);
+
+  Options saved = options;
+  PassPipeline pipeline;
+
+  options.optimizationLevel = OPTION_O_0;
+  test("-O0 pipeline is valid", passPipelineInit(&pipeline) == 0);
+  test("-O0 runs no passes", pipeline.passes.size == 0);
+  passPipelineUninit(&pipeline);
+
+  options.optimizationLevel = OPTION_O_1;
+  test("-O1 pipeline is valid", passPipelineInit(&pipeline) == 0);
+  test("-O1 folds comparisons",
+       pipeline.passes.size == 1 &&
+           pipelinePass(&pipeline, 0) == passLookup("fold-comparisons"));
+  passPipelineUninit(&pipeline);
+
+  options.optimizationLevel = OPTION_O_2;
+  options.disabledPasses = "fold-comparisons";
+  test("pipeline with a disabled pass is valid",
+       passPipelineInit(&pipeline) == 0);
+  test("disabled pass doesn't run",
+       pipeline.passes.size == 1 &&
+           pipelinePass(&pipeline, 0) == passLookup("fold-float-identities"));
+  passPipelineUninit(&pipeline);
+  options.disabledPasses = NULL;
+
+  options.passPipeline = "fold-float-identities,fold-comparisons";
+  test("explicit pipeline is valid", passPipelineInit(&pipeline) == 0);
+  test("explicit pipeline replaces the level's pipeline",
+       pipeline.passes.size == 2 &&
+           pipelinePass(&pipeline, 0) == passLookup("fold-float-identities") &&
+           pipelinePass(&pipeline, 1) == passLookup("fold-comparisons"));
+  passPipelineUninit(&pipeline);
+
+  options.passPipeline = "";
+  test("empty pipeline is valid", passPipelineInit(&pipeline) == 0);
+  test("empty pipeline runs no passes", pipeline.passes.size == 0);
+  passPipelineUninit(&pipeline);
+
+  options.passPipeline = "fold-comparisons,bogus";
+  test("pipeline with an unknown pass is rejected",
+       passPipelineInit(&pipeline) != 0);
+  passPipelineUninit(&pipeline);
+  options.passPipeline = NULL;
+  options.printAfter = "all";
+  test("printing after all passes is valid",
+       passPipelineInit(&pipeline) == 0);
+  passPipelineUninit(&pipeline);
+  options.printAfter = NULL;
+  options.disabledPasses = "all";
+  test("all isn't a pass to disable", passPipelineInit(&pipeline) != 0);
+  passPipelineUninit(&pipeline);
+  options.disabledPasses = NULL;
+
+  FileListEntry entry;
+  fileList.entries = &entry;
+  fileList.size = 1;
+
+  entry.inputFilename = "testFiles/optimization/passManager.tc";
+  entry.isCode = true;
+  entry.errored = false;
+  test("pass manager file parses", parse() == 0);
+  if (entry.errored) {
+    options = saved;
+    return;
+  }
+
+  Node *unknown = ((Node *)bodyNamed(&entry, "unknown")->elements[0])
+                      ->data.returnStmt.value;
+  test("parsed AST is well formed", astVerify(&entry));
+  Node *rhs = unknown->data.binOpExp.rhs;
+  unknown->data.binOpExp.rhs = NULL;
+  test("missing operand is malformed", !astVerify(&entry));
+  unknown->data.binOpExp.rhs = rhs;
+
+  size_t sizeBefore = astSize(&entry);
+  TimeReport report;
+  timeReportInit(&report);
+  test("-O2 pipeline is valid", passPipelineInit(&pipeline) == 0);
+  passPipelineRun(&pipeline, &report);
+  passPipelineUninit(&pipeline);
+
+  Node *alwaysTrue = ((Node *)bodyNamed(&entry, "alwaysTrue")->elements[0])
+                         ->data.returnStmt.value;
+  Node *same =
+      ((Node *)bodyNamed(&entry, "same")->elements[0])->data.returnStmt.value;
+  test("decided comparison is folded",
+       alwaysTrue->type == NT_LITERAL &&
+           alwaysTrue->data.literal.literalType == LT_BOOL &&
+           alwaysTrue->data.literal.data.boolVal);
+  test("identity multiplication is folded", same->type == NT_ID);
+  test("undecided comparison is kept", unknown->type == NT_BINOPEXP);
+  test("folded AST is well formed", astVerify(&entry));
+  test("folding shrinks the AST", astSize(&entry) == sizeBefore - 4);
+
+  TimeReportEntry const *first =
+      report.entries.size == 2 ? report.entries.elements[0] : NULL;
+  test("each pass is timed", first != NULL &&
+                                 strcmp(first->name, "fold-comparisons") == 0 &&
+                                 first->hasSizes &&
+                                 first->sizeAfter == first->sizeBefore - 2);
+  timeReportUninit(&report);
+
+  options = saved;
+  nodeFree(entry.ast);
+
+  // every statement and expression the parser produces is well formed
+  char **filenames;
+  size_t numFiles = fuzzListFiles("testFiles/parser", &filenames);
+  size_t numVerified = 0;
+  bool parsedValid = true;
+  for (size_t idx = 0; idx < numFiles; ++idx) {
+    if (filenames[idx][strlen(filenames[idx]) - 1] != 'c') continue;
+    entry.inputFilename = filenames[idx];
+    entry.isCode = true;
+    entry.errored = false;
+    entry.ast = NULL;
+    if (parse() == 0) {
+      ++numVerified;
+      if (!astVerify(&entry)) {
+        fprintf(stderr, "%s: note: AST is malformed\n", filenames[idx]);
+        parsedValid = false;
+      }
+    }
+    nodeFree(entry.ast);
+  }
+  fuzzFilenamesFree(filenames, numFiles);
+  test("parsed ASTs are well formed", numVerified != 0 && parsedValid);
+}
+
+static Remark const *remarkAt(RemarkKind kind, size_t line) {
+  Vector const *remarks = remarksSaved();
+  for (size_t idx = 0; idx < remarks->size; ++idx) {
+    Remark const *r = remarks->elements[idx];
+    if (r->kind == kind && r->line == line) return r;
+  }
+  return NULL;
+}
+
+static void testRemarks(void) {
+  Options saved = options;
+
+  options.remarksPassed = "fold-(";
+  test("invalid remark regex is rejected", remarksInit() != 0);
+  options.remarksPassed = "fold-.*";
+  test("remark regex is accepted", remarksInit() == 0);
+  test("matching passed remarks are enabled",
+       remarkEnabled(RK_PASSED, "fold-comparisons"));
+  test("missed remarks are disabled without -Rpass-missed",
+       !remarkEnabled(RK_MISSED, "fold-comparisons"));
+  remarksUninit();
+  options.remarksPassed = NULL;
+
+  FileListEntry entry;
+  fileList.entries = &entry;
+  fileList.size = 1;
+
+  entry.inputFilename = "testFiles/optimization/passManager.tc";
+  entry.isCode = true;
+  entry.errored = false;
+  test("remarks file parses", parse() == 0);
+  if (entry.errored) {
+    options = saved;
+    return;
+  }
+
+  options.optimizationLevel = OPTION_O_2;
+  options.optimizationRecord = OPTION_OR_YAML;
+  PassPipeline pipeline;
+  test("remarks are initialized", remarksInit() == 0);
+  passPipelineInit(&pipeline);
+  passPipelineRun(&pipeline, NULL);
+  passPipelineUninit(&pipeline);
+
+  Remark const *r = remarkAt(RK_PASSED, 4);
+  test("folded comparison is remarked",
+       r != NULL && strcmp(r->pass, "fold-comparisons") == 0 &&
+           r->character == 10 && strcmp(r->function, "alwaysTrue") == 0 &&
+           strcmp(r->message, "comparison is always true") == 0);
+  r = remarkAt(RK_MISSED, 12);
+  test("undecided comparison is remarked as missed",
+       r != NULL && strcmp(r->function, "unknown") == 0);
+  r = remarkAt(RK_MISSED, 16);
+  test("positive zero addition is remarked as missed",
+       r != NULL && strcmp(r->pass, "fold-float-identities") == 0 &&
+           strstr(r->message, "-fno-signed-zeros") != NULL);
+
+  char *buffer;
+  size_t length;
+  FILE *record = open_memstream(&buffer, &length);
+  remarksWrite(record, &entry);
+  fclose(record);
+  test("remarks are saved as YAML",
+       strstr(buffer,
+              "--- !Passed\n"
+              "Pass: 'fold-comparisons'\n"
+              "DebugLoc: { File: 'testFiles/optimization/passManager.tc', "
+              "Line: 4, Column: 10 }\n"
+              "Function: 'alwaysTrue'\n"
+              "Message: 'comparison is always true'\n"
+              "...\n") == buffer);
+  free(buffer);
+
+  options.optimizationRecord = OPTION_OR_JSON;
+  record = open_memstream(&buffer, &length);
+  remarksWrite(record, &entry);
+  fclose(record);
+  test("remarks are saved as JSON",
+       strstr(buffer,
+              "[\n  {\"Kind\": \"Passed\", \"Pass\": "
+              "\"fold-comparisons\", \"DebugLoc\": {\"File\": "
+              "\"testFiles/optimization/passManager.tc\", \"Line\": 4, "
+              "\"Column\": 10}, \"Function\": \"alwaysTrue\", "
+              "\"Message\": \"comparison is always true\"},\n") == buffer &&
+           buffer[length - 2] == ']');
+  free(buffer);
+  remarksUninit();
+
+  options = saved;
+  nodeFree(entry.ast);
+}
+
+static void testFrame(void) {
+  FramePlan plan;
+  framePlanCreate(OPTION_FP_OMIT, true, 0, 0, &plan);
+  test("leaf without locals has no frame", framePlanIsEmpty(&plan));
+
+  framePlanCreate(OPTION_FP_OMIT, true, 96, 2, &plan);
+  test("small leaf uses the red zone",
+       plan.usesRedZone && plan.stackAdjustment == 0 && plan.frameSize == 112);
+
+  framePlanCreate(OPTION_FP_OMIT, true, 128, 1, &plan);
+  test("large leaf adjusts the stack pointer",
+       !plan.usesRedZone && plan.stackAdjustment == 128);
+
+  framePlanCreate(OPTION_FP_OMIT, false, 0, 0, &plan);
+  test("non-leaf aligns the stack",
+       !plan.usesRedZone && plan.stackAdjustment == 8);
+
+  framePlanCreate(OPTION_FP_OMIT, false, 20, 1, &plan);
+  test("non-leaf with a save aligns the stack",
+       plan.stackAdjustment == 32 && (8 + plan.frameSize) % 16 == 0);
+
+  framePlanCreate(OPTION_FP_KEEP, true, 0, 0, &plan);
+  test("frame pointer is kept when requested",
+       plan.usesFramePointer && !framePlanIsEmpty(&plan));
+
+  framePlanCreate(OPTION_FP_KEEP, false, 16, 0, &plan);
+  test("frame pointer counts towards alignment",
+       plan.stackAdjustment == 16 && (8 + plan.frameSize) % 16 == 0);
+
+  FileListEntry entry;
+  fileList.entries = &entry;
+  fileList.size = 1;
+  entry.inputFilename = "testFiles/optimization/frame.tc";
+  entry.isCode = true;
+  entry.errored = false;
+  test("frame file parses", parse() == 0);
+  if (entry.errored) return;
+
+  Vector *bodies = entry.ast->data.file.bodies;
+  test("accessor has nothing to shrink-wrap",
+       shrinkWrapPoint(bodies->elements[0]) == 0);
+  test("guard clauses run before the prologue",
+       shrinkWrapPoint(bodies->elements[1]) == 2);
+  test("guard clause with a call needs the prologue",
+       shrinkWrapPoint(bodies->elements[2]) == 0);
+
+  TuneOption savedTune = options.tune;
+  options.tune = OPTION_MT_GENERIC;
+  test("large aggregate copy is a call", !functionIsLeaf(bodies->elements[4]));
+  test("large aggregate initialization is a call",
+       !functionIsLeaf(bodies->elements[5]));
+  test("small aggregate initialization is inline",
+       functionIsLeaf(bodies->elements[6]));
+  framePlanCreate(OPTION_FP_OMIT, functionIsLeaf(bodies->elements[4]), 0, 0,
+                  &plan);
+  test("large aggregate copy doesn't use the red zone",
+       !plan.usesRedZone && (8 + plan.frameSize) % 16 == 0);
+  options.tune = savedTune;
+
+  nodeFree(entry.ast);
+}
+
+/**
+ * does a schedule order keep dependent instructions in their original order?
+ */
+static bool scheduleRespectsDependences(ScheduleInstruction const *block,
+                                        size_t count, size_t const *order) {
+  for (size_t first = 0; first < count; ++first) {
+    for (size_t second = first + 1; second < count; ++second) {
+      if (order[first] < order[second]) continue;
+      // a was originally before b, but is scheduled after it
+      ScheduleInstruction const *a = &block[order[second]];
+      ScheduleInstruction const *b = &block[order[first]];
+      for (size_t use = 0; use < b->numUses; ++use)
+        if (a->def != NO_REGISTER && b->uses[use] == a->def) return false;
+      for (size_t use = 0; use < a->numUses; ++use)
+        if (b->def != NO_REGISTER && a->uses[use] == b->def) return false;
+      if ((a->kind == IC_STORE &&
+           (b->kind == IC_LOAD || b->kind == IC_STORE)) ||
+          (a->kind == IC_LOAD && b->kind == IC_STORE) || b->kind == IC_BRANCH)
+        return false;
+    }
+  }
+  return true;
+}
+
+static void testOutliner(void) {
+  // a four instruction sequence shared by three functions
+  OutlinerInstruction first[] = {
+      {1, 3, true, false}, {2, 4, true, false}, {3, 4, true, false},
+      {4, 3, true, false}, {10, 1, true, true},
+  };
+  OutlinerInstruction second[] = {
+      {7, 2, true, false}, {1, 3, true, false}, {2, 4, true, false},
+      {3, 4, true, false}, {4, 3, true, false}, {8, 2, true, false},
+      {10, 1, true, true},
+  };
+  OutlinerInstruction third[] = {
+      {1, 3, true, false}, {2, 4, true, false},  {3, 4, true, false},
+      {4, 3, true, false}, {11, 5, false, false}, {1, 3, true, false},
+      {2, 4, true, false}, {11, 5, false, false}, {3, 4, true, false},
+      {4, 3, true, false},
+  };
+  OutlinerFunction functions[] = {
+      {first, sizeof(first) / sizeof(OutlinerInstruction)},
+      {second, sizeof(second) / sizeof(OutlinerInstruction)},
+      {third, sizeof(third) / sizeof(OutlinerInstruction)},
+  };
+  OutlinePlan plan;
+
+  outlinePlanCreate(functions, 3, 1, &plan);
+  OutlinedSequence const *sequence =
+      plan.sequences.size == 1 ? plan.sequences.elements[0] : NULL;
+  test("shared sequence is outlined once", sequence != NULL);
+  if (sequence != NULL) {
+    test("shared sequence is the whole repeat",
+         sequence->length == 4 && sequence->size == 14 && !sequence->tail);
+    test("shared sequence replaces every complete occurrence",
+         sequence->numSites == 3 && sequence->sites[0].function == 0 &&
+             sequence->sites[0].start == 0 &&
+             sequence->sites[1].function == 1 &&
+             sequence->sites[1].start == 1 &&
+             sequence->sites[2].function == 2 &&
+             sequence->sites[2].start == 0);
+    test("benefit accounts for calls and the return",
+         sequence->benefit == 3 * 14 - (3 * 5 + 14 + 1));
+  }
+  outlinePlanUninit(&plan);
+
+  outlinePlanCreate(functions, 3, 16, &plan);
+  test("sequence saving too little isn't outlined", plan.sequences.size == 0);
+  outlinePlanUninit(&plan);
+
+  outlinePlanCreate(functions, 3, 0, &plan);
+  test("nothing is outlined when outlining is off", plan.sequences.size == 0);
+  outlinePlanUninit(&plan);
+
+  // two functions sharing all 100 instructions - longer than the longest
+  // sequence outlined
+  OutlinerInstruction longSequence[200];
+  for (size_t idx = 0; idx < 200; ++idx) {
+    OutlinerInstruction instruction = {idx % 100 + 100, 4, true, false};
+    longSequence[idx] = instruction;
+  }
+  OutlinerFunction longFunctions[] = {
+      {longSequence, 100},
+      {longSequence + 100, 100},
+  };
+  outlinePlanCreate(longFunctions, 2, 1, &plan);
+  sequence = plan.sequences.size >= 1 ? plan.sequences.elements[0] : NULL;
+  test("long sequence is outlined in bounded pieces",
+       sequence != NULL && sequence->length == OUTLINE_MAX_LENGTH &&
+           sequence->numSites == 2);
+  outlinePlanUninit(&plan);
+
+  // a shared tail, which is jumped to
+  OutlinerInstruction tailFirst[] = {
+      {20, 2, true, false},
+      {5, 6, true, false},
+      {6, 6, true, false},
+      {10, 1, true, true},
+  };
+  OutlinerInstruction tailSecond[] = {
+      {21, 2, true, false},
+      {5, 6, true, false},
+      {6, 6, true, false},
+      {10, 1, true, true},
+  };
+  OutlinerFunction tails[] = {
+      {tailFirst, sizeof(tailFirst) / sizeof(OutlinerInstruction)},
+      {tailSecond, sizeof(tailSecond) / sizeof(OutlinerInstruction)},
+  };
+  outlinePlanCreate(tails, 2, 1, &plan);
+  sequence = plan.sequences.size == 1 ? plan.sequences.elements[0] : NULL;
+  test("shared tail is outlined",
+       sequence != NULL && sequence->tail && sequence->length == 3 &&
+           sequence->numSites == 2 && sequence->benefit == 26 - (10 + 13));
+  outlinePlanUninit(&plan);
+
+  Options saved = options;
+  options.optimizationLevel = OPTION_O_2;
+  test("outlining is off at -O2", outlinerMinimumBenefit() == 0);
+  options.optimizationLevel = OPTION_O_S;
+  test("outlining at -Os needs a larger benefit",
+       outlinerMinimumBenefit() == OUTLINE_OS_MIN_BENEFIT);
+  options.optimizationLevel = OPTION_O_Z;
+  test("outlining at -Oz takes any benefit", outlinerMinimumBenefit() == 1);
+  options = saved;
+}
+
+static void testSchedule(void) {
+  // two independent floating point chains, one after the other
+  ScheduleInstruction chains[] = {
+      {IC_LOAD, 0, {100}, 1},
+      {IC_FMUL, 1, {0, 0}, 2},
+      {IC_FADD, 2, {1, 0}, 2},
+      {IC_FMUL, 3, {2, 2}, 2},
+      {IC_LOAD, 10, {101}, 1},
+      {IC_FMUL, 11, {10, 10}, 2},
+      {IC_FADD, 12, {11, 10}, 2},
+      {IC_FMUL, 13, {12, 12}, 2},
+      {IC_STORE, NO_REGISTER, {3, 100}, 2},
+      {IC_STORE, NO_REGISTER, {13, 101}, 2},
+      {IC_ALU, 14, {102}, 1},
+      {IC_BRANCH, NO_REGISTER, {14}, 1},
+  };
+  size_t count = sizeof(chains) / sizeof(ScheduleInstruction);
+  size_t original[sizeof(chains) / sizeof(ScheduleInstruction)];
+  size_t order[sizeof(chains) / sizeof(ScheduleInstruction)];
+  for (size_t idx = 0; idx < count; ++idx) original[idx] = idx;
+
+  scheduleBlock(chains, count, OPTION_MT_SKYLAKE, 16, order);
+  test("schedule respects dependences",
+       scheduleRespectsDependences(chains, count, order));
+  test("branch is scheduled last", order[count - 1] == count - 1);
+  test("independent chains are overlapped",
+       scheduleLength(chains, count, order, OPTION_MT_SKYLAKE) <
+           scheduleLength(chains, count, original, OPTION_MT_SKYLAKE));
+
+  scheduleBlock(chains, count, OPTION_MT_GENERIC, 16, order);
+  test("generic schedule is no worse than the original",
+       scheduleRespectsDependences(chains, count, order) &&
+           scheduleLength(chains, count, order, OPTION_MT_GENERIC) <=
+               scheduleLength(chains, count, original, OPTION_MT_GENERIC));
+
+  // eight loads summed together
+  ScheduleInstruction sum[] = {
+      {IC_LOAD, 0, {100}, 1},
+      {IC_LOAD, 1, {100}, 1},
+      {IC_LOAD, 2, {100}, 1},
+      {IC_LOAD, 3, {100}, 1},
+      {IC_LOAD, 4, {100}, 1},
+      {IC_LOAD, 5, {100}, 1},
+      {IC_LOAD, 6, {100}, 1},
+      {IC_LOAD, 7, {100}, 1},
+      {IC_ALU, 8, {0, 1}, 2},
+      {IC_ALU, 9, {8, 2}, 2},
+      {IC_ALU, 10, {9, 3}, 2},
+      {IC_ALU, 11, {10, 4}, 2},
+      {IC_ALU, 12, {11, 5}, 2},
+      {IC_ALU, 13, {12, 6}, 2},
+      {IC_ALU, 14, {13, 7}, 2},
+      {IC_STORE, NO_REGISTER, {14, 100}, 2},
+  };
+  size_t sumCount = sizeof(sum) / sizeof(ScheduleInstruction);
+  size_t sumOrder[sizeof(sum) / sizeof(ScheduleInstruction)];
+  scheduleBlock(sum, sumCount, OPTION_MT_SKYLAKE, 64, sumOrder);
+  size_t unlimitedPressure = schedulePressure(sum, sumCount, sumOrder);
+  scheduleBlock(sum, sumCount, OPTION_MT_SKYLAKE, 3, sumOrder);
+  test("schedule respects dependences under pressure",
+       scheduleRespectsDependences(sum, sumCount, sumOrder));
+  test("register pressure is limited",
+       schedulePressure(sum, sumCount, sumOrder) < unlimitedPressure);
+
+  // a long block of independent load and add pairs
+  size_t longCount = 3 * MAX_SCHEDULE_REGION + 5;
+  ScheduleInstruction *longBlock =
+      malloc(longCount * sizeof(ScheduleInstruction));
+  for (size_t idx = 0; idx < longCount; ++idx) {
+    if (idx % 2 == 0)
+      longBlock[idx] = (ScheduleInstruction){IC_LOAD, idx, {100}, 1};
+    else
+      longBlock[idx] = (ScheduleInstruction){IC_ALU, idx, {idx - 1}, 1};
+  }
+  size_t *longOrder = malloc(longCount * sizeof(size_t));
+  scheduleBlock(longBlock, longCount, OPTION_MT_SKYLAKE, 16, longOrder);
+  bool withinRegions = true;
+  for (size_t idx = 0; idx < longCount; ++idx)
+    withinRegions = withinRegions && longOrder[idx] / MAX_SCHEDULE_REGION ==
+                                         idx / MAX_SCHEDULE_REGION;
+  test("long blocks are scheduled in regions",
+       scheduleRespectsDependences(longBlock, longCount, longOrder) &&
+           withinRegions);
+  free(longOrder);
+  free(longBlock);
+}
+
+void testOptimization(void) {
+  testStringPool();
+  testIdioms();
+  testIfConversion();
+  testStrengthReduction();
+  testCallingConvention();
+  testAddressing();
+  testModRef();
+  testCallPromotion();
+  testValueRange();
+  testFloatingPoint();
+  testSections();
+  testCodeFolding();
+  testLayout();
+  testMemoryOps();
+  testFrame();
+  testSchedule();
+  testOutliner();
+  testPassManager();
+  testRemarks();
+}
@@ -28,8 +28,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "ast/dump.h"
+#include "bundle.h"
 #include "engine.h"
 #include "fileList.h"
 #include "tests.h"
@@ -148,6 +150,48 @@ static void testImportParser(void) {
   nodeFree(entries[2].ast);
 }
 
+static void testBundleParser(void) {
+  char bundleFilename[] = "/tmp/tlc-bundle-XXXXXX";
+  int fd = mkstemp(bundleFilename);
+  assert("couldn't create bundle" && fd != -1);
+  close(fd);
+
+  char const *inputs[] = {
+      "testFiles/parser/targetWithScope.td",
+      "testFiles/parser/target.td",
+  };
+  test("bundle is written", bundleWrite(bundleFilename, 2, inputs) == 0);
+  Bundle bundle;
+  test("bundle is read", bundleInit(&bundle, bundleFilename) == 0);
+  test("bundle has both modules", bundle.numMembers == 2);
+  test("bundle is sorted", bundleFind(&bundle, "target") == 0 &&
+                               bundleFind(&bundle, "target::with::scope") == 1);
+  test("bundle doesn't have other modules", bundleFind(&bundle, "foo") == 2);
+  test("bundled path is kept", strcmp(bundleMemberPath(&bundle, 0),
+                                      "testFiles/parser/target.td") == 0);
+
+  fileList.entries = malloc(sizeof(FileListEntry));
+  fileList.size = 1;
+  fileList.bundles = &bundle;
+  fileList.numBundles = 1;
+  fileList.entries[0].inputFilename = "testFiles/parser/importWithId.tc";
+  fileList.entries[0].isCode = true;
+  fileList.entries[0].errored = false;
+  test("parser accepts the file", parse() == 0);
+  test("file has not errored", fileList.entries[0].errored == false);
+  test("only the imported module is added", fileList.size == 2);
+  test("ast is correct",
+       dumpEqual(&fileList.entries[0],
+                 "testFiles/parser/expected/importWithId.txt"));
+  nodeFree(fileList.entries[0].ast);
+  nodeFree(fileList.entries[1].ast);
+  free(fileList.entries);
+  fileList.numBundles = 0;
+
+  bundleUninit(&bundle);
+  remove(bundleFilename);
+}
+
 static void testFunDefnParser(void) {
   FileListEntry entries[1];
   fileList.entries = &entries[0];
@@ -202,6 +246,13 @@ static void testFunDefnParser(void) {
        dumpEqual(&entries[0],
                  "testFiles/parser/expected/funDefnManyBodiesNoArgs.txt"));
   nodeFree(entries[0].ast);
+
+  entries[0].inputFilename = "testFiles/parser/funDefnUnclosedParen.tc";
+  entries[0].isCode = true;
+  entries[0].errored = false;
+  test("parser rejects the file", parse() != 0);
+  test("file has errored", entries[0].errored == true);
+  nodeFree(entries[0].ast);
 }
 
 static void testVarDefnParser(void) {
@@ -237,6 +288,32 @@ static void testVarDefnParser(void) {
   test("ast is correct",
        dumpEqual(&entries[0], "testFiles/parser/expected/varDefnMany.txt"));
   nodeFree(entries[0].ast);
+
+  entries[0].inputFilename = "testFiles/parser/varDefnErrors.tc";
+  entries[0].isCode = true;
+  entries[0].errored = false;
+  test("parser rejects the file", parse() != 0);
+  test("file has errored", entries[0].errored == true);
+  nodeFree(entries[0].ast);
+
+  entries[0].inputFilename = "testFiles/parser/varDefnThreadLocal.tc";
+  entries[0].isCode = true;
+  entries[0].errored = false;
+  test("parser accepts the file", parse() == 0);
+  test("file has not errored", entries[0].errored == false);
+  test("ast is correct",
+       dumpEqual(&entries[0],
+                 "testFiles/parser/expected/varDefnThreadLocal.txt"));
+  nodeFree(entries[0].ast);
+
+  entries[0].inputFilename = "testFiles/parser/varDefnMixed.tc";
+  entries[0].isCode = true;
+  entries[0].errored = false;
+  test("parser accepts the file", parse() == 0);
+  test("file has not errored", entries[0].errored == false);
+  test("ast is correct",
+       dumpEqual(&entries[0], "testFiles/parser/expected/varDefnMixed.txt"));
+  nodeFree(entries[0].ast);
 }
 
 static void testFunDeclParser(void) {
@@ -278,6 +355,17 @@ static void testFunDeclParser(void) {
        dumpEqual(&entries[0], "testFiles/parser/expected/funDeclManyArgs.txt"));
   nodeFree(entries[0].ast);
   nodeFree(entries[1].ast);
+
+  entries[0].inputFilename = "testFiles/parser/funDeclEffects.td";
+  entries[0].isCode = false;
+  entries[0].errored = false;
+  entries[1].errored = false;
+  test("parser accepts the file", parse() == 0);
+  test("file has not errored", entries[0].errored == false);
+  test("ast is correct",
+       dumpEqual(&entries[0], "testFiles/parser/expected/funDeclEffects.txt"));
+  nodeFree(entries[0].ast);
+  nodeFree(entries[1].ast);
 }
 
 static void testVarDeclParser(void) {
@@ -308,6 +396,18 @@ static void testVarDeclParser(void) {
        dumpEqual(&entries[0], "testFiles/parser/expected/varDeclManyIds.txt"));
   nodeFree(entries[0].ast);
   nodeFree(entries[1].ast);
+
+  entries[0].inputFilename = "testFiles/parser/varDeclThreadLocal.td";
+  entries[0].isCode = false;
+  entries[0].errored = false;
+  entries[1].errored = false;
+  test("parser accepts the file", parse() == 0);
+  test("file has not errored", entries[0].errored == false);
+  test("ast is correct",
+       dumpEqual(&entries[0],
+                 "testFiles/parser/expected/varDeclThreadLocal.txt"));
+  nodeFree(entries[0].ast);
+  nodeFree(entries[1].ast);
 }
 
 static void testOpaqueDeclParser(void) {
@@ -509,6 +609,15 @@ static void testIfStmtParser(void) {
        dumpEqual(&entries[0], "testFiles/parser/expected/ifWithElse.txt"));
   nodeFree(entries[0].ast);
 
+  entries[0].inputFilename = "testFiles/parser/ifWithHints.tc";
+  entries[0].isCode = true;
+  entries[0].errored = false;
+  test("parser accepts the file", parse() == 0);
+  test("file has not errored", entries[0].errored == false);
+  test("ast is correct",
+       dumpEqual(&entries[0], "testFiles/parser/expected/ifWithHints.txt"));
+  nodeFree(entries[0].ast);
+
   entries[0].inputFilename = "testFiles/parser/ifWithCompoundStmts.tc";
   entries[0].isCode = true;
   entries[0].errored = false;
@@ -1147,6 +1256,22 @@ static void testPrimaryExprParser(void) {
   nodeFree(entries[0].ast);
 }
 
+static void testAggregateInitParser(void) {
+  FileListEntry entries[1];
+  fileList.entries = &entries[0];
+  fileList.size = 1;
+
+  entries[0].inputFilename = "testFiles/parser/aggregateInitPacked.tc";
+  entries[0].isCode = true;
+  entries[0].errored = false;
+  test("parser accepts the file", parse() == 0);
+  test("file has not errored", entries[0].errored == false);
+  test("ast is correct",
+       dumpEqual(&entries[0],
+                 "testFiles/parser/expected/aggregateInitPacked.txt"));
+  nodeFree(entries[0].ast);
+}
+
 static void testTypeParser(void) {
   FileListEntry entries[1];
   fileList.entries = &entries[0];
@@ -1165,6 +1290,7 @@ static void testTypeParser(void) {
 void testParser(void) {
   testModuleParser();
   testImportParser();
+  testBundleParser();
 
   testFunDefnParser();
   testVarDefnParser();
@@ -1213,6 +1339,7 @@ void testParser(void) {
   testPrefixExprParser();
   testPostfixExprParser();
   testPrimaryExprParser();
+  testAggregateInitParser();
 
   testTypeParser();
 }
\ No newline at end of file
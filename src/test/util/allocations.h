@@ -0,0 +1,54 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * allocation counting
+ *
+ * the test executable is linked with malloc, calloc and realloc wrapped (see
+ * TLDFLAGS in the makefile), so every allocation made by the compiler under
+ * test goes through these wrappers
+ */
+
+#ifndef TLC_TEST_UTIL_ALLOCATIONS_H_
+#define TLC_TEST_UTIL_ALLOCATIONS_H_
+
+#include <stddef.h>
+
+/**
+ * @returns number of allocations (calls to malloc, calloc, or realloc) made
+ * since the program started
+ */
+size_t allocationCount(void);
+
+/** the real malloc, provided by the linker */
+void *__real_malloc(size_t size);
+/** the real calloc, provided by the linker */
+void *__real_calloc(size_t num, size_t size);
+/** the real realloc, provided by the linker */
+void *__real_realloc(void *ptr, size_t size);
+
+/** counting replacement for malloc */
+void *__wrap_malloc(size_t size);
+/** counting replacement for calloc */
+void *__wrap_calloc(size_t num, size_t size);
+/** counting replacement for realloc */
+void *__wrap_realloc(void *ptr, size_t size);
+
+#endif  // TLC_TEST_UTIL_ALLOCATIONS_H_
@@ -0,0 +1,806 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "util/fuzzer.h"
+
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "util/format.h"
+#include "util/random.h"
+
+/** limits on generated programs */
+enum {
+  MAX_DEPTH = 4,          /**< deepest nesting of statements or expressions */
+  MAX_LOCALS = 32,        /**< most locals visible at once */
+  MAX_BLOCK_LENGTH = 4,   /**< most statements in a compound statement */
+  MAX_LINE_LENGTH = 72,   /**< column after which a line is broken */
+  MUTATION_CHANCES = 1024 /**< mutation rates are out of this many */
+};
+
+/** generator state */
+typedef struct {
+  FILE *out;
+  unsigned mutationRate;
+  size_t column;          /**< length of the current line */
+  size_t numGlobals;      /**< globals g0 to gn are declared */
+  size_t numFunctions;    /**< functions f0 to fn are declared */
+  size_t nextName;        /**< number for the next top-level type name */
+  size_t nextLocal;       /**< number for the next local */
+  size_t locals[MAX_LOCALS]; /**< numbers of the visible locals */
+  size_t numLocals;       /**< number of visible locals */
+  size_t loopDepth;       /**< number of enclosing loops */
+  size_t breakDepth;      /**< number of enclosing loops and switches */
+} Generator;
+
+/** tokens substituted into near-valid programs */
+static char const *const MUTATIONS[] = {
+    "(", ")", "{", "}", ";", ",", "=", "::", "[", "]", "if", "int", "case",
+};
+
+/** base types - short and ushort are left out since they can't start a
+ * top-level definition */
+static char const *const BASE_TYPES[] = {
+    "ubyte", "byte",  "char",   "uint", "int",  "wchar",
+    "ulong", "long",  "float",  "double", "bool",
+};
+
+/** binary operators, at every precedence level */
+static char const *const BINOPS[] = {
+    "*", "/",  "%",  "+",  "-",  "<<", ">>", ">>>", "<=>", "<",
+    ">", "<=", ">=", "==", "!=", "&",  "|",  "^",   "&&",  "||",
+};
+
+/** assignment operators */
+static char const *const ASSIGNMENTS[] = {
+    "=",  "*=",  "/=",   "%=", "+=", "-=", "<<=", ">>=",
+    ">>>=", "&=", "^=", "|=", "&&=", "||=",
+};
+
+/** prefix operators */
+static char const *const PREFIXES[] = {"-", "!", "~", "++", "--"};
+
+/**
+ * picks a random number
+ *
+ * @param n number of choices
+ * @returns a number in [0, n)
+ */
+static size_t pick(size_t n) { return intRand() % n; }
+
+/**
+ * writes a token without mutating it
+ *
+ * @param g generator to write with
+ * @param token token to write
+ */
+static void writeToken(Generator *g, char const *token) {
+  size_t length = strlen(token);
+  if (g->column != 0 && g->column + length > MAX_LINE_LENGTH) {
+    fputc('\n', g->out);
+    g->column = 0;
+  }
+  if (g->column != 0) {
+    fputc(' ', g->out);
+    ++g->column;
+  }
+  fputs(token, g->out);
+  g->column += length;
+  if (strcmp(token, ";") == 0 || strcmp(token, "{") == 0 ||
+      strcmp(token, "}") == 0) {
+    fputc('\n', g->out);
+    g->column = 0;
+  }
+}
+
+/**
+ * writes a token, maybe mutating it
+ *
+ * @param g generator to write with
+ * @param token token to write
+ */
+static void emit(Generator *g, char const *token) {
+  if (g->mutationRate != 0 && pick(MUTATION_CHANCES) < g->mutationRate) {
+    switch (pick(3)) {
+      case 0: {
+        return;  // drop it
+      }
+      case 1: {
+        writeToken(g, token);  // duplicate it
+        break;
+      }
+      default: {
+        token = MUTATIONS[pick(sizeof(MUTATIONS) / sizeof(char const *))];
+        break;
+      }
+    }
+  }
+  writeToken(g, token);
+}
+
+/**
+ * writes a formatted token, maybe mutating it
+ *
+ * @param g generator to write with
+ * @param fmt format string
+ * @param number number to format
+ */
+static void emitNumbered(Generator *g, char const *fmt, size_t number) {
+  char *token = format(fmt, number);
+  emit(g, token);
+  free(token);
+}
+
+static void generateType(Generator *g) {
+  emit(g, BASE_TYPES[pick(sizeof(BASE_TYPES) / sizeof(char const *))]);
+  switch (pick(6)) {
+    case 0: {
+      emit(g, "*");
+      break;
+    }
+    case 1: {
+      emit(g, "const");
+      break;
+    }
+    case 2: {
+      emit(g, "[");
+      emitNumbered(g, "%zu", pick(16) + 1);
+      emit(g, "]");
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+static void generateLiteral(Generator *g) {
+  switch (pick(6)) {
+    case 0: {
+      emit(g, "true");
+      break;
+    }
+    case 1: {
+      emit(g, "'a'");
+      break;
+    }
+    case 2: {
+      emitNumbered(g, "0x%zx", pick(256));
+      break;
+    }
+    default: {
+      emitNumbered(g, "%zu", pick(100));
+      break;
+    }
+  }
+}
+
+static void generateExpression(Generator *g, size_t depth);
+
+static void generatePrimary(Generator *g) {
+  switch (pick(3)) {
+    case 0: {
+      if (g->numLocals != 0) {
+        emitNumbered(g, "l%zu", g->locals[pick(g->numLocals)]);
+        break;
+      }
+      generateLiteral(g);
+      break;
+    }
+    case 1: {
+      if (g->numGlobals != 0) {
+        emitNumbered(g, "g%zu", pick(g->numGlobals));
+        break;
+      }
+      generateLiteral(g);
+      break;
+    }
+    default: {
+      generateLiteral(g);
+      break;
+    }
+  }
+}
+
+static void generateExpression(Generator *g, size_t depth) {
+  if (depth >= MAX_DEPTH) {
+    generatePrimary(g);
+    return;
+  }
+
+  switch (pick(10)) {
+    case 0:
+    case 1:
+    case 2: {
+      generateExpression(g, depth + 1);
+      emit(g, BINOPS[pick(sizeof(BINOPS) / sizeof(char const *))]);
+      generateExpression(g, depth + 1);
+      break;
+    }
+    case 3: {
+      emit(g, PREFIXES[pick(sizeof(PREFIXES) / sizeof(char const *))]);
+      generateExpression(g, depth + 1);
+      break;
+    }
+    case 4: {
+      emit(g, "(");
+      generateExpression(g, depth + 1);
+      emit(g, ")");
+      break;
+    }
+    case 5: {
+      generateExpression(g, depth + 1);
+      emit(g, "?");
+      generateExpression(g, depth + 1);
+      emit(g, ":");
+      generateExpression(g, depth + 1);
+      break;
+    }
+    case 6: {
+      if (g->numFunctions == 0) {
+        generatePrimary(g);
+        break;
+      }
+      emitNumbered(g, "f%zu", pick(g->numFunctions));
+      emit(g, "(");
+      generateExpression(g, depth + 1);
+      emit(g, ",");
+      generateExpression(g, depth + 1);
+      emit(g, ")");
+      break;
+    }
+    case 7: {
+      emit(g, "cast");
+      emit(g, "<");
+      emit(g, BASE_TYPES[pick(sizeof(BASE_TYPES) / sizeof(char const *))]);
+      emit(g, ">");
+      emit(g, "(");
+      generateExpression(g, depth + 1);
+      emit(g, ")");
+      break;
+    }
+    case 8: {
+      if (g->numLocals == 0) {
+        emit(g, "sizeof");
+        emit(g, "(");
+        generateType(g);
+        emit(g, ")");
+        break;
+      }
+      emitNumbered(g, "l%zu", g->locals[pick(g->numLocals)]);
+      emit(g, ASSIGNMENTS[pick(sizeof(ASSIGNMENTS) / sizeof(char const *))]);
+      generateExpression(g, depth + 1);
+      break;
+    }
+    default: {
+      generatePrimary(g);
+      break;
+    }
+  }
+}
+
+/**
+ * writes the name of a new local
+ *
+ * @param g generator to write with
+ * @returns number of the local
+ */
+static size_t newLocal(Generator *g) {
+  emitNumbered(g, "l%zu", g->nextLocal);
+  return g->nextLocal++;
+}
+
+/**
+ * makes a local visible to later expressions, if there's room for it
+ *
+ * @param g generator to declare in
+ * @param local number of the local
+ */
+static void addLocal(Generator *g, size_t local) {
+  if (g->numLocals < MAX_LOCALS) g->locals[g->numLocals++] = local;
+}
+
+static void generateStatement(Generator *g, size_t depth);
+
+/**
+ * generates a statement in its own scope, so any local it declares isn't
+ * visible afterwards
+ *
+ * @param g generator to write with
+ * @param depth nesting depth of the statement
+ */
+static void generateScopedStatement(Generator *g, size_t depth) {
+  size_t numLocals = g->numLocals;
+  generateStatement(g, depth);
+  g->numLocals = numLocals;
+}
+
+static void generateCompound(Generator *g, size_t depth) {
+  size_t numLocals = g->numLocals;
+  emit(g, "{");
+  size_t length = pick(MAX_BLOCK_LENGTH + 1);
+  for (size_t idx = 0; idx < length; ++idx) generateStatement(g, depth + 1);
+  emit(g, "}");
+  g->numLocals = numLocals;
+}
+
+static void generateStatement(Generator *g, size_t depth) {
+  if (depth >= MAX_DEPTH) {
+    generateExpression(g, MAX_DEPTH - 1);
+    emit(g, ";");
+    return;
+  }
+
+  switch (pick(14)) {
+    case 0: {
+      generateCompound(g, depth);
+      break;
+    }
+    case 1: {
+      emit(g, "if");
+      emit(g, "(");
+      generateExpression(g, depth);
+      emit(g, ")");
+      generateCompound(g, depth);
+      if (pick(2) == 0) {
+        emit(g, "else");
+        generateScopedStatement(g, depth + 1);
+      }
+      break;
+    }
+    case 2: {
+      emit(g, "while");
+      emit(g, "(");
+      generateExpression(g, depth);
+      emit(g, ")");
+      ++g->loopDepth;
+      ++g->breakDepth;
+      generateCompound(g, depth);
+      --g->loopDepth;
+      --g->breakDepth;
+      break;
+    }
+    case 3: {
+      emit(g, "do");
+      ++g->loopDepth;
+      ++g->breakDepth;
+      generateCompound(g, depth);
+      --g->loopDepth;
+      --g->breakDepth;
+      emit(g, "while");
+      emit(g, "(");
+      generateExpression(g, depth);
+      emit(g, ")");
+      break;
+    }
+    case 4: {
+      size_t numLocals = g->numLocals;
+      emit(g, "for");
+      emit(g, "(");
+      emit(g, "int");
+      size_t counter = newLocal(g);
+      addLocal(g, counter);
+      emit(g, "=");
+      emit(g, "0");
+      emit(g, ";");
+      emitNumbered(g, "l%zu", counter);
+      emit(g, "<");
+      generateExpression(g, depth);
+      emit(g, ";");
+      emit(g, "++");
+      emitNumbered(g, "l%zu", counter);
+      emit(g, ")");
+      ++g->loopDepth;
+      ++g->breakDepth;
+      generateCompound(g, depth);
+      --g->loopDepth;
+      --g->breakDepth;
+      g->numLocals = numLocals;
+      break;
+    }
+    case 5: {
+      emit(g, "switch");
+      emit(g, "(");
+      generateExpression(g, depth);
+      emit(g, ")");
+      emit(g, "{");
+      ++g->breakDepth;
+      size_t numCases = pick(4) + 1;
+      for (size_t idx = 0; idx < numCases; ++idx) {
+        emit(g, "case");
+        emitNumbered(g, "%zu", idx);
+        emit(g, ":");
+        generateScopedStatement(g, depth + 1);
+      }
+      if (pick(2) == 0) {
+        emit(g, "default");
+        emit(g, ":");
+        generateScopedStatement(g, depth + 1);
+      }
+      --g->breakDepth;
+      emit(g, "}");
+      break;
+    }
+    case 6: {
+      if (g->breakDepth == 0) {
+        emit(g, ";");
+        break;
+      }
+      emit(g, g->loopDepth != 0 && pick(2) == 0 ? "continue" : "break");
+      emit(g, ";");
+      break;
+    }
+    case 7: {
+      emit(g, "return");
+      generateExpression(g, depth);
+      emit(g, ";");
+      break;
+    }
+    case 8:
+    case 9: {
+      emit(g, "int");
+      size_t local = newLocal(g);
+      if (pick(2) == 0) {
+        emit(g, "=");
+        generateExpression(g, depth);
+      }
+      emit(g, ";");
+      addLocal(g, local);
+      break;
+    }
+    default: {
+      generateExpression(g, depth);
+      emit(g, ";");
+      break;
+    }
+  }
+}
+
+static void generateFields(Generator *g) {
+  size_t numFields = pick(4) + 1;
+  for (size_t idx = 0; idx < numFields; ++idx) {
+    generateType(g);
+    emitNumbered(g, "m%zu", idx);
+    emit(g, ";");
+  }
+}
+
+static void generateTopLevel(Generator *g) {
+  switch (pick(10)) {
+    case 0: {
+      generateType(g);
+      emitNumbered(g, "g%zu", g->numGlobals++);
+      if (pick(2) == 0) {
+        emit(g, "=");
+        generateLiteral(g);
+      }
+      emit(g, ";");
+      break;
+    }
+    case 1: {
+      // function declarations aren't allowed in code files, so this is the
+      // multi-variable form of variable_definition instead
+      emit(g, "long");
+      emitNumbered(g, "g%zu", g->numGlobals++);
+      emit(g, ",");
+      emitNumbered(g, "g%zu", g->numGlobals++);
+      emit(g, "=");
+      generateLiteral(g);
+      emit(g, ";");
+      break;
+    }
+    case 2: {
+      emit(g, pick(2) == 0 ? "struct" : "union");
+      emitNumbered(g, "t%zu", g->nextName++);
+      emit(g, "{");
+      generateFields(g);
+      emit(g, "}");
+      emit(g, ";");
+      break;
+    }
+    case 3: {
+      emit(g, "enum");
+      emitNumbered(g, "t%zu", g->nextName++);
+      emit(g, "{");
+      size_t numConstants = pick(4) + 1;
+      for (size_t idx = 0; idx < numConstants; ++idx) {
+        emitNumbered(g, "c%zu", idx);
+        if (pick(2) == 0) {
+          emit(g, "=");
+          emitNumbered(g, "%zu", idx * 4);
+        }
+        emit(g, ",");
+      }
+      emit(g, "}");
+      emit(g, ";");
+      break;
+    }
+    case 4: {
+      emit(g, "typedef");
+      generateType(g);
+      emitNumbered(g, "t%zu", g->nextName++);
+      emit(g, ";");
+      break;
+    }
+    case 5: {
+      emit(g, "opaque");
+      emitNumbered(g, "t%zu", g->nextName++);
+      emit(g, ";");
+      break;
+    }
+    default: {
+      emit(g, "int");
+      emitNumbered(g, "f%zu", g->numFunctions++);
+      emit(g, "(");
+      emit(g, "int");
+      emit(g, "l0");
+      emit(g, ",");
+      emit(g, "int");
+      emit(g, "l1");
+      emit(g, ")");
+      g->locals[0] = 0;
+      g->locals[1] = 1;
+      g->numLocals = 2;
+      g->nextLocal = 2;
+      generateCompound(g, 0);
+      g->numLocals = 0;
+      break;
+    }
+  }
+}
+
+/**
+ * opens a file in a directory for writing, and starts a generator on it
+ *
+ * @param g generator to initialize
+ * @param directory directory to write in
+ * @param name name of the file
+ * @param mutationRate chance of mutating each token
+ * @returns status code (0 = OK)
+ */
+static int generatorInit(Generator *g, char const *directory, char const *name,
+                         unsigned mutationRate) {
+  char *filename = format("%s/%s", directory, name);
+  g->out = fopen(filename, "w");
+  free(filename);
+  if (g->out == NULL) return -1;
+
+  g->mutationRate = mutationRate;
+  g->column = 0;
+  g->numGlobals = 0;
+  g->numFunctions = 0;
+  g->nextName = 0;
+  g->nextLocal = 0;
+  g->numLocals = 0;
+  g->loopDepth = 0;
+  g->breakDepth = 0;
+  return 0;
+}
+
+/**
+ * finishes writing a file
+ *
+ * @param g generator to uninitialize
+ * @returns status code (0 = OK)
+ */
+static int generatorUninit(Generator *g) {
+  if (g->column != 0) fputc('\n', g->out);
+  return fclose(g->out) == 0 ? 0 : -1;
+}
+
+static int generateGrammar(char const *directory, size_t size,
+                           unsigned mutationRate) {
+  Generator g;
+  if (generatorInit(&g, directory, "fuzz.tc", mutationRate) != 0) return -1;
+
+  emit(&g, "module");
+  emit(&g, "fuzz");
+  emit(&g, ";");
+  for (size_t idx = 0; idx < size; ++idx) generateTopLevel(&g);
+
+  return generatorUninit(&g);
+}
+
+static int generateImports(char const *directory, size_t size,
+                           unsigned mutationRate) {
+  Generator g;
+  for (size_t idx = 0; idx < size; ++idx) {
+    char *name = format("m%zu.td", idx);
+    int retval = generatorInit(&g, directory, name, mutationRate);
+    free(name);
+    if (retval != 0) return -1;
+
+    emit(&g, "module");
+    emit(&g, "fuzz");
+    emit(&g, "::");
+    emitNumbered(&g, "m%zu", idx);
+    emit(&g, ";");
+    emit(&g, "int");
+    emitNumbered(&g, "v%zu", idx);
+    emit(&g, ";");
+    emit(&g, "enum");
+    emitNumbered(&g, "e%zu", idx);
+    emit(&g, "{");
+    emit(&g, "c0");
+    emit(&g, ",");
+    emit(&g, "c1");
+    emit(&g, ",");
+    emit(&g, "}");
+    emit(&g, ";");
+
+    if (generatorUninit(&g) != 0) return -1;
+  }
+
+  if (generatorInit(&g, directory, "fuzz.tc", mutationRate) != 0) return -1;
+  emit(&g, "module");
+  emit(&g, "fuzz");
+  emit(&g, ";");
+  for (size_t idx = 0; idx < size; ++idx) {
+    emit(&g, "import");
+    emit(&g, "fuzz");
+    emit(&g, "::");
+    emitNumbered(&g, "m%zu", idx);
+    emit(&g, ";");
+  }
+  return generatorUninit(&g);
+}
+
+static int generateEnumChain(char const *directory, size_t size,
+                             unsigned mutationRate) {
+  Generator g;
+  if (generatorInit(&g, directory, "fuzz.tc", mutationRate) != 0) return -1;
+
+  emit(&g, "module");
+  emit(&g, "fuzz");
+  emit(&g, ";");
+  // later enums come first, so every constant is a forward reference
+  for (size_t idx = size; idx-- > 0;) {
+    emit(&g, "enum");
+    emitNumbered(&g, "e%zu", idx);
+    emit(&g, "{");
+    emit(&g, "c");
+    emit(&g, "=");
+    if (idx == 0) {
+      emit(&g, "1");
+    } else {
+      emitNumbered(&g, "e%zu", idx - 1);
+      emit(&g, "::");
+      emit(&g, "c");
+    }
+    emit(&g, ",");
+    emit(&g, "}");
+    emit(&g, ";");
+  }
+
+  return generatorUninit(&g);
+}
+
+static int generateWideScope(char const *directory, size_t size,
+                             unsigned mutationRate) {
+  Generator g;
+  if (generatorInit(&g, directory, "fuzz.tc", mutationRate) != 0) return -1;
+
+  emit(&g, "module");
+  emit(&g, "fuzz");
+  emit(&g, ";");
+  for (size_t idx = 0; idx < size; ++idx) {
+    emit(&g, "int");
+    emitNumbered(&g, "g%zu", idx);
+    emit(&g, ";");
+  }
+
+  return generatorUninit(&g);
+}
+
+char const *fuzzShapeName(FuzzShape shape) {
+  switch (shape) {
+    case FS_GRAMMAR: {
+      return "grammar";
+    }
+    case FS_IMPORTS: {
+      return "imports";
+    }
+    case FS_ENUM_CHAIN: {
+      return "enumChain";
+    }
+    case FS_WIDE_SCOPE: {
+      return "wideScope";
+    }
+    default: {
+      return NULL;  // not a valid shape
+    }
+  }
+}
+
+int fuzzGenerate(char const *directory, FuzzShape shape, size_t size,
+                 unsigned mutationRate) {
+  switch (shape) {
+    case FS_GRAMMAR: {
+      return generateGrammar(directory, size, mutationRate);
+    }
+    case FS_IMPORTS: {
+      return generateImports(directory, size, mutationRate);
+    }
+    case FS_ENUM_CHAIN: {
+      return generateEnumChain(directory, size, mutationRate);
+    }
+    case FS_WIDE_SCOPE: {
+      return generateWideScope(directory, size, mutationRate);
+    }
+    default: {
+      return -1;  // not a valid shape
+    }
+  }
+}
+
+/**
+ * is a file name that of a T file
+ *
+ * @param name name to check
+ * @returns whether it ends in .tc or .td
+ */
+static bool isTFile(char const *name) {
+  size_t length = strlen(name);
+  return length > 3 && (strcmp(name + length - 3, ".tc") == 0 ||
+                        strcmp(name + length - 3, ".td") == 0);
+}
+
+/** compares two strings through pointers to them, for qsort */
+static int compareFilenames(void const *a, void const *b) {
+  return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+size_t fuzzListFiles(char const *directory, char ***filenames) {
+  size_t numFiles = 0;
+  size_t capacity = 1;
+  *filenames = malloc(capacity * sizeof(char *));
+
+  DIR *dir = opendir(directory);
+  if (dir == NULL) return 0;
+  for (struct dirent *entry = readdir(dir); entry != NULL;
+       entry = readdir(dir)) {
+    if (!isTFile(entry->d_name)) continue;
+    if (numFiles == capacity) {
+      capacity *= 2;
+      *filenames = realloc(*filenames, capacity * sizeof(char *));
+    }
+    (*filenames)[numFiles++] = format("%s/%s", directory, entry->d_name);
+  }
+  closedir(dir);
+
+  qsort(*filenames, numFiles, sizeof(char *), compareFilenames);
+  return numFiles;
+}
+
+void fuzzFilenamesFree(char **filenames, size_t numFiles) {
+  for (size_t idx = 0; idx < numFiles; ++idx) free(filenames[idx]);
+  free(filenames);
+}
+
+void fuzzRemove(char const *directory) {
+  char **filenames;
+  size_t numFiles = fuzzListFiles(directory, &filenames);
+  for (size_t idx = 0; idx < numFiles; ++idx) remove(filenames[idx]);
+  fuzzFilenamesFree(filenames, numFiles);
+  rmdir(directory);
+}
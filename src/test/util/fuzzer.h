@@ -0,0 +1,95 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * grammar-driven program generator
+ *
+ * generates random T programs by walking the productions in "Appendix B -
+ * Syntax.ebnf", as well as programs shaped to stress the parts of the front end
+ * whose cost depends on how many names are in play
+ */
+
+#ifndef TLC_TEST_UTIL_FUZZER_H_
+#define TLC_TEST_UTIL_FUZZER_H_
+
+#include <stddef.h>
+
+/** the kind of program to generate */
+typedef enum {
+  FS_GRAMMAR,    /**< random derivations of the whole grammar */
+  FS_IMPORTS,    /**< one code module importing many declaration modules */
+  FS_ENUM_CHAIN, /**< enums whose constants depend on the previous enum */
+  FS_WIDE_SCOPE, /**< many declarations in one scope */
+} FuzzShape;
+
+/**
+ * gets the name of a shape
+ *
+ * @param shape shape to name
+ * @returns name of the shape, non-owning
+ */
+char const *fuzzShapeName(FuzzShape shape);
+
+/**
+ * generates a program and writes its files into an existing directory
+ *
+ * the program has size top-level productions (FS_GRAMMAR), imported modules
+ * (FS_IMPORTS), enums (FS_ENUM_CHAIN), or declarations (FS_WIDE_SCOPE)
+ *
+ * randomness comes from util/random.h, so seed it with srand to get repeatable
+ * programs
+ *
+ * @param directory directory to write to
+ * @param shape kind of program to generate
+ * @param size how big the program should be
+ * @param mutationRate chance, out of 1024, that any emitted token is dropped,
+ * duplicated or replaced - zero generates syntactically valid programs, and
+ * small values generate near-valid ones
+ * @returns status code (0 = OK)
+ */
+int fuzzGenerate(char const *directory, FuzzShape shape, size_t size,
+                 unsigned mutationRate);
+
+/**
+ * lists the T files in a directory, in sorted order
+ *
+ * @param directory directory to list
+ * @param filenames output array of paths, owning - free with
+ * fuzzFilenamesFree
+ * @returns number of files listed
+ */
+size_t fuzzListFiles(char const *directory, char ***filenames);
+
+/**
+ * frees a list of files from fuzzListFiles
+ *
+ * @param filenames list to free
+ * @param numFiles number of files in the list
+ */
+void fuzzFilenamesFree(char **filenames, size_t numFiles);
+
+/**
+ * deletes every T file in a directory, and then the directory itself
+ *
+ * @param directory directory to remove
+ */
+void fuzzRemove(char const *directory);
+
+#endif  // TLC_TEST_UTIL_FUZZER_H_